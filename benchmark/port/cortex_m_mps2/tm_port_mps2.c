@@ -0,0 +1,250 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    Benchmark suite: port for ARM MPS2 boards as emulated by QEMU:
+ *
+ *       - mps2-an385: Cortex-M3;
+ *       - mps2-an386: Cortex-M4.
+ *
+ *    Console is the CMSDK UART0 (QEMU connects it to the stdio with
+ *    `-nographic`), exit is done via semihosting (QEMU should be run with
+ *    `-semihosting`).
+ *
+ *    This file also contains the startup code: the vector table and the
+ *    reset handler, so that no vendor files are needed.
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "tm_common.h"
+#include "tm_port.h"
+
+
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+//-- system clock frequency of the MPS2 FPGA images
+#define SYS_FREQ              25000000UL
+
+//-- register access
+#define REG32(addr)           (*(volatile unsigned long *)(addr))
+
+//-- CMSDK UART0
+#define UART0_BASE            0x40004000UL
+#define UART0_DATA            REG32(UART0_BASE + 0x00)
+#define UART0_STATE           REG32(UART0_BASE + 0x04)
+#define UART0_CTRL            REG32(UART0_BASE + 0x08)
+#define UART0_BAUDDIV         REG32(UART0_BASE + 0x10)
+
+#define UART_STATE_TX_FULL    (1 << 0)
+#define UART_CTRL_TX_EN       (1 << 0)
+
+//-- SysTick
+#define SYST_CSR              REG32(0xE000E010)
+#define SYST_RVR              REG32(0xE000E018)
+#define SYST_CVR              REG32(0xE000E01C)
+
+#define SYST_CSR_ENABLE       (1 << 0)
+#define SYST_CSR_TICKINT      (1 << 1)
+#define SYST_CSR_CLKSOURCE    (1 << 2)
+
+//-- SysTick is a 24-bit down-counter
+#define SYST_MAX              0x00ffffffUL
+
+//-- NVIC
+#define NVIC_ISER0            REG32(0xE000E100)
+#define NVIC_ISPR0            REG32(0xE000E200)
+
+//-- IRQ used as the test interrupt: it is wired to the FPGA peripherals
+//   which the benchmark doesn't use, so it can be pended by software freely.
+//   NOTE: vector_table assumes it is the last one.
+#define TEST_IRQ              31
+
+//-- number of external interrupts in the vector table
+#define IRQS_CNT              32
+
+//-- semihosting
+#define SEMIHOSTING_SYS_EXIT              0x18
+#define SEMIHOSTING_ADP_APP_EXIT          0x20026
+#define SEMIHOSTING_ADP_RUNTIME_ERROR     0x20023
+
+
+
+
+/*******************************************************************************
+ *    EXTERNAL DATA
+ ******************************************************************************/
+
+//-- defined by the linker script
+extern unsigned long _sidata;
+extern unsigned long _sdata;
+extern unsigned long _edata;
+extern unsigned long _sbss;
+extern unsigned long _ebss;
+extern unsigned long _estack;
+
+//-- implemented by the kernel
+void PendSV_Handler(void);
+void SVC_Handler(void);
+
+int main(void);
+
+
+
+
+/*******************************************************************************
+ *    ISRs
+ ******************************************************************************/
+
+void Reset_Handler(void)
+{
+   unsigned long *src = &_sidata;
+   unsigned long *dst;
+
+   for (dst = &_sdata; dst < &_edata; ){
+      *dst++ = *src++;
+   }
+
+   for (dst = &_sbss; dst < &_ebss; ){
+      *dst++ = 0;
+   }
+
+#if defined(__ARM_FP)
+   //-- enable FPU: set CP10 and CP11 full access
+   REG32(0xE000ED88) |= (0xf << 20);
+   __asm volatile ("dsb\n\tisb" ::: "memory");
+#endif
+
+   main();
+
+   tm_port_exit(1);
+}
+
+static void Default_Handler(void)
+{
+   tm_fail("unexpected exception");
+}
+
+static void SysTick_Handler(void)
+{
+   tn_tick_int_processing();
+}
+
+static void Test_IRQHandler(void)
+{
+   tm_interrupt_handler();
+}
+
+typedef void (*IsrFunc)(void);
+
+#define _DEF_HANDLERS_8                                                 \
+   Default_Handler, Default_Handler, Default_Handler, Default_Handler,  \
+   Default_Handler, Default_Handler, Default_Handler, Default_Handler
+
+__attribute__((section(".isr_vector"), used))
+static const IsrFunc vector_table[16 + IRQS_CNT] = {
+   (IsrFunc)&_estack,
+   Reset_Handler,
+   Default_Handler,     //-- NMI
+   Default_Handler,     //-- HardFault
+   Default_Handler,     //-- MemManage
+   Default_Handler,     //-- BusFault
+   Default_Handler,     //-- UsageFault
+   0, 0, 0, 0,
+   SVC_Handler,
+   Default_Handler,     //-- DebugMon
+   0,
+   PendSV_Handler,
+   SysTick_Handler,
+
+   //-- external interrupts: all of them are unexpected, except the test one
+   //   (the last one, see TEST_IRQ)
+   _DEF_HANDLERS_8, _DEF_HANDLERS_8, _DEF_HANDLERS_8,
+   Default_Handler, Default_Handler, Default_Handler, Default_Handler,
+   Default_Handler, Default_Handler, Default_Handler,
+   Test_IRQHandler,
+};
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC DATA
+ ******************************************************************************/
+
+const unsigned long tm_port_counter_mask = SYST_MAX;
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC FUNCTIONS
+ ******************************************************************************/
+
+void tm_port_hw_init(void)
+{
+   UART0_BAUDDIV = 16;
+   UART0_CTRL = UART_CTRL_TX_EN;
+
+   SYST_RVR = SYS_FREQ / TM_TICK_FREQ - 1;
+   SYST_CVR = 0;
+   SYST_CSR = SYST_CSR_ENABLE | SYST_CSR_TICKINT | SYST_CSR_CLKSOURCE;
+
+   NVIC_ISER0 = (1UL << TEST_IRQ);
+}
+
+void tm_port_counter_init(void)
+{
+   SYST_CSR = 0;
+   SYST_RVR = SYST_MAX;
+   SYST_CVR = 0;
+   SYST_CSR = SYST_CSR_ENABLE | SYST_CSR_CLKSOURCE;
+}
+
+unsigned long tm_port_counter_get(void)
+{
+   //-- SysTick counts down, and we need the counter counting up
+   return SYST_MAX - SYST_CVR;
+}
+
+void tm_port_putc(char c)
+{
+   while (UART0_STATE & UART_STATE_TX_FULL){
+      //-- wait
+   }
+   UART0_DATA = (unsigned char)c;
+}
+
+void tm_port_interrupt_raise(void)
+{
+   NVIC_ISPR0 = (1UL << TEST_IRQ);
+
+   //-- make sure the interrupt is taken before we go on
+   __asm volatile ("dsb\n\tisb" ::: "memory");
+}
+
+void tm_port_exit(int code)
+{
+   register unsigned long r0 __asm("r0") = SEMIHOSTING_SYS_EXIT;
+   register unsigned long r1 __asm("r1") = (code == 0)
+      ? SEMIHOSTING_ADP_APP_EXIT
+      : SEMIHOSTING_ADP_RUNTIME_ERROR;
+
+   __asm volatile ("bkpt 0xab" : : "r" (r0), "r" (r1) : "memory");
+
+   //-- if semihosting isn't available, just hang
+   for (;;);
+}
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
@@ -0,0 +1,86 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    Benchmark suite: interface which should be implemented by each port
+ *    (i.e. by each target the benchmark can run on).
+ *
+ ******************************************************************************/
+
+#ifndef _TM_PORT_H
+#define _TM_PORT_H
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "tn.h"
+
+
+
+/*******************************************************************************
+ *    PUBLIC FUNCTION PROTOTYPES
+ ******************************************************************************/
+
+/**
+ * Initialize the hardware: console output, system tick timer with the
+ * frequency `#TM_TICK_FREQ`, and the interrupt used by the interrupt
+ * processing tests (it should be enabled, but not yet triggered).
+ *
+ * Called from `main()` before the kernel is started.
+ */
+void tm_port_hw_init(void);
+
+/**
+ * Output one char to the console.
+ */
+void tm_port_putc(char c);
+
+/**
+ * Trigger the test interrupt. The port's ISR should call
+ * `#tm_interrupt_handler()`.
+ */
+void tm_port_interrupt_raise(void);
+
+/**
+ * Stop the target (and exit the simulator, if applicable) with the given
+ * code: 0 on success, non-zero on failure.
+ */
+void tm_port_exit(int code);
+
+/**
+ * Turn the system tick timer into the free-running counter, which is read by
+ * `#tm_port_counter_get()`; the system tick interrupt is disabled.
+ *
+ * Used by the instruction-count workload (tm_icount.c), which runs under
+ * QEMU with `-icount`, so the counter advances deterministically with each
+ * executed instruction.
+ */
+void tm_port_counter_init(void);
+
+/**
+ * Get the current value of the counter, see `#tm_port_counter_init()`. The
+ * counter counts up and wraps around; only bits from `#tm_port_counter_mask`
+ * are valid.
+ */
+unsigned long tm_port_counter_get(void);
+
+/**
+ * Mask of the valid bits of the counter value
+ */
+extern const unsigned long tm_port_counter_mask;
+
+/**
+ * Handler of the test interrupt, implemented by the test (or by the common
+ * code, if the test doesn't use the interrupt).
+ */
+void tm_interrupt_handler(void);
+
+#endif // _TM_PORT_H
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
@@ -0,0 +1,310 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    Benchmark suite: common code (startup, reporter task, output).
+ *
+ *    Output is line-based; each line is a JSON object, so that it is easy
+ *    to process by scripts (see tm_run.py). Lines are:
+ *
+ *       {"tm":"start","test":"...","period_ticks":N,"periods":N,"tick_freq":N}
+ *       {"tm":"period","test":"...","period":N,"count":N,"counters":[N,...]}
+ *       {"tm":"result","test":"...","status":"ok","total":N,"avg":N}
+ *       {"tm":"result","test":"...","status":"error","error":"..."}
+ *
+ *    `count` is the number of iterations done during the period (sum of all
+ *    the test counters). If the test reports its RAM usage (see
+ *    `TM_Test::ram_get`), the successful result line also has the `"ram":N`
+ *    field; the same goes for the number of context switches (see
+ *    `TM_Test::switches_get`) and the `"switches":N` field.
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "tm_common.h"
+#include "tm_port.h"
+
+
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+//-- idle task stack size, in words
+#define IDLE_TASK_STACK_SIZE     (TN_MIN_STACK_SIZE + 32)
+
+//-- interrupt stack size, in words
+#define INTERRUPT_STACK_SIZE     (TN_MIN_STACK_SIZE + 64)
+
+//-- reporter task stack size, in words
+#define REPORTER_STACK_SIZE      (TN_MIN_STACK_SIZE + 96)
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC DATA
+ ******************************************************************************/
+
+volatile unsigned long tm_counters[ TM_COUNTERS_MAX ];
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+TN_STACK_ARR_DEF(idle_task_stack, IDLE_TASK_STACK_SIZE);
+TN_STACK_ARR_DEF(interrupt_stack, INTERRUPT_STACK_SIZE);
+TN_STACK_ARR_DEF(reporter_stack, REPORTER_STACK_SIZE);
+
+static struct TN_Task reporter_task;
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+static void _puts(const char *str)
+{
+   while (*str){
+      tm_port_putc(*str++);
+   }
+}
+
+static void _put_ulong(unsigned long value)
+{
+   char buf[12];
+   int i = 0;
+
+   do {
+      buf[i++] = '0' + (value % 10);
+      value /= 10;
+   } while (value != 0);
+
+   while (i > 0){
+      tm_port_putc(buf[--i]);
+   }
+}
+
+static void _put_str_field(const char *name, const char *value)
+{
+   _puts(",\"");
+   _puts(name);
+   _puts("\":\"");
+   _puts(value);
+   _puts("\"");
+}
+
+static void _put_num_field(const char *name, unsigned long value)
+{
+   _puts(",\"");
+   _puts(name);
+   _puts("\":");
+   _put_ulong(value);
+}
+
+static void _line_start(const char *kind)
+{
+   _puts("{\"tm\":\"");
+   _puts(kind);
+   _puts("\"");
+   _put_str_field("test", tm_test.name);
+}
+
+static void _line_end(void)
+{
+   _puts("}\n");
+}
+
+/**
+ * Check that all counters were incremented by about the same value during
+ * the period: each one should be within +/-1 of the average (as in
+ * Thread-Metric).
+ */
+static TN_BOOL _deltas_balanced(unsigned long *deltas, unsigned long total)
+{
+   TN_BOOL ret = TN_TRUE;
+   unsigned long avg = total / tm_test.counters_cnt;
+   int i;
+
+   for (i = 0; i < tm_test.counters_cnt; i++){
+      if (deltas[i] + 1 < avg || deltas[i] > avg + 1){
+         ret = TN_FALSE;
+      }
+   }
+
+   return ret;
+}
+
+static void reporter_task_body(void *par)
+{
+   unsigned long prev[ TM_COUNTERS_MAX ] = {0};
+   unsigned long deltas[ TM_COUNTERS_MAX ];
+   unsigned long total = 0;
+   int period;
+   int i;
+
+   _TN_UNUSED(par);
+
+   _line_start("start");
+   _put_num_field("period_ticks", TM_PERIOD_TICKS);
+   _put_num_field("periods", TM_PERIODS_CNT);
+   _put_num_field("tick_freq", TM_TICK_FREQ);
+   _line_end();
+
+   for (period = 1; period <= TM_PERIODS_CNT; period++){
+      unsigned long count = 0;
+
+      tn_task_sleep(TM_PERIOD_TICKS);
+
+      //-- take snapshot of counters
+      for (i = 0; i < tm_test.counters_cnt; i++){
+         unsigned long cur = tm_counters[i];
+         deltas[i] = cur - prev[i];
+         prev[i] = cur;
+         count += deltas[i];
+      }
+      total += count;
+
+      _line_start("period");
+      _put_num_field("period", period);
+      _put_num_field("count", count);
+      _puts(",\"counters\":[");
+      for (i = 0; i < tm_test.counters_cnt; i++){
+         if (i > 0){
+            _puts(",");
+         }
+         _put_ulong(deltas[i]);
+      }
+      _puts("]");
+      _line_end();
+
+      if (count == 0){
+         tm_fail("no progress");
+      } else if (!_deltas_balanced(deltas, count)){
+         tm_fail("counters are unbalanced");
+      }
+   }
+
+   _line_start("result");
+   _put_str_field("status", "ok");
+   _put_num_field("total", total);
+   _put_num_field("avg", total / TM_PERIODS_CNT);
+   if (tm_test.ram_get != TN_NULL){
+      _put_num_field("ram", tm_test.ram_get());
+   }
+   if (tm_test.switches_get != TN_NULL){
+      _put_num_field("switches", tm_test.switches_get());
+   }
+   _line_end();
+
+   tm_port_exit(0);
+}
+
+/**
+ * Callback passed to `tn_sys_start()`: creates all the tasks.
+ */
+static void init_task_create(void)
+{
+   tm_task_create(
+         &reporter_task,
+         reporter_task_body,
+         TM_PRIORITY_REPORTER,
+         reporter_stack,
+         TN_NULL
+         );
+
+   tm_test.init();
+}
+
+/**
+ * Callback passed to `tn_sys_start()`
+ */
+static void idle_task_callback(void)
+{
+}
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC FUNCTIONS
+ ******************************************************************************/
+
+void tm_task_create(
+      struct TN_Task   *task,
+      TN_TaskBody      *task_func,
+      int               priority,
+      TN_UWord         *stack,
+      void             *param
+      )
+{
+   //-- all the tasks except the reporter have the same stack size
+   int stack_size = (stack == reporter_stack)
+      ? REPORTER_STACK_SIZE
+      : TM_TASK_STACK_SIZE;
+
+   tm_check(
+         tn_task_create(
+            task, task_func, priority, stack, stack_size, param,
+            TN_TASK_CREATE_OPT_START
+            ),
+         "tn_task_create"
+         );
+}
+
+void tm_check(enum TN_RCode rc, const char *what)
+{
+   if (rc != TN_RC_OK){
+      tm_fail(what);
+   }
+}
+
+void tm_fail(const char *what)
+{
+   tn_arch_int_dis();
+
+   _line_start("result");
+   _put_str_field("status", "error");
+   _put_str_field("error", what);
+   _line_end();
+
+   tm_port_exit(1);
+}
+
+void tm_interrupt_handler(void)
+{
+   if (tm_test.interrupt != TN_NULL){
+      tm_test.interrupt();
+   }
+}
+
+int main(void)
+{
+   tm_port_hw_init();
+
+   tn_sys_start(
+         idle_task_stack,
+         IDLE_TASK_STACK_SIZE,
+         interrupt_stack,
+         INTERRUPT_STACK_SIZE,
+         init_task_create,
+         idle_task_callback
+         );
+
+   return 1;
+}
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
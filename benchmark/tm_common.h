@@ -0,0 +1,147 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    Benchmark suite, in the spirit of Thread-Metric: common definitions.
+ *
+ *    Each test is built as a separate binary: it consists of the common code
+ *    (tm_common.c), one test file (tm_<test>.c) and the port for the target
+ *    (port/<port>/). The test creates its tasks which spin doing some kernel
+ *    job and incrementing counters in `#tm_counters`; the reporter task
+ *    wakes up each `#TM_PERIOD_TICKS` and prints how many iterations were
+ *    done during the period. See readme.txt for the output format.
+ *
+ ******************************************************************************/
+
+#ifndef _TM_COMMON_H
+#define _TM_COMMON_H
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "tn.h"
+
+
+
+#ifdef __cplusplus
+extern "C"  {     /*}*/
+#endif
+
+/*******************************************************************************
+ *    PUBLIC DEFINITIONS
+ ******************************************************************************/
+
+/// Frequency of the system tick, the port should configure the timer
+/// accordingly
+#define TM_TICK_FREQ          1000
+
+/// Duration of one reporting period, in system ticks
+#ifndef TM_PERIOD_TICKS
+#  define TM_PERIOD_TICKS     (TM_TICK_FREQ * 1)
+#endif
+
+/// Number of reporting periods, after which the benchmark exits
+#ifndef TM_PERIODS_CNT
+#  define TM_PERIODS_CNT      5
+#endif
+
+/// Max number of counters a test can use
+#define TM_COUNTERS_MAX       8
+
+/// Stack size of test tasks, in words
+#define TM_TASK_STACK_SIZE    (TN_MIN_STACK_SIZE + 64)
+
+/// Priority of the reporter task: the highest one
+#define TM_PRIORITY_REPORTER  0
+
+/// Base priority of test tasks: test tasks have priorities
+/// `TM_PRIORITY_BASE`, `TM_PRIORITY_BASE + 1`, etc (the larger value, the
+/// lower priority)
+#define TM_PRIORITY_BASE      2
+
+/**
+ * Test descriptor, each test defines the instance `#tm_test`.
+ */
+struct TM_Test {
+   ///
+   /// Test name, as printed in the output
+   const char *name;
+   ///
+   /// Number of counters in `#tm_counters` the test uses. In each period,
+   /// all of them are expected to be incremented by about the same value;
+   /// otherwise, the test fails (like in Thread-Metric).
+   int counters_cnt;
+   ///
+   /// Creates test objects and tasks; called from the
+   /// `#TN_CBUserTaskCreate` callback, i.e. before the scheduler is started.
+   void (*init)(void);
+   ///
+   /// Called from the test interrupt (see `#tm_port_interrupt_raise()`),
+   /// may be `TN_NULL` if the test doesn't use interrupts.
+   void (*interrupt)(void);
+   ///
+   /// Returns RAM (in bytes) needed by the test for its concurrent
+   /// activities, reported in the result line; may be `TN_NULL`. Useful
+   /// for the tests which do the same job in different ways.
+   unsigned long (*ram_get)(void);
+   ///
+   /// Returns the number of context switches between the test tasks since
+   /// the start, reported in the result line; may be `TN_NULL`. Useful for
+   /// the tests which do the same job with different scheduling.
+   unsigned long (*switches_get)(void);
+};
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC DATA
+ ******************************************************************************/
+
+/// Descriptor of the test, defined by the test file
+extern const struct TM_Test tm_test;
+
+/// Counters which are incremented by the test
+extern volatile unsigned long tm_counters[ TM_COUNTERS_MAX ];
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC FUNCTION PROTOTYPES
+ ******************************************************************************/
+
+/**
+ * Create and start test task; on failure, the benchmark is stopped.
+ */
+void tm_task_create(
+      struct TN_Task   *task,
+      TN_TaskBody      *task_func,
+      int               priority,
+      TN_UWord         *stack,
+      void             *param
+      );
+
+/**
+ * If `rc` isn't `#TN_RC_OK`, print error and stop the benchmark.
+ */
+void tm_check(enum TN_RCode rc, const char *what);
+
+/**
+ * Print error and stop the benchmark.
+ */
+void tm_fail(const char *what);
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+
+#endif // _TM_COMMON_H
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
@@ -0,0 +1,105 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    Benchmark: cooperative context switch.
+ *
+ *    Five tasks of the same priority pass control to each other in a ring:
+ *    each task wakes up the next one and goes to sleep. TNeo has no
+ *    "relinquish" service, so, sleep/wakeup is used as the cheapest way to
+ *    switch between tasks of equal priority without preemption.
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "tm_common.h"
+
+
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+#define TASKS_CNT    5
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+TN_STACK_ARR_DEF(task_stack_0, TM_TASK_STACK_SIZE);
+TN_STACK_ARR_DEF(task_stack_1, TM_TASK_STACK_SIZE);
+TN_STACK_ARR_DEF(task_stack_2, TM_TASK_STACK_SIZE);
+TN_STACK_ARR_DEF(task_stack_3, TM_TASK_STACK_SIZE);
+TN_STACK_ARR_DEF(task_stack_4, TM_TASK_STACK_SIZE);
+
+static TN_UWord *const task_stacks[ TASKS_CNT ] = {
+   task_stack_0, task_stack_1, task_stack_2, task_stack_3, task_stack_4,
+};
+
+static struct TN_Task tasks[ TASKS_CNT ];
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+static void task_body(void *par)
+{
+   int idx = (int)(TN_UIntPtr)par;
+   struct TN_Task *next = &tasks[ (idx + 1) % TASKS_CNT ];
+
+   //-- all tasks but the first one wait until they're woken up, and the
+   //   first one starts the ring (it is created last, so, it runs last)
+   if (idx != 0){
+      tm_check(tn_task_sleep(TN_WAIT_INFINITE), "tn_task_sleep");
+   }
+
+   for (;;){
+      tm_counters[idx]++;
+
+      tm_check(tn_task_wakeup(next), "tn_task_wakeup");
+      tm_check(tn_task_sleep(TN_WAIT_INFINITE), "tn_task_sleep");
+   }
+}
+
+static void init(void)
+{
+   int i;
+
+   //-- create the first task last, see comment in task_body()
+   for (i = TASKS_CNT - 1; i >= 0; i--){
+      tm_task_create(
+            &tasks[i], task_body, TM_PRIORITY_BASE, task_stacks[i],
+            (void *)(TN_UIntPtr)i
+            );
+   }
+}
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC DATA
+ ******************************************************************************/
+
+const struct TM_Test tm_test = {
+   "cooperative",
+   TASKS_CNT,
+   init,
+   TN_NULL,
+};
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
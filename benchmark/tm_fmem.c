@@ -0,0 +1,98 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    Benchmark: memory allocation.
+ *
+ *    The task gets the block from the fixed memory pool and releases it
+ *    back.
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "tm_common.h"
+
+
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+//-- number of blocks in the pool
+#define BLOCKS_CNT      4
+
+//-- block size: 128 bytes on 32-bit targets, like in Thread-Metric
+struct Block {
+   TN_UWord data[32];
+};
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+TN_STACK_ARR_DEF(task_stack, TM_TASK_STACK_SIZE);
+
+static struct TN_Task task;
+static struct TN_FMem fmem;
+
+TN_FMEM_BUF_DEF(fmem_buf, struct Block, BLOCKS_CNT);
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+static void task_body(void *par)
+{
+   void *p_block;
+
+   _TN_UNUSED(par);
+
+   for (;;){
+      tm_check(tn_fmem_get(&fmem, &p_block, TN_WAIT_INFINITE), "tn_fmem_get");
+      tm_check(tn_fmem_release(&fmem, p_block), "tn_fmem_release");
+
+      tm_counters[0]++;
+   }
+}
+
+static void init(void)
+{
+   tm_check(
+         tn_fmem_create(
+            &fmem, fmem_buf,
+            TN_MAKE_ALIG_SIZE(sizeof(struct Block)), BLOCKS_CNT
+            ),
+         "tn_fmem_create"
+         );
+   tm_task_create(&task, task_body, TM_PRIORITY_BASE, task_stack, TN_NULL);
+}
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC DATA
+ ******************************************************************************/
+
+const struct TM_Test tm_test = {
+   "fmem",
+   1,
+   init,
+   TN_NULL,
+};
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
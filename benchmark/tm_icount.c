@@ -0,0 +1,574 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    Benchmark suite: fixed workload for the instruction-count regression
+ *    harness (see tm_icount.py).
+ *
+ *    Unlike the other tests, this one doesn't measure throughput: it runs
+ *    each scenario a few times, and measures the time taken by it with the
+ *    free-running counter (see `tm_port_counter_init()`). Under QEMU with
+ *    `-icount`, the counter advances exactly by the same value with each
+ *    executed instruction, so the harness converts the measured values into
+ *    exact instruction counts, calibrating it with the known sequence of
+ *    `nop` instructions.
+ *
+ *    Some scenarios span several tasks: e.g. "sem_signal_switch" starts in
+ *    one task right before `tn_sem_signal()`, and ends in the higher-priority
+ *    task right after its `tn_sem_wait()` returns. Tasks follow the fixed
+ *    choreography, each step is commented below.
+ *
+ *    The system tick is off during the measurements, so timers never fire.
+ *
+ *    Output is line-based, each line is a JSON object:
+ *
+ *       {"ic":"meas","name":"...","ticks":[N,...]}
+ *       {"ic":"done"}
+ *
+ *    or, on failure:
+ *
+ *       {"ic":"error","error":"..."}
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "tm_common.h"
+#include "tm_port.h"
+
+#if !TN_USE_MUTEXES
+#  error instruction-count workload needs TN_USE_MUTEXES to be non-zero
+#endif
+
+
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+//-- how many times each scenario is run
+#define REPS_CNT           4
+
+//-- number of nops used for calibration; if changed, tm_icount.py should
+//   be changed as well
+#define CALIB_NOPS_CNT     1000
+
+//-- max number of timers which are active while the measured one is started
+#define TIMERS_CNT         64
+
+//-- idle task stack size, in words
+#define IDLE_TASK_STACK_SIZE     (TN_MIN_STACK_SIZE + 32)
+
+//-- interrupt stack size, in words
+#define INTERRUPT_STACK_SIZE     (TN_MIN_STACK_SIZE + 64)
+
+//-- task priorities: the control task and the peer have the same priority,
+//   so that the peer is made runnable without preemption
+#define PRIORITY_HIGH      (TM_PRIORITY_BASE)
+#define PRIORITY_CTL       (TM_PRIORITY_BASE + 1)
+#define PRIORITY_PEER      (TM_PRIORITY_BASE + 1)
+
+#define X_SCENARIOS                                                         \
+   X(CALIB_EMPTY,             "calib_empty")                                \
+   X(CALIB_NOPS,              "calib_nops")                                 \
+   X(SEM_SIGNAL,              "sem_signal")                                 \
+   X(SEM_WAIT_POLLING,        "sem_wait_polling")                           \
+   X(SEM_SIGNAL_WAKE,         "sem_signal_wake")                            \
+   X(SEM_SIGNAL_SWITCH,       "sem_signal_switch")                          \
+   X(TASK_RESUME_SWITCH,      "task_resume_switch")                         \
+   X(TASK_SLEEP_SWITCH,       "task_sleep_switch")                          \
+   X(QUEUE_SEND,              "queue_send")                                 \
+   X(QUEUE_RECEIVE_POLLING,   "queue_receive_polling")                      \
+   X(QUEUE_SEND_WAKE,         "queue_send_wake")                            \
+   X(QUEUE_SEND_SWITCH,       "queue_send_switch")                          \
+   X(MUTEX_LOCK,              "mutex_lock")                                 \
+   X(MUTEX_UNLOCK,            "mutex_unlock")                               \
+   X(FMEM_GET_POLLING,        "fmem_get_polling")                           \
+   X(FMEM_RELEASE,            "fmem_release")                               \
+   X(TIMER_START_0,           "timer_start_0")                              \
+   X(TIMER_CANCEL_0,          "timer_cancel_0")                             \
+   X(TIMER_START_4,           "timer_start_4")                              \
+   X(TIMER_CANCEL_4,          "timer_cancel_4")                             \
+   X(TIMER_START_16,          "timer_start_16")                             \
+   X(TIMER_CANCEL_16,         "timer_cancel_16")                            \
+   X(TIMER_START_64,          "timer_start_64")                             \
+   X(TIMER_CANCEL_64,         "timer_cancel_64")                            \
+
+#define X(id, name)  SC_##id,
+enum Scenario {
+   X_SCENARIOS
+   SCENARIOS_CNT
+};
+#undef X
+
+#define _STR(x)            #x
+#define _XSTR(x)           _STR(x)
+
+//-- start measurement
+#define MEAS_START()                                                        \
+   (_meas_start = tm_port_counter_get())
+
+//-- end measurement and save the result
+#define MEAS_END(scenario, rep)                                             \
+   (_results[scenario][rep] =                                               \
+      (tm_port_counter_get() - _meas_start) & tm_port_counter_mask)
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+#define X(id, name)  name,
+static const char *const _scenario_names[ SCENARIOS_CNT ] = {
+   X_SCENARIOS
+};
+#undef X
+
+static volatile unsigned long _meas_start;
+static unsigned long _results[ SCENARIOS_CNT ][ REPS_CNT ];
+
+TN_STACK_ARR_DEF(idle_task_stack, IDLE_TASK_STACK_SIZE);
+TN_STACK_ARR_DEF(interrupt_stack, INTERRUPT_STACK_SIZE);
+
+TN_STACK_ARR_DEF(task_ctl_stack, TM_TASK_STACK_SIZE);
+TN_STACK_ARR_DEF(task_high_stack, TM_TASK_STACK_SIZE);
+TN_STACK_ARR_DEF(task_peer_stack, TM_TASK_STACK_SIZE);
+
+static struct TN_Task task_ctl;
+static struct TN_Task task_high;
+static struct TN_Task task_peer;
+
+static struct TN_Sem sem_free;
+static struct TN_Sem sem_peer;
+static struct TN_Sem sem_high;
+static struct TN_Sem sem_ack;
+
+static struct TN_DQueue queue_free;
+static struct TN_DQueue queue_peer;
+static struct TN_DQueue queue_high;
+static void *queue_free_fifo[ 4 ];
+static void *queue_peer_fifo[ 4 ];
+static void *queue_high_fifo[ 4 ];
+
+static struct TN_Mutex mutex;
+
+static struct TN_FMem fmem;
+TN_FMEM_BUF_DEF(fmem_buf, TN_UWord, 4);
+
+static struct TN_Timer timers[ TIMERS_CNT ];
+static struct TN_Timer timer_meas;
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+static void _puts(const char *str)
+{
+   while (*str){
+      tm_port_putc(*str++);
+   }
+}
+
+static void _put_ulong(unsigned long value)
+{
+   char buf[12];
+   int i = 0;
+
+   do {
+      buf[i++] = '0' + (value % 10);
+      value /= 10;
+   } while (value != 0);
+
+   while (i > 0){
+      tm_port_putc(buf[--i]);
+   }
+}
+
+static void _results_print(void)
+{
+   int sc;
+   int rep;
+
+   for (sc = 0; sc < SCENARIOS_CNT; sc++){
+      _puts("{\"ic\":\"meas\",\"name\":\"");
+      _puts(_scenario_names[sc]);
+      _puts("\",\"ticks\":[");
+      for (rep = 0; rep < REPS_CNT; rep++){
+         if (rep > 0){
+            _puts(",");
+         }
+         _put_ulong(_results[sc][rep]);
+      }
+      _puts("]}\n");
+   }
+
+   _puts("{\"ic\":\"done\"}\n");
+}
+
+static void timer_func(struct TN_Timer *timer, void *p_user_data)
+{
+   //-- never called: the system tick is off
+   _TN_UNUSED(timer);
+   _TN_UNUSED(p_user_data);
+}
+
+/**
+ * Measure the empty section and the known number of nops
+ */
+static void _calibrate(void)
+{
+   int rep;
+
+   for (rep = 0; rep < REPS_CNT; rep++){
+      MEAS_START();
+      MEAS_END(SC_CALIB_EMPTY, rep);
+   }
+
+   for (rep = 0; rep < REPS_CNT; rep++){
+      MEAS_START();
+      __asm volatile (
+            ".rept " _XSTR(CALIB_NOPS_CNT) "\n\t"
+            "nop\n\t"
+            ".endr\n\t"
+            ::: "memory"
+            );
+      MEAS_END(SC_CALIB_NOPS, rep);
+   }
+}
+
+/**
+ * Services which don't switch context and don't wake up anyone
+ */
+static void _services_simple(void)
+{
+   int rep;
+   void *p_data;
+
+   for (rep = 0; rep < REPS_CNT; rep++){
+      MEAS_START();
+      tn_sem_signal(&sem_free);
+      MEAS_END(SC_SEM_SIGNAL, rep);
+
+      MEAS_START();
+      tn_sem_wait_polling(&sem_free);
+      MEAS_END(SC_SEM_WAIT_POLLING, rep);
+   }
+
+   for (rep = 0; rep < REPS_CNT; rep++){
+      MEAS_START();
+      tn_queue_send_polling(&queue_free, TN_NULL);
+      MEAS_END(SC_QUEUE_SEND, rep);
+
+      MEAS_START();
+      tn_queue_receive_polling(&queue_free, &p_data);
+      MEAS_END(SC_QUEUE_RECEIVE_POLLING, rep);
+   }
+
+   for (rep = 0; rep < REPS_CNT; rep++){
+      MEAS_START();
+      tn_mutex_lock_polling(&mutex);
+      MEAS_END(SC_MUTEX_LOCK, rep);
+
+      MEAS_START();
+      tn_mutex_unlock(&mutex);
+      MEAS_END(SC_MUTEX_UNLOCK, rep);
+   }
+
+   for (rep = 0; rep < REPS_CNT; rep++){
+      MEAS_START();
+      tn_fmem_get_polling(&fmem, &p_data);
+      MEAS_END(SC_FMEM_GET_POLLING, rep);
+
+      MEAS_START();
+      tn_fmem_release(&fmem, p_data);
+      MEAS_END(SC_FMEM_RELEASE, rep);
+   }
+}
+
+/**
+ * Services which wake up the peer task of the same priority: it becomes
+ * runnable, but doesn't preempt us.
+ */
+static void _services_wake(void)
+{
+   int rep;
+
+   for (rep = 0; rep < REPS_CNT; rep++){
+      MEAS_START();
+      tn_sem_signal(&sem_peer);
+      MEAS_END(SC_SEM_SIGNAL_WAKE, rep);
+
+      //-- let the peer run and wait again
+      tm_check(tn_sem_wait(&sem_ack, TN_WAIT_INFINITE), "tn_sem_wait");
+   }
+
+   for (rep = 0; rep < REPS_CNT; rep++){
+      MEAS_START();
+      tn_queue_send(&queue_peer, TN_NULL, TN_WAIT_INFINITE);
+      MEAS_END(SC_QUEUE_SEND_WAKE, rep);
+
+      //-- let the peer run and wait again
+      tm_check(tn_sem_wait(&sem_ack, TN_WAIT_INFINITE), "tn_sem_wait");
+   }
+}
+
+/**
+ * Services which wake up the high-priority task, so that it preempts us;
+ * measurements end in that task, see task_high_body().
+ */
+static void _services_switch(void)
+{
+   int rep;
+
+   for (rep = 0; rep < REPS_CNT; rep++){
+      MEAS_START();
+      tn_sem_signal(&sem_high);
+   }
+
+   for (rep = 0; rep < REPS_CNT; rep++){
+      MEAS_START();
+      tn_task_resume(&task_high);
+      //-- the high-priority task has measured the resume, and then it went
+      //   to sleep
+      MEAS_END(SC_TASK_SLEEP_SWITCH, rep);
+      tn_task_wakeup(&task_high);
+   }
+
+   for (rep = 0; rep < REPS_CNT; rep++){
+      MEAS_START();
+      tn_queue_send(&queue_high, TN_NULL, TN_WAIT_INFINITE);
+   }
+}
+
+/**
+ * Timer start and cancel while a number of other timers are active
+ */
+static void _timers_run(int active_cnt, enum Scenario sc_start)
+{
+   int i;
+   int rep;
+
+   for (i = 0; i < active_cnt; i++){
+      tm_check(tn_timer_start(&timers[i], 10 + i * 7), "tn_timer_start");
+   }
+
+   for (rep = 0; rep < REPS_CNT; rep++){
+      MEAS_START();
+      tn_timer_start(&timer_meas, 100);
+      MEAS_END(sc_start, rep);
+
+      MEAS_START();
+      tn_timer_cancel(&timer_meas);
+      //-- cancel scenario follows the start one
+      MEAS_END(sc_start + 1, rep);
+   }
+
+   for (i = 0; i < active_cnt; i++){
+      tm_check(tn_timer_cancel(&timers[i]), "tn_timer_cancel");
+   }
+}
+
+static void task_ctl_body(void *par)
+{
+   _TN_UNUSED(par);
+
+   //-- from now on, the system tick is off
+   tm_port_counter_init();
+
+   _calibrate();
+   _services_simple();
+   _services_wake();
+   _services_switch();
+
+   _timers_run(0, SC_TIMER_START_0);
+   _timers_run(4, SC_TIMER_START_4);
+   _timers_run(16, SC_TIMER_START_16);
+   _timers_run(TIMERS_CNT, SC_TIMER_START_64);
+
+   _results_print();
+   tm_port_exit(0);
+}
+
+static void task_high_body(void *par)
+{
+   int rep;
+   void *p_data;
+
+   _TN_UNUSED(par);
+
+   for (rep = 0; rep < REPS_CNT; rep++){
+      tm_check(tn_sem_wait(&sem_high, TN_WAIT_INFINITE), "tn_sem_wait");
+      MEAS_END(SC_SEM_SIGNAL_SWITCH, rep);
+   }
+
+   for (rep = 0; rep < REPS_CNT; rep++){
+      tm_check(tn_task_suspend(&task_high), "tn_task_suspend");
+      MEAS_END(SC_TASK_RESUME_SWITCH, rep);
+
+      MEAS_START();
+      //-- the control task will wake us up
+      tn_task_sleep(TN_WAIT_INFINITE);
+   }
+
+   for (rep = 0; rep < REPS_CNT; rep++){
+      tm_check(
+            tn_queue_receive(&queue_high, &p_data, TN_WAIT_INFINITE),
+            "tn_queue_receive"
+            );
+      MEAS_END(SC_QUEUE_SEND_SWITCH, rep);
+   }
+
+   tn_task_sleep(TN_WAIT_INFINITE);
+}
+
+static void task_peer_body(void *par)
+{
+   int rep;
+   void *p_data;
+
+   _TN_UNUSED(par);
+
+   for (rep = 0; rep < REPS_CNT; rep++){
+      tm_check(tn_sem_wait(&sem_peer, TN_WAIT_INFINITE), "tn_sem_wait");
+      tm_check(tn_sem_signal(&sem_ack), "tn_sem_signal");
+   }
+
+   for (rep = 0; rep < REPS_CNT; rep++){
+      tm_check(
+            tn_queue_receive(&queue_peer, &p_data, TN_WAIT_INFINITE),
+            "tn_queue_receive"
+            );
+      tm_check(tn_sem_signal(&sem_ack), "tn_sem_signal");
+   }
+
+   tn_task_sleep(TN_WAIT_INFINITE);
+}
+
+/**
+ * Callback passed to `tn_sys_start()`: creates all the objects and tasks.
+ */
+static void init_task_create(void)
+{
+   int i;
+
+   tm_check(tn_sem_create(&sem_free, 0, 1), "tn_sem_create");
+   tm_check(tn_sem_create(&sem_peer, 0, 1), "tn_sem_create");
+   tm_check(tn_sem_create(&sem_high, 0, 1), "tn_sem_create");
+   tm_check(tn_sem_create(&sem_ack, 0, 1), "tn_sem_create");
+
+   tm_check(tn_queue_create(&queue_free, queue_free_fifo, 4), "tn_queue_create");
+   tm_check(tn_queue_create(&queue_peer, queue_peer_fifo, 4), "tn_queue_create");
+   tm_check(tn_queue_create(&queue_high, queue_high_fifo, 4), "tn_queue_create");
+
+   tm_check(
+         tn_mutex_create(&mutex, TN_MUTEX_PROT_INHERIT, 0),
+         "tn_mutex_create"
+         );
+
+   tm_check(
+         tn_fmem_create(&fmem, fmem_buf, TN_MAKE_ALIG_SIZE(sizeof(TN_UWord)), 4),
+         "tn_fmem_create"
+         );
+
+   for (i = 0; i < TIMERS_CNT; i++){
+      tm_check(tn_timer_create(&timers[i], timer_func, TN_NULL), "tn_timer_create");
+   }
+   tm_check(tn_timer_create(&timer_meas, timer_func, TN_NULL), "tn_timer_create");
+
+   //-- the high-priority task runs first and waits for the semaphore; then,
+   //   the peer runs (since it is created before the control task) and waits
+   //   for its semaphore; and then the control task runs.
+   tm_task_create(
+         &task_high, task_high_body, PRIORITY_HIGH, task_high_stack, TN_NULL
+         );
+   tm_task_create(
+         &task_peer, task_peer_body, PRIORITY_PEER, task_peer_stack, TN_NULL
+         );
+   tm_task_create(
+         &task_ctl, task_ctl_body, PRIORITY_CTL, task_ctl_stack, TN_NULL
+         );
+}
+
+/**
+ * Callback passed to `tn_sys_start()`
+ */
+static void idle_task_callback(void)
+{
+}
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC FUNCTIONS
+ ******************************************************************************/
+
+void tm_task_create(
+      struct TN_Task   *task,
+      TN_TaskBody      *task_func,
+      int               priority,
+      TN_UWord         *stack,
+      void             *param
+      )
+{
+   tm_check(
+         tn_task_create(
+            task, task_func, priority, stack, TM_TASK_STACK_SIZE, param,
+            TN_TASK_CREATE_OPT_START
+            ),
+         "tn_task_create"
+         );
+}
+
+void tm_check(enum TN_RCode rc, const char *what)
+{
+   if (rc != TN_RC_OK){
+      tm_fail(what);
+   }
+}
+
+void tm_fail(const char *what)
+{
+   tn_arch_int_dis();
+
+   _puts("{\"ic\":\"error\",\"error\":\"");
+   _puts(what);
+   _puts("\"}\n");
+
+   tm_port_exit(1);
+}
+
+void tm_interrupt_handler(void)
+{
+   //-- not used
+}
+
+int main(void)
+{
+   tm_port_hw_init();
+
+   tn_sys_start(
+         idle_task_stack,
+         IDLE_TASK_STACK_SIZE,
+         interrupt_stack,
+         INTERRUPT_STACK_SIZE,
+         init_task_create,
+         idle_task_callback
+         );
+
+   return 1;
+}
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
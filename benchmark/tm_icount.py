@@ -0,0 +1,224 @@
+#!/usr/bin/env python3
+#
+# TNeo: real-time kernel initially based on TNKernel
+#
+# Instruction-count regression harness: runs the fixed workload (tm_icount.c)
+# under QEMU with `-icount`, and reports the exact number of instructions
+# taken by each kernel service / scenario. Since the numbers are exact, any
+# change in a kernel hot path shows up, and it doesn't depend on the host
+# machine.
+#
+# The workload measures scenarios with the counter which, under `-icount`,
+# advances by the fixed amount per instruction; the amount is calibrated by
+# the known sequence of nops, so the result doesn't depend on the exact clock
+# settings of the emulated board.
+#
+# Results are compared with the baseline (stored in the icount_baseline
+# directory): the script fails if some scenario takes more instructions than
+# in the baseline.
+#
+# Usage (normally invoked by `make icount-run` / `make icount-baseline`):
+#
+#    tm_icount.py --machine mps2-an385 --baseline base.json tm_icount.elf
+#    tm_icount.py --machine mps2-an385 --baseline base.json --update tm_icount.elf
+#
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+
+
+#-- should match CALIB_NOPS_CNT in tm_icount.c
+CALIB_NOPS_CNT = 1000
+
+#-- each instruction takes 2^shift ns of virtual time; it should be large
+#   enough so that the counter advances by several units per instruction: the
+#   measured values might be off by a unit or so due to quantization, and
+#   rounding to instructions should still be exact. With shift 8, the counter
+#   running at 25 MHz (as on MPS2) advances by 6.4 per instruction.
+ICOUNT_SHIFT = 8
+
+#-- min counter advance per instruction for the rounding to be exact
+_TICKS_PER_INSN_MIN = 4
+
+
+class ICountError(Exception):
+    pass
+
+
+def output_parse(lines):
+    """Returns dict: scenario name -> list of measured counter values."""
+    meas = {}
+    done = False
+
+    for line in lines:
+        line = line.strip()
+        if not line.startswith("{"):
+            continue
+        try:
+            rec = json.loads(line)
+        except ValueError:
+            continue
+
+        kind = rec.get("ic")
+        if kind == "meas":
+            meas[rec["name"]] = rec["ticks"]
+        elif kind == "error":
+            raise ICountError("workload failed: {}".format(rec["error"]))
+        elif kind == "done":
+            done = True
+
+    if not done:
+        raise ICountError("workload didn't finish")
+
+    return meas
+
+
+def insns_calc(meas):
+    """
+    Converts counter values into instruction counts. Returns dict:
+    scenario name -> (instructions count, stable), where `stable` is false
+    if the repetitions of the scenario gave different results (the min
+    value is used then).
+    """
+    empty = meas.pop("calib_empty")
+    nops = meas.pop("calib_nops")
+
+    #-- counter value is quantized, so, depending on the phase, the same
+    #   number of instructions might give values differing by 1
+    if max(empty) - min(empty) > 1 or max(nops) - min(nops) > 1:
+        raise ICountError(
+            "calibration is unstable: is QEMU run with -icount?"
+        )
+
+    empty = float(sum(empty)) / len(empty)
+    nops = float(sum(nops)) / len(nops)
+    ticks_per_insn = (nops - empty) / CALIB_NOPS_CNT
+    if ticks_per_insn < _TICKS_PER_INSN_MIN:
+        raise ICountError(
+            "counter is too slow: {:.2f} ticks per instruction"
+            .format(ticks_per_insn)
+        )
+
+    res = {}
+    for name, ticks in meas.items():
+        insns = [int(round((t - empty) / ticks_per_insn)) for t in ticks]
+        res[name] = (min(insns), len(set(insns)) == 1)
+    return res
+
+
+def workload_run(elf, qemu, machine, timeout):
+    cmd = [
+        qemu, "-machine", machine, "-nographic", "-semihosting",
+        "-monitor", "none", "-serial", "stdio",
+        "-icount", "shift={},align=off,sleep=off".format(ICOUNT_SHIFT),
+        "-kernel", elf,
+    ]
+    try:
+        proc = subprocess.run(
+            cmd, stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+            universal_newlines=True, timeout=timeout,
+        )
+    except subprocess.TimeoutExpired:
+        raise ICountError("timeout")
+
+    return output_parse(proc.stdout.splitlines())
+
+
+def report(res, baseline, out=sys.stdout):
+    """Prints the table, returns the number of regressions."""
+    regressions = 0
+
+    out.write("{:<24} {:>9} {:>9} {:>7}\n".format(
+        "scenario", "baseline", "insns", "delta"
+    ))
+    for name in sorted(set(res) | set(baseline)):
+        old = baseline.get(name)
+        new, stable = res.get(name, (None, True))
+
+        mark = "" if stable else "  (unstable)"
+        if old is None or new is None:
+            delta = "n/a"
+        else:
+            delta = "{:+d}".format(new - old)
+            if new > old:
+                mark += "  <-- REGRESSION"
+                regressions += 1
+
+        out.write("{:<24} {:>9} {:>9} {:>7}{}\n".format(
+            name,
+            old if old is not None else "-",
+            new if new is not None else "-",
+            delta, mark,
+        ))
+
+    return regressions
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(
+        description="TNeo instruction-count regression harness"
+    )
+    parser.add_argument("elf", help="workload binary (tm_icount.elf)")
+    parser.add_argument(
+        "--qemu", default="qemu-system-arm",
+        help="QEMU executable (default: qemu-system-arm)"
+    )
+    parser.add_argument(
+        "--machine", default="mps2-an385",
+        help="QEMU machine (default: mps2-an385)"
+    )
+    parser.add_argument(
+        "--timeout", type=float, default=120,
+        help="timeout, in seconds (default: 120)"
+    )
+    parser.add_argument(
+        "--baseline", metavar="FILE",
+        help="baseline JSON file: scenario name -> instructions count"
+    )
+    parser.add_argument(
+        "--update", action="store_true",
+        help="write the results to the baseline file instead of comparing"
+    )
+    args = parser.parse_args(argv)
+
+    try:
+        res = insns_calc(
+            workload_run(args.elf, args.qemu, args.machine, args.timeout)
+        )
+    except ICountError as e:
+        sys.stderr.write("error: {}\n".format(e))
+        return 1
+
+    baseline = {}
+    if args.baseline and not args.update and os.path.exists(args.baseline):
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+
+    regressions = report(res, baseline)
+
+    if args.update:
+        if not args.baseline:
+            parser.error("--update needs --baseline")
+        with open(args.baseline, "w") as f:
+            json.dump(
+                dict((name, v[0]) for name, v in res.items()),
+                f, indent=1, sort_keys=True,
+            )
+            f.write("\n")
+        sys.stderr.write("baseline is written to {}\n".format(args.baseline))
+        return 0
+
+    if args.baseline and not baseline:
+        sys.stderr.write(
+            "warning: no baseline {}, run `make icount-baseline` first\n"
+            .format(args.baseline)
+        )
+
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
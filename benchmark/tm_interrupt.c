@@ -0,0 +1,95 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    Benchmark: interrupt processing without preemption.
+ *
+ *    The task triggers the interrupt, whose handler signals the semaphore;
+ *    then the task acquires the semaphore. Since the task is the only one
+ *    waiting for the semaphore (and it isn't waiting yet when the interrupt
+ *    fires), no context switch happens.
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "tm_common.h"
+#include "tm_port.h"
+
+
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+enum {
+   COUNTER_TASK,
+   COUNTER_ISR,
+   COUNTERS_CNT
+};
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+TN_STACK_ARR_DEF(task_stack, TM_TASK_STACK_SIZE);
+
+static struct TN_Task task;
+static struct TN_Sem sem;
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+static void task_body(void *par)
+{
+   _TN_UNUSED(par);
+
+   for (;;){
+      tm_port_interrupt_raise();
+
+      tm_check(tn_sem_wait(&sem, TN_WAIT_INFINITE), "tn_sem_wait");
+      tm_counters[COUNTER_TASK]++;
+   }
+}
+
+static void interrupt(void)
+{
+   tm_counters[COUNTER_ISR]++;
+   tm_check(tn_sem_isignal(&sem), "tn_sem_isignal");
+}
+
+static void init(void)
+{
+   tm_check(tn_sem_create(&sem, 0, 1), "tn_sem_create");
+   tm_task_create(&task, task_body, TM_PRIORITY_BASE, task_stack, TN_NULL);
+}
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC DATA
+ ******************************************************************************/
+
+const struct TM_Test tm_test = {
+   "interrupt",
+   COUNTERS_CNT,
+   init,
+   interrupt,
+};
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
@@ -0,0 +1,113 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    Benchmark: interrupt processing with preemption.
+ *
+ *    The low-priority task triggers the interrupt, whose handler wakes up the
+ *    high-priority task; so, on return from the interrupt, the high-priority
+ *    task preempts the low-priority one. The high-priority task goes back to
+ *    sleep, and the low-priority task continues.
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "tm_common.h"
+#include "tm_port.h"
+
+
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+enum {
+   COUNTER_TASK_LOW,
+   COUNTER_ISR,
+   COUNTER_TASK_HIGH,
+   COUNTERS_CNT
+};
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+TN_STACK_ARR_DEF(task_low_stack, TM_TASK_STACK_SIZE);
+TN_STACK_ARR_DEF(task_high_stack, TM_TASK_STACK_SIZE);
+
+static struct TN_Task task_low;
+static struct TN_Task task_high;
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+static void task_low_body(void *par)
+{
+   _TN_UNUSED(par);
+
+   for (;;){
+      //-- the high-priority task preempts us right here
+      tm_port_interrupt_raise();
+
+      tm_counters[COUNTER_TASK_LOW]++;
+   }
+}
+
+static void task_high_body(void *par)
+{
+   _TN_UNUSED(par);
+
+   for (;;){
+      tm_check(tn_task_sleep(TN_WAIT_INFINITE), "tn_task_sleep");
+      tm_counters[COUNTER_TASK_HIGH]++;
+   }
+}
+
+static void interrupt(void)
+{
+   tm_counters[COUNTER_ISR]++;
+   tm_check(tn_task_iwakeup(&task_high), "tn_task_iwakeup");
+}
+
+static void init(void)
+{
+   tm_task_create(
+         &task_high, task_high_body, TM_PRIORITY_BASE, task_high_stack,
+         TN_NULL
+         );
+   tm_task_create(
+         &task_low, task_low_body, TM_PRIORITY_BASE + 1, task_low_stack,
+         TN_NULL
+         );
+}
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC DATA
+ ******************************************************************************/
+
+const struct TM_Test tm_test = {
+   "interrupt_preemption",
+   COUNTERS_CNT,
+   init,
+   interrupt,
+};
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
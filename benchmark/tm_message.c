@@ -0,0 +1,105 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    Benchmark: message passing.
+ *
+ *    The task sends the message to the data queue and receives it back. TNeo
+ *    data queue carries pointers, so, the message is passed by reference:
+ *    this is how data queues are normally used with TNeo (together with the
+ *    fixed memory pool holding the message bodies).
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "tm_common.h"
+
+
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+//-- size of the queue, in items
+#define QUEUE_ITEMS_CNT    10
+
+//-- message size, in words: 16 bytes on 32-bit targets, like in Thread-Metric
+#define MSG_WORDS_CNT      4
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+TN_STACK_ARR_DEF(task_stack, TM_TASK_STACK_SIZE);
+
+static struct TN_Task task;
+static struct TN_DQueue queue;
+static void *queue_fifo[ QUEUE_ITEMS_CNT ];
+
+static TN_UWord msg[ MSG_WORDS_CNT ];
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+static void task_body(void *par)
+{
+   void *p_received;
+
+   _TN_UNUSED(par);
+
+   for (;;){
+      msg[0]++;
+
+      tm_check(tn_queue_send(&queue, msg, TN_WAIT_INFINITE), "tn_queue_send");
+      tm_check(
+            tn_queue_receive(&queue, &p_received, TN_WAIT_INFINITE),
+            "tn_queue_receive"
+            );
+
+      if (p_received != msg){
+         tm_fail("wrong message received");
+      }
+
+      tm_counters[0]++;
+   }
+}
+
+static void init(void)
+{
+   tm_check(
+         tn_queue_create(&queue, queue_fifo, QUEUE_ITEMS_CNT),
+         "tn_queue_create"
+         );
+   tm_task_create(&task, task_body, TM_PRIORITY_BASE, task_stack, TN_NULL);
+}
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC DATA
+ ******************************************************************************/
+
+const struct TM_Test tm_test = {
+   "message",
+   1,
+   init,
+   TN_NULL,
+};
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
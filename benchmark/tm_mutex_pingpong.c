@@ -0,0 +1,132 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    Benchmark: mutex ping-pong with priority inheritance.
+ *
+ *    The low-priority task locks the mutex and wakes up the high-priority
+ *    task, which preempts it and tries to lock the same mutex; so, the
+ *    high-priority task blocks, and the low-priority task inherits its
+ *    priority. Then, the low-priority task unlocks the mutex, which is handed
+ *    off to the high-priority task; the latter preempts the former again,
+ *    unlocks the mutex and waits for the next round.
+ *
+ *    So, each round exercises the contended paths of the mutex: blocking,
+ *    priority inheritance, hand-off and priority restoring.
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "tm_common.h"
+
+#if !TN_USE_MUTEXES
+#  error mutex benchmark needs TN_USE_MUTEXES to be non-zero
+#endif
+
+
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+enum {
+   COUNTER_TASK_LOW,
+   COUNTER_TASK_HIGH,
+   COUNTERS_CNT
+};
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+TN_STACK_ARR_DEF(task_low_stack, TM_TASK_STACK_SIZE);
+TN_STACK_ARR_DEF(task_high_stack, TM_TASK_STACK_SIZE);
+
+static struct TN_Task task_low;
+static struct TN_Task task_high;
+
+static struct TN_Mutex mutex;
+static struct TN_Sem sem_go;
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+static void task_low_body(void *par)
+{
+   _TN_UNUSED(par);
+
+   for (;;){
+      tm_check(tn_mutex_lock(&mutex, TN_WAIT_INFINITE), "tn_mutex_lock");
+
+      //-- the high-priority task preempts us and blocks on the mutex
+      tm_check(tn_sem_signal(&sem_go), "tn_sem_signal");
+
+      tm_counters[COUNTER_TASK_LOW]++;
+
+      //-- the high-priority task gets the mutex and preempts us
+      tm_check(tn_mutex_unlock(&mutex), "tn_mutex_unlock");
+   }
+}
+
+static void task_high_body(void *par)
+{
+   _TN_UNUSED(par);
+
+   for (;;){
+      tm_check(tn_sem_wait(&sem_go, TN_WAIT_INFINITE), "tn_sem_wait");
+      tm_check(tn_mutex_lock(&mutex, TN_WAIT_INFINITE), "tn_mutex_lock");
+
+      tm_counters[COUNTER_TASK_HIGH]++;
+
+      tm_check(tn_mutex_unlock(&mutex), "tn_mutex_unlock");
+   }
+}
+
+static void init(void)
+{
+   tm_check(
+         tn_mutex_create(&mutex, TN_MUTEX_PROT_INHERIT, 0),
+         "tn_mutex_create"
+         );
+   tm_check(tn_sem_create(&sem_go, 0, 1), "tn_sem_create");
+
+   tm_task_create(
+         &task_high, task_high_body, TM_PRIORITY_BASE, task_high_stack,
+         TN_NULL
+         );
+   tm_task_create(
+         &task_low, task_low_body, TM_PRIORITY_BASE + 1, task_low_stack,
+         TN_NULL
+         );
+}
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC DATA
+ ******************************************************************************/
+
+const struct TM_Test tm_test = {
+   "mutex_pingpong",
+   COUNTERS_CNT,
+   init,
+   TN_NULL,
+};
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
@@ -0,0 +1,107 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    Benchmark: preemptive context switch.
+ *
+ *    Five tasks of different priorities. The lowest-priority task resumes the
+ *    next one, which preempts it immediately, and in turn resumes the next
+ *    one, etc; the highest-priority task just suspends itself. Then, each
+ *    task suspends itself, so that control gets back down the chain to the
+ *    lowest-priority task.
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "tm_common.h"
+
+
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+#define TASKS_CNT    5
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+TN_STACK_ARR_DEF(task_stack_0, TM_TASK_STACK_SIZE);
+TN_STACK_ARR_DEF(task_stack_1, TM_TASK_STACK_SIZE);
+TN_STACK_ARR_DEF(task_stack_2, TM_TASK_STACK_SIZE);
+TN_STACK_ARR_DEF(task_stack_3, TM_TASK_STACK_SIZE);
+TN_STACK_ARR_DEF(task_stack_4, TM_TASK_STACK_SIZE);
+
+static TN_UWord *const task_stacks[ TASKS_CNT ] = {
+   task_stack_0, task_stack_1, task_stack_2, task_stack_3, task_stack_4,
+};
+
+//-- tasks[0] has the lowest priority, tasks[TASKS_CNT - 1] has the highest
+static struct TN_Task tasks[ TASKS_CNT ];
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+static void task_body(void *par)
+{
+   int idx = (int)(TN_UIntPtr)par;
+   struct TN_Task *next = (idx < TASKS_CNT - 1) ? &tasks[idx + 1] : TN_NULL;
+
+   for (;;){
+      //-- all tasks but the lowest-priority one wait until they're resumed
+      if (idx != 0){
+         tm_check(tn_task_suspend(&tasks[idx]), "tn_task_suspend");
+      }
+
+      tm_counters[idx]++;
+
+      if (next != TN_NULL){
+         //-- the next task preempts us right here
+         tm_check(tn_task_resume(next), "tn_task_resume");
+      }
+   }
+}
+
+static void init(void)
+{
+   int i;
+
+   for (i = 0; i < TASKS_CNT; i++){
+      tm_task_create(
+            &tasks[i], task_body, TM_PRIORITY_BASE + (TASKS_CNT - 1 - i),
+            task_stacks[i], (void *)(TN_UIntPtr)i
+            );
+   }
+}
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC DATA
+ ******************************************************************************/
+
+const struct TM_Test tm_test = {
+   "preemptive",
+   TASKS_CNT,
+   init,
+   TN_NULL,
+};
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
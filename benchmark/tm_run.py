@@ -0,0 +1,221 @@
+#!/usr/bin/env python3
+#
+# TNeo: real-time kernel initially based on TNKernel
+#
+# Runs the benchmark binaries (see readme.txt) under QEMU, collects their
+# output and prints the results as a single JSON document:
+#
+#    {
+#       "machine": "mps2-an385",
+#       "tests": {
+#          "preemptive": {"status": "ok", "avg": 123456, "periods": [...]},
+#          ...
+#       }
+#    }
+#
+# `avg` is the average number of iterations per period (the larger, the
+# better).
+#
+# If the results of the previous run are given with --baseline, each test is
+# compared with it, and the script fails if some test got slower by more than
+# --threshold percent.
+#
+# Usage:
+#
+#    tm_run.py --machine mps2-an385 _build/.../tm_*.elf
+#    tm_run.py --machine mps2-an385 -o new.json --baseline old.json _build/.../tm_*.elf
+#    tm_run.py --compare old.json new.json
+#
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+
+
+class TestRunError(Exception):
+    pass
+
+
+def output_parse(lines):
+    """
+    Parses output of one benchmark binary, returns dict with the results of
+    the test.
+    """
+    res = {"status": "error", "error": "no result", "periods": []}
+    name = None
+
+    for line in lines:
+        line = line.strip()
+        if not line.startswith("{"):
+            #-- might be some garbage from QEMU
+            continue
+        try:
+            rec = json.loads(line)
+        except ValueError:
+            continue
+
+        name = rec.get("test", name)
+        kind = rec.get("tm")
+        if kind == "start":
+            res["period_ticks"] = rec["period_ticks"]
+            res["tick_freq"] = rec["tick_freq"]
+        elif kind == "period":
+            res["periods"].append(rec["count"])
+        elif kind == "result":
+            res["status"] = rec["status"]
+            res.pop("error", None)
+            if rec["status"] == "ok":
+                res["avg"] = rec["avg"]
+                if "ram" in rec:
+                    res["ram"] = rec["ram"]
+                if "switches" in rec:
+                    res["switches"] = rec["switches"]
+            else:
+                res["error"] = rec.get("error", "unknown")
+
+    if name is None:
+        raise TestRunError("no benchmark output")
+
+    return name, res
+
+
+def test_run(elf, qemu, machine, timeout, extra_args):
+    cmd = [
+        qemu, "-machine", machine, "-nographic", "-semihosting",
+        "-monitor", "none", "-serial", "stdio", "-kernel", elf,
+    ] + extra_args
+
+    try:
+        proc = subprocess.run(
+            cmd, stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+            universal_newlines=True, timeout=timeout,
+        )
+        out = proc.stdout
+    except subprocess.TimeoutExpired as e:
+        out = e.stdout or ""
+        if isinstance(out, bytes):
+            out = out.decode("utf-8", "replace")
+
+    return output_parse(out.splitlines())
+
+
+def results_compare(baseline, current, threshold, out=sys.stdout):
+    """
+    Compares two results documents, returns the number of regressions.
+    """
+    regressions = 0
+
+    out.write("{:<24} {:>12} {:>12} {:>9}\n".format(
+        "test", "baseline", "current", "change"
+    ))
+    for name in sorted(set(baseline["tests"]) | set(current["tests"])):
+        old = baseline["tests"].get(name, {}).get("avg")
+        new = current["tests"].get(name, {}).get("avg")
+
+        if old is None or new is None:
+            out.write("{:<24} {:>12} {:>12} {:>9}\n".format(
+                name, old if old is not None else "-",
+                new if new is not None else "-", "n/a"
+            ))
+            if new is None:
+                regressions += 1
+            continue
+
+        change = 100.0 * (new - old) / old if old else 0.0
+        mark = ""
+        if change < -threshold:
+            mark = "  <-- REGRESSION"
+            regressions += 1
+        out.write("{:<24} {:>12} {:>12} {:>+8.2f}%{}\n".format(
+            name, old, new, change, mark
+        ))
+
+    return regressions
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(
+        description="Run TNeo benchmark suite under QEMU"
+    )
+    parser.add_argument("elfs", nargs="*", help="benchmark binaries")
+    parser.add_argument(
+        "--qemu", default="qemu-system-arm",
+        help="QEMU executable (default: qemu-system-arm)"
+    )
+    parser.add_argument(
+        "--machine", default="mps2-an385",
+        help="QEMU machine (default: mps2-an385)"
+    )
+    parser.add_argument(
+        "--timeout", type=float, default=120,
+        help="timeout for each test, in seconds (default: 120)"
+    )
+    parser.add_argument(
+        "--qemu-arg", action="append", default=[], metavar="ARG",
+        help="additional argument for QEMU, may be given several times"
+    )
+    parser.add_argument(
+        "-o", "--output", default="-",
+        help="output JSON file (default: stdout)"
+    )
+    parser.add_argument(
+        "--baseline", metavar="FILE",
+        help="results of the previous run, to compare with"
+    )
+    parser.add_argument(
+        "--compare", nargs=2, metavar=("BASELINE", "CURRENT"),
+        help="just compare two results files, don't run anything"
+    )
+    parser.add_argument(
+        "--threshold", type=float, default=5.0, metavar="PERCENT",
+        help="slowdown which is considered a regression (default: 5)"
+    )
+    args = parser.parse_args(argv)
+
+    if args.compare:
+        with open(args.compare[0]) as f:
+            baseline = json.load(f)
+        with open(args.compare[1]) as f:
+            current = json.load(f)
+        return 1 if results_compare(baseline, current, args.threshold) else 0
+
+    if not args.elfs:
+        parser.error("no benchmark binaries given")
+
+    results = {"machine": args.machine, "tests": {}}
+    failed = 0
+    for elf in args.elfs:
+        sys.stderr.write("running {} ...\n".format(os.path.basename(elf)))
+        try:
+            name, res = test_run(
+                elf, args.qemu, args.machine, args.timeout, args.qemu_arg
+            )
+        except TestRunError as e:
+            name = os.path.splitext(os.path.basename(elf))[0]
+            res = {"status": "error", "error": str(e), "periods": []}
+
+        if res["status"] != "ok":
+            sys.stderr.write("error: {}: {}\n".format(name, res["error"]))
+            failed += 1
+        results["tests"][name] = res
+
+    if args.output == "-":
+        json.dump(results, sys.stdout, indent=1, sort_keys=True)
+        sys.stdout.write("\n")
+    else:
+        with open(args.output, "w") as f:
+            json.dump(results, f, indent=1, sort_keys=True)
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+        if results_compare(baseline, results, args.threshold, sys.stderr):
+            failed += 1
+
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,115 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    Benchmark: semaphore ping-pong.
+ *
+ *    Two tasks of the same priority signal each other's semaphore and wait for
+ *    their own one; so, each round takes two semaphore signals, two waits
+ *    and two context switches.
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "tm_common.h"
+
+
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+enum {
+   TASK_PING,
+   TASK_PONG,
+   TASKS_CNT
+};
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+TN_STACK_ARR_DEF(task_ping_stack, TM_TASK_STACK_SIZE);
+TN_STACK_ARR_DEF(task_pong_stack, TM_TASK_STACK_SIZE);
+
+static struct TN_Task tasks[ TASKS_CNT ];
+static struct TN_Sem sems[ TASKS_CNT ];
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+static void task_ping_body(void *par)
+{
+   _TN_UNUSED(par);
+
+   for (;;){
+      tm_check(tn_sem_signal(&sems[TASK_PONG]), "tn_sem_signal");
+      tm_check(tn_sem_wait(&sems[TASK_PING], TN_WAIT_INFINITE), "tn_sem_wait");
+
+      tm_counters[TASK_PING]++;
+   }
+}
+
+static void task_pong_body(void *par)
+{
+   _TN_UNUSED(par);
+
+   for (;;){
+      tm_check(tn_sem_wait(&sems[TASK_PONG], TN_WAIT_INFINITE), "tn_sem_wait");
+
+      tm_counters[TASK_PONG]++;
+
+      tm_check(tn_sem_signal(&sems[TASK_PING]), "tn_sem_signal");
+   }
+}
+
+static void init(void)
+{
+   int i;
+
+   for (i = 0; i < TASKS_CNT; i++){
+      tm_check(tn_sem_create(&sems[i], 0, 1), "tn_sem_create");
+   }
+
+   //-- pong is created first, so that it is already waiting when ping
+   //   starts the game
+   tm_task_create(
+         &tasks[TASK_PONG], task_pong_body, TM_PRIORITY_BASE, task_pong_stack,
+         TN_NULL
+         );
+   tm_task_create(
+         &tasks[TASK_PING], task_ping_body, TM_PRIORITY_BASE, task_ping_stack,
+         TN_NULL
+         );
+}
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC DATA
+ ******************************************************************************/
+
+const struct TM_Test tm_test = {
+   "sem_pingpong",
+   TASKS_CNT,
+   init,
+   TN_NULL,
+};
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
@@ -0,0 +1,120 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    Benchmark: many sessions, a task per session.
+ *
+ *    There are `TM_SESSIONS_CNT` sessions (think of protocol sessions), each
+ *    one waits for messages on its own data queue. Each round, the driver
+ *    task sends one message to each session and waits until all of them
+ *    are handled: the session which handles the last message of the round
+ *    signals the semaphore.
+ *
+ *    Here, each session is served by its own task; tm_sessions_coro.cpp
+ *    does exactly the same with coroutines run by one task (see
+ *    src/cpp/tn_coro.hpp). The counter is the number of rounds, and the RAM
+ *    reported is the one needed for the sessions themselves (tasks and
+ *    stacks; queues are the same in both tests).
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "tm_sessions.h"
+
+
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+TN_STACK_ARR_DEF(driver_stack, TM_TASK_STACK_SIZE);
+
+//-- stacks of the session tasks; wrapped in the struct so that each one is
+//   aligned as the one defined by `TN_STACK_ARR_DEF()`
+static struct {
+   TN_STACK_ARR_DEF(stack, TM_TASK_STACK_SIZE);
+} session_stacks[ TM_SESSIONS_CNT ];
+
+static struct TN_Task driver_task;
+static struct TN_Task session_tasks[ TM_SESSIONS_CNT ];
+
+static struct TM_Sessions sessions;
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+static void session_task_body(void *par)
+{
+   int idx = (int)(TN_UWord)par;
+   void *p_msg;
+
+   for (;;){
+      tm_check(
+            tn_queue_receive(&sessions.queues[idx], &p_msg, TN_WAIT_INFINITE),
+            "tn_queue_receive"
+            );
+      tm_sessions_msg_handle(&sessions, idx, p_msg);
+   }
+}
+
+static void driver_task_body(void *par)
+{
+   _TN_UNUSED(par);
+
+   for (;;){
+      tm_sessions_round(&sessions);
+   }
+}
+
+static void init(void)
+{
+   int i;
+
+   tm_sessions_init(&sessions);
+
+   for (i = 0; i < TM_SESSIONS_CNT; i++){
+      tm_task_create(
+            &session_tasks[i], session_task_body, TM_PRIORITY_BASE + 1,
+            session_stacks[i].stack, (void *)(TN_UWord)i
+            );
+   }
+
+   tm_task_create(
+         &driver_task, driver_task_body, TM_PRIORITY_BASE, driver_stack,
+         TN_NULL
+         );
+}
+
+static unsigned long ram_get(void)
+{
+   return sizeof(session_tasks) + sizeof(session_stacks);
+}
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC DATA
+ ******************************************************************************/
+
+const struct TM_Test tm_test = {
+   "sessions",
+   1,
+   init,
+   TN_NULL,
+   ram_get,
+};
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
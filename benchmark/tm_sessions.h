@@ -0,0 +1,131 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    Benchmark: sessions, common part of tm_sessions.c and
+ *    tm_sessions_coro.cpp (the driver and the job of the session), so that
+ *    both tests do exactly the same.
+ *
+ ******************************************************************************/
+
+#ifndef _TM_SESSIONS_H
+#define _TM_SESSIONS_H
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "tm_common.h"
+
+
+
+/*******************************************************************************
+ *    PUBLIC DEFINITIONS
+ ******************************************************************************/
+
+/// Number of sessions. Note that the coroutine executor can have at most
+/// `(TN_INT_WIDTH - 1)` connected queues.
+#define TM_SESSIONS_CNT       16
+
+/**
+ * Objects shared by the driver and the sessions
+ */
+struct TM_Sessions {
+   ///
+   /// Queue of each session, and its storage (one item is enough: there's
+   /// at most one message per session in each round)
+   struct TN_DQueue queues[ TM_SESSIONS_CNT ];
+   void *queue_fifos[ TM_SESSIONS_CNT ][ 1 ];
+   ///
+   /// Message for each session
+   TN_UWord msgs[ TM_SESSIONS_CNT ];
+   ///
+   /// Signalled when all the messages of the round are handled
+   struct TN_Sem done_sem;
+   ///
+   /// Number of messages of the current round which are not yet handled;
+   /// sessions don't preempt each other, and the driver doesn't touch it
+   /// until the round is done, so, no locking is needed
+   int pending;
+};
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC FUNCTIONS
+ ******************************************************************************/
+
+static inline void tm_sessions_init(struct TM_Sessions *sessions)
+{
+   int i;
+
+   for (i = 0; i < TM_SESSIONS_CNT; i++){
+      tm_check(
+            tn_queue_create(
+               &sessions->queues[i], sessions->queue_fifos[i], 1
+               ),
+            "tn_queue_create"
+            );
+   }
+
+   tm_check(tn_sem_create(&sessions->done_sem, 0, 1), "tn_sem_create");
+}
+
+/**
+ * Driver: send a message to each session and wait until all of them are
+ * handled. Should be called from the task whose priority is higher than
+ * that of sessions, so that sessions run only after all the messages are
+ * sent.
+ */
+static inline void tm_sessions_round(struct TM_Sessions *sessions)
+{
+   int i;
+
+   sessions->pending = TM_SESSIONS_CNT;
+
+   for (i = 0; i < TM_SESSIONS_CNT; i++){
+      sessions->msgs[i]++;
+      tm_check(
+            tn_queue_send(
+               &sessions->queues[i], &sessions->msgs[i], TN_WAIT_INFINITE
+               ),
+            "tn_queue_send"
+            );
+   }
+
+   tm_check(
+         tn_sem_wait(&sessions->done_sem, TN_WAIT_INFINITE),
+         "tn_sem_wait"
+         );
+
+   //-- (not `++`, since it's deprecated for volatile in C++20)
+   tm_counters[0] = tm_counters[0] + 1;
+}
+
+/**
+ * Job of the session: handle the received message.
+ */
+static inline void tm_sessions_msg_handle(
+      struct TM_Sessions  *sessions,
+      int                  idx,
+      void                *p_msg
+      )
+{
+   if (p_msg != &sessions->msgs[idx]){
+      tm_fail("wrong message received");
+   }
+
+   if (--sessions->pending == 0){
+      tm_check(tn_sem_signal(&sessions->done_sem), "tn_sem_signal");
+   }
+}
+
+#endif // _TM_SESSIONS_H
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
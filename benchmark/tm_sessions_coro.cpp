@@ -0,0 +1,150 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    Benchmark: many sessions, a coroutine per session.
+ *
+ *    The same job as in tm_sessions.c, but each session is a C++20
+ *    coroutine, and all of them are run by one executor task (see
+ *    src/cpp/tn_coro.hpp). Queues of the sessions are connected to the
+ *    executor, so that it wakes up as soon as messages arrive. The RAM
+ *    reported is the one needed for the sessions themselves: the executor
+ *    (including its task and stack) plus coroutine frames, assuming that the
+ *    frame pool is sized for the actual frame size.
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "tm_sessions.h"
+#include "cpp/tn_coro.hpp"
+
+
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+//-- block size of the frames pool, in words; it should be large enough for
+//   the frame of `session()`, otherwise the test fails
+#define FRAME_BLOCK_SIZE   48
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+TN_STACK_ARR_DEF(driver_stack, TM_TASK_STACK_SIZE);
+TN_STACK_ARR_DEF(executor_stack, TM_TASK_STACK_SIZE);
+
+static struct TN_Task driver_task;
+
+static struct TN_FMem frames_fmem;
+static TN_UWord frames_buf[ TM_SESSIONS_CNT * FRAME_BLOCK_SIZE ];
+
+//-- the port doesn't run C++ constructors, so, these are constinit
+static constinit tn::coro::FMemFrameAllocator frames_allocator(frames_fmem);
+static constinit tn::coro::Executor executor(frames_allocator);
+
+static struct TM_Sessions sessions;
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+static tn::coro::Task session(tn::coro::Executor &exec, int idx)
+{
+   void *p_msg;
+
+   for (;;){
+      tm_check(
+            co_await exec.receive(&sessions.queues[idx], &p_msg),
+            "receive"
+            );
+      tm_sessions_msg_handle(&sessions, idx, p_msg);
+   }
+}
+
+static void driver_task_body(void *par)
+{
+   int i;
+
+   _TN_UNUSED(par);
+
+   for (i = 0; i < TM_SESSIONS_CNT; i++){
+      tm_check(executor.spawn(session(executor, i)), "frame allocation");
+   }
+
+   for (;;){
+      tm_sessions_round(&sessions);
+   }
+}
+
+static void init(void)
+{
+   int i;
+
+   tm_sessions_init(&sessions);
+
+   tm_check(
+         tn_fmem_create(
+            &frames_fmem, frames_buf, FRAME_BLOCK_SIZE * sizeof(TN_UWord),
+            TM_SESSIONS_CNT
+            ),
+         "tn_fmem_create"
+         );
+
+   //-- all the awaited queues are connected below, so there's nothing to
+   //   poll
+   tm_check(
+         executor.start(
+            TM_PRIORITY_BASE + 1, executor_stack, TM_TASK_STACK_SIZE,
+            TN_WAIT_INFINITE
+            ),
+         "executor start"
+         );
+
+   for (i = 0; i < TM_SESSIONS_CNT; i++){
+      tm_check(executor.connect(&sessions.queues[i]), "executor connect");
+   }
+
+   tm_task_create(
+         &driver_task, driver_task_body, TM_PRIORITY_BASE, driver_stack,
+         TN_NULL
+         );
+}
+
+static unsigned long ram_get(void)
+{
+   return sizeof(executor) + sizeof(executor_stack)
+      + TM_SESSIONS_CNT * TN_MAKE_ALIG_SIZE(frames_allocator.size_max());
+}
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC DATA
+ ******************************************************************************/
+
+const struct TM_Test tm_test = {
+   "sessions_coro",
+   1,
+   init,
+   TN_NULL,
+   ram_get,
+};
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
@@ -0,0 +1,140 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    Benchmark: preemption threshold, common part of tm_threshold_none.c and
+ *    tm_threshold_group.c (the chain of tasks and counting of context
+ *    switches), so that both tests do exactly the same.
+ *
+ *    There are `TM_THRESHOLD_TASKS_CNT` tasks of different priorities, the
+ *    first one has the lowest priority. Each round, the first task signals
+ *    the semaphore of the second one and waits for its own semaphore; each
+ *    next task waits for its semaphore and signals the one of the next task;
+ *    the last (highest-priority) task signals the semaphore of the first
+ *    one.
+ *
+ *    Without threshold, each signal makes the next task preempt the
+ *    signalling one, so control goes up the chain and then back down:
+ *    `2 * (TM_THRESHOLD_TASKS_CNT - 1)` context switches per round. If all
+ *    the tasks are in the threshold group (threshold of each one is the
+ *    highest priority in the group), they don't preempt each other, and the
+ *    next task runs only when the previous one blocks:
+ *    `TM_THRESHOLD_TASKS_CNT` context switches per round.
+ *
+ ******************************************************************************/
+
+#ifndef _TM_THRESHOLD_H
+#define _TM_THRESHOLD_H
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "tm_common.h"
+
+#if !TN_USE_PREEMPT_THRESHOLD
+#  error threshold tests need TM_CFLAGS=-DTN_USE_PREEMPT_THRESHOLD=1, see readme.txt
+#endif
+
+
+
+/*******************************************************************************
+ *    PUBLIC DEFINITIONS
+ ******************************************************************************/
+
+/// Number of tasks in the chain
+#define TM_THRESHOLD_TASKS_CNT   5
+
+/// Priority of the task with the given index: the first task has the lowest
+/// priority
+#define TM_THRESHOLD_PRIORITY(idx)                                            \
+   (TM_PRIORITY_BASE + TM_THRESHOLD_TASKS_CNT - 1 - (idx))
+
+/**
+ * Objects shared by the tasks of the chain
+ */
+struct TM_Threshold {
+   ///
+   /// Semaphore of each task
+   struct TN_Sem sems[ TM_THRESHOLD_TASKS_CNT ];
+   ///
+   /// Index of the task which ran last, see `tm_threshold_switch_note()`
+   int last_idx;
+   ///
+   /// Number of context switches between the tasks of the chain
+   volatile unsigned long switches;
+};
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC FUNCTIONS
+ ******************************************************************************/
+
+static inline void tm_threshold_init(struct TM_Threshold *threshold)
+{
+   int i;
+
+   for (i = 0; i < TM_THRESHOLD_TASKS_CNT; i++){
+      tm_check(tn_sem_create(&threshold->sems[i], 0, 1), "tn_sem_create");
+   }
+
+   threshold->last_idx = -1;
+}
+
+/**
+ * Should be called by the task with the given index after each kernel call
+ * which may switch context: if some other task of the chain ran last, we've
+ * got here by a context switch. Switches to and from the reporter task
+ * aren't counted, since it doesn't update `last_idx`.
+ */
+static inline void tm_threshold_switch_note(
+      struct TM_Threshold *threshold,
+      int                  idx
+      )
+{
+   if (threshold->last_idx != idx){
+      threshold->last_idx = idx;
+      threshold->switches = threshold->switches + 1;
+   }
+}
+
+/**
+ * Body of the task with the given index, never returns.
+ */
+static inline void tm_threshold_task_run(
+      struct TM_Threshold *threshold,
+      int                  idx
+      )
+{
+   struct TN_Sem *my_sem = &threshold->sems[idx];
+   struct TN_Sem *next_sem =
+      &threshold->sems[(idx + 1) % TM_THRESHOLD_TASKS_CNT];
+
+   for (;;){
+      if (idx != 0){
+         tm_check(tn_sem_wait(my_sem, TN_WAIT_INFINITE), "tn_sem_wait");
+         tm_threshold_switch_note(threshold, idx);
+      }
+
+      tm_counters[idx]++;
+
+      tm_check(tn_sem_signal(next_sem), "tn_sem_signal");
+      tm_threshold_switch_note(threshold, idx);
+
+      if (idx == 0){
+         tm_check(tn_sem_wait(my_sem, TN_WAIT_INFINITE), "tn_sem_wait");
+         tm_threshold_switch_note(threshold, idx);
+      }
+   }
+}
+
+#endif // _TM_THRESHOLD_H
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
@@ -0,0 +1,100 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    Benchmark: chain of tasks of different priorities, all of them are in
+ *    the preemption threshold group.
+ *
+ *    Each task signals the semaphore of the next one (see tm_threshold.h),
+ *    but the next task runs only when the signalling one blocks, since each
+ *    task has the threshold equal to the highest priority in the chain.
+ *    tm_threshold_none.c does exactly the same without threshold; compare
+ *    both "avg" and "switches" of the two tests.
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "tm_threshold.h"
+
+
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+//-- wrapped in the struct so that each stack is aligned as the one defined
+//   by `TN_STACK_ARR_DEF()`
+static struct {
+   TN_STACK_ARR_DEF(stack, TM_TASK_STACK_SIZE);
+} task_stacks[ TM_THRESHOLD_TASKS_CNT ];
+
+static struct TN_Task tasks[ TM_THRESHOLD_TASKS_CNT ];
+
+static struct TM_Threshold threshold;
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+static void task_body(void *par)
+{
+   //-- threshold can't be set before the scheduler is started, so each task
+   //   sets its own one
+   tm_check(
+         tn_task_preempt_threshold_set(
+            tn_cur_task_get(),
+            TM_THRESHOLD_PRIORITY(TM_THRESHOLD_TASKS_CNT - 1)
+            ),
+         "tn_task_preempt_threshold_set"
+         );
+
+   tm_threshold_task_run(&threshold, (int)(TN_UIntPtr)par);
+}
+
+static void init(void)
+{
+   int i;
+
+   tm_threshold_init(&threshold);
+
+   for (i = 0; i < TM_THRESHOLD_TASKS_CNT; i++){
+      tm_task_create(
+            &tasks[i], task_body, TM_THRESHOLD_PRIORITY(i),
+            task_stacks[i].stack, (void *)(TN_UIntPtr)i
+            );
+   }
+}
+
+static unsigned long switches_get(void)
+{
+   return threshold.switches;
+}
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC DATA
+ ******************************************************************************/
+
+const struct TM_Test tm_test = {
+   "threshold_group",
+   TM_THRESHOLD_TASKS_CNT,
+   init,
+   TN_NULL,
+   TN_NULL,
+   switches_get,
+};
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
@@ -0,0 +1,89 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    Benchmark: chain of tasks of different priorities, without preemption
+ *    threshold.
+ *
+ *    Each task signals the semaphore of the next one (see tm_threshold.h),
+ *    and the next task preempts it immediately. tm_threshold_group.c does
+ *    exactly the same, but all the tasks are in the threshold group; compare
+ *    both "avg" and "switches" of the two tests.
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "tm_threshold.h"
+
+
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+//-- wrapped in the struct so that each stack is aligned as the one defined
+//   by `TN_STACK_ARR_DEF()`
+static struct {
+   TN_STACK_ARR_DEF(stack, TM_TASK_STACK_SIZE);
+} task_stacks[ TM_THRESHOLD_TASKS_CNT ];
+
+static struct TN_Task tasks[ TM_THRESHOLD_TASKS_CNT ];
+
+static struct TM_Threshold threshold;
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+static void task_body(void *par)
+{
+   tm_threshold_task_run(&threshold, (int)(TN_UIntPtr)par);
+}
+
+static void init(void)
+{
+   int i;
+
+   tm_threshold_init(&threshold);
+
+   for (i = 0; i < TM_THRESHOLD_TASKS_CNT; i++){
+      tm_task_create(
+            &tasks[i], task_body, TM_THRESHOLD_PRIORITY(i),
+            task_stacks[i].stack, (void *)(TN_UIntPtr)i
+            );
+   }
+}
+
+static unsigned long switches_get(void)
+{
+   return threshold.switches;
+}
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC DATA
+ ******************************************************************************/
+
+const struct TM_Test tm_test = {
+   "threshold_none",
+   TM_THRESHOLD_TASKS_CNT,
+   init,
+   TN_NULL,
+   TN_NULL,
+   switches_get,
+};
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
@@ -161,6 +161,16 @@ int ffs_asm(int x);
 #  define _TN_CORTEX_FPU_CONTEXT_SIZE 0  /* no FPU registers */
 #endif
 
+#if TN_STACK_OVERFLOW_MPU_GUARD
+/*
+ * MPU guard region is 32 bytes (8 words), and it should be aligned by 32
+ * bytes, so in the worst case it takes 15 words of stack
+ */
+#  define _TN_CORTEX_MPU_GUARD_SIZE   15
+#else
+#  define _TN_CORTEX_MPU_GUARD_SIZE   0
+#endif
+
 
 /**
  * Minimum task's stack size, in words, not in bytes; includes a space for
@@ -169,6 +179,7 @@ int ffs_asm(int x);
 #define  TN_MIN_STACK_SIZE          (17 /* context: 17 words */   \
       + _TN_STACK_OVERFLOW_SIZE_ADD                               \
       + _TN_CORTEX_FPU_CONTEXT_SIZE                               \
+      + _TN_CORTEX_MPU_GUARD_SIZE                                 \
       )
 
 /**
@@ -267,9 +278,17 @@ typedef  unsigned int               TN_UIntPtr;
  * @see `tn_arch_sr_save_int_dis()`
  */
 
-#define TN_INT_DIS_SAVE()   TN_INTSAVE_VAR = tn_arch_sr_save_int_dis()
-#define TN_INT_RESTORE()    _TN_CORTEX_INTSAVE_CHECK();                     \
-                            tn_arch_sr_restore(TN_INTSAVE_VAR)
+#define TN_INT_DIS_SAVE()                                                   \
+   do {                                                                     \
+      TN_INTSAVE_VAR = tn_arch_sr_save_int_dis();                           \
+      _TN_CSECT_ENTER();                                                    \
+   } while (0)
+#define TN_INT_RESTORE()                                                    \
+   do {                                                                     \
+      _TN_CORTEX_INTSAVE_CHECK();                                           \
+      _TN_CSECT_EXIT();                                                     \
+      tn_arch_sr_restore(TN_INTSAVE_VAR);                                   \
+   } while (0)
 
 /**
  * The same as `TN_INT_DIS_SAVE()` but for using in ISR.
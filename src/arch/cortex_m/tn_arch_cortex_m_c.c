@@ -82,6 +82,53 @@
  ******************************************************************************/
 
 #include "_tn_tasks.h"
+#include "_tn_sys.h"
+
+
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+#if TN_STACK_OVERFLOW_MPU_GUARD
+
+//-- ARMv7-M MPU and System Control Block registers
+#define _MPU_TYPE       (*(volatile TN_UWord *)0xE000ED90)
+#define _MPU_CTRL       (*(volatile TN_UWord *)0xE000ED94)
+#define _MPU_RNR        (*(volatile TN_UWord *)0xE000ED98)
+#define _MPU_RBAR       (*(volatile TN_UWord *)0xE000ED9C)
+#define _MPU_RASR       (*(volatile TN_UWord *)0xE000EDA0)
+#define _SCB_SHCSR      (*(volatile TN_UWord *)0xE000ED24)
+#define _SCB_CFSR       (*(volatile TN_UWord *)0xE000ED28)
+#define _SCB_MMFAR      (*(volatile TN_UWord *)0xE000ED34)
+
+#define _MPU_TYPE_DREGION_MASK   0x0000ff00
+
+#define _MPU_CTRL_ENABLE         (1 << 0)
+#define _MPU_CTRL_PRIVDEFENA     (1 << 2)
+
+#define _MPU_RBAR_VALID          (1 << 4)
+
+#define _MPU_RASR_ENABLE         (1 << 0)
+//-- SIZE field: region size is 2^(SIZE + 1) bytes, so 4 means 32 bytes
+#define _MPU_RASR_SIZE_32        (4 << 1)
+//-- AP = 0b110: read-only, both privileged and unprivileged
+#define _MPU_RASR_AP_RO          (6 << 24)
+#define _MPU_RASR_XN             (1 << 28)
+
+#define _SCB_SHCSR_MEMFAULTENA   (1 << 16)
+
+#define _SCB_CFSR_MMARVALID      (1 << 7)
+#define _SCB_CFSR_MSTKERR        (1 << 4)
+
+//-- MPU region used for stack guard: the highest-numbered one, since
+//   it has the highest priority when regions overlap
+#define _GUARD_REGION            7
+
+//-- guard region size, in bytes
+#define _GUARD_SIZE              32
+
+#endif
 
 
 
@@ -107,6 +154,90 @@
  *    CORTEX-M SPECIFIC FUNCTIONS
  ******************************************************************************/
 
+#if TN_STACK_OVERFLOW_MPU_GUARD
+
+/**
+ * Returns address of the MPU guard region for the given task: the first
+ * 32-byte aligned address in the task's stack.
+ */
+static TN_UWord _guard_addr_get(struct TN_Task *task)
+{
+   return ((TN_UWord)task->stack_low_addr + (_GUARD_SIZE - 1))
+      & ~(TN_UWord)(_GUARD_SIZE - 1);
+}
+
+/**
+ * Called from `_tn_arch_sys_start()` (see tn_arch_cortex_m.S), before the
+ * first context switch: sets up MPU guard region, enables MPU and MemManage
+ * fault.
+ */
+void _tn_arch_mpu_guard_init(void)
+{
+   if ((_MPU_TYPE & _MPU_TYPE_DREGION_MASK) == 0){
+      _TN_FATAL_ERROR("MPU is not present");
+   }
+
+   //-- set the guard for the first task, and configure the region
+   _MPU_RNR  = _GUARD_REGION;
+   _MPU_RBAR = _guard_addr_get(_tn_next_task_to_run);
+   _MPU_RASR = _MPU_RASR_XN | _MPU_RASR_AP_RO | _MPU_RASR_SIZE_32
+      | _MPU_RASR_ENABLE;
+
+   //-- enable MemManage fault, so that it isn't escalated to HardFault
+   _SCB_SHCSR |= _SCB_SHCSR_MEMFAULTENA;
+
+   //-- enable MPU, with background region for privileged access, so that
+   //   memory map isn't affected except our guard region
+   _MPU_CTRL = _MPU_CTRL_PRIVDEFENA | _MPU_CTRL_ENABLE;
+
+   //-- NOTE: DSB + ISB, required after the MPU is enabled, are executed
+   //   by the caller (_tn_arch_sys_start()) right after return.
+}
+
+/**
+ * Called from `PendSV_Handler` and `SVC_Handler` (see tn_arch_cortex_m.S),
+ * right before the context of the given task is restored: moves the guard
+ * region to the end of its stack.
+ *
+ * Since region number and base address are written by a single store to
+ * `MPU->RBAR` (with VALID bit set), and size/attributes are kept from
+ * `_tn_arch_mpu_guard_init()`, this is cheap. The caller executes DSB + ISB
+ * right after return, so the new base address is guaranteed to take effect
+ * before the context of the task is restored.
+ */
+void _tn_arch_mpu_guard_set(struct TN_Task *task)
+{
+   _MPU_RBAR = _guard_addr_get(task) | _MPU_RBAR_VALID | _GUARD_REGION;
+}
+
+/**
+ * MemManage fault handler: if the fault was caused by the write to the
+ * guard region of the running task (or by the exception stacking which hit
+ * the guard), report stack overflow. Anyway, the task can't proceed, so the
+ * fatal error is generated.
+ */
+void MemManage_Handler(void)
+{
+   TN_UWord cfsr = _SCB_CFSR;
+   struct TN_Task *task = _tn_curr_run_task;
+
+   if (cfsr & _SCB_CFSR_MSTKERR){
+      //-- fault on exception entry stacking: the task's stack is overflowed
+      _tn_sys_stack_overflow_notify(task);
+   } else if (cfsr & _SCB_CFSR_MMARVALID){
+      TN_UWord addr = _SCB_MMFAR;
+      TN_UWord guard_addr = _guard_addr_get(task);
+
+      if (addr >= guard_addr && addr < guard_addr + _GUARD_SIZE){
+         _tn_sys_stack_overflow_notify(task);
+      }
+   }
+
+   _TN_FATAL_ERROR("MemManage fault");
+}
+
+#endif
+
 
 /*******************************************************************************
  *    IMPLEMENTATION
@@ -161,7 +161,11 @@ typedef  unsigned int               TN_UIntPtr;
  * @see `#TN_INTSAVE_DATA`
  * @see `tn_arch_sr_save_int_dis()`
  */
-#define TN_INT_DIS_SAVE()        tn_save_status_reg = tn_arch_sr_save_int_dis()
+#define TN_INT_DIS_SAVE()                                                   \
+   do {                                                                     \
+      tn_save_status_reg = tn_arch_sr_save_int_dis();                       \
+      _TN_CSECT_ENTER();                                                    \
+   } while (0)
 
 /**
  * Restore previously saved status register.
@@ -173,7 +177,11 @@ typedef  unsigned int               TN_UIntPtr;
  * @see `#TN_INTSAVE_DATA`
  * @see `tn_arch_sr_save_int_dis()`
  */
-#define TN_INT_RESTORE()         tn_arch_sr_restore(tn_save_status_reg)
+#define TN_INT_RESTORE()                                                    \
+   do {                                                                     \
+      _TN_CSECT_EXIT();                                                     \
+      tn_arch_sr_restore(tn_save_status_reg);                               \
+   } while (0)
 
 /**
  * The same as `TN_INT_DIS_SAVE()` but for using in ISR.
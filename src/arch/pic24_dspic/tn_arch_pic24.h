@@ -251,9 +251,17 @@ typedef  unsigned int               TN_UIntPtr;
  * @see `tn_arch_sr_save_int_dis()`
  */
 
-#  define TN_INT_DIS_SAVE()   TN_INTSAVE_VAR = tn_arch_sr_save_int_dis()
-#  define TN_INT_RESTORE()    _TN_PIC24_INTSAVE_CHECK();                      \
-                              tn_arch_sr_restore(TN_INTSAVE_VAR)
+#  define TN_INT_DIS_SAVE()                                                 \
+   do {                                                                     \
+      TN_INTSAVE_VAR = tn_arch_sr_save_int_dis();                           \
+      _TN_CSECT_ENTER();                                                    \
+   } while (0)
+#  define TN_INT_RESTORE()                                                  \
+   do {                                                                     \
+      _TN_PIC24_INTSAVE_CHECK();                                            \
+      _TN_CSECT_EXIT();                                                     \
+      tn_arch_sr_restore(TN_INTSAVE_VAR);                                   \
+   } while (0)
 
 /**
  * The same as `TN_INT_DIS_SAVE()` but for using in ISR.
@@ -251,16 +251,32 @@ typedef  unsigned int               TN_UIntPtr;
  */
 
 #ifdef __mips16
-#  define TN_INT_DIS_SAVE()   TN_INTSAVE_VAR = tn_arch_sr_save_int_dis()
-#  define TN_INT_RESTORE()    _TN_PIC32_INTSAVE_CHECK();                      \
-                              tn_arch_sr_restore(TN_INTSAVE_VAR)
+#  define TN_INT_DIS_SAVE()                                                 \
+   do {                                                                     \
+      TN_INTSAVE_VAR = tn_arch_sr_save_int_dis();                           \
+      _TN_CSECT_ENTER();                                                    \
+   } while (0)
+#  define TN_INT_RESTORE()                                                  \
+   do {                                                                     \
+      _TN_PIC32_INTSAVE_CHECK();                                            \
+      _TN_CSECT_EXIT();                                                     \
+      tn_arch_sr_restore(TN_INTSAVE_VAR);                                   \
+   } while (0)
 #else
-#  define TN_INT_DIS_SAVE()   __asm__ __volatile__(                           \
-                                    "di %0; ehb"                              \
-                                    : "=d" (TN_INTSAVE_VAR)                   \
-                                    )
-#  define TN_INT_RESTORE()    _TN_PIC32_INTSAVE_CHECK();                      \
-                              __builtin_mtc0(12, 0, TN_INTSAVE_VAR)
+#  define TN_INT_DIS_SAVE()                                                 \
+   do {                                                                     \
+      __asm__ __volatile__(                                                 \
+            "di %0; ehb"                                                    \
+            : "=d" (TN_INTSAVE_VAR)                                         \
+            );                                                              \
+      _TN_CSECT_ENTER();                                                    \
+   } while (0)
+#  define TN_INT_RESTORE()                                                  \
+   do {                                                                     \
+      _TN_PIC32_INTSAVE_CHECK();                                            \
+      _TN_CSECT_EXIT();                                                     \
+      __builtin_mtc0(12, 0, TN_INTSAVE_VAR);                                \
+   } while (0)
 #endif
 
 /**
@@ -141,6 +141,38 @@
 
 
 
+//-- Hooks for `#TN_CSECT_MEASURE`: the port should invoke
+//   `_TN_CSECT_ENTER()` in `TN_INT_DIS_SAVE()` right after interrupts are
+//   disabled, and `_TN_CSECT_EXIT()` in `TN_INT_RESTORE()` right before
+//   they are restored.
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#if TN_CSECT_MEASURE
+
+//-- return address of the current function, if compiler is able to provide it
+#  if defined(__TN_COMPILER_ARMCC__)
+#     define _TN_CSECT_CALLER_PC()  ((void *)__return_address())
+#  elif defined(__GNUC__)
+#     define _TN_CSECT_CALLER_PC()  __builtin_return_address(0)
+#  else
+#     define _TN_CSECT_CALLER_PC()  TN_NULL
+#  endif
+
+#  define _TN_CSECT_ENTER()                                            \
+   _tn_csect_enter(__func__, __LINE__, _TN_CSECT_CALLER_PC())
+
+#  define _TN_CSECT_EXIT()     _tn_csect_exit()
+
+#else
+#  define _TN_CSECT_ENTER()    /* nothing */
+#  define _TN_CSECT_EXIT()     /* nothing */
+#endif
+
+#endif
+
+
+
 #ifdef __cplusplus
 extern "C"  {  /*}*/
 #endif
@@ -322,6 +354,43 @@ void _tn_arch_sys_start(
       TN_UWord       int_stack_size
       );
 
+#if TN_CSECT_MEASURE
+/**
+ * Called by `_TN_CSECT_ENTER()` when interrupts are just disabled by
+ * `TN_INT_DIS_SAVE()`; implemented in `tn_csect.c`.
+ *
+ * @param service
+ *    Name of the function which contains the critical section
+ * @param line
+ *    Line number of the critical section
+ * @param caller_pc
+ *    Return address of the function which contains the critical section
+ */
+void _tn_csect_enter(
+      const char    *service,
+      unsigned int   line,
+      void          *caller_pc
+      );
+
+/**
+ * Called by `_TN_CSECT_EXIT()` when interrupts are about to be restored by
+ * `TN_INT_RESTORE()`; implemented in `tn_csect.c`.
+ */
+void _tn_csect_exit(void);
+#endif
+
+#if TN_PC_SAMPLE && defined(__TN_ARCH_CORTEX_M__)
+/**
+ * Should be called from ISR: returns address of the instruction interrupted
+ * by the current interrupt, if only it is a task code; otherwise (if the
+ * interrupted code is an interrupt as well), returns 0. Used by PC-sampling
+ * profiler, see `tn_pc_sample.h`.
+ *
+ * Implemented on Cortex-M only.
+ */
+TN_UWord _tn_arch_isr_interrupted_pc_get(void);
+#endif
+
 
 #ifdef __cplusplus
 }  /* extern "C" */
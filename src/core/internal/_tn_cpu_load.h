@@ -0,0 +1,111 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef __TN_CPU_LOAD_H
+#define __TN_CPU_LOAD_H
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "_tn_sys.h"
+#include "tn_cpu_load.h"
+
+
+
+
+#ifdef __cplusplus
+extern "C"  {     /*}*/
+#endif
+
+/*******************************************************************************
+ *    PROTECTED FUNCTION PROTOTYPES
+ ******************************************************************************/
+
+#if TN_CPU_LOAD
+
+/**
+ * Should be called at every system tick, with interrupts disabled: samples
+ * idle task (if precise timestamps aren't available), and closes the period
+ * when it's time to.
+ */
+void _tn_cpu_load_on_tick(void);
+
+/**
+ * Should be called at every context switch: if precise timestamps are
+ * available, accounts idle time when the idle task is switched out.
+ */
+void _tn_cpu_load_on_context_switch(
+      struct TN_Task *task_prev,
+      struct TN_Task *task_new
+      );
+
+#else
+
+/*
+ * Stub empty functions, they are needed when `#TN_CPU_LOAD` is zero.
+ */
+
+_TN_STATIC_INLINE void _tn_cpu_load_on_tick(void)
+{
+   //-- nothing to do
+}
+
+_TN_STATIC_INLINE void _tn_cpu_load_on_context_switch(
+      struct TN_Task *task_prev,
+      struct TN_Task *task_new
+      )
+{
+   _TN_UNUSED(task_prev);
+   _TN_UNUSED(task_new);
+}
+
+#endif   // TN_CPU_LOAD
+
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+
+
+#endif // __TN_CPU_LOAD_H
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
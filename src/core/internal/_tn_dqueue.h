@@ -71,6 +71,23 @@ extern "C"  {     /*}*/
  ******************************************************************************/
 
 
+/*******************************************************************************
+ *    PROTECTED FUNCTION PROTOTYPES
+ ******************************************************************************/
+
+#if TN_USE_SELECT
+/**
+ * Try to receive data from the queue without waiting, on behalf of
+ * `tn_select()`: returns `#TN_RC_OK` or `#TN_RC_TIMEOUT`.
+ *
+ * \attention Caller must disable interrupts.
+ */
+enum TN_RCode _tn_dqueue_select_try(
+      struct TN_DQueue *dque,
+      void **pp_data
+      );
+#endif
+
 /*******************************************************************************
  *    PROTECTED INLINE FUNCTIONS
  ******************************************************************************/
@@ -126,6 +126,22 @@ enum TN_RCode _tn_eventgrp_link_manage(
 
 
 
+#if TN_USE_SELECT
+/**
+ * Check the event group without waiting, on behalf of `tn_select()`: if the
+ * condition is met, flags are cleared (if needed), and `#TN_RC_OK` is
+ * returned; otherwise, `#TN_RC_TIMEOUT` is returned.
+ *
+ * \attention Caller must disable interrupts.
+ */
+enum TN_RCode _tn_eventgrp_select_try(
+      struct TN_EventGrp  *eventgrp,
+      TN_UWord             wait_pattern,
+      enum TN_EGrpWaitMode wait_mode,
+      TN_UWord            *p_flags_pattern
+      );
+#endif
+
 /*******************************************************************************
  *    PROTECTED INLINE FUNCTIONS
  ******************************************************************************/
@@ -71,6 +71,20 @@ extern "C"  {     /*}*/
  ******************************************************************************/
 
 
+/*******************************************************************************
+ *    PROTECTED FUNCTION PROTOTYPES
+ ******************************************************************************/
+
+#if TN_USE_SELECT
+/**
+ * Try to get memory block from the pool without waiting, on behalf of
+ * `tn_select()`: returns `#TN_RC_OK` or `#TN_RC_TIMEOUT`.
+ *
+ * \attention Caller must disable interrupts.
+ */
+enum TN_RCode _tn_fmem_select_try(struct TN_FMem *fmem, void **p_data);
+#endif
+
 /*******************************************************************************
  *    PROTECTED INLINE FUNCTIONS
  ******************************************************************************/
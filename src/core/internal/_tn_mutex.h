@@ -94,6 +94,42 @@ void _tn_mutex_i_on_task_wait_complete(struct TN_Task *task);
  */
 void _tn_mutex_on_task_wait_complete(struct TN_Task *task);
 
+/**
+ * Recalculate the priority of the task, depending on its base priority and
+ * all the mutexes (and rwlocks) it holds. If the task waits for the mutex
+ * with priority inheritance, the priority of the mutex holder is updated as
+ * well, and so on, recursively.
+ */
+void _tn_mutex_task_priority_update(struct TN_Task *task);
+
+/**
+ * Elevate task's priority to given value (if task's priority is now lower).
+ * If task is waiting for some mutex (or rwlock) with priority inheritance,
+ * elevate priority of the holder too, recursively.
+ */
+void _tn_mutex_task_priority_elevate(struct TN_Task *task, int priority);
+
+/**
+ * Unlock the mutex held by the current task, regardless of the recursive
+ * lock count, and hand it over to the first waiter (if any). Used by the
+ * condition variable which releases the mutex on behalf of the task which
+ * starts waiting.
+ */
+void _tn_mutex_release(struct TN_Mutex *mutex);
+
+/**
+ * Make the task, which is waiting for some other object (e.g. for the
+ * condition variable), acquire the mutex, without waking it up just to block
+ * on the mutex again:
+ *
+ * - if the mutex isn't locked, task finishes waiting with `#TN_RC_OK` and
+ *   becomes the holder of the mutex;
+ * - otherwise, task is moved to the mutex's wait queue with no timeout, and
+ *   the priority of the holder is elevated (for `#TN_MUTEX_PROT_INHERIT`),
+ *   just like if the task called `tn_mutex_lock()` by itself.
+ */
+void _tn_mutex_wait_transfer(struct TN_Mutex *mutex, struct TN_Task *task);
+
 #else
 
 /*
@@ -0,0 +1,164 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef __TN_OBJ_STATS_H
+#define __TN_OBJ_STATS_H
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "_tn_sys.h"
+#include "tn_obj_stats.h"
+
+
+
+
+#ifdef __cplusplus
+extern "C"  {     /*}*/
+#endif
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+/**
+ * Should be used by the kernel code when the object is acquired (see
+ * `struct #TN_ObjStats`), with interrupts disabled. If `#TN_OBJ_STATS` is
+ * zero, it expands to nothing.
+ *
+ * @param obj
+ *    Pointer to the object which contains `obj_stats` field
+ */
+#if TN_OBJ_STATS
+#  define _TN_OBJ_STATS_ACQUIRED(obj)                                   \
+   ((obj)->obj_stats.stats.acquire_cnt++)
+#else
+#  define _TN_OBJ_STATS_ACQUIRED(obj)     /* nothing */
+#endif
+
+/**
+ * Should be used by the kernel code when the number of items in the data
+ * queue, or used blocks in the memory pool, increases; with interrupts
+ * disabled. If `#TN_OBJ_STATS` is zero, it expands to nothing, so arguments
+ * aren't evaluated at all.
+ *
+ * @param obj
+ *    Pointer to the object which contains `obj_stats` field
+ * @param level
+ *    New number of items or used blocks
+ */
+#if TN_OBJ_STATS
+#  define _TN_OBJ_STATS_LEVEL(obj, level)                               \
+   do {                                                                 \
+      if ((obj)->obj_stats.stats.level_max < (unsigned int)(level)){    \
+         (obj)->obj_stats.stats.level_max = (unsigned int)(level);      \
+      }                                                                 \
+   } while (0)
+#else
+#  define _TN_OBJ_STATS_LEVEL(obj, level)  /* nothing */
+#endif
+
+
+
+
+/*******************************************************************************
+ *    PROTECTED FUNCTION PROTOTYPES
+ ******************************************************************************/
+
+#if TN_OBJ_STATS
+
+/**
+ * Should be called when the object is created: resets statistics and adds
+ * the object to the list of objects with statistics.
+ *
+ * @param obj_stats
+ *    Statistics structure contained in the object
+ * @param obj
+ *    The object itself
+ */
+void _tn_obj_stats_create(struct _TN_ObjStats *obj_stats, const void *obj);
+
+/**
+ * Should be called when the object is deleted, after all waiting tasks are
+ * woken up: removes the object from the list of objects with statistics.
+ */
+void _tn_obj_stats_delete(struct _TN_ObjStats *obj_stats);
+
+/**
+ * Should be called when task starts waiting, after `task->pwait_queue` and
+ * `task->task_wait_reason` are set.
+ */
+void _tn_obj_stats_on_wait(struct TN_Task *task);
+
+/**
+ * Should be called when task finishes waiting, before `task->pwait_queue`
+ * is reset.
+ */
+void _tn_obj_stats_on_wait_end(struct TN_Task *task);
+
+#else
+
+/*
+ * Stub empty functions, they are needed when `#TN_OBJ_STATS` is zero.
+ */
+
+_TN_STATIC_INLINE void _tn_obj_stats_on_wait(struct TN_Task *task)
+{
+   _TN_UNUSED(task);
+}
+
+_TN_STATIC_INLINE void _tn_obj_stats_on_wait_end(struct TN_Task *task)
+{
+   _TN_UNUSED(task);
+}
+
+#endif   // TN_OBJ_STATS
+
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+
+
+#endif // __TN_OBJ_STATS_H
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
@@ -0,0 +1,149 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef __TN_RPC_H
+#define __TN_RPC_H
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "_tn_sys.h"
+#include "tn_rpc.h"
+
+
+
+
+#ifdef __cplusplus
+extern "C"  {     /*}*/
+#endif
+
+/*******************************************************************************
+ *    PUBLIC TYPES
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    PROTECTED GLOBAL DATA
+ ******************************************************************************/
+
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+
+/*******************************************************************************
+ *    PROTECTED FUNCTION PROTOTYPES
+ ******************************************************************************/
+
+#if TN_USE_RPC
+/**
+ * Abort all the calls being handled by the task: their clients wake up with
+ * `#TN_RC_FORCED`. Should be called when task is terminated.
+ */
+void _tn_rpc_abort_all_by_task(struct TN_Task *task);
+
+/**
+ * Should be called when client task finishes waiting for the RPC object
+ * (no matter why: the call is replied, timeout, etc).
+ *
+ * Preconditions: 
+ *
+ * - `task->task_queue` is removed from the RPC object's wait queue;
+ * - `task->pwait_queue` still points to the RPC object which task was
+ *   waiting for.
+ */
+void _tn_rpc_on_task_wait_complete(struct TN_Task *task);
+
+/**
+ * Returns the task which handles the call of the RPC object now, or
+ * `#TN_NULL` if there's no such task. Used to propagate priority of the
+ * client to the server (see `_tn_mutex_task_priority_elevate()`).
+ *
+ * @param wait_queue
+ *    Wait queue of the RPC object (the one for clients)
+ */
+struct TN_Task *_tn_rpc_server_get(struct TN_ListItem *wait_queue);
+
+#else
+
+/*
+ * RPC objects are excluded from project: define some stub functions that 
+ * are just compiled out.
+ */
+
+_TN_STATIC_INLINE void _tn_rpc_abort_all_by_task(struct TN_Task *task) {
+   (void) task;
+}
+_TN_STATIC_INLINE void _tn_rpc_on_task_wait_complete(struct TN_Task *task) {
+   (void) task;
+}
+#endif
+
+
+
+/*******************************************************************************
+ *    PROTECTED INLINE FUNCTIONS
+ ******************************************************************************/
+
+/**
+ * Checks whether given RPC object is valid 
+ * (actually, just checks against `id_rpc` field, see `enum #TN_ObjId`)
+ */
+_TN_STATIC_INLINE TN_BOOL _tn_rpc_is_valid(
+      const struct TN_RPC  *rpc
+      )
+{
+   return (rpc->id_rpc == TN_ID_RPC);
+}
+
+
+
+
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+
+
+#endif // __TN_RPC_H
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
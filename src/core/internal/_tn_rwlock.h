@@ -0,0 +1,152 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef __TN_RWLOCK_H
+#define __TN_RWLOCK_H
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "_tn_sys.h"
+#include "tn_rwlock.h"
+
+
+
+
+#ifdef __cplusplus
+extern "C"  {     /*}*/
+#endif
+
+/*******************************************************************************
+ *    PUBLIC TYPES
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    PROTECTED GLOBAL DATA
+ ******************************************************************************/
+
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+
+/*******************************************************************************
+ *    PROTECTED FUNCTION PROTOTYPES
+ ******************************************************************************/
+
+#if TN_USE_RWLOCKS
+/**
+ * Unlock all rwlocks locked by the task
+ */
+void _tn_rwlock_unlock_all_by_task(struct TN_Task *task);
+
+/**
+ * Should be called when task finishes waiting for the rwlock (no matter
+ * why: the rwlock is locked, timeout, etc).
+ *
+ * Preconditions: 
+ *
+ * - `task->task_queue` is removed from the rwlock's wait queue;
+ * - `task->pwait_queue` still points to the rwlock which task was waiting
+ *   for.
+ */
+void _tn_rwlock_on_task_wait_complete(struct TN_Task *task);
+
+/**
+ * Elevate priorities of all the holders of the rwlock to the given value
+ * (see `_tn_mutex_task_priority_elevate()`).
+ *
+ * @param wait_queue
+ *    Wait queue of the rwlock
+ * @param priority
+ *    Priority to elevate holders to
+ */
+void _tn_rwlock_holders_priority_elevate(
+      struct TN_ListItem  *wait_queue,
+      int                  priority
+      );
+
+#else
+
+/*
+ * Rwlocks are excluded from project: define some stub functions that 
+ * are just compiled out.
+ */
+
+_TN_STATIC_INLINE void _tn_rwlock_unlock_all_by_task(struct TN_Task *task) {
+   (void) task;
+}
+_TN_STATIC_INLINE void _tn_rwlock_on_task_wait_complete(struct TN_Task *task) {
+   (void) task;
+}
+#endif
+
+
+
+/*******************************************************************************
+ *    PROTECTED INLINE FUNCTIONS
+ ******************************************************************************/
+
+/**
+ * Checks whether given rwlock object is valid 
+ * (actually, just checks against `id_rwlock` field, see `enum #TN_ObjId`)
+ */
+_TN_STATIC_INLINE TN_BOOL _tn_rwlock_is_valid(
+      const struct TN_RWLock  *rwlock
+      )
+{
+   return (rwlock->id_rwlock == TN_ID_RWLOCK);
+}
+
+
+
+
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+
+
+#endif // __TN_RWLOCK_H
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
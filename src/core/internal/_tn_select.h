@@ -0,0 +1,150 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef __TN_SELECT_H
+#define __TN_SELECT_H
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "_tn_sys.h"
+#include "tn_select.h"
+
+
+
+
+#ifdef __cplusplus
+extern "C"  {     /*}*/
+#endif
+
+/*******************************************************************************
+ *    PUBLIC TYPES
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    PROTECTED GLOBAL DATA
+ ******************************************************************************/
+
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+
+/*******************************************************************************
+ *    PROTECTED FUNCTION PROTOTYPES
+ ******************************************************************************/
+
+#if TN_USE_SELECT
+/**
+ * Wake up the task waiting in `tn_select()` for the given item, with the
+ * given return code. All the other items of the task are removed from the
+ * select queues of their objects.
+ *
+ * \attention Caller must disable interrupts.
+ */
+void _tn_select_item_complete(struct TN_SelectItem *item, enum TN_RCode rc);
+
+/**
+ * If there is some task waiting in `tn_select()` for the object, hand the
+ * resource to the first one: store `data` in its item and wake the task up.
+ *
+ * \attention Caller must disable interrupts.
+ *
+ * @param select_queue
+ *    `select_queue` list of the object
+ * @param data
+ *    Data to store in `#TN_SelectItem::data`: item of the data queue, block
+ *    of the memory pool, or `TN_NULL`.
+ *
+ * @return
+ *    - `TN_TRUE` if some task has taken the resource;
+ *    - `TN_FALSE` if there are no tasks waiting in `tn_select()`.
+ */
+TN_BOOL _tn_select_first_complete(
+      struct TN_ListItem  *select_queue,
+      void                *data
+      );
+
+/**
+ * Wake up all the tasks waiting in `tn_select()` for the object, with the
+ * `#TN_RC_DELETED` code.
+ *
+ * \attention Caller must disable interrupts.
+ */
+void _tn_select_notify_deleted(struct TN_ListItem *select_queue);
+
+/**
+ * Should be called when task finishes waiting in `tn_select()` (no matter
+ * why: some object is signaled, timeout, etc): removes all the items of the
+ * task from the select queues of their objects.
+ */
+void _tn_select_on_task_wait_complete(struct TN_Task *task);
+
+#else
+
+/*
+ * Select is excluded from project: define some stub functions that 
+ * are just compiled out. These are macros since objects don't even have
+ * `select_queue` field.
+ */
+
+#  define   _tn_select_first_complete(select_queue, data)   (TN_FALSE)
+#  define   _tn_select_notify_deleted(select_queue)
+
+_TN_STATIC_INLINE void _tn_select_on_task_wait_complete(struct TN_Task *task) {
+   (void) task;
+}
+#endif
+
+
+
+
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+
+
+#endif // __TN_SELECT_H
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
@@ -71,6 +71,32 @@ extern "C"  {     /*}*/
  ******************************************************************************/
 
 
+/*******************************************************************************
+ *    PROTECTED FUNCTION PROTOTYPES
+ ******************************************************************************/
+
+/**
+ * Should be called when task finishes waiting for the semaphore (no matter
+ * why: units are given to the task, timeout, etc).
+ *
+ * Preconditions: 
+ *
+ * - `task->task_queue` is removed from the semaphore's wait queue;
+ * - `task->pwait_queue` still points to the semaphore which task was waiting
+ *   for.
+ */
+void _tn_sem_on_task_wait_complete(struct TN_Task *task);
+
+#if TN_USE_SELECT
+/**
+ * Try to acquire the semaphore without waiting, on behalf of `tn_select()`:
+ * returns `#TN_RC_OK` or `#TN_RC_TIMEOUT`.
+ *
+ * \attention Caller must disable interrupts.
+ */
+enum TN_RCode _tn_sem_select_try(struct TN_Sem *sem);
+#endif
+
 /*******************************************************************************
  *    PROTECTED INLINE FUNCTIONS
  ******************************************************************************/
@@ -67,6 +67,13 @@ extern struct TN_ListItem _tn_tasks_ready_list[TN_PRIORITIES_CNT];
 /// list all created tasks (now it is used for statictic only)
 extern struct TN_ListItem _tn_tasks_created_list;
 
+#if TN_USE_PREEMPT_THRESHOLD
+/// list of runnable tasks which were switched out while their preemption
+/// threshold was in effect, the most recently preempted one first. See
+/// `_tn_task_preempt_threshold_on_context_switch()`.
+extern struct TN_ListItem _tn_tasks_preempted_list;
+#endif
+
 /// count of created tasks
 extern volatile int _tn_tasks_created_cnt;           
 
@@ -151,6 +158,52 @@ enum TN_StateFlag _tn_sys_state_flags_set(enum TN_StateFlag flags);
  */
 enum TN_StateFlag _tn_sys_state_flags_clear(enum TN_StateFlag flags);
 
+/**
+ * Returns timestamp for kernel instrumentation features: either a value
+ * returned by the user-provided callback (see `#tn_callback_timestamp_set()`),
+ * or the system tick count.
+ */
+TN_UWord _tn_sys_timestamp_get(void);
+
+/**
+ * Returns whether timestamps returned by `_tn_sys_timestamp_get()` come from
+ * the user-provided callback (typically, a hardware cycle counter), as
+ * opposed to the coarse system tick count.
+ */
+TN_BOOL _tn_sys_timestamp_is_precise(void);
+
+#if TN_PROFILER
+#if TN_PROFILER_ISR_CNT
+/**
+ * Current time for the profiler. ISRs usually take way less than a system
+ * tick, so, if they are accounted (see `#TN_PROFILER_ISR_CNT`), the profiler
+ * uses timestamps (see `_tn_sys_timestamp_get()`) for both tasks and ISRs,
+ * so that their times are comparable. Otherwise, system ticks are used.
+ */
+#  define _TN_PROFILER_TIME_GET()                                             \
+   ((TN_TickCnt)_tn_sys_timestamp_get())
+
+/**
+ * Time elapsed between two values returned by `_TN_PROFILER_TIME_GET()`:
+ * timestamps wrap around at the width of `#TN_UWord`.
+ */
+#  define _TN_PROFILER_TIME_DIFF(end, start)                                  \
+   ((TN_TickCnt)(TN_UWord)((end) - (start)))
+#else
+#  define _TN_PROFILER_TIME_GET()              _tn_timer_sys_time_get()
+#  define _TN_PROFILER_TIME_DIFF(end, start)   ((TN_TickCnt)((end) - (start)))
+#endif
+#endif
+
+/**
+ * Should be called when stack overflow of the task is detected, by any of
+ * the detection strategies (see `#TN_STACK_OVERFLOW_CHECK`,
+ * `#TN_STACK_OVERFLOW_CANARY_CNT`, `#TN_STACK_OVERFLOW_MPU_GUARD`): calls
+ * user-provided callback (see `#tn_callback_stack_overflow_set()`), or, if
+ * it isn't set, `#_TN_FATAL_ERROR()`.
+ */
+void _tn_sys_stack_overflow_notify(struct TN_Task *task);
+
 #if TN_MUTEX_DEADLOCK_DETECT
 /**
  * This function is called when deadlock becomes active or inactive 
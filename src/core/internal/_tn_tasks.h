@@ -74,6 +74,15 @@ extern "C"  {     /*}*/
 #define _tn_get_task_by_tsk_queue(que)                                   \
    (que ? container_of(que, struct TN_Task, task_queue) : 0)
 
+#if TN_USE_PREEMPT_THRESHOLD
+/**
+ * Value of `preempt_threshold` of the task which has no threshold set: the
+ * lowest priority (the one of the idle task), so that the threshold never
+ * takes effect, whatever priority the task is given.
+ */
+#define _TN_PREEMPT_THRESHOLD_NONE     (TN_PRIORITIES_CNT - 1)
+#endif
+
 
 
 
@@ -156,6 +165,37 @@ void _tn_task_set_waiting(
  */
 void _tn_task_clear_waiting(struct TN_Task *task, enum TN_RCode wait_rc);
 
+/**
+ * Move the task which is in the $(TN_TASK_STATE_WAIT) state to another wait
+ * queue, without making it runnable: as far as the kernel is concerned, task
+ * finishes waiting for one object and immediately starts waiting for
+ * another one. The timeout of the previous wait (if any) is cancelled.
+ *
+ * It allows to avoid two needless context switches when the object being
+ * waited for is handed over to some other object on behalf of the task
+ * (e.g. when condition variable is signaled, its waiter starts waiting for
+ * the mutex).
+ *
+ * @param task
+ *    Task which is waiting for something
+ *
+ * @param wait_que
+ *    New wait queue to put task in, must not be `#TN_NULL`.
+ *
+ * @param wait_reason
+ *    New reason of waiting, see `enum #TN_WaitReason`.
+ *
+ * @param timeout
+ *    If neither `0` nor `#TN_WAIT_INFINITE`, task will be woken up by timer
+ *    after specified number of system ticks.
+ */
+void _tn_task_wait_move(
+      struct TN_Task      *task,
+      struct TN_ListItem  *wait_que,
+      enum TN_WaitReason   wait_reason,
+      TN_TickCnt           timeout
+      );
+
 /**
  * Returns whether given task is in $(TN_TASK_STATE_WAIT) state. 
  * Note that this state could be combined with $(TN_TASK_STATE_SUSPEND) state.
@@ -394,6 +434,97 @@ TN_UWord *_tn_task_stack_end_get(
       struct TN_Task *task
       );
 
+#if TN_STACK_USAGE_IDLE_SCAN
+/**
+ * Performs one step of the incremental stack scanning: checks at most
+ * `#TN_STACK_USAGE_SCAN_CHUNK` stack words of some task, and updates
+ * `task->stack_free_cached` when the scanning of the task is done. Then, the
+ * next created task is scanned, and so on.
+ *
+ * Should be called from the idle task.
+ */
+void _tn_task_stack_scan_step(void);
+#else
+
+/*
+ * Stub empty function, it is needed when `#TN_STACK_USAGE_IDLE_SCAN` is
+ * zero.
+ */
+_TN_STATIC_INLINE void _tn_task_stack_scan_step(void)
+{
+   //-- nothing to do
+}
+#endif
+
+#if TN_STACK_OVERFLOW_CANARY_CNT
+/**
+ * Checks that `#TN_STACK_OVERFLOW_CANARY_CNT` words at the end of the stack
+ * of some task are untouched, and if not, calls
+ * `_tn_sys_stack_overflow_notify()`. Each call checks the next created task.
+ *
+ * Should be called from the idle task.
+ */
+void _tn_task_stack_canary_check_step(void);
+#else
+
+/*
+ * Stub empty function, it is needed when `#TN_STACK_OVERFLOW_CANARY_CNT` is
+ * zero.
+ */
+_TN_STATIC_INLINE void _tn_task_stack_canary_check_step(void)
+{
+   //-- nothing to do
+}
+#endif
+
+#if TN_STACK_USAGE_IDLE_SCAN || TN_STACK_OVERFLOW_CANARY_CNT
+/**
+ * Should be called when the task is deleted, so that stack checks performed
+ * by the idle task (see `_tn_task_stack_scan_step()` and
+ * `_tn_task_stack_canary_check_step()`) don't stumble on it. Interrupts
+ * should be disabled.
+ */
+void _tn_task_stack_scan_on_delete(struct TN_Task *task);
+#else
+
+/*
+ * Stub empty function, it is needed when there are no stack checks
+ * performed by the idle task.
+ */
+_TN_STATIC_INLINE void _tn_task_stack_scan_on_delete(struct TN_Task *task)
+{
+   _TN_UNUSED(task);
+}
+#endif
+
+#if TN_USE_PREEMPT_THRESHOLD
+/**
+ * Should be called at every context switch, with interrupts disabled:
+ * `task_new` isn't preempted anymore, and if `task_prev` is switched out
+ * while it is still runnable and its preemption threshold is in effect, it
+ * is added to `#_tn_tasks_preempted_list`, so that it gets the processor
+ * back before any task whose priority isn't higher than its threshold.
+ */
+void _tn_task_preempt_threshold_on_context_switch(
+      struct TN_Task *task_prev,
+      struct TN_Task *task_new
+      );
+#else
+
+/*
+ * Stub empty function, it is needed when `#TN_USE_PREEMPT_THRESHOLD` is
+ * zero.
+ */
+_TN_STATIC_INLINE void _tn_task_preempt_threshold_on_context_switch(
+      struct TN_Task *task_prev,
+      struct TN_Task *task_new
+      )
+{
+   _TN_UNUSED(task_prev);
+   _TN_UNUSED(task_new);
+}
+#endif
+
 /*******************************************************************************
  *    PROTECTED INLINE FUNCTIONS
  ******************************************************************************/
@@ -0,0 +1,131 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef __TN_TRACE_H
+#define __TN_TRACE_H
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "_tn_sys.h"
+#include "tn_trace.h"
+
+
+
+
+#ifdef __cplusplus
+extern "C"  {     /*}*/
+#endif
+
+/*******************************************************************************
+ *    PUBLIC TYPES
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    PROTECTED GLOBAL DATA
+ ******************************************************************************/
+
+#if TN_TRACE
+/// Trace ring buffer, see `struct #TN_TraceBuf`
+extern struct TN_TraceBuf _tn_trace_buf;
+#endif
+
+
+
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+/**
+ * Trace hook: should be used by the kernel code to write a record to the trace
+ * buffer. If `#TN_TRACE` is zero, it expands to nothing, so arguments aren't
+ * evaluated at all.
+ *
+ * @param event
+ *    Event, see `enum #TN_TraceEvent`
+ * @param small_arg
+ *    "Small" argument, only 8 lower bits are stored
+ * @param obj
+ *    Pointer to the object the event relates to
+ * @param arg
+ *    Argument, it is cast to `#TN_UWord`
+ */
+#if TN_TRACE
+#  define _TN_TRACE(event, small_arg, obj, arg)                      \
+   _tn_trace_rec(                                                    \
+         (event), (int)(small_arg), (obj), (TN_UWord)(TN_UIntPtr)(arg) \
+         )
+#else
+#  define _TN_TRACE(event, small_arg, obj, arg)   /* nothing */
+#endif
+
+
+
+
+/*******************************************************************************
+ *    PROTECTED FUNCTION PROTOTYPES
+ ******************************************************************************/
+
+#if TN_TRACE
+/**
+ * Write a record to the trace buffer; should not be called directly, use
+ * `#_TN_TRACE()` instead. Can be called with interrupts either enabled or
+ * disabled.
+ */
+void _tn_trace_rec(
+      enum TN_TraceEvent   event,
+      int                  small_arg,
+      const void          *obj,
+      TN_UWord             arg
+      );
+#endif
+
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+
+
+#endif // __TN_TRACE_H
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
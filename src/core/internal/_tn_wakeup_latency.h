@@ -0,0 +1,140 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef __TN_WAKEUP_LATENCY_H
+#define __TN_WAKEUP_LATENCY_H
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "_tn_sys.h"
+#include "tn_wakeup_latency.h"
+
+
+
+
+#ifdef __cplusplus
+extern "C"  {     /*}*/
+#endif
+
+/*******************************************************************************
+ *    PROTECTED FUNCTION PROTOTYPES
+ ******************************************************************************/
+
+#if TN_WAKEUP_LATENCY
+
+/**
+ * Reset the histogram; should be called when the object which contains
+ * histogram is created.
+ */
+void _tn_wakeup_latency_reset(struct TN_WakeupLatency *hist);
+
+/**
+ * Should be called when the task becomes runnable: remembers the timestamp.
+ */
+void _tn_wakeup_latency_on_runnable(struct TN_Task *task);
+
+/**
+ * Should be called when task finishes waiting, before `task->pwait_queue`
+ * is reset: remembers the object that has woken the task up, so that
+ * latency can be accounted in the object's histogram as well.
+ *
+ * @param task
+ *    Task that finishes waiting
+ * @param wait_rc
+ *    Wait result; if it is `#TN_RC_DELETED`, the object isn't remembered,
+ *    since it is being deleted.
+ */
+void _tn_wakeup_latency_on_wait_end(
+      struct TN_Task   *task,
+      enum TN_RCode     wait_rc
+      );
+
+/**
+ * Should be called at every context switch: if `task_new` became runnable
+ * and wasn't switched in since then, latency is accounted.
+ */
+void _tn_wakeup_latency_on_context_switch(
+      struct TN_Task *task_prev,
+      struct TN_Task *task_new
+      );
+
+#else
+
+/*
+ * Stub empty functions, they are needed when `#TN_WAKEUP_LATENCY` is zero.
+ */
+
+_TN_STATIC_INLINE void _tn_wakeup_latency_on_runnable(struct TN_Task *task)
+{
+   _TN_UNUSED(task);
+}
+
+_TN_STATIC_INLINE void _tn_wakeup_latency_on_wait_end(
+      struct TN_Task   *task,
+      enum TN_RCode     wait_rc
+      )
+{
+   _TN_UNUSED(task);
+   _TN_UNUSED(wait_rc);
+}
+
+_TN_STATIC_INLINE void _tn_wakeup_latency_on_context_switch(
+      struct TN_Task *task_prev,
+      struct TN_Task *task_new
+      )
+{
+   _TN_UNUSED(task_prev);
+   _TN_UNUSED(task_new);
+}
+
+#endif   // TN_WAKEUP_LATENCY
+
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+
+
+#endif // __TN_WAKEUP_LATENCY_H
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
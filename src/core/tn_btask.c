@@ -0,0 +1,405 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+//-- common tnkernel headers
+#include "tn_common.h"
+#include "tn_sys.h"
+
+//-- internal tnkernel headers
+#include "_tn_tasks.h"
+#include "_tn_list.h"
+
+
+//-- header of current module
+#include "_tn_btask.h"
+
+//-- header of other needed modules
+#include "tn_tasks.h"
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+//-- Additional param checking {{{
+#if TN_CHECK_PARAM
+_TN_STATIC_INLINE enum TN_RCode _check_param_grp_generic(
+      const struct TN_BTaskGrp *grp
+      )
+{
+   enum TN_RCode rc = TN_RC_OK;
+
+   if (grp == TN_NULL){
+      rc = TN_RC_WPARAM;
+   } else if (!_tn_btask_grp_is_valid(grp)){
+      rc = TN_RC_INVALID_OBJ;
+   }
+
+   return rc;
+}
+
+_TN_STATIC_INLINE enum TN_RCode _check_param_generic(
+      const struct TN_BTask *btask
+      )
+{
+   enum TN_RCode rc = TN_RC_OK;
+
+   if (btask == TN_NULL){
+      rc = TN_RC_WPARAM;
+   } else if (0
+         || !_tn_btask_is_valid(btask)
+         || !_tn_btask_grp_is_valid(btask->grp)
+         )
+   {
+      rc = TN_RC_INVALID_OBJ;
+   }
+
+   return rc;
+}
+
+/**
+ * Additional param checking when creating basic task
+ */
+_TN_STATIC_INLINE enum TN_RCode _check_param_create(
+      const struct TN_BTask      *btask,
+      const struct TN_BTaskGrp   *grp,
+      TN_BTaskBody               *func
+      )
+{
+   enum TN_RCode rc = TN_RC_OK;
+
+   if (btask == TN_NULL || grp == TN_NULL || func == TN_NULL){
+      rc = TN_RC_WPARAM;
+   } else if (0
+         || _tn_btask_is_valid(btask)
+         || !_tn_btask_grp_is_valid(grp)
+         )
+   {
+      rc = TN_RC_WPARAM;
+   }
+
+   return rc;
+}
+
+#else
+#  define _check_param_grp_generic(grp)                  (TN_RC_OK)
+#  define _check_param_generic(btask)                    (TN_RC_OK)
+#  define _check_param_create(btask, grp, func)          (TN_RC_OK)
+#endif
+// }}}
+
+/**
+ * Returns whether the basic task is activated and waits for its turn to run
+ */
+_TN_STATIC_INLINE TN_BOOL _btask_is_ready(struct TN_BTask *btask)
+{
+   return !_tn_list_is_empty(&btask->ready_queue);
+}
+
+/**
+ * Body of the group's task: runs activated basic tasks one by one, and
+ * sleeps when there are none.
+ */
+static void _grp_task_body(void *param)
+{
+   struct TN_BTaskGrp *grp = (struct TN_BTaskGrp *)param;
+   struct TN_BTask *btask;
+   TN_INTSAVE_DATA;
+
+   for (;;){
+      TN_INT_DIS_SAVE();
+
+      if (_tn_list_is_empty(&grp->ready_list)){
+         //-- nothing to do: wait until some basic task is activated.
+         //   Note that the list is checked and the task is put to wait in
+         //   the same critical section, so activations can't be missed.
+         btask = TN_NULL;
+         _tn_task_curr_to_wait_action(
+               &grp->wait_queue, TN_WAIT_REASON_SLEEP, TN_WAIT_INFINITE
+               );
+      } else {
+         //-- take the first activated basic task
+         btask = _tn_list_first_entry(
+               &grp->ready_list, struct TN_BTask, ready_queue
+               );
+         _tn_list_remove_entry(&btask->ready_queue);
+         _tn_list_reset(&btask->ready_queue);
+         grp->cur = btask;
+      }
+
+      TN_INT_RESTORE();
+      _tn_context_switch_pend_if_needed();
+
+      if (btask != TN_NULL){
+         //-- run the basic task to completion
+         btask->func(btask->param);
+
+         TN_INT_DIS_SAVE();
+         grp->cur = TN_NULL;
+         TN_INT_RESTORE();
+      }
+   }
+}
+
+/**
+ * Generic function that performs job from task context
+ *
+ * @param btask      basic task to perform job on
+ * @param p_worker   pointer to actual worker function
+ */
+_TN_STATIC_INLINE enum TN_RCode _btask_job_perform(
+      struct TN_BTask *btask,
+      enum TN_RCode (p_worker)(struct TN_BTask *btask)
+      )
+{
+   enum TN_RCode rc = _check_param_generic(btask);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (!tn_is_task_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      TN_INTSAVE_DATA;
+
+      TN_INT_DIS_SAVE();      //-- disable interrupts
+      rc = p_worker(btask);   //-- call actual worker function
+      TN_INT_RESTORE();       //-- restore previous interrupts state
+
+      _tn_context_switch_pend_if_needed();
+   }
+   return rc;
+}
+
+/**
+ * Generic function that performs job from interrupt context
+ *
+ * @param btask      basic task to perform job on
+ * @param p_worker   pointer to actual worker function
+ */
+_TN_STATIC_INLINE enum TN_RCode _btask_job_iperform(
+      struct TN_BTask *btask,
+      enum TN_RCode (p_worker)(struct TN_BTask *btask)
+      )
+{
+   enum TN_RCode rc = _check_param_generic(btask);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (!tn_is_isr_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      TN_INTSAVE_DATA_INT;
+
+      TN_INT_IDIS_SAVE();     //-- disable interrupts
+      rc = p_worker(btask);   //-- call actual worker function
+      TN_INT_IRESTORE();      //-- restore previous interrupts state
+
+      _TN_CONTEXT_SWITCH_IPEND_IF_NEEDED();
+   }
+   return rc;
+}
+
+static enum TN_RCode _btask_activate(struct TN_BTask *btask)
+{
+   enum TN_RCode rc = TN_RC_OK;
+
+   if (_btask_is_ready(btask)){
+      //-- already activated, and hasn't run yet
+      rc = TN_RC_WSTATE;
+   } else {
+      struct TN_BTaskGrp *grp = btask->grp;
+
+      _tn_list_add_tail(&grp->ready_list, &btask->ready_queue);
+
+      //-- wake up the group's task, if it sleeps
+      _tn_task_first_wait_complete(
+            &grp->wait_queue, TN_RC_OK,
+            TN_NULL, TN_NULL, TN_NULL
+            );
+   }
+
+   return rc;
+}
+
+static enum TN_RCode _btask_delete(struct TN_BTask *btask)
+{
+   enum TN_RCode rc = TN_RC_OK;
+
+   if (_btask_is_ready(btask) || btask->grp->cur == btask){
+      rc = TN_RC_WSTATE;
+   } else {
+      btask->id_btask = TN_ID_NONE;
+   }
+
+   return rc;
+}
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC FUNCTIONS
+ ******************************************************************************/
+
+/*
+ * See comments in the header file (tn_btask.h)
+ */
+enum TN_RCode tn_btask_grp_create(
+      struct TN_BTaskGrp     *grp,
+      int                     priority,
+      TN_UWord               *stack_low_addr,
+      int                     stack_size
+      )
+{
+   enum TN_RCode rc = TN_RC_OK;
+
+   if (grp == TN_NULL || _tn_btask_grp_is_valid(grp)){
+      rc = TN_RC_WPARAM;
+   } else {
+      _tn_list_reset(&grp->ready_list);
+      _tn_list_reset(&grp->wait_queue);
+      grp->cur = TN_NULL;
+
+      //-- the group should be valid before its task starts running
+      grp->id_btask_grp = TN_ID_BTASK_GRP;
+
+      //-- params of the task are checked by tn_task_create()
+      rc = tn_task_create(
+            &grp->task, _grp_task_body, priority,
+            stack_low_addr, stack_size,
+            grp, TN_TASK_CREATE_OPT_START
+            );
+
+      if (rc != TN_RC_OK){
+         grp->id_btask_grp = TN_ID_NONE;
+      }
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_btask.h)
+ */
+enum TN_RCode tn_btask_grp_delete(struct TN_BTaskGrp *grp)
+{
+   enum TN_RCode rc = _check_param_grp_generic(grp);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (!tn_is_task_context() || tn_cur_task_get() == &grp->task){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      TN_INTSAVE_DATA;
+
+      TN_INT_DIS_SAVE();
+      if (!_tn_list_is_empty(&grp->ready_list) || grp->cur != TN_NULL){
+         rc = TN_RC_WSTATE;
+      } else {
+         //-- the group doesn't exist from now on, so basic tasks can't be
+         //   activated anymore
+         grp->id_btask_grp = TN_ID_NONE;
+      }
+      TN_INT_RESTORE();
+
+      if (rc == TN_RC_OK){
+         tn_task_terminate(&grp->task);
+         tn_task_delete(&grp->task);
+      }
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_btask.h)
+ */
+enum TN_RCode tn_btask_create(
+      struct TN_BTask        *btask,
+      struct TN_BTaskGrp     *grp,
+      TN_BTaskBody           *func,
+      void                   *param
+      )
+{
+   //-- perform additional params checking (if enabled by TN_CHECK_PARAM)
+   enum TN_RCode rc = _check_param_create(btask, grp, func);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else {
+      btask->grp     = grp;
+      btask->func    = func;
+      btask->param   = param;
+      _tn_list_reset(&btask->ready_queue);
+
+      btask->id_btask = TN_ID_BTASK;
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_btask.h)
+ */
+enum TN_RCode tn_btask_delete(struct TN_BTask *btask)
+{
+   return _btask_job_perform(btask, _btask_delete);
+}
+
+/*
+ * See comments in the header file (tn_btask.h)
+ */
+enum TN_RCode tn_btask_activate(struct TN_BTask *btask)
+{
+   return _btask_job_perform(btask, _btask_activate);
+}
+
+/*
+ * See comments in the header file (tn_btask.h)
+ */
+enum TN_RCode tn_btask_iactivate(struct TN_BTask *btask)
+{
+   return _btask_job_iperform(btask, _btask_activate);
+}
+
+
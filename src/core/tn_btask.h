@@ -0,0 +1,363 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/**
+ * \file
+ *
+ * Basic tasks: run-to-completion tasks sharing one stack, in the spirit of
+ * OSEK basic tasks.
+ *
+ * Each regular task (`struct #TN_Task`) needs a private stack sized for its
+ * worst case, and for many tasks, stack RAM is the biggest memory consumer.
+ * Quite often though, a lot of tasks are just short event handlers which
+ * never block mid-way: they are activated, do their job and finish.
+ *
+ * Such handlers can be made basic tasks (`struct #TN_BTask`). Basic tasks
+ * are grouped (`struct #TN_BTaskGrp`), typically one group per priority
+ * level, and each group has just one stack, shared by all of its basic
+ * tasks. The group is served by the regular kernel task (contained in the
+ * group), which is dispatched by the scheduler as any other task at the
+ * group's priority: it runs activated basic tasks one after another, in the
+ * order of activation, each one to completion; when there are no activated
+ * basic tasks, it sleeps.
+ *
+ * So, the basic task:
+ *
+ * - is activated by `tn_btask_activate()` / `tn_btask_iactivate()`; the
+ *   activation of the basic task which is currently running is queued (the
+ *   task will run once again after it finishes), the activation of the
+ *   basic task which is already activated but not yet running is rejected;
+ * - runs to completion: it finishes by returning from its body function.
+ *   It is preempted by higher-priority tasks (including basic tasks of the
+ *   higher-priority groups) as usual, but never by other basic tasks of the
+ *   same group;
+ * - should not block: it may call any kernel services, but while it waits
+ *   for something, other basic tasks of the same group can't run.
+ *
+ * RAM needed for the basic task is just `sizeof(struct #TN_BTask)` (6 words),
+ * plus the group's task and stack per group. For example, 30 short handlers
+ * with the worst-case stack of 64 words each, on Cortex-M3 with the default
+ * configuration (`sizeof(struct #TN_Task)` is about 128 bytes):
+ *
+ * | Configuration                          | RAM, bytes                   |
+ * |----------------------------------------|------------------------------|
+ * | 30 regular tasks                       | 30 * (128 + 256) = 11520     |
+ * | 30 basic tasks in 3 groups (3 levels)  | 30 * 24 + 3 * (152 + 256) = 1944 |
+ *
+ * That is, about 83% less. Activation of the basic task costs about the
+ * same as `tn_task_wakeup()`, and if the group's task is already running
+ * basic tasks, no context switch is needed at all to run the next one.
+ *
+ * Note that the single shared stack for different priority levels (which
+ * OSEK allows under priority ceiling rules) isn't supported: tasks of
+ * different priorities need different groups.
+ */
+
+#ifndef _TN_BTASK_H
+#define _TN_BTASK_H
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "tn_list.h"
+#include "tn_common.h"
+#include "tn_tasks.h"
+
+
+
+#ifdef __cplusplus
+extern "C"  {     /*}*/
+#endif
+
+/*******************************************************************************
+ *    PUBLIC TYPES
+ ******************************************************************************/
+
+/**
+ * Prototype for the basic task body function.
+ *
+ * @param param
+ *    The user-provided parameter given to `tn_btask_create()`.
+ */
+typedef void (TN_BTaskBody)(void *param);
+
+/**
+ * Group of basic tasks sharing one stack, see `tn_btask.h` for details.
+ */
+struct TN_BTaskGrp {
+   ///
+   /// id for object validity verification.
+   /// This field is in the beginning of the structure to make it easier
+   /// to detect memory corruption.
+   enum TN_ObjId id_btask_grp;
+   ///
+   /// The task which runs basic tasks of the group; its stack is the one
+   /// shared by basic tasks
+   struct TN_Task task;
+   ///
+   /// List of activated basic tasks which are waiting for their turn to run
+   struct TN_ListItem ready_list;
+   ///
+   /// Wait queue for the group's task (it waits there when there are no
+   /// activated basic tasks)
+   struct TN_ListItem wait_queue;
+   ///
+   /// Currently running basic task, or `#TN_NULL`
+   struct TN_BTask *cur;
+};
+
+/**
+ * Basic task, see `tn_btask.h` for details.
+ */
+struct TN_BTask {
+   ///
+   /// id for object validity verification.
+   /// This field is in the beginning of the structure to make it easier
+   /// to detect memory corruption.
+   enum TN_ObjId id_btask;
+   ///
+   /// Group which the basic task belongs to
+   struct TN_BTaskGrp *grp;
+   ///
+   /// Item of the `ready_list` of the group; it is non-empty if only the
+   /// basic task is activated and waits for its turn to run.
+   struct TN_ListItem ready_queue;
+   ///
+   /// Body function given to `tn_btask_create()`
+   TN_BTaskBody *func;
+   ///
+   /// Parameter given to `tn_btask_create()`
+   void *param;
+};
+
+
+/*******************************************************************************
+ *    PROTECTED GLOBAL DATA
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    PUBLIC FUNCTION PROTOTYPES
+ ******************************************************************************/
+
+/**
+ * Construct the group of basic tasks, and start the group's task.
+ * `id_btask_grp` field should not contain `#TN_ID_BTASK_GRP`, otherwise,
+ * `#TN_RC_WPARAM` is returned.
+ *
+ * Usage example:
+ *
+ * \code{.c}
+ *     #define HANDLERS_STACK_SIZE   (TN_MIN_STACK_SIZE + 64)
+ *     #define HANDLERS_PRIORITY     3
+ *
+ *     struct TN_BTaskGrp handlers_grp;
+ *     TN_STACK_ARR_DEF(handlers_stack, HANDLERS_STACK_SIZE);
+ *
+ *     struct TN_BTask rx_handler;
+ *
+ *     void rx_handler_body(void *param)
+ *     {
+ *        //-- handle received data, and just return
+ *     }
+ *
+ *     void init(void)
+ *     {
+ *        tn_btask_grp_create(
+ *              &handlers_grp, HANDLERS_PRIORITY,
+ *              handlers_stack, HANDLERS_STACK_SIZE
+ *              );
+ *
+ *        tn_btask_create(&rx_handler, &handlers_grp, rx_handler_body, NULL);
+ *     }
+ *
+ *     void rx_isr(void)
+ *     {
+ *        tn_btask_iactivate(&rx_handler);
+ *     }
+ * \endcode
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_MAIN)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param grp
+ *    Pointer to already allocated `struct #TN_BTaskGrp`
+ * @param priority
+ *    Priority of the group's task, see `tn_task_create()`
+ * @param stack_low_addr
+ *    Pointer to the stack shared by basic tasks of the group, see
+ *    `tn_task_create()`
+ * @param stack_size
+ *    Size of the stack array, in words (not in bytes); it should be enough
+ *    for the basic task of the group with the deepest stack usage.
+ *
+ * @return
+ *    * `#TN_RC_OK` on success;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * `#TN_RC_WPARAM` if wrong params were given.
+ */
+enum TN_RCode tn_btask_grp_create(
+      struct TN_BTaskGrp     *grp,
+      int                     priority,
+      TN_UWord               *stack_low_addr,
+      int                     stack_size
+      );
+
+/**
+ * Destruct the group of basic tasks: its task is terminated and deleted.
+ * All the basic tasks of the group should be deleted before.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param grp
+ *    Group to delete
+ *
+ * @return
+ *    * `#TN_RC_OK` on success;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context (including calling
+ *      from the basic task of the same group);
+ *    * `#TN_RC_WSTATE` if some basic task of the group is activated or is
+ *      running;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_btask_grp_delete(struct TN_BTaskGrp *grp);
+
+/**
+ * Construct the basic task. `id_btask` field should not contain
+ * `#TN_ID_BTASK`, otherwise, `#TN_RC_WPARAM` is returned.
+ *
+ * The basic task isn't activated after creation, call `tn_btask_activate()`
+ * for that.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_CALL_FROM_MAIN)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param btask
+ *    Pointer to already allocated `struct #TN_BTask`
+ * @param grp
+ *    Group to put the basic task in
+ * @param func
+ *    Body function of the basic task
+ * @param param
+ *    Parameter which is given to `func`
+ *
+ * @return
+ *    * `#TN_RC_OK` on success;
+ *    * `#TN_RC_WPARAM` if wrong params were given.
+ */
+enum TN_RCode tn_btask_create(
+      struct TN_BTask        *btask,
+      struct TN_BTaskGrp     *grp,
+      TN_BTaskBody           *func,
+      void                   *param
+      );
+
+/**
+ * Destruct the basic task.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param btask
+ *    Basic task to delete
+ *
+ * @return
+ *    * `#TN_RC_OK` on success;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * `#TN_RC_WSTATE` if the basic task is activated or is running;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_btask_delete(struct TN_BTask *btask);
+
+/**
+ * Activate the basic task: it is put to the end of the list of activated
+ * basic tasks of its group, and it will run when its turn comes (and when
+ * the group's task is the highest-priority runnable task).
+ *
+ * If the basic task is currently running, the activation is queued, so the
+ * basic task will run once again after it finishes.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param btask
+ *    Basic task to activate
+ *
+ * @return
+ *    * `#TN_RC_OK` on success;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * `#TN_RC_WSTATE` if the basic task is already activated and waits for
+ *      its turn to run;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_btask_activate(struct TN_BTask *btask);
+
+/**
+ * The same as `tn_btask_activate()` but for using in the ISR.
+ *
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ */
+enum TN_RCode tn_btask_iactivate(struct TN_BTask *btask);
+
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+
+
+#endif // _TN_BTASK_H
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
@@ -117,6 +117,22 @@
 #  endif
 #endif
 
+#if !defined(TN_USE_RWLOCKS)
+#  error TN_USE_RWLOCKS is not defined
+#endif
+
+#if !defined(TN_USE_SELECT)
+#  error TN_USE_SELECT is not defined
+#endif
+
+#if !defined(TN_USE_RPC)
+#  error TN_USE_RPC is not defined
+#endif
+
+#if !defined(TN_USE_PREEMPT_THRESHOLD)
+#  error TN_USE_PREEMPT_THRESHOLD is not defined
+#endif
+
 #if !defined(TN_TICK_LISTS_CNT)
 #  error TN_TICK_LISTS_CNT is not defined
 #endif
@@ -133,6 +149,70 @@
 #  error TN_PROFILER_WAIT_TIME is not defined
 #endif
 
+#if !defined(TN_PROFILER_ISR_CNT)
+#  error TN_PROFILER_ISR_CNT is not defined
+#endif
+
+#if !defined(TN_TRACE)
+#  error TN_TRACE is not defined
+#endif
+
+#if !defined(TN_TRACE_RECS_CNT)
+#  error TN_TRACE_RECS_CNT is not defined
+#endif
+
+#if !defined(TN_WAKEUP_LATENCY)
+#  error TN_WAKEUP_LATENCY is not defined
+#endif
+
+#if !defined(TN_WAKEUP_LATENCY_BINS_CNT)
+#  error TN_WAKEUP_LATENCY_BINS_CNT is not defined
+#endif
+
+#if !defined(TN_CSECT_MEASURE)
+#  error TN_CSECT_MEASURE is not defined
+#endif
+
+#if !defined(TN_CSECT_MEASURE_TOP_CNT)
+#  error TN_CSECT_MEASURE_TOP_CNT is not defined
+#endif
+
+#if !defined(TN_CPU_LOAD)
+#  error TN_CPU_LOAD is not defined
+#endif
+
+#if !defined(TN_CPU_LOAD_PERIOD_TICKS)
+#  error TN_CPU_LOAD_PERIOD_TICKS is not defined
+#endif
+
+#if !defined(TN_CPU_LOAD_PERIODS_CNT)
+#  error TN_CPU_LOAD_PERIODS_CNT is not defined
+#endif
+
+#if !defined(TN_PC_SAMPLE)
+#  error TN_PC_SAMPLE is not defined
+#endif
+
+#if !defined(TN_PC_SAMPLE_RECS_CNT)
+#  error TN_PC_SAMPLE_RECS_CNT is not defined
+#endif
+
+#if !defined(TN_PC_SAMPLE_ON_TICK)
+#  error TN_PC_SAMPLE_ON_TICK is not defined
+#endif
+
+#if !defined(TN_OBJ_STATS)
+#  error TN_OBJ_STATS is not defined
+#endif
+
+#if !defined(TN_OBJ_REGISTRY)
+#  error TN_OBJ_REGISTRY is not defined
+#endif
+
+#if !defined(TN_COMPACT_TCB)
+#  error TN_COMPACT_TCB is not defined
+#endif
+
 #if !defined(TN_INIT_INTERRUPT_STACK_SPACE)
 #  error TN_INIT_INTERRUPT_STACK_SPACE is not defined
 #endif
@@ -141,6 +221,22 @@
 #  error TN_STACK_OVERFLOW_CHECK is not defined
 #endif
 
+#if !defined(TN_STACK_OVERFLOW_CANARY_CNT)
+#  error TN_STACK_OVERFLOW_CANARY_CNT is not defined
+#endif
+
+#if !defined(TN_STACK_OVERFLOW_MPU_GUARD)
+#  error TN_STACK_OVERFLOW_MPU_GUARD is not defined
+#endif
+
+#if !defined(TN_STACK_USAGE_IDLE_SCAN)
+#  error TN_STACK_USAGE_IDLE_SCAN is not defined
+#endif
+
+#if !defined(TN_STACK_USAGE_SCAN_CHUNK)
+#  error TN_STACK_USAGE_SCAN_CHUNK is not defined
+#endif
+
 #if defined (__TN_ARCH_PIC24_DSPIC__)
 #  if !defined(TN_P24_SYS_IPL)
 #     error TN_P24_SYS_IPL is not defined
@@ -178,7 +274,53 @@
 #  endif
 #endif
 
+//-- check TN_PROFILER_ISR_CNT: should be 0 .. 255, and makes sense only
+//   if TN_PROFILER is set
+#if TN_PROFILER_ISR_CNT < 0 || TN_PROFILER_ISR_CNT > 255
+#  error TN_PROFILER_ISR_CNT must be in the range [0, 255]
+#endif
+#if TN_PROFILER_ISR_CNT && !TN_PROFILER
+#  error TN_PROFILER_ISR_CNT requires TN_PROFILER to be set
+#endif
+
+//-- check TN_STACK_OVERFLOW_CANARY_CNT: should be 0 .. 255
+#if TN_STACK_OVERFLOW_CANARY_CNT < 0 || TN_STACK_OVERFLOW_CANARY_CNT > 255
+#  error TN_STACK_OVERFLOW_CANARY_CNT must be in the range [0, 255]
+#endif
+
+//-- check TN_STACK_OVERFLOW_MPU_GUARD: only ARMv7-M MPU is supported
+#if TN_STACK_OVERFLOW_MPU_GUARD && !defined(__TN_ARCHFEAT_CORTEX_M_ARMv7M_ISA__)
+#  error TN_STACK_OVERFLOW_MPU_GUARD is supported on Cortex-M3/M4/M4F only
+#endif
+
+//-- check TN_PC_SAMPLE_ON_TICK: the kernel is able to get PC of the
+//   interrupted code on Cortex-M only
+#if TN_PC_SAMPLE && TN_PC_SAMPLE_ON_TICK && !defined(__TN_ARCH_CORTEX_M__)
+#  error TN_PC_SAMPLE_ON_TICK is supported on Cortex-M only
+#endif
+
+//-- check TN_USE_RWLOCKS: rwlocks are built on top of the mutexes machinery
+#if TN_USE_RWLOCKS && !TN_USE_MUTEXES
+#  error TN_USE_RWLOCKS requires TN_USE_MUTEXES to be set
+#endif
+
+//-- check TN_USE_RPC: priority inheritance is done by the mutexes machinery
+#if TN_USE_RPC && !TN_USE_MUTEXES
+#  error TN_USE_RPC requires TN_USE_MUTEXES to be set
+#endif
+
+//-- check TN_STACK_USAGE_SCAN_CHUNK: should be at least 1
+#if TN_STACK_USAGE_SCAN_CHUNK < 1
+#  error TN_STACK_USAGE_SCAN_CHUNK must be at least 1
+#endif
+
 //-- NOTE: TN_TICK_LISTS_CNT is checked in tn_timer_static.c
+//-- NOTE: TN_TRACE_RECS_CNT is checked in tn_trace.c
+//-- NOTE: TN_WAKEUP_LATENCY_BINS_CNT is checked in tn_wakeup_latency.c
+//-- NOTE: TN_CSECT_MEASURE_TOP_CNT is checked in tn_csect.c
+//-- NOTE: TN_CPU_LOAD_PERIOD_TICKS and TN_CPU_LOAD_PERIODS_CNT are checked in
+//         tn_cpu_load.c
+//-- NOTE: TN_PC_SAMPLE_RECS_CNT is checked in tn_pc_sample.c
 //-- NOTE: TN_PRIORITIES_CNT is checked in tn_sys.c
 //-- NOTE: TN_API_MAKE_ALIG_ARG is checked in tn_common.h
 
@@ -187,7 +329,8 @@
  * Internal kernel definition: set to non-zero if `_tn_sys_on_context_switch()`
  * should be called on context switch. 
  */
-#if TN_PROFILER || TN_STACK_OVERFLOW_CHECK
+#if TN_PROFILER || TN_STACK_OVERFLOW_CHECK || TN_TRACE || TN_WAKEUP_LATENCY \
+   || TN_CPU_LOAD || TN_USE_PREEMPT_THRESHOLD
 #  define   _TN_ON_CONTEXT_SWITCH_HANDLER  1
 #else
 #  define   _TN_ON_CONTEXT_SWITCH_HANDLER  0
@@ -195,9 +338,14 @@
 
 /**
  * If `#TN_STACK_OVERFLOW_CHECK` is set, we have 1-word overhead for each
- * task stack.
+ * task stack; plus, `#TN_STACK_OVERFLOW_CANARY_CNT` words for canary.
+ * (overhead of `#TN_STACK_OVERFLOW_MPU_GUARD` is arch-dependent, so it is
+ * added in the arch header)
  */
-#define _TN_STACK_OVERFLOW_SIZE_ADD    (TN_STACK_OVERFLOW_CHECK ? 1 : 0)
+#define _TN_STACK_OVERFLOW_SIZE_ADD    (                                    \
+      (TN_STACK_OVERFLOW_CHECK ? 1 : 0)                                     \
+      + TN_STACK_OVERFLOW_CANARY_CNT                                        \
+      )
 
 #endif // _TN_CFG_DISPATCH_H
 
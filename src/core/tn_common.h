@@ -73,6 +73,11 @@ enum TN_ObjId {
    TN_ID_TIMER          = (int)0x1A937FBC,  //!< id for timers
    TN_ID_EXCHANGE       = (int)0x32b7c072,  //!< id for exchange objects
    TN_ID_EXCHANGE_LINK  = (int)0x24d36f35,  //!< id for exchange link
+   TN_ID_BTASK          = (int)0x3C5E91A7,  //!< id for basic tasks
+   TN_ID_BTASK_GRP      = (int)0x69D0B34E,  //!< id for groups of basic tasks
+   TN_ID_CONDVAR        = (int)0x4B1D3E27,  //!< id for condition variables
+   TN_ID_RWLOCK         = (int)0x7E0A5C93,  //!< id for reader-writer locks
+   TN_ID_RPC            = (int)0x1C7B49E6,  //!< id for RPC objects
 };
 
 /**
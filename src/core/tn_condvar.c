@@ -0,0 +1,416 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+//-- common tnkernel headers
+#include "tn_common.h"
+#include "tn_sys.h"
+
+//-- internal tnkernel headers
+#include "_tn_tasks.h"
+#include "_tn_list.h"
+#include "_tn_mutex.h"
+#include "_tn_wakeup_latency.h"
+#include "_tn_obj_stats.h"
+#include "_tn_obj_registry.h"
+
+
+//-- header of current module
+#include "_tn_condvar.h"
+
+//-- header of other needed modules
+#include "tn_tasks.h"
+
+
+#if TN_USE_MUTEXES
+
+
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+//-- Additional param checking {{{
+#if TN_CHECK_PARAM
+_TN_STATIC_INLINE enum TN_RCode _check_param_generic(
+      const struct TN_CondVar *condvar
+      )
+{
+   enum TN_RCode rc = TN_RC_OK;
+
+   if (condvar == TN_NULL){
+      rc = TN_RC_WPARAM;
+   } else if (!_tn_condvar_is_valid(condvar)){
+      rc = TN_RC_INVALID_OBJ;
+   }
+
+   return rc;
+}
+
+/**
+ * Additional param checking when creating condition variable
+ */
+_TN_STATIC_INLINE enum TN_RCode _check_param_create(
+      const struct TN_CondVar *condvar
+      )
+{
+   enum TN_RCode rc = TN_RC_OK;
+
+   if (condvar == TN_NULL || _tn_condvar_is_valid(condvar)){
+      rc = TN_RC_WPARAM;
+   }
+
+   return rc;
+}
+
+/**
+ * Additional param checking when waiting for condition variable
+ */
+_TN_STATIC_INLINE enum TN_RCode _check_param_wait(
+      const struct TN_CondVar *condvar,
+      const struct TN_Mutex   *mutex
+      )
+{
+   enum TN_RCode rc = _check_param_generic(condvar);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (mutex == TN_NULL){
+      rc = TN_RC_WPARAM;
+   } else if (!_tn_mutex_is_valid(mutex)){
+      rc = TN_RC_INVALID_OBJ;
+   }
+
+   return rc;
+}
+
+#else
+#  define _check_param_generic(condvar)               (TN_RC_OK)
+#  define _check_param_create(condvar)                (TN_RC_OK)
+#  define _check_param_wait(condvar, mutex)           (TN_RC_OK)
+#endif
+// }}}
+
+
+/**
+ * Generic function that performs job from task context
+ *
+ * @param condvar    condition variable to perform job on
+ * @param p_worker   pointer to actual worker function
+ */
+_TN_STATIC_INLINE enum TN_RCode _condvar_job_perform(
+      struct TN_CondVar *condvar,
+      void (p_worker)(struct TN_CondVar *condvar)
+      )
+{
+   enum TN_RCode rc = _check_param_generic(condvar);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (!tn_is_task_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      TN_INTSAVE_DATA;
+
+      TN_INT_DIS_SAVE();      //-- disable interrupts
+      p_worker(condvar);      //-- call actual worker function
+      TN_INT_RESTORE();       //-- restore previous interrupts state
+
+      _tn_context_switch_pend_if_needed();
+   }
+   return rc;
+}
+
+/**
+ * Generic function that performs job from interrupt context
+ *
+ * @param condvar    condition variable to perform job on
+ * @param p_worker   pointer to actual worker function
+ */
+_TN_STATIC_INLINE enum TN_RCode _condvar_job_iperform(
+      struct TN_CondVar *condvar,
+      void (p_worker)(struct TN_CondVar *condvar)
+      )
+{
+   enum TN_RCode rc = _check_param_generic(condvar);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (!tn_is_isr_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      TN_INTSAVE_DATA_INT;
+
+      TN_INT_IDIS_SAVE();     //-- disable interrupts
+      p_worker(condvar);      //-- call actual worker function
+      TN_INT_IRESTORE();      //-- restore previous interrupts state
+
+      _TN_CONTEXT_SWITCH_IPEND_IF_NEEDED();
+   }
+   return rc;
+}
+
+/**
+ * Make the first task from the condition variable's wait queue lock the
+ * mutex. The queue must not be empty.
+ */
+static void _condvar_first_to_mutex(struct TN_CondVar *condvar)
+{
+   struct TN_Task *task = _tn_list_first_entry(
+         &(condvar->wait_queue), struct TN_Task, task_queue
+         );
+
+   _TN_OBJ_STATS_ACQUIRED(condvar);
+
+   if (_tn_mutex_is_valid(condvar->mutex)){
+      //-- the task doesn't wake up here unless the mutex is free: instead,
+      //   it is moved to the mutex's wait queue, so that it wakes up
+      //   just once, when it already holds the mutex.
+      _tn_mutex_wait_transfer(condvar->mutex, task);
+   } else {
+      //-- the mutex was deleted while task waited for the condition variable
+      _tn_task_wait_complete(task, TN_RC_DELETED);
+   }
+}
+
+static void _condvar_signal(struct TN_CondVar *condvar)
+{
+   if (!_tn_list_is_empty(&(condvar->wait_queue))){
+      _condvar_first_to_mutex(condvar);
+   }
+}
+
+static void _condvar_broadcast(struct TN_CondVar *condvar)
+{
+   while (!_tn_list_is_empty(&(condvar->wait_queue))){
+      _condvar_first_to_mutex(condvar);
+   }
+}
+
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC FUNCTIONS
+ ******************************************************************************/
+
+/*
+ * See comments in the header file (tn_condvar.h)
+ */
+enum TN_RCode tn_condvar_create(struct TN_CondVar *condvar)
+{
+   //-- perform additional params checking (if enabled by TN_CHECK_PARAM)
+   enum TN_RCode rc = _check_param_create(condvar);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else {
+      _tn_list_reset(&(condvar->wait_queue));
+
+      condvar->mutex       = TN_NULL;
+      condvar->id_condvar  = TN_ID_CONDVAR;
+
+#if TN_WAKEUP_LATENCY
+      _tn_wakeup_latency_reset(&condvar->wakeup_latency);
+#endif
+#if TN_OBJ_STATS
+      _tn_obj_stats_create(&condvar->obj_stats, condvar);
+#endif
+#if TN_OBJ_REGISTRY
+      _tn_obj_registry_add(TN_ID_CONDVAR, &condvar->registry_item);
+#endif
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_condvar.h)
+ */
+enum TN_RCode tn_condvar_delete(struct TN_CondVar *condvar)
+{
+   //-- perform additional params checking (if enabled by TN_CHECK_PARAM)
+   enum TN_RCode rc = _check_param_generic(condvar);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (!tn_is_task_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      TN_INTSAVE_DATA;
+
+      TN_INT_DIS_SAVE();
+
+      //-- Remove all tasks from wait queue, returning the TN_RC_DELETED code.
+      //   They will lock the mutex again by themselves.
+      _tn_wait_queue_notify_deleted(&(condvar->wait_queue));
+
+      condvar->id_condvar = TN_ID_NONE;   //-- condvar does not exist now
+#if TN_OBJ_STATS
+      _tn_obj_stats_delete(&condvar->obj_stats);
+#endif
+#if TN_OBJ_REGISTRY
+      _tn_obj_registry_remove(&condvar->registry_item);
+#endif
+      TN_INT_RESTORE();
+
+      //-- we might need to switch context if _tn_wait_queue_notify_deleted()
+      //   has woken up some high-priority task
+      _tn_context_switch_pend_if_needed();
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_condvar.h)
+ */
+enum TN_RCode tn_condvar_wait(
+      struct TN_CondVar   *condvar,
+      struct TN_Mutex     *mutex,
+      TN_TickCnt           timeout
+      )
+{
+   enum TN_RCode rc = _check_param_wait(condvar, mutex);
+   TN_BOOL waited_for_condvar = TN_FALSE;
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (!tn_is_task_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      TN_INTSAVE_DATA;
+
+      TN_INT_DIS_SAVE();
+
+      if (     mutex->holder != _tn_curr_run_task
+            || mutex->cnt > 1
+            || (  !_tn_list_is_empty(&(condvar->wait_queue))
+               && condvar->mutex != mutex
+               )
+         )
+      {
+         //-- mutex should be locked by the current task just once, and
+         //   all the waiters should use the same mutex
+         rc = TN_RC_ILLEGAL_USE;
+      } else if (timeout == 0){
+         //-- in polling mode, just return TN_RC_TIMEOUT
+         //   (the mutex isn't unlocked)
+         rc = TN_RC_TIMEOUT;
+      } else {
+         condvar->mutex = mutex;
+
+         //-- unlock the mutex and start waiting for the condition variable,
+         //   in the same critical section: no signal can be missed between
+         //   them.
+         _tn_mutex_release(mutex);
+         _tn_task_curr_to_wait_action(
+               &(condvar->wait_queue), TN_WAIT_REASON_CONDVAR, timeout
+               );
+
+         waited_for_condvar = TN_TRUE;
+      }
+
+#if TN_DEBUG
+      //-- if we're going to wait, _tn_need_context_switch() must return TN_TRUE
+      if (!_tn_need_context_switch() && waited_for_condvar){
+         _TN_FATAL_ERROR("");
+      }
+#endif
+
+      TN_INT_RESTORE();
+      _tn_context_switch_pend_if_needed();
+
+      if (waited_for_condvar){
+         //-- get wait result
+         rc = _tn_curr_run_task->task_wait_rc;
+
+         //-- TN_RC_OK means that the condition variable was signaled and
+         //   the mutex is already locked by the current task (see
+         //   _tn_mutex_wait_transfer()). Otherwise (timeout,
+         //   tn_task_release_wait(), deletion of the condition variable)
+         //   we should lock the mutex by ourselves, unless it is deleted.
+         if (rc != TN_RC_OK && _tn_mutex_is_valid(mutex)){
+            enum TN_RCode lock_rc = tn_mutex_lock(mutex, TN_WAIT_INFINITE);
+            if (lock_rc != TN_RC_OK){
+               rc = lock_rc;
+            }
+         }
+      }
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_condvar.h)
+ */
+enum TN_RCode tn_condvar_signal(struct TN_CondVar *condvar)
+{
+   return _condvar_job_perform(condvar, _condvar_signal);
+}
+
+/*
+ * See comments in the header file (tn_condvar.h)
+ */
+enum TN_RCode tn_condvar_isignal(struct TN_CondVar *condvar)
+{
+   return _condvar_job_iperform(condvar, _condvar_signal);
+}
+
+/*
+ * See comments in the header file (tn_condvar.h)
+ */
+enum TN_RCode tn_condvar_broadcast(struct TN_CondVar *condvar)
+{
+   return _condvar_job_perform(condvar, _condvar_broadcast);
+}
+
+/*
+ * See comments in the header file (tn_condvar.h)
+ */
+enum TN_RCode tn_condvar_ibroadcast(struct TN_CondVar *condvar)
+{
+   return _condvar_job_iperform(condvar, _condvar_broadcast);
+}
+
+
+#endif //-- TN_USE_MUTEXES
+
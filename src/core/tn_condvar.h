@@ -0,0 +1,313 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/**
+ * \file
+ *
+ * Condition variable: an object to wait until some predicate, protected by
+ * the mutex, becomes true.
+ *
+ * Without it, the task which waits for the predicate has to use some extra
+ * signaling object (semaphore or event group), unlocking the mutex before
+ * waiting for it, and locking the mutex again afterwards. This is both
+ * inefficient and error-prone: e.g. the signal might be sent after the mutex
+ * is unlocked, but before the task starts waiting.
+ *
+ * Condition variable is always used together with the mutex (`struct
+ * #TN_Mutex`). Typical usage:
+ *
+ * \code{.c}
+ *    //-- consumer
+ *    tn_mutex_lock(&mutex, TN_WAIT_INFINITE);
+ *    while (!predicate){
+ *       tn_condvar_wait(&condvar, &mutex, TN_WAIT_INFINITE);
+ *    }
+ *    //-- ... use the data protected by the mutex ...
+ *    tn_mutex_unlock(&mutex);
+ *
+ *    //-- producer
+ *    tn_mutex_lock(&mutex, TN_WAIT_INFINITE);
+ *    predicate = TN_TRUE;
+ *    tn_condvar_signal(&condvar);
+ *    tn_mutex_unlock(&mutex);
+ * \endcode
+ *
+ * `tn_condvar_wait()` unlocks the mutex and puts the task to the wait queue of
+ * the condition variable atomically, i.e. in the same critical section, so
+ * that no signal can be missed.
+ *
+ * When the condition variable is signaled, the waiter isn't just woken up to
+ * lock the mutex by itself: if the mutex is locked by someone else (typically
+ * by the signaling task), the waiter is moved straight to the mutex's wait
+ * queue, with the priority of the mutex holder elevated according to the
+ * mutex protocol. So the waiter wakes up once, when it already holds the
+ * mutex. This is especially valuable for `tn_condvar_broadcast()`: woken up
+ * tasks don't rush to lock the same mutex.
+ *
+ * Condition variables are available if only `#TN_USE_MUTEXES` is non-zero.
+ */
+
+#ifndef _TN_CONDVAR_H
+#define _TN_CONDVAR_H
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "tn_list.h"
+#include "tn_common.h"
+#include "tn_mutex.h"
+#include "tn_wakeup_latency.h"
+#include "tn_obj_stats.h"
+#include "tn_obj_registry.h"
+
+
+
+#ifdef __cplusplus
+extern "C"  {     /*}*/
+#endif
+
+/*******************************************************************************
+ *    PUBLIC TYPES
+ ******************************************************************************/
+
+/**
+ * Condition variable
+ */
+struct TN_CondVar {
+   ///
+   /// id for object validity verification.
+   /// This field is in the beginning of the structure to make it easier
+   /// to detect memory corruption.
+   enum TN_ObjId id_condvar;
+   ///
+   /// List of tasks that wait for the condition variable
+   struct TN_ListItem wait_queue;
+   ///
+   /// Mutex which is given to `tn_condvar_wait()` by the current waiters.
+   /// All the tasks that wait for the condition variable at the same time
+   /// should use the same mutex.
+   struct TN_Mutex *mutex;
+#if TN_WAKEUP_LATENCY || DOXYGEN_ACTIVE
+   ///
+   /// Wake-up latency histogram, available if only `#TN_WAKEUP_LATENCY`
+   /// option is non-zero. See `#tn_wakeup_latency_obj_get()`
+   struct TN_WakeupLatency wakeup_latency;
+#endif
+#if TN_OBJ_STATS || DOXYGEN_ACTIVE
+   ///
+   /// Contention statistics, available if only `#TN_OBJ_STATS` option is
+   /// non-zero. See `#tn_obj_stats_get()`
+   struct _TN_ObjStats obj_stats;
+#endif
+#if TN_OBJ_REGISTRY || DOXYGEN_ACTIVE
+   ///
+   /// List item for the registry of kernel objects, available if only
+   /// `#TN_OBJ_REGISTRY` option is non-zero. See `#tn_obj_registry_next()`
+   struct TN_ListItem registry_item;
+#endif
+};
+
+
+/*******************************************************************************
+ *    PROTECTED GLOBAL DATA
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    PUBLIC FUNCTION PROTOTYPES
+ ******************************************************************************/
+
+#if TN_USE_MUTEXES || DOXYGEN_ACTIVE
+
+/**
+ * Construct the condition variable. `id_condvar` field should not contain
+ * `#TN_ID_CONDVAR`, otherwise, `#TN_RC_WPARAM` is returned.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param condvar
+ *    Pointer to already allocated `struct TN_CondVar`
+ *
+ * @return 
+ *    * `#TN_RC_OK` if condition variable was successfully created;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return code
+ *      is available: `#TN_RC_WPARAM`.
+ */
+enum TN_RCode tn_condvar_create(struct TN_CondVar *condvar);
+
+/**
+ * Destruct the condition variable.
+ *
+ * All tasks that wait for the condition variable lock the mutex again, and
+ * then `#TN_RC_DELETED` code is returned to them.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param condvar     condition variable to destruct
+ *
+ * @return 
+ *    * `#TN_RC_OK` if condition variable was successfully deleted;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_condvar_delete(struct TN_CondVar *condvar);
+
+/**
+ * Wait for the condition variable to be signaled.
+ *
+ * The mutex must be locked by the current task (not recursively). It is
+ * unlocked, and the task starts waiting for the condition variable; these
+ * two actions are performed atomically. Before the function returns, the
+ * mutex is locked by the task again, no matter of the wait result (with the
+ * only exception: if the mutex is deleted meanwhile, `#TN_RC_DELETED` is
+ * returned and the mutex obviously isn't locked).
+ *
+ * Note that `timeout` applies to waiting for the signal only: once the
+ * condition variable is signaled (or the timeout is expired), task waits for
+ * the mutex as long as needed.
+ *
+ * Just like with any other condition variable implementation, the predicate
+ * should be checked again after the function returns, since some other task
+ * might have changed the state between the signal and the moment when the
+ * task locked the mutex.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_CAN_SLEEP)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param condvar    condition variable to wait for
+ * @param mutex      mutex which is locked by the current task
+ * @param timeout    refer to `#TN_TickCnt`
+ *
+ * @return
+ *    * `#TN_RC_OK` if the condition variable was signaled;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * `#TN_RC_ILLEGAL_USE` if the mutex isn't locked by the current task,
+ *      or it is locked recursively, or if other tasks wait for the condition
+ *      variable with another mutex;
+ *    * `#TN_RC_DELETED` if either condition variable or mutex was deleted
+ *      while task was waiting;
+ *    * Other possible return codes depend on `timeout` value,
+ *      refer to `#TN_TickCnt`. If `timeout` is zero, `#TN_RC_TIMEOUT` is
+ *      returned immediately, and the mutex isn't unlocked at all;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_condvar_wait(
+      struct TN_CondVar   *condvar,
+      struct TN_Mutex     *mutex,
+      TN_TickCnt           timeout
+      );
+
+/**
+ * Signal the condition variable: the first task (if any) that \ref
+ * tn_condvar_wait() "waits" for it stops waiting for the condition variable
+ * and locks the mutex: if the mutex is locked by someone else, the task is
+ * moved to the mutex's wait queue.
+ *
+ * If there are no waiting tasks, nothing is done.
+ *
+ * It is allowed to signal the condition variable without locking the mutex,
+ * but then the task which is going to wait for it might miss the signal, so
+ * it is usually a bad idea.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param condvar     condition variable to signal
+ * 
+ * @return
+ *    * `#TN_RC_OK` if successful
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_condvar_signal(struct TN_CondVar *condvar);
+
+/**
+ * The same as `tn_condvar_signal()` but for using in the ISR.
+ *
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ */
+enum TN_RCode tn_condvar_isignal(struct TN_CondVar *condvar);
+
+/**
+ * The same as `tn_condvar_signal()`, but all the waiting tasks are affected:
+ * one of them locks the mutex (if it is free), and the rest are moved to the
+ * mutex's wait queue.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ */
+enum TN_RCode tn_condvar_broadcast(struct TN_CondVar *condvar);
+
+/**
+ * The same as `tn_condvar_broadcast()` but for using in the ISR.
+ *
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ */
+enum TN_RCode tn_condvar_ibroadcast(struct TN_CondVar *condvar);
+
+#endif   // TN_USE_MUTEXES
+
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+
+#endif // _TN_CONDVAR_H
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
@@ -0,0 +1,303 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+//-- common tnkernel headers
+#include "tn_common.h"
+#include "tn_sys.h"
+
+//-- internal tnkernel headers
+#include "_tn_sys.h"
+
+#include "tn_tasks.h"
+
+//-- header of current module
+#include "tn_cpu_load.h"
+#include "_tn_cpu_load.h"
+
+
+#if TN_CPU_LOAD
+
+
+
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+//-- configuration check
+#if TN_CPU_LOAD_PERIOD_TICKS < 1
+#  error TN_CPU_LOAD_PERIOD_TICKS must be at least 1
+#endif
+
+#if (TN_CPU_LOAD_PERIODS_CNT < 1) || (TN_CPU_LOAD_PERIODS_CNT > 255)
+#  error TN_CPU_LOAD_PERIODS_CNT must be in the range [1, 255]
+#endif
+
+#if TN_DYNAMIC_TICK
+#  error TN_CPU_LOAD is not available together with TN_DYNAMIC_TICK
+#endif
+
+//-- load is expressed in permille
+#define _LOAD_MAX    1000
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+///
+/// History of loads of the completed periods, in permille. It is a ring
+/// buffer, `_hist_idx` is the index of the next slot to write.
+static unsigned short _hist[ TN_CPU_LOAD_PERIODS_CNT ];
+static int _hist_idx = 0;
+
+///
+/// Number of valid items in `_hist`
+static int _hist_cnt = 0;
+
+///
+/// Ticks elapsed since the current period has started
+static unsigned long _period_ticks = 0;
+
+///
+/// Ticks during which the idle task was running in the current period
+/// (used if only precise timestamps aren't available)
+static unsigned long _idle_ticks = 0;
+
+///
+/// Timestamp of the current period start, and whether it is valid (it isn't
+/// until the first tick)
+static TN_UWord _period_start_ts = 0;
+static TN_BOOL _period_start_valid = TN_FALSE;
+
+///
+/// Idle time accounted in the current period, in timestamp units
+static TN_UWord _idle_time = 0;
+
+///
+/// Timestamp of when the idle task was switched in last time
+static TN_UWord _idle_start_ts = 0;
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+//-- Additional param checking {{{
+#if TN_CHECK_PARAM
+_TN_STATIC_INLINE enum TN_RCode _check_param_get(
+      int                   periods_cnt,
+      const unsigned int   *p_load
+      )
+{
+   enum TN_RCode rc = TN_RC_OK;
+
+   if (     p_load == TN_NULL
+         || periods_cnt < 1
+         || periods_cnt > TN_CPU_LOAD_PERIODS_CNT
+      )
+   {
+      rc = TN_RC_WPARAM;
+   }
+
+   return rc;
+}
+
+#else
+#  define _check_param_get(periods_cnt, p_load)     (TN_RC_OK)
+#endif
+// }}}
+
+/**
+ * Calculates load of the current period, resets period counters and
+ * returns the load in permille.
+ */
+static unsigned int _period_load_get(void)
+{
+   unsigned int ret = 0;
+
+   if (_tn_sys_timestamp_is_precise()){
+      TN_UWord now = _tn_sys_timestamp_get();
+      TN_UWord total = now - _period_start_ts;
+      TN_UWord idle = _idle_time;
+
+      if (_tn_curr_run_task == &_tn_idle_task){
+         //-- idle task is running right now: account the time since it was
+         //   switched in, and move its start to the new period
+         idle += now - _idle_start_ts;
+         _idle_start_ts = now;
+      }
+
+      if (idle >= total){
+         ret = 0;
+      } else {
+         ret = _LOAD_MAX - (unsigned int)(
+               ((unsigned long long)idle * _LOAD_MAX) / total
+               );
+      }
+
+      _period_start_ts = now;
+      _idle_time = 0;
+   } else {
+      ret = _LOAD_MAX - (unsigned int)(
+            ((unsigned long long)_idle_ticks * _LOAD_MAX) / _period_ticks
+            );
+   }
+
+   _idle_ticks = 0;
+   _period_ticks = 0;
+
+   return ret;
+}
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC FUNCTIONS
+ ******************************************************************************/
+
+/*
+ * See comments in the header file (tn_cpu_load.h)
+ */
+enum TN_RCode tn_cpu_load_get(int periods_cnt, unsigned int *p_load)
+{
+   enum TN_RCode rc = _check_param_get(periods_cnt, p_load);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else {
+      unsigned long sum = 0;
+      int cnt;
+      int idx;
+      int i;
+
+      TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+
+      cnt = (periods_cnt < _hist_cnt) ? periods_cnt : _hist_cnt;
+
+      //-- walk back from the most recent period
+      idx = _hist_idx;
+      for (i = 0; i < cnt; i++){
+         idx = (idx == 0) ? (TN_CPU_LOAD_PERIODS_CNT - 1) : (idx - 1);
+         sum += _hist[idx];
+      }
+
+      tn_arch_sr_restore(sr_saved);
+
+      if (cnt == 0){
+         rc = TN_RC_WSTATE;
+      } else {
+         *p_load = (unsigned int)(sum / cnt);
+      }
+   }
+
+   return rc;
+}
+
+
+
+
+/*******************************************************************************
+ *    PROTECTED FUNCTIONS
+ ******************************************************************************/
+
+/*
+ * See comments in the header file (_tn_cpu_load.h)
+ */
+void _tn_cpu_load_on_tick(void)
+{
+   if (!_period_start_valid){
+      //-- the very first tick: start the first period
+      _period_start_ts = _tn_sys_timestamp_get();
+      _idle_start_ts = _period_start_ts;
+      _idle_time = 0;
+      _period_start_valid = TN_TRUE;
+   } else {
+      if (_tn_curr_run_task == &_tn_idle_task){
+         _idle_ticks++;
+      }
+
+      _period_ticks++;
+
+      if (_period_ticks >= TN_CPU_LOAD_PERIOD_TICKS){
+         _hist[_hist_idx] = (unsigned short)_period_load_get();
+
+         _hist_idx++;
+         if (_hist_idx >= TN_CPU_LOAD_PERIODS_CNT){
+            _hist_idx = 0;
+         }
+
+         if (_hist_cnt < TN_CPU_LOAD_PERIODS_CNT){
+            _hist_cnt++;
+         }
+      }
+   }
+}
+
+/*
+ * See comments in the header file (_tn_cpu_load.h)
+ */
+void _tn_cpu_load_on_context_switch(
+      struct TN_Task *task_prev,
+      struct TN_Task *task_new
+      )
+{
+   if (_tn_sys_timestamp_is_precise()){
+      if (task_prev == &_tn_idle_task){
+         _idle_time += _tn_sys_timestamp_get() - _idle_start_ts;
+      } else if (task_new == &_tn_idle_task){
+         _idle_start_ts = _tn_sys_timestamp_get();
+      }
+   }
+}
+
+#endif // TN_CPU_LOAD
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
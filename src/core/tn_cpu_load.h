@@ -0,0 +1,142 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/**
+ * \file
+ *
+ * CPU load measurement, available if only `#TN_CPU_LOAD` option is non-zero.
+ *
+ * The kernel measures how much time is spent in the idle task, and every
+ * `#TN_CPU_LOAD_PERIOD_TICKS` system ticks it calculates CPU load of the
+ * elapsed period (that is, the share of non-idle time), in permille. The
+ * history of the last `#TN_CPU_LOAD_PERIODS_CNT` periods is kept, so that
+ * the load can be averaged over several windows. Say, if the system tick is
+ * 1 ms, `#TN_CPU_LOAD_PERIOD_TICKS` is 1000 and `#TN_CPU_LOAD_PERIODS_CNT` is
+ * 60, then CPU load for the last 1 s, 10 s and 60 s can be obtained like
+ * this:
+ *
+ * \code{.c}
+ *    unsigned int load_1s, load_10s, load_60s;
+ *
+ *    tn_cpu_load_get(1, &load_1s);
+ *    tn_cpu_load_get(10, &load_10s);
+ *    tn_cpu_load_get(60, &load_60s);
+ * \endcode
+ *
+ * Idle time is measured in one of two ways:
+ *
+ * - If timestamp callback is set (see `#tn_callback_timestamp_set()`),
+ *   timestamps are taken when the idle task is switched in and out, so the
+ *   measurement is precise. Period should be shorter than the wrap-around
+ *   period of the timestamp counter.
+ * - Otherwise, at each system tick the kernel checks whether the idle task
+ *   is running; that is, idle time is sampled with the tick resolution,
+ *   which is good enough for the long-term average, as long as the
+ *   application activity isn't synchronized with system ticks.
+ *
+ * Either way, the overhead is negligible: a couple of comparisons at each
+ * context switch and tick, and some arithmetic once per period.
+ *
+ * Note that time spent in interrupts while the idle task was running is
+ * accounted as idle time.
+ *
+ * Since periods are counted in system ticks, this option is not available
+ * together with `#TN_DYNAMIC_TICK`.
+ */
+
+#ifndef _TN_CPU_LOAD_H
+#define _TN_CPU_LOAD_H
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "../arch/tn_arch.h"
+#include "tn_common.h"
+
+
+
+#ifdef __cplusplus
+extern "C"  {     /*}*/
+#endif
+
+/*******************************************************************************
+ *    PUBLIC FUNCTION PROTOTYPES
+ ******************************************************************************/
+
+#if TN_CPU_LOAD || DOXYGEN_ACTIVE
+
+/**
+ * Get CPU load averaged over the given number of the most recent completed
+ * periods (each period is `#TN_CPU_LOAD_PERIOD_TICKS` system ticks). If less
+ * periods are completed so far, the load is averaged over the completed
+ * ones.
+ *
+ * Available if only `#TN_CPU_LOAD` option is non-zero.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param periods_cnt
+ *    Number of periods to average over, from 1 to `#TN_CPU_LOAD_PERIODS_CNT`
+ * @param p_load
+ *    Pointer to the location where CPU load should be stored, in permille:
+ *    0 means the system was idle all the time, 1000 means the idle task
+ *    didn't run at all.
+ *
+ * @return
+ *    * `#TN_RC_OK` if load was successfully stored;
+ *    * `#TN_RC_WSTATE` if no period is completed yet;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return code
+ *      is available: `#TN_RC_WPARAM`.
+ */
+enum TN_RCode tn_cpu_load_get(int periods_cnt, unsigned int *p_load);
+
+#endif   // TN_CPU_LOAD
+
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+
+#endif // _TN_CPU_LOAD_H
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
@@ -0,0 +1,281 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+//-- common tnkernel headers
+#include "tn_common.h"
+#include "tn_sys.h"
+
+//-- internal tnkernel headers
+#include "_tn_sys.h"
+
+//-- header of current module
+#include "tn_csect.h"
+
+//-- std header for memcpy()
+#include <string.h>
+
+
+#if TN_CSECT_MEASURE
+
+
+
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+//-- configuration check
+#if (TN_CSECT_MEASURE_TOP_CNT < 1) || (TN_CSECT_MEASURE_TOP_CNT > 255)
+#  error TN_CSECT_MEASURE_TOP_CNT must be in the range [1, 255]
+#endif
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+///
+/// Table of the longest sections, sorted by `max`, the longest one first
+static struct TN_CSectRec _top[ TN_CSECT_MEASURE_TOP_CNT ];
+
+///
+/// Number of valid records in `_top`
+static int _top_cnt = 0;
+
+///
+/// Nesting depth of the critical sections; only the outermost one is
+/// accounted.
+static int _depth = 0;
+
+///
+/// Call site of the current outermost section
+static const char *_cur_service = TN_NULL;
+static unsigned int _cur_line = 0;
+static void *_cur_caller_pc = TN_NULL;
+
+///
+/// Timestamp of the current outermost section start
+static TN_UWord _cur_start_ts = 0;
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+//-- Additional param checking {{{
+#if TN_CHECK_PARAM
+_TN_STATIC_INLINE enum TN_RCode _check_param_top_get(
+      const struct TN_CSectRec  *tgt,
+      const int                 *p_cnt
+      )
+{
+   enum TN_RCode rc = TN_RC_OK;
+
+   if (tgt == TN_NULL || p_cnt == TN_NULL || *p_cnt < 0){
+      rc = TN_RC_WPARAM;
+   }
+
+   return rc;
+}
+
+#else
+#  define _check_param_top_get(tgt, p_cnt)      (TN_RC_OK)
+#endif
+// }}}
+
+/**
+ * Account the finished section in the table: update the record of its call
+ * site, or create new one if the section is longer than the shortest one in
+ * the table.
+ */
+static void _top_add(TN_UWord duration)
+{
+   struct TN_CSectRec *rec = TN_NULL;
+   int i;
+
+   //-- find the record of this call site
+   for (i = 0; i < _top_cnt; i++){
+      if (     _top[i].service == _cur_service
+            && _top[i].line == _cur_line
+         )
+      {
+         rec = &_top[i];
+         break;
+      }
+   }
+
+   if (rec == TN_NULL){
+      if (_top_cnt < TN_CSECT_MEASURE_TOP_CNT){
+         //-- there is free room in the table
+         rec = &_top[_top_cnt++];
+      } else if (duration > _top[TN_CSECT_MEASURE_TOP_CNT - 1].max){
+         //-- the table is full, but the section is longer than the shortest
+         //   one: evict it
+         rec = &_top[TN_CSECT_MEASURE_TOP_CNT - 1];
+      } else {
+         //-- the section is not interesting
+      }
+
+      if (rec != TN_NULL){
+         rec->service   = _cur_service;
+         rec->line      = _cur_line;
+         rec->max       = 0;
+         rec->cnt       = 0;
+      }
+   }
+
+   if (rec != TN_NULL){
+      rec->cnt++;
+
+      if (rec->cnt == 1 || duration > rec->max){
+         rec->max       = duration;
+         rec->caller_pc = _cur_caller_pc;
+
+         //-- max has grown: keep the table sorted, by moving the record
+         //   towards the head
+         while (rec > _top && (rec - 1)->max < rec->max){
+            struct TN_CSectRec tmp = *(rec - 1);
+            *(rec - 1) = *rec;
+            *rec = tmp;
+            rec--;
+         }
+      }
+   }
+}
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC FUNCTIONS
+ ******************************************************************************/
+
+/*
+ * See comments in the header file (tn_csect.h)
+ */
+enum TN_RCode tn_csect_top_get(struct TN_CSectRec *tgt, int *p_cnt)
+{
+   enum TN_RCode rc = _check_param_top_get(tgt, p_cnt);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else {
+      //-- NOTE: we don't use TN_INT_DIS_SAVE() here, since this section
+      //   isn't interesting to account.
+      TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+
+      if (*p_cnt > _top_cnt){
+         *p_cnt = _top_cnt;
+      }
+
+      memcpy(tgt, _top, sizeof(*tgt) * (*p_cnt));
+
+      tn_arch_sr_restore(sr_saved);
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_csect.h)
+ */
+void tn_csect_reset(void)
+{
+   TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+
+   _top_cnt = 0;
+
+   tn_arch_sr_restore(sr_saved);
+}
+
+
+
+
+/*******************************************************************************
+ *    PROTECTED FUNCTIONS
+ ******************************************************************************/
+
+/*
+ * See comments in the header file (tn_arch.h)
+ */
+void _tn_csect_enter(
+      const char    *service,
+      unsigned int   line,
+      void          *caller_pc
+      )
+{
+   if (_depth++ == 0){
+      _cur_service   = service;
+      _cur_line      = line;
+      _cur_caller_pc = caller_pc;
+
+      //-- take timestamp the last, so that our own overhead is excluded
+      //   as much as possible
+      _cur_start_ts  = _tn_sys_timestamp_get();
+   }
+}
+
+/*
+ * See comments in the header file (tn_arch.h)
+ */
+void _tn_csect_exit(void)
+{
+   if (_depth > 0){
+      if (--_depth == 0){
+         _top_add(_tn_sys_timestamp_get() - _cur_start_ts);
+      }
+   } else {
+      //-- unbalanced TN_INT_RESTORE(): interrupts were disabled by some
+      //   other means, so there's nothing to account. Just ignore.
+   }
+}
+
+#endif // TN_CSECT_MEASURE
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
@@ -0,0 +1,185 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/**
+ * \file
+ *
+ * Measurement of the kernel critical sections, available if only
+ * `#TN_CSECT_MEASURE` option is non-zero.
+ *
+ * Every kernel service brackets its job with `TN_INT_DIS_SAVE()` /
+ * `TN_INT_RESTORE()` (or `TN_INT_IDIS_SAVE()` / `TN_INT_IRESTORE()` in ISR),
+ * and the worst-case interrupt latency of the system depends on the longest
+ * of such sections. When `#TN_CSECT_MEASURE` is non-zero, these macros
+ * timestamp each section, and the duration is accounted in the table of
+ * `#TN_CSECT_MEASURE_TOP_CNT` longest sections, one record per call site.
+ * The table can be read with `#tn_csect_top_get()`.
+ *
+ * The call site is identified by the name of the function which contains
+ * the section (that is, the kernel service, like `tn_sem_signal`, or some
+ * internal function of it) and the line number. Additionally, for the
+ * longest run of each section, the "caller PC" is remembered: the return
+ * address of the function which contains the section, which tells who has
+ * called the service (on compilers where it's available; otherwise it is
+ * `#TN_NULL`). Note that if the section resides in a function which is
+ * inlined in the caller, return address of that caller is taken instead.
+ *
+ * Only the outermost section is accounted if sections are nested. Sections
+ * made with `tn_arch_sr_save_int_dis()` / `tn_arch_sr_restore()` called
+ * directly are not accounted.
+ *
+ * Sections of the application which uses the same macros are accounted as
+ * well.
+ *
+ * Timestamps are taken from the callback set by
+ * `#tn_callback_timestamp_set()`; if it isn't set, system ticks are used,
+ * which is way too coarse for this purpose. Note also that this mode
+ * obviously makes every critical section somewhat longer, so, measured
+ * values include this overhead; use it for finding the offenders, not for
+ * production.
+ */
+
+#ifndef _TN_CSECT_H
+#define _TN_CSECT_H
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "../arch/tn_arch.h"
+#include "tn_common.h"
+
+
+
+#ifdef __cplusplus
+extern "C"  {     /*}*/
+#endif
+
+/*******************************************************************************
+ *    PUBLIC TYPES
+ ******************************************************************************/
+
+#if TN_CSECT_MEASURE || DOXYGEN_ACTIVE
+
+/**
+ * Record of the critical section call site, see `#tn_csect_top_get()`.
+ *
+ * Available if only `#TN_CSECT_MEASURE` option is non-zero.
+ */
+struct TN_CSectRec {
+   ///
+   /// Name of the function which contains the section (kernel service or
+   /// some internal function of it)
+   const char       *service;
+   ///
+   /// Line number of the section start (i.e. `TN_INT_DIS_SAVE()`)
+   unsigned int      line;
+   ///
+   /// Caller PC: return address of the function which contains the section,
+   /// taken on the longest run of the section. `#TN_NULL` if the compiler
+   /// doesn't provide it.
+   void             *caller_pc;
+   ///
+   /// Maximum duration of the section, in timestamp units (see
+   /// `#tn_callback_timestamp_set()`)
+   TN_UWord          max;
+   ///
+   /// How many times the section was executed since the record was created
+   unsigned long     cnt;
+};
+
+#endif   // TN_CSECT_MEASURE
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC FUNCTION PROTOTYPES
+ ******************************************************************************/
+
+#if TN_CSECT_MEASURE || DOXYGEN_ACTIVE
+
+/**
+ * Read the table of the longest critical sections, sorted by maximum
+ * duration, the longest one first.
+ *
+ * Available if only `#TN_CSECT_MEASURE` option is non-zero.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_CALL_FROM_MAIN)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param tgt
+ *    Array where records should be stored
+ * @param p_cnt
+ *    On entry, capacity of `tgt` (in records); on exit, number of records
+ *    actually stored, which is at most `#TN_CSECT_MEASURE_TOP_CNT`.
+ *
+ * @return
+ *    * `#TN_RC_OK` if records were successfully copied;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return code
+ *      is available: `#TN_RC_WPARAM`.
+ */
+enum TN_RCode tn_csect_top_get(struct TN_CSectRec *tgt, int *p_cnt);
+
+/**
+ * Clear the table of the longest critical sections, so that measurement
+ * starts over. Might be useful e.g. to exclude system initialization.
+ *
+ * Available if only `#TN_CSECT_MEASURE` option is non-zero.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_CALL_FROM_MAIN)
+ * $(TN_LEGEND_LINK)
+ */
+void tn_csect_reset(void);
+
+#endif   // TN_CSECT_MEASURE
+
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+
+#endif // _TN_CSECT_H
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
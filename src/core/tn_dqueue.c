@@ -46,6 +46,11 @@
 #include "_tn_eventgrp.h"
 #include "_tn_tasks.h"
 #include "_tn_list.h"
+#include "_tn_trace.h"
+#include "_tn_wakeup_latency.h"
+#include "_tn_obj_stats.h"
+#include "_tn_obj_registry.h"
+#include "_tn_select.h"
 
 
 #include "tn_dqueue.h"
@@ -152,6 +157,7 @@ static enum TN_RCode _fifo_write(struct TN_DQueue *dque, void *p_data)
       //-- write data
       dque->data_fifo[dque->head_idx] = p_data;
       dque->filled_items_cnt++;
+      _TN_OBJ_STATS_LEVEL(dque, dque->filled_items_cnt);
       dque->head_idx++;
       if (dque->head_idx >= dque->items_cnt){
          dque->head_idx = 0;
@@ -307,16 +313,27 @@ static enum TN_RCode _queue_send(
    //   from the waiting tasks list, and don't modify messages
    //   fifo at all.
    //
+   //   Otherwise, if there is a task waiting for the queue in tn_select(),
+   //   the message is given to it.
+   //
    //   Otherwise (no waiting tasks), we add new message to the fifo.
 
    if (  !_tn_task_first_wait_complete(
             &dque->wait_receive_list, TN_RC_OK,
             _cb_before_task_wait_complete__send, p_data, TN_NULL
             )
+      && !_tn_select_first_complete(&dque->select_queue, p_data)
       )
    {
       //-- the data queue's wait_receive list is empty
       rc = _fifo_write(dque, p_data);
+   } else {
+      //-- data is received by the waiting task
+      _TN_OBJ_STATS_ACQUIRED(dque);
+   }
+
+   if (rc == TN_RC_OK){
+      _TN_TRACE(TN_TRACE_EV_DQUEUE_SEND, 0, dque, p_data);
    }
 
    return rc;
@@ -395,6 +412,11 @@ static enum TN_RCode _queue_receive(
          break;
    }
 
+   if (rc == TN_RC_OK){
+      _TN_OBJ_STATS_ACQUIRED(dque);
+      _TN_TRACE(TN_TRACE_EV_DQUEUE_RECEIVE, 0, dque, *pp_data);
+   }
+
    return rc;
 }
 
@@ -597,6 +619,9 @@ enum TN_RCode tn_queue_create(
    } else {
       _tn_list_reset(&(dque->wait_send_list));
       _tn_list_reset(&(dque->wait_receive_list));
+#if TN_USE_SELECT
+      _tn_list_reset(&(dque->select_queue));
+#endif
 
       dque->data_fifo         = data_fifo;
       dque->items_cnt         = items_cnt;
@@ -612,6 +637,18 @@ enum TN_RCode tn_queue_create(
       dque->head_idx          = 0;
 
       dque->id_dque = TN_ID_DATAQUEUE;
+
+#if TN_WAKEUP_LATENCY
+      _tn_wakeup_latency_reset(&dque->wakeup_latency);
+#endif
+#if TN_OBJ_STATS
+      _tn_obj_stats_create(&dque->obj_stats, dque);
+#endif
+#if TN_OBJ_REGISTRY
+      _tn_obj_registry_add(TN_ID_DATAQUEUE, &dque->registry_item);
+#endif
+
+      _TN_TRACE(TN_TRACE_EV_DQUEUE_CREATE, 0, dque, dque->items_cnt);
    }
 
    return rc;
@@ -639,8 +676,17 @@ enum TN_RCode tn_queue_delete(struct TN_DQueue * dque)
       //   (TN_RC_DELETED is returned)
       _tn_wait_queue_notify_deleted(&(dque->wait_send_list));
       _tn_wait_queue_notify_deleted(&(dque->wait_receive_list));
+      _tn_select_notify_deleted(&(dque->select_queue));
 
       dque->id_dque = TN_ID_NONE; //-- data queue does not exist now
+#if TN_OBJ_STATS
+      _tn_obj_stats_delete(&dque->obj_stats);
+#endif
+#if TN_OBJ_REGISTRY
+      _tn_obj_registry_remove(&dque->registry_item);
+#endif
+
+      _TN_TRACE(TN_TRACE_EV_DQUEUE_DELETE, 0, dque, 0);
 
       TN_INT_RESTORE();
 
@@ -796,3 +842,21 @@ enum TN_RCode tn_queue_eventgrp_disconnect(
 }
 
 
+/*******************************************************************************
+ *    PROTECTED FUNCTIONS
+ ******************************************************************************/
+
+#if TN_USE_SELECT
+/**
+ * See comments in the file _tn_dqueue.h
+ */
+enum TN_RCode _tn_dqueue_select_try(
+      struct TN_DQueue *dque,
+      void **pp_data
+      )
+{
+   return _queue_receive(dque, pp_data);
+}
+#endif
+
+
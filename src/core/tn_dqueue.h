@@ -81,6 +81,9 @@
 
 #include "tn_list.h"
 #include "tn_common.h"
+#include "tn_wakeup_latency.h"
+#include "tn_obj_stats.h"
+#include "tn_obj_registry.h"
 #include "tn_eventgrp.h"
 
 
@@ -114,6 +117,12 @@ struct TN_DQueue {
    ///
    /// list of tasks waiting to receive data
    struct TN_ListItem  wait_receive_list;
+#if TN_USE_SELECT || DOXYGEN_ACTIVE
+   ///
+   /// List of `tn_select()` items that wait for the data from the queue,
+   /// available if only `#TN_USE_SELECT` option is non-zero.
+   struct TN_ListItem  select_queue;
+#endif
 
    ///
    /// array of `void *` to store data queue items. Can be `TN_NULL`.
@@ -133,6 +142,24 @@ struct TN_DQueue {
    ///
    /// connected event group
    struct TN_EGrpLink eventgrp_link;
+#if TN_WAKEUP_LATENCY || DOXYGEN_ACTIVE
+   ///
+   /// Wake-up latency histogram, available if only `#TN_WAKEUP_LATENCY`
+   /// option is non-zero. See `#tn_wakeup_latency_obj_get()`
+   struct TN_WakeupLatency wakeup_latency;
+#endif
+#if TN_OBJ_STATS || DOXYGEN_ACTIVE
+   ///
+   /// Contention statistics, available if only `#TN_OBJ_STATS` option is
+   /// non-zero. See `#tn_obj_stats_get()`
+   struct _TN_ObjStats obj_stats;
+#endif
+#if TN_OBJ_REGISTRY || DOXYGEN_ACTIVE
+   ///
+   /// List item for the registry of kernel objects, available if only
+   /// `#TN_OBJ_REGISTRY` option is non-zero. See `#tn_obj_registry_next()`
+   struct TN_ListItem registry_item;
+#endif
 };
 
 /**
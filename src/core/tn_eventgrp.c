@@ -45,6 +45,10 @@
 #include "_tn_eventgrp.h"
 #include "_tn_tasks.h"
 #include "_tn_list.h"
+#include "_tn_trace.h"
+#include "_tn_wakeup_latency.h"
+#include "_tn_obj_registry.h"
+#include "_tn_select.h"
 
 
 //-- header of current module
@@ -268,6 +272,32 @@ static void _scan_event_waitqueue(struct TN_EventGrp *eventgrp)
                );
       }
    }
+
+#if TN_USE_SELECT
+   {
+      struct TN_SelectItem *item;
+      struct TN_SelectItem *tmp_item;
+
+      //-- Then, walk through all tasks waiting in tn_select(), in the same
+      //   way. Note that each task has only one item in the select_queue of
+      //   the given event group (see tn_select()), so the task being woken up
+      //   doesn't remove `tmp_item` from the list.
+      _tn_list_for_each_entry_safe(
+            item, struct TN_SelectItem, tmp_item,
+            &(eventgrp->select_queue), select_queue
+            )
+      {
+         if (_cond_check(eventgrp, item->wait_mode, item->wait_pattern)){
+            item->flags_pattern = eventgrp->pattern;
+            _tn_select_item_complete(item, TN_RC_OK);
+
+            _clear_pattern_if_needed(
+                  eventgrp, item->wait_mode, item->wait_pattern
+                  );
+         }
+      }
+   }
+#endif
 }
 
 
@@ -386,6 +416,8 @@ static enum TN_RCode _eventgrp_modify(
          break;
    }
 
+   _TN_TRACE(TN_TRACE_EV_EVENTGRP_MODIFY, operation, eventgrp, eventgrp->pattern);
+
    return TN_RC_OK;
 }
 
@@ -414,13 +446,25 @@ enum TN_RCode tn_eventgrp_create_wattr(
    } else {
 
       _tn_list_reset(&(eventgrp->wait_queue));
+#if TN_USE_SELECT
+      _tn_list_reset(&(eventgrp->select_queue));
+#endif
 
       eventgrp->pattern    = initial_pattern;
       eventgrp->id_event   = TN_ID_EVENTGRP;
+
+#if TN_WAKEUP_LATENCY
+      _tn_wakeup_latency_reset(&eventgrp->wakeup_latency);
+#endif
+#if TN_OBJ_REGISTRY
+      _tn_obj_registry_add(TN_ID_EVENTGRP, &eventgrp->registry_item);
+#endif
 #if TN_OLD_EVENT_API
       eventgrp->attr       = attr;
 #endif
 
+      _TN_TRACE(TN_TRACE_EV_EVENTGRP_CREATE, 0, eventgrp, initial_pattern);
+
    }
    return rc;
 }
@@ -445,8 +489,14 @@ enum TN_RCode tn_eventgrp_delete(struct TN_EventGrp *eventgrp)
       // remove all waiting tasks from wait list (if any), returning the
       // TN_RC_DELETED code.
       _tn_wait_queue_notify_deleted(&(eventgrp->wait_queue));
+      _tn_select_notify_deleted(&(eventgrp->select_queue));
 
       eventgrp->id_event = TN_ID_NONE; //-- event does not exist now
+#if TN_OBJ_REGISTRY
+      _tn_obj_registry_remove(&eventgrp->registry_item);
+#endif
+
+      _TN_TRACE(TN_TRACE_EV_EVENTGRP_DELETE, 0, eventgrp, 0);
 
       TN_INT_RESTORE();
 
@@ -729,4 +779,19 @@ enum TN_RCode _tn_eventgrp_link_manage(
    return rc;
 }
 
+#if TN_USE_SELECT
+/**
+ * See comments in the file _tn_eventgrp.h
+ */
+enum TN_RCode _tn_eventgrp_select_try(
+      struct TN_EventGrp  *eventgrp,
+      TN_UWord             wait_pattern,
+      enum TN_EGrpWaitMode wait_mode,
+      TN_UWord            *p_flags_pattern
+      )
+{
+   return _eventgrp_wait(eventgrp, wait_pattern, wait_mode, p_flags_pattern);
+}
+#endif
+
 
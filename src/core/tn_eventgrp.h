@@ -87,8 +87,15 @@
  * manually: this flag is maintained completely by the queue. If the queue is
  * non-empty, the flag is set. If the queue becomes empty, the flag is cleared.
  * 
+ * Semaphores and fixed memory pools can be connected to an event group as
+ * well: the flag is set while the semaphore counter is non-zero (or while the
+ * pool has at least one free block), and cleared otherwise. So, one task can
+ * wait for a message in the queue, the semaphore, or a free memory block, in
+ * a single call to `tn_eventgrp_wait()`.
+ *
  * For the information on system services related to queue, refer to the \ref 
- * tn_dqueue.h "queue reference".
+ * tn_dqueue.h "queue reference". Related semaphore and memory pool services
+ * are `tn_sem_eventgrp_connect()` and `tn_fmem_eventgrp_connect()`.
  *
  * There is an example project available that demonstrates event group
  * connection technique: `examples/queue_eventgrp_conn`. Be sure to examine the
@@ -105,7 +112,9 @@
 
 #include "tn_list.h"
 #include "tn_common.h"
+#include "tn_wakeup_latency.h"
 #include "tn_sys.h"
+#include "tn_obj_registry.h"
 
 
 
@@ -218,6 +227,12 @@ struct TN_EventGrp {
    ///
    /// task wait queue
    struct TN_ListItem   wait_queue;
+#if TN_USE_SELECT || DOXYGEN_ACTIVE
+   ///
+   /// List of `tn_select()` items that wait for the event group,
+   /// available if only `#TN_USE_SELECT` option is non-zero.
+   struct TN_ListItem   select_queue;
+#endif
    ///
    /// current flags pattern
    TN_UWord             pattern;
@@ -229,6 +244,19 @@ struct TN_EventGrp {
    enum TN_EGrpAttr     attr;
 #endif
 
+#if TN_WAKEUP_LATENCY || DOXYGEN_ACTIVE
+   ///
+   /// Wake-up latency histogram, available if only `#TN_WAKEUP_LATENCY`
+   /// option is non-zero. See `#tn_wakeup_latency_obj_get()`
+   struct TN_WakeupLatency wakeup_latency;
+#endif
+#if TN_OBJ_REGISTRY || DOXYGEN_ACTIVE
+   ///
+   /// List item for the registry of kernel objects, available if only
+   /// `#TN_OBJ_REGISTRY` option is non-zero. See `#tn_obj_registry_next()`
+   struct TN_ListItem registry_item;
+#endif
+
 };
 
 /**
@@ -44,8 +44,13 @@
 #include "tn_sys.h"
 
 //-- internal tnkernel headers
+#include "_tn_eventgrp.h"
 #include "_tn_tasks.h"
 #include "_tn_list.h"
+#include "_tn_wakeup_latency.h"
+#include "_tn_obj_stats.h"
+#include "_tn_obj_registry.h"
+#include "_tn_select.h"
 
 
 //-- header of current module
@@ -188,6 +193,15 @@ _TN_STATIC_INLINE enum TN_RCode _fmem_get(struct TN_FMem *fmem, void **p_data)
       //-- And just decrement free blocks count.
       fmem->free_blocks_cnt--;
 
+      if (fmem->free_blocks_cnt == 0){
+         //-- clear flag in the connected event group (if any),
+         //   indicating that there are no free blocks in the pool
+         _tn_eventgrp_link_manage(&fmem->eventgrp_link, TN_FALSE);
+      }
+
+      _TN_OBJ_STATS_ACQUIRED(fmem);
+      _TN_OBJ_STATS_LEVEL(fmem, fmem->blocks_cnt - fmem->free_blocks_cnt);
+
       //-- Store pointer to newly allocated memory block to the user-provided
       //   location.
       *p_data = ptr;
@@ -225,12 +239,14 @@ _TN_STATIC_INLINE enum TN_RCode _fmem_release(struct TN_FMem *fmem, void *p_data
 {
    enum TN_RCode rc = TN_RC_OK;
 
-   //-- Check if there are tasks waiting for memory block. If there is,
+   //-- Check if there are tasks waiting for memory block (first, regular
+   //   waiters, then the ones waiting in tn_select()). If there is,
    //   give the block to the first task from the queue.
    if (  !_tn_task_first_wait_complete(
             &fmem->wait_queue, TN_RC_OK,
             _cb_before_task_wait_complete, p_data, TN_NULL
             )
+      && !_tn_select_first_complete(&fmem->select_queue, p_data)
       )
    {
       //-- no task is waiting for free memory block, so,
@@ -243,6 +259,12 @@ _TN_STATIC_INLINE enum TN_RCode _fmem_release(struct TN_FMem *fmem, void *p_data
          *(void **)p_data = fmem->free_list;
          fmem->free_list = p_data;
          fmem->free_blocks_cnt++;
+
+         if (fmem->free_blocks_cnt == 1){
+            //-- set flag in the connected event group (if any),
+            //   indicating that there are free blocks in the pool
+            _tn_eventgrp_link_manage(&fmem->eventgrp_link, TN_TRUE);
+         }
       } else {
 #if TN_DEBUG
          if (fmem->free_blocks_cnt > fmem->blocks_cnt){
@@ -254,6 +276,9 @@ _TN_STATIC_INLINE enum TN_RCode _fmem_release(struct TN_FMem *fmem, void *p_data
          //-- the memory pool already has all the blocks free
          rc = TN_RC_OVERFLOW;
       }
+   } else {
+      //-- memory block is taken by the waiting task
+      _TN_OBJ_STATS_ACQUIRED(fmem);
    }
 
    return rc;
@@ -319,6 +344,9 @@ enum TN_RCode tn_fmem_create(
 
    //-- reset wait_queue
    _tn_list_reset(&(fmem->wait_queue));
+#if TN_USE_SELECT
+   _tn_list_reset(&(fmem->select_queue));
+#endif
 
    //-- init block pointers
    {
@@ -339,9 +367,22 @@ enum TN_RCode tn_fmem_create(
       fmem->free_blocks_cnt = fmem->blocks_cnt;
    }
 
+   _tn_eventgrp_link_reset(&fmem->eventgrp_link);
+
+#if TN_WAKEUP_LATENCY
+   _tn_wakeup_latency_reset(&fmem->wakeup_latency);
+#endif
+#if TN_OBJ_STATS
+   _tn_obj_stats_create(&fmem->obj_stats, fmem);
+#endif
+
    //-- set id
    fmem->id_fmp = TN_ID_FSMEMORYPOOL;
 
+#if TN_OBJ_REGISTRY
+   _tn_obj_registry_add(TN_ID_FSMEMORYPOOL, &fmem->registry_item);
+#endif
+
 out:
    return rc;
 }
@@ -365,8 +406,15 @@ enum TN_RCode tn_fmem_delete(struct TN_FMem *fmem)
 
       //-- remove all tasks (if any) from fmem's wait queue
       _tn_wait_queue_notify_deleted(&(fmem->wait_queue));
+      _tn_select_notify_deleted(&(fmem->select_queue));
 
       fmem->id_fmp = TN_ID_NONE;   //-- Fixed-size memory pool does not exist now
+#if TN_OBJ_STATS
+      _tn_obj_stats_delete(&fmem->obj_stats);
+#endif
+#if TN_OBJ_REGISTRY
+      _tn_obj_registry_remove(&fmem->registry_item);
+#endif
 
       TN_INT_RESTORE();
 
@@ -564,3 +612,69 @@ int tn_fmem_used_blocks_cnt_get(struct TN_FMem *fmem)
    return ret;
 }
 
+/*
+ * See comments in the header file (tn_fmem.h)
+ */
+enum TN_RCode tn_fmem_eventgrp_connect(
+      struct TN_FMem      *fmem,
+      struct TN_EventGrp  *eventgrp,
+      TN_UWord             pattern
+      )
+{
+   TN_UWord sr_saved;
+   enum TN_RCode rc = _check_param_generic(fmem);
+
+   if (rc == TN_RC_OK){
+      sr_saved = tn_arch_sr_save_int_dis();
+      rc = _tn_eventgrp_link_set(&fmem->eventgrp_link, eventgrp, pattern);
+      if (rc == TN_RC_OK){
+         //-- set or clear flag(s) according to the current state
+         _tn_eventgrp_link_manage(
+               &fmem->eventgrp_link, (fmem->free_blocks_cnt > 0)
+               );
+      }
+      tn_arch_sr_restore(sr_saved);
+
+      //-- we might need to switch context if some task waiting for the
+      //   flag(s) has been woken up
+      _tn_context_switch_pend_if_needed();
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_fmem.h)
+ */
+enum TN_RCode tn_fmem_eventgrp_disconnect(
+      struct TN_FMem      *fmem
+      )
+{
+   TN_UWord sr_saved;
+   enum TN_RCode rc = _check_param_generic(fmem);
+
+   if (rc == TN_RC_OK){
+      sr_saved = tn_arch_sr_save_int_dis();
+      rc = _tn_eventgrp_link_reset(&fmem->eventgrp_link);
+      tn_arch_sr_restore(sr_saved);
+   }
+
+   return rc;
+}
+
+
+/*******************************************************************************
+ *    PROTECTED FUNCTIONS
+ ******************************************************************************/
+
+#if TN_USE_SELECT
+/**
+ * See comments in the file _tn_fmem.h
+ */
+enum TN_RCode _tn_fmem_select_try(struct TN_FMem *fmem, void **p_data)
+{
+   return _fmem_get(fmem, p_data);
+}
+#endif
+
+
@@ -63,6 +63,10 @@
 
 #include "tn_list.h"
 #include "tn_common.h"
+#include "tn_wakeup_latency.h"
+#include "tn_obj_stats.h"
+#include "tn_obj_registry.h"
+#include "tn_eventgrp.h"
 
 
 
@@ -86,6 +90,12 @@ struct TN_FMem {
    ///
    /// list of tasks waiting for free memory block
    struct TN_ListItem   wait_queue;
+#if TN_USE_SELECT || DOXYGEN_ACTIVE
+   ///
+   /// List of `tn_select()` items that wait for the free memory block,
+   /// available if only `#TN_USE_SELECT` option is non-zero.
+   struct TN_ListItem   select_queue;
+#endif
 
    ///
    /// block size (in bytes); note that it should be a multiple of
@@ -108,6 +118,27 @@ struct TN_FMem {
    /// pointer to the next free memory block as the first word, or `NULL` if
    /// this is the last block.
    void                *free_list;
+   ///
+   /// connected event group
+   struct TN_EGrpLink   eventgrp_link;
+#if TN_WAKEUP_LATENCY || DOXYGEN_ACTIVE
+   ///
+   /// Wake-up latency histogram, available if only `#TN_WAKEUP_LATENCY`
+   /// option is non-zero. See `#tn_wakeup_latency_obj_get()`
+   struct TN_WakeupLatency wakeup_latency;
+#endif
+#if TN_OBJ_STATS || DOXYGEN_ACTIVE
+   ///
+   /// Contention statistics, available if only `#TN_OBJ_STATS` option is
+   /// non-zero. See `#tn_obj_stats_get()`
+   struct _TN_ObjStats obj_stats;
+#endif
+#if TN_OBJ_REGISTRY || DOXYGEN_ACTIVE
+   ///
+   /// List item for the registry of kernel objects, available if only
+   /// `#TN_OBJ_REGISTRY` option is non-zero. See `#tn_obj_registry_next()`
+   struct TN_ListItem registry_item;
+#endif
 };
 
 
@@ -362,6 +393,53 @@ int tn_fmem_free_blocks_cnt_get(struct TN_FMem *fmem);
  */
 int tn_fmem_used_blocks_cnt_get(struct TN_FMem *fmem);
 
+/**
+ * Connect an event group to the memory pool.
+ * Refer to the section \ref eventgrp_connect for details.
+ *
+ * The flag(s) given in `pattern` are set while there is at least one free block in the pool, and
+ * cleared otherwise. The flags are brought in line with the current state of
+ * the memory pool right when the event group is connected.
+ *
+ * Only one event group can be connected to the memory pool at a time. If you
+ * connect event group while another event group is already connected,
+ * the old link is discarded.
+ *
+ * @param fmem
+ *    memory pool to which event group should be connected
+ * @param eventgrp 
+ *    event group to connect
+ * @param pattern
+ *    flags pattern that should be managed by the memory pool automatically
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ */
+enum TN_RCode tn_fmem_eventgrp_connect(
+      struct TN_FMem      *fmem,
+      struct TN_EventGrp  *eventgrp,
+      TN_UWord             pattern
+      );
+
+
+/**
+ * Disconnect a connected event group from the memory pool.
+ * Refer to the section \ref eventgrp_connect for details.
+ *
+ * If there is no event group connected, nothing is changed.
+ *
+ * @param fmem    memory pool from which event group should be disconnected
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_LEGEND_LINK)
+ */
+enum TN_RCode tn_fmem_eventgrp_disconnect(
+      struct TN_FMem      *fmem
+      );
+
 
 #ifdef __cplusplus
 }  /* extern "C" */
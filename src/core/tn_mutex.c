@@ -44,8 +44,14 @@
 
 //-- internal tnkernel headers
 #include "_tn_mutex.h"
+#include "_tn_rwlock.h"
+#include "_tn_rpc.h"
 #include "_tn_tasks.h"
 #include "_tn_list.h"
+#include "_tn_trace.h"
+#include "_tn_wakeup_latency.h"
+#include "_tn_obj_stats.h"
+#include "_tn_obj_registry.h"
 
 //-- header of current module
 #include "tn_mutex.h"
@@ -149,12 +155,14 @@ _TN_STATIC_INLINE enum TN_RCode _check_param_create(
 
 
 /**
- * Iterate through all the tasks that wait for locked mutex,
+ * Iterate through all the tasks that wait for locked mutex (or rwlock),
  * checking if task's priority is higher than ref_priority.
  *
  * Max priority (i.e. lowest value) is returned.
  */
-_TN_STATIC_INLINE int _find_max_blocked_priority(struct TN_Mutex *mutex, int ref_priority)
+_TN_STATIC_INLINE int _find_max_blocked_priority(
+      struct TN_ListItem *wait_queue, int ref_priority
+      )
 {
    int               priority;
    struct TN_Task   *task;
@@ -164,7 +172,7 @@ _TN_STATIC_INLINE int _find_max_blocked_priority(struct TN_Mutex *mutex, int ref
    //-- Iterate through all the tasks that wait for lock mutex.
    //   Highest priority (i.e. lowest number) will be returned eventually.
    _tn_list_for_each_entry(
-         task, struct TN_Task, &(mutex->wait_queue), task_queue
+         task, struct TN_Task, wait_queue, task_queue
          )
    {
       if (task->priority < priority){
@@ -200,7 +208,7 @@ _TN_STATIC_INLINE int _find_max_priority_by_mutex(
          //   we need to iterate through all the tasks that wait for 
          //   the mutex, checking if task's priority is higher than
          //   `ref_priority`.
-         priority = _find_max_blocked_priority(mutex, priority);
+         priority = _find_max_blocked_priority(&(mutex->wait_queue), priority);
          break;
 
       default:
@@ -223,6 +231,12 @@ _TN_STATIC_INLINE int _find_max_priority_by_mutex(
  *      and check if priority of each task is higher than
  *      our task's base priority
  *
+ * If `#TN_USE_RWLOCKS` is set, do the same for all the rwlocks that are held
+ * by task (for reading or writing): they always use priority inheritance.
+ *
+ * If `#TN_USE_RPC` is set, do the same for all the RPC objects whose calls
+ * are being served by task.
+ *
  * Eventually, find out highest priority and set it.
  */
 static void _update_task_priority(struct TN_Task *task)
@@ -247,6 +261,36 @@ static void _update_task_priority(struct TN_Task *task)
       }
    }
 
+#if TN_USE_RWLOCKS
+   {
+      struct TN_RWLockHold *hold;
+
+      //-- Iterate through all the rwlocks locked by given task
+      _tn_list_for_each_entry(
+            hold, struct TN_RWLockHold, &(task->rwlock_queue), rwlock_queue
+            )
+      {
+         priority = _find_max_blocked_priority(
+               &(hold->rwlock->wait_queue), priority
+               );
+      }
+   }
+#endif
+
+#if TN_USE_RPC
+   {
+      struct TN_RPC *rpc;
+
+      //-- Iterate through all the RPC objects served by given task
+      _tn_list_for_each_entry(
+            rpc, struct TN_RPC, &(task->rpc_queue), rpc_queue
+            )
+      {
+         priority = _find_max_blocked_priority(&(rpc->wait_queue), priority);
+      }
+   }
+#endif
+
    //-- New priority determined, set it
    if (priority != task->priority){
       _tn_change_task_priority(task, priority);
@@ -305,6 +349,33 @@ in:
          task = _get_mutex_by_wait_queque(task->pwait_queue)->holder;
          goto in;
       }
+#if TN_USE_RWLOCKS
+      else if (   (_tn_task_is_waiting(task))
+               && (     (task->task_wait_reason == TN_WAIT_REASON_RWLOCK_R)
+                     || (task->task_wait_reason == TN_WAIT_REASON_RWLOCK_W)
+                  )
+              )
+      {
+         //-- Task is waiting for the rwlock, which might have several
+         //   holders (readers), and all of them should inherit the
+         //   priority. So, there is no tail recursion here.
+         _tn_rwlock_holders_priority_elevate(task->pwait_queue, priority);
+      }
+#endif
+#if TN_USE_RPC
+      else if (   (_tn_task_is_waiting(task))
+               && (     (task->task_wait_reason == TN_WAIT_REASON_RPC_CALL)
+                     || (task->task_wait_reason == TN_WAIT_REASON_RPC_REPLY)
+                  )
+               && (_tn_rpc_server_get(task->pwait_queue) != TN_NULL)
+              )
+      {
+         //-- Task is waiting for the RPC object which is being served by
+         //   some task: go on to the server, the same way as for the mutex.
+         task = _tn_rpc_server_get(task->pwait_queue);
+         goto in;
+      }
+#endif
    }
 
 }
@@ -313,6 +384,9 @@ _TN_STATIC_INLINE void _mutex_do_lock(struct TN_Mutex *mutex, struct TN_Task *ta
 {
    mutex->holder = task;
    __mutex_lock_cnt_change(mutex, 1);
+   _TN_OBJ_STATS_ACQUIRED(mutex);
+
+   _TN_TRACE(TN_TRACE_EV_MUTEX_LOCK, 0, mutex, task);
 
    //-- Add mutex to task's locked mutexes queue
    _tn_list_add_tail(&(task->mutex_queue), &(mutex->mutex_queue));
@@ -535,6 +609,8 @@ _TN_STATIC_INLINE void _add_curr_task_to_mutex_wait_queue(
  */
 static void _mutex_do_unlock(struct TN_Mutex * mutex)
 {
+   _TN_TRACE(TN_TRACE_EV_MUTEX_UNLOCK, 0, mutex, mutex->holder);
+
    //-- explicitly reset lock count to 0, because it might be not zero
    //   if mutex is unlocked because task is being deleted.
    mutex->cnt = 0;
@@ -690,6 +766,18 @@ enum TN_RCode tn_mutex_create(
       mutex->ceil_priority = ceil_priority;
       mutex->cnt           = 0;
       mutex->id_mutex      = TN_ID_MUTEX;
+
+#if TN_WAKEUP_LATENCY
+      _tn_wakeup_latency_reset(&mutex->wakeup_latency);
+#endif
+#if TN_OBJ_STATS
+      _tn_obj_stats_create(&mutex->obj_stats, mutex);
+#endif
+#if TN_OBJ_REGISTRY
+      _tn_obj_registry_add(TN_ID_MUTEX, &mutex->registry_item);
+#endif
+
+      _TN_TRACE(TN_TRACE_EV_MUTEX_CREATE, protocol, mutex, ceil_priority);
    }
 
    return rc;
@@ -731,6 +819,14 @@ enum TN_RCode tn_mutex_delete(struct TN_Mutex *mutex)
          }
 
          mutex->id_mutex = TN_ID_NONE; //-- mutex does not exist now
+#if TN_OBJ_STATS
+         _tn_obj_stats_delete(&mutex->obj_stats);
+#endif
+#if TN_OBJ_REGISTRY
+         _tn_obj_registry_remove(&mutex->registry_item);
+#endif
+
+         _TN_TRACE(TN_TRACE_EV_MUTEX_DELETE, 0, mutex, 0);
 
       }
 
@@ -949,6 +1045,73 @@ void _tn_mutex_on_task_wait_complete(struct TN_Task *task)
          );
 }
 
+/**
+ * See comments in _tn_mutex.h file
+ */
+void _tn_mutex_task_priority_update(struct TN_Task *task)
+{
+   _update_task_priority(task);
+
+   //-- if the task waits for a mutex with priority inheritance, its new
+   //   priority affects the holder of that mutex, and so on.
+   if (     (_tn_task_is_waiting(task))
+         && (task->task_wait_reason == TN_WAIT_REASON_MUTEX_I)
+      )
+   {
+      _update_holders_priority_recursive(task);
+   }
+}
+
+/**
+ * See comments in _tn_mutex.h file
+ */
+void _tn_mutex_task_priority_elevate(struct TN_Task *task, int priority)
+{
+   _task_priority_elevate(task, priority);
+}
+
+/**
+ * See comments in _tn_mutex.h file
+ */
+void _tn_mutex_release(struct TN_Mutex *mutex)
+{
+   _mutex_do_unlock(mutex);
+}
+
+/**
+ * See comments in _tn_mutex.h file
+ */
+void _tn_mutex_wait_transfer(struct TN_Mutex *mutex, struct TN_Task *task)
+{
+   if (mutex->holder == TN_NULL){
+      //-- mutex is free: wake the task up and lock mutex by it right away
+      _tn_task_wait_complete(task, TN_RC_OK);
+      _mutex_do_lock(mutex, task);
+   } else {
+      enum TN_WaitReason wait_reason;
+
+      if (mutex->protocol == TN_MUTEX_PROT_INHERIT){
+         //-- Priority inheritance protocol
+         if (task->priority < mutex->holder->priority){
+            _task_priority_elevate(mutex->holder, task->priority);
+         }
+
+         wait_reason = TN_WAIT_REASON_MUTEX_I;
+      } else {
+         //-- Priority ceiling protocol
+         wait_reason = TN_WAIT_REASON_MUTEX_C;
+      }
+
+      //-- task keeps waiting, but now for the mutex
+      _tn_task_wait_move(
+            task, &(mutex->wait_queue), wait_reason, TN_WAIT_INFINITE
+            );
+
+      //-- check if there is deadlock
+      _check_deadlock_active(mutex, task);
+   }
+}
+
 
 #endif //-- TN_USE_MUTEXES
 
@@ -92,6 +92,9 @@
 
 #include "tn_list.h"
 #include "tn_common.h"
+#include "tn_wakeup_latency.h"
+#include "tn_obj_stats.h"
+#include "tn_obj_registry.h"
 
 
 
@@ -150,6 +153,24 @@ struct TN_Mutex {
    ///
    /// Lock count (for recursive locking)
    int cnt;
+#if TN_WAKEUP_LATENCY || DOXYGEN_ACTIVE
+   ///
+   /// Wake-up latency histogram, available if only `#TN_WAKEUP_LATENCY`
+   /// option is non-zero. See `#tn_wakeup_latency_obj_get()`
+   struct TN_WakeupLatency wakeup_latency;
+#endif
+#if TN_OBJ_STATS || DOXYGEN_ACTIVE
+   ///
+   /// Contention statistics, available if only `#TN_OBJ_STATS` option is
+   /// non-zero. See `#tn_obj_stats_get()`
+   struct _TN_ObjStats obj_stats;
+#endif
+#if TN_OBJ_REGISTRY || DOXYGEN_ACTIVE
+   ///
+   /// List item for the registry of kernel objects, available if only
+   /// `#TN_OBJ_REGISTRY` option is non-zero. See `#tn_obj_registry_next()`
+   struct TN_ListItem registry_item;
+#endif
 };
 
 /*******************************************************************************
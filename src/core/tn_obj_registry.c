@@ -0,0 +1,589 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+//-- common tnkernel headers
+#include "tn_common.h"
+#include "tn_sys.h"
+
+//-- internal tnkernel headers
+#include "_tn_sys.h"
+#include "_tn_list.h"
+#include "_tn_timer.h"
+
+#include "tn_tasks.h"
+#include "tn_sem.h"
+#include "tn_mutex.h"
+#include "tn_dqueue.h"
+#include "tn_eventgrp.h"
+#include "tn_fmem.h"
+#include "tn_timer.h"
+#include "tn_rwlock.h"
+#include "tn_condvar.h"
+#include "tn_rpc.h"
+
+//-- header of current module
+#include "tn_obj_registry.h"
+#include "_tn_obj_registry.h"
+
+
+#if TN_OBJ_REGISTRY
+
+
+
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+/**
+ * Indexes of the registry lists (tasks are tracked by the kernel anyway, see
+ * `#_tn_tasks_created_list`)
+ */
+enum _RegistryIdx {
+   _REG_IDX_SEM,
+   _REG_IDX_MUTEX,
+   _REG_IDX_DQUEUE,
+   _REG_IDX_EVENTGRP,
+   _REG_IDX_FMEM,
+   _REG_IDX_TIMER,
+   _REG_IDX_RWLOCK,
+   _REG_IDX_CONDVAR,
+   _REG_IDX_RPC,
+
+   _REG_IDX_CNT
+};
+
+/**
+ * Static initializer of the empty list
+ */
+#define _LIST_INIT(idx)    { &_registry_lists[idx], &_registry_lists[idx] }
+
+/**
+ * Number of words in the snapshot header and record, respectively
+ */
+#define _HDR_WORDS_CNT     (sizeof(struct TN_ObjRegistrySnapshotHdr) / sizeof(TN_UWord))
+#define _REC_WORDS_CNT     (sizeof(struct TN_ObjRegistryRec) / sizeof(TN_UWord))
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+/// Registry lists, see `enum _RegistryIdx`. They are initialized statically,
+/// since objects might be created before `#tn_sys_start()`.
+static struct TN_ListItem _registry_lists[ _REG_IDX_CNT ] = {
+   _LIST_INIT(_REG_IDX_SEM),
+   _LIST_INIT(_REG_IDX_MUTEX),
+   _LIST_INIT(_REG_IDX_DQUEUE),
+   _LIST_INIT(_REG_IDX_EVENTGRP),
+   _LIST_INIT(_REG_IDX_FMEM),
+   _LIST_INIT(_REG_IDX_TIMER),
+   _LIST_INIT(_REG_IDX_RWLOCK),
+   _LIST_INIT(_REG_IDX_CONDVAR),
+   _LIST_INIT(_REG_IDX_RPC),
+};
+
+/// Order of types in the snapshot
+static const enum TN_ObjId _snapshot_types[] = {
+   TN_ID_TASK,
+   TN_ID_SEMAPHORE,
+   TN_ID_MUTEX,
+   TN_ID_DATAQUEUE,
+   TN_ID_EVENTGRP,
+   TN_ID_FSMEMORYPOOL,
+   TN_ID_TIMER,
+   TN_ID_RWLOCK,
+   TN_ID_CONDVAR,
+   TN_ID_RPC,
+};
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+/**
+ * Returns the list of objects of the given type, or `#TN_NULL` if the type
+ * is wrong.
+ */
+static struct TN_ListItem *_list_get(enum TN_ObjId type)
+{
+   struct TN_ListItem *ret = TN_NULL;
+
+   switch (type){
+      case TN_ID_TASK:
+         ret = &_tn_tasks_created_list;
+         break;
+      case TN_ID_SEMAPHORE:
+         ret = &_registry_lists[_REG_IDX_SEM];
+         break;
+      case TN_ID_MUTEX:
+         ret = &_registry_lists[_REG_IDX_MUTEX];
+         break;
+      case TN_ID_DATAQUEUE:
+         ret = &_registry_lists[_REG_IDX_DQUEUE];
+         break;
+      case TN_ID_EVENTGRP:
+         ret = &_registry_lists[_REG_IDX_EVENTGRP];
+         break;
+      case TN_ID_FSMEMORYPOOL:
+         ret = &_registry_lists[_REG_IDX_FMEM];
+         break;
+      case TN_ID_TIMER:
+         ret = &_registry_lists[_REG_IDX_TIMER];
+         break;
+      case TN_ID_RWLOCK:
+         ret = &_registry_lists[_REG_IDX_RWLOCK];
+         break;
+      case TN_ID_CONDVAR:
+         ret = &_registry_lists[_REG_IDX_CONDVAR];
+         break;
+      case TN_ID_RPC:
+         ret = &_registry_lists[_REG_IDX_RPC];
+         break;
+      default:
+         //-- wrong type
+         break;
+   }
+
+   return ret;
+}
+
+/**
+ * Returns the object which contains the given list item.
+ */
+static const void *_obj_by_item(enum TN_ObjId type, struct TN_ListItem *item)
+{
+   const void *ret = TN_NULL;
+
+   switch (type){
+      case TN_ID_TASK:
+         ret = container_of(item, struct TN_Task, create_queue);
+         break;
+      case TN_ID_SEMAPHORE:
+         ret = container_of(item, struct TN_Sem, registry_item);
+         break;
+      case TN_ID_MUTEX:
+         ret = container_of(item, struct TN_Mutex, registry_item);
+         break;
+      case TN_ID_DATAQUEUE:
+         ret = container_of(item, struct TN_DQueue, registry_item);
+         break;
+      case TN_ID_EVENTGRP:
+         ret = container_of(item, struct TN_EventGrp, registry_item);
+         break;
+      case TN_ID_FSMEMORYPOOL:
+         ret = container_of(item, struct TN_FMem, registry_item);
+         break;
+      case TN_ID_TIMER:
+         ret = container_of(item, struct TN_Timer, registry_item);
+         break;
+      case TN_ID_RWLOCK:
+         ret = container_of(item, struct TN_RWLock, registry_item);
+         break;
+      case TN_ID_CONDVAR:
+         ret = container_of(item, struct TN_CondVar, registry_item);
+         break;
+      case TN_ID_RPC:
+         ret = container_of(item, struct TN_RPC, registry_item);
+         break;
+      default:
+         //-- wrong type
+         break;
+   }
+
+   return ret;
+}
+
+/**
+ * Returns registry list item of the given object, or `#TN_NULL` if the
+ * object isn't valid (say, it is deleted).
+ */
+static struct TN_ListItem *_item_by_obj(enum TN_ObjId type, const void *obj)
+{
+   struct TN_ListItem *ret = TN_NULL;
+
+   switch (type){
+      case TN_ID_TASK:
+         if (((struct TN_Task *)obj)->id_task == TN_ID_TASK){
+            ret = &((struct TN_Task *)obj)->create_queue;
+         }
+         break;
+      case TN_ID_SEMAPHORE:
+         if (((struct TN_Sem *)obj)->id_sem == TN_ID_SEMAPHORE){
+            ret = &((struct TN_Sem *)obj)->registry_item;
+         }
+         break;
+      case TN_ID_MUTEX:
+         if (((struct TN_Mutex *)obj)->id_mutex == TN_ID_MUTEX){
+            ret = &((struct TN_Mutex *)obj)->registry_item;
+         }
+         break;
+      case TN_ID_DATAQUEUE:
+         if (((struct TN_DQueue *)obj)->id_dque == TN_ID_DATAQUEUE){
+            ret = &((struct TN_DQueue *)obj)->registry_item;
+         }
+         break;
+      case TN_ID_EVENTGRP:
+         if (((struct TN_EventGrp *)obj)->id_event == TN_ID_EVENTGRP){
+            ret = &((struct TN_EventGrp *)obj)->registry_item;
+         }
+         break;
+      case TN_ID_FSMEMORYPOOL:
+         if (((struct TN_FMem *)obj)->id_fmp == TN_ID_FSMEMORYPOOL){
+            ret = &((struct TN_FMem *)obj)->registry_item;
+         }
+         break;
+      case TN_ID_TIMER:
+         if (((struct TN_Timer *)obj)->id_timer == TN_ID_TIMER){
+            ret = &((struct TN_Timer *)obj)->registry_item;
+         }
+         break;
+      case TN_ID_RWLOCK:
+         if (((struct TN_RWLock *)obj)->id_rwlock == TN_ID_RWLOCK){
+            ret = &((struct TN_RWLock *)obj)->registry_item;
+         }
+         break;
+      case TN_ID_CONDVAR:
+         if (((struct TN_CondVar *)obj)->id_condvar == TN_ID_CONDVAR){
+            ret = &((struct TN_CondVar *)obj)->registry_item;
+         }
+         break;
+      case TN_ID_RPC:
+         if (((struct TN_RPC *)obj)->id_rpc == TN_ID_RPC){
+            ret = &((struct TN_RPC *)obj)->registry_item;
+         }
+         break;
+      default:
+         //-- wrong type
+         break;
+   }
+
+   return ret;
+}
+
+/**
+ * Returns the number of items in the list (say, number of tasks waiting
+ * in the wait queue)
+ */
+static TN_UWord _list_items_cnt(struct TN_ListItem *list)
+{
+   TN_UWord ret = 0;
+   struct TN_ListItem *item;
+
+   for (item = list->next; item != list; item = item->next){
+      ret++;
+   }
+
+   return ret;
+}
+
+/**
+ * Fill the snapshot record for the given object; interrupts should be
+ * disabled.
+ */
+static void _rec_fill(
+      struct TN_ObjRegistryRec  *rec,
+      enum TN_ObjId              type,
+      const void                *obj
+      )
+{
+   TN_UWord *args = rec->args;
+
+   rec->id  = (TN_UWord)type;
+   rec->obj = (TN_UWord)(TN_UIntPtr)obj;
+   args[0] = args[1] = args[2] = args[3] = 0;
+
+   switch (type){
+      case TN_ID_TASK:
+         {
+            const struct TN_Task *task = obj;
+            args[0] = (TN_UWord)task->priority;
+            args[1] = (TN_UWord)task->task_state;
+            args[2] = (TN_UWord)task->task_wait_reason;
+            args[3] = (TN_UWord)(task->stack_high_addr - task->stack_low_addr + 1);
+         }
+         break;
+      case TN_ID_SEMAPHORE:
+         {
+            struct TN_Sem *sem = (struct TN_Sem *)obj;
+            args[0] = (TN_UWord)sem->count;
+            args[1] = (TN_UWord)sem->max_count;
+            args[2] = _list_items_cnt(&sem->wait_queue);
+         }
+         break;
+      case TN_ID_MUTEX:
+         {
+            struct TN_Mutex *mutex = (struct TN_Mutex *)obj;
+            args[0] = (TN_UWord)(TN_UIntPtr)mutex->holder;
+            args[1] = (TN_UWord)mutex->cnt;
+            args[2] = (TN_UWord)mutex->protocol;
+            args[3] = _list_items_cnt(&mutex->wait_queue);
+         }
+         break;
+      case TN_ID_DATAQUEUE:
+         {
+            struct TN_DQueue *dque = (struct TN_DQueue *)obj;
+            args[0] = (TN_UWord)dque->items_cnt;
+            args[1] = (TN_UWord)dque->filled_items_cnt;
+            args[2] = _list_items_cnt(&dque->wait_send_list);
+            args[3] = _list_items_cnt(&dque->wait_receive_list);
+         }
+         break;
+      case TN_ID_EVENTGRP:
+         {
+            struct TN_EventGrp *eventgrp = (struct TN_EventGrp *)obj;
+            args[0] = eventgrp->pattern;
+            args[1] = _list_items_cnt(&eventgrp->wait_queue);
+         }
+         break;
+      case TN_ID_FSMEMORYPOOL:
+         {
+            struct TN_FMem *fmem = (struct TN_FMem *)obj;
+            args[0] = (TN_UWord)fmem->block_size;
+            args[1] = (TN_UWord)fmem->blocks_cnt;
+            args[2] = (TN_UWord)fmem->free_blocks_cnt;
+            args[3] = _list_items_cnt(&fmem->wait_queue);
+         }
+         break;
+      case TN_ID_TIMER:
+         {
+            struct TN_Timer *timer = (struct TN_Timer *)obj;
+            args[0] = (TN_UWord)(TN_UIntPtr)timer->func;
+            args[1] = (TN_UWord)(TN_UIntPtr)timer->p_user_data;
+            args[2] = !!_tn_timer_is_active(timer);
+            args[3] = (TN_UWord)_tn_timer_time_left(timer);
+         }
+         break;
+      case TN_ID_RWLOCK:
+         {
+            struct TN_RWLock *rwlock = (struct TN_RWLock *)obj;
+            args[0] = (TN_UWord)(TN_UIntPtr)rwlock->writer;
+            args[1] = (TN_UWord)rwlock->readers_cnt;
+            args[2] = (TN_UWord)rwlock->holds_cnt;
+            args[3] = _list_items_cnt(&rwlock->wait_queue);
+         }
+         break;
+      case TN_ID_CONDVAR:
+         {
+            struct TN_CondVar *condvar = (struct TN_CondVar *)obj;
+            args[0] = (TN_UWord)(TN_UIntPtr)condvar->mutex;
+            args[1] = _list_items_cnt(&condvar->wait_queue);
+         }
+         break;
+      case TN_ID_RPC:
+         {
+            struct TN_RPC *rpc = (struct TN_RPC *)obj;
+            args[0] = (TN_UWord)(TN_UIntPtr)rpc->server;
+            args[1] = (TN_UWord)(TN_UIntPtr)rpc->client;
+            args[2] = _list_items_cnt(&rpc->wait_queue);
+            args[3] = _list_items_cnt(&rpc->server_wait_queue);
+         }
+         break;
+      default:
+         break;
+   }
+}
+
+/**
+ * Actual worker function for `#tn_obj_registry_next()`; interrupts should
+ * be disabled.
+ */
+static const void *_next_get(enum TN_ObjId type, const void *obj)
+{
+   const void *ret = TN_NULL;
+   struct TN_ListItem *list = _list_get(type);
+   struct TN_ListItem *item = TN_NULL;
+
+   if (list == TN_NULL){
+      //-- wrong type
+   } else if (obj == TN_NULL){
+      item = list->next;
+   } else {
+      struct TN_ListItem *obj_item = _item_by_obj(type, obj);
+
+      //-- if the object is deleted (its id is reset), we can't go on
+      if (obj_item != TN_NULL){
+         item = obj_item->next;
+      }
+   }
+
+   if (item != TN_NULL && item != list){
+      ret = _obj_by_item(type, item);
+   }
+
+   return ret;
+}
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC FUNCTIONS
+ ******************************************************************************/
+
+/*
+ * See comments in the header file (tn_obj_registry.h)
+ */
+const void *tn_obj_registry_next(enum TN_ObjId type, const void *obj)
+{
+   const void *ret;
+   TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+
+   ret = _next_get(type, obj);
+
+   tn_arch_sr_restore(sr_saved);
+
+   return ret;
+}
+
+/*
+ * See comments in the header file (tn_obj_registry.h)
+ */
+unsigned int tn_obj_registry_snapshot(TN_UWord *buf, unsigned int words_cnt)
+{
+   unsigned int ret = 0;
+
+   if (buf != TN_NULL && words_cnt >= _HDR_WORDS_CNT){
+      struct TN_ObjRegistrySnapshotHdr *hdr
+         = (struct TN_ObjRegistrySnapshotHdr *)buf;
+      struct TN_ObjRegistryRec *rec
+         = (struct TN_ObjRegistryRec *)(buf + _HDR_WORDS_CNT);
+      unsigned int recs_max = (words_cnt - _HDR_WORDS_CNT) / _REC_WORDS_CNT;
+      unsigned int i;
+
+      hdr->magic     = TN_OBJ_REGISTRY_MAGIC;
+      hdr->version   = TN_OBJ_REGISTRY_FORMAT_VERSION;
+      hdr->recs_cnt  = 0;
+      hdr->objs_cnt  = 0;
+      hdr->flags     = 0;
+
+      for (i = 0; i < sizeof(_snapshot_types) / sizeof(_snapshot_types[0]); i++){
+         enum TN_ObjId type = _snapshot_types[i];
+         const void *obj = TN_NULL;
+
+         for (;;){
+            TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+
+            if (obj != TN_NULL && _item_by_obj(type, obj) == TN_NULL){
+               //-- previous object was deleted while interrupts were
+               //   enabled, so we can't get to the next one: the rest of
+               //   objects of this type are missed
+               hdr->flags |= TN_OBJ_REGISTRY_SNAPSHOT_FLAG_INCOMPLETE;
+               obj = TN_NULL;
+            } else {
+               obj = _next_get(type, obj);
+            }
+
+            if (obj != TN_NULL){
+               if (hdr->recs_cnt < recs_max){
+                  _rec_fill(rec, type, obj);
+                  rec++;
+                  hdr->recs_cnt++;
+               }
+               hdr->objs_cnt++;
+            }
+
+            tn_arch_sr_restore(sr_saved);
+
+            if (obj == TN_NULL){
+               break;
+            }
+         }
+      }
+
+      ret = _HDR_WORDS_CNT + hdr->recs_cnt * _REC_WORDS_CNT;
+   }
+
+   return ret;
+}
+
+
+
+
+/*******************************************************************************
+ *    PROTECTED FUNCTIONS
+ ******************************************************************************/
+
+/*
+ * See comments in the file _tn_obj_registry.h
+ */
+void _tn_obj_registry_add(
+      enum TN_ObjId        type,
+      struct TN_ListItem  *registry_item
+      )
+{
+   struct TN_ListItem *list = _list_get(type);
+
+#if TN_DEBUG
+   if (list == TN_NULL || type == TN_ID_TASK){
+      _TN_FATAL_ERROR("wrong object type for registry");
+   }
+#endif
+
+   {
+      TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+      _tn_list_add_tail(list, registry_item);
+      tn_arch_sr_restore(sr_saved);
+   }
+}
+
+/*
+ * See comments in the file _tn_obj_registry.h
+ */
+void _tn_obj_registry_remove(struct TN_ListItem *registry_item)
+{
+   _tn_list_remove_entry(registry_item);
+   _tn_list_reset(registry_item);
+}
+
+
+#endif // TN_OBJ_REGISTRY
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
@@ -0,0 +1,253 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/**
+ * \file
+ *
+ * Registry of kernel objects, available if only `#TN_OBJ_REGISTRY` option is
+ * non-zero.
+ *
+ * Normally, the kernel keeps track of created tasks only. When
+ * `#TN_OBJ_REGISTRY` is non-zero, each semaphore, mutex, data queue, event
+ * group, fixed memory pool, timer, rwlock, condition variable and RPC object
+ * contains a list item, and the kernel keeps all the existing objects of
+ * each type in a list, maintained on create and delete. So, the application
+ * (say, a monitoring shell) can enumerate all objects by
+ * `#tn_obj_registry_next()`, and report their state.
+ *
+ * Additionally, the compact binary snapshot of all the objects can be made by
+ * `#tn_obj_registry_snapshot()`, and sent to the host by any means. The
+ * snapshot layout follows the idea of the kernel trace buffer (see
+ * tn_trace.h): it starts with a small header (`struct
+ * #TN_ObjRegistrySnapshotHdr`) which allows the host tool to figure out the
+ * word size and endianness, followed by records (`struct
+ * #TN_ObjRegistryRec`). The decoder is `stuff/tntrace/tnobjreg.py`.
+ *
+ * When the option is zero, objects don't contain any additional fields, and
+ * creating/deleting objects isn't affected at all.
+ */
+
+#ifndef _TN_OBJ_REGISTRY_H
+#define _TN_OBJ_REGISTRY_H
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "../arch/tn_arch.h"
+#include "tn_common.h"
+
+
+
+#ifdef __cplusplus
+extern "C"  {     /*}*/
+#endif
+
+/*******************************************************************************
+ *    PUBLIC TYPES
+ ******************************************************************************/
+
+/**
+ * Single record of the registry snapshot, see `#tn_obj_registry_snapshot()`.
+ *
+ * Meaning of `args` depends on the object type:
+ *
+ * type                  | `args[0]`       | `args[1]`          | `args[2]`         | `args[3]`
+ * ----------------------|-----------------|--------------------|-------------------|-----------------
+ * `#TN_ID_TASK`         | priority        | `enum #TN_TaskState` | `enum #TN_WaitReason` | stack size, in words
+ * `#TN_ID_SEMAPHORE`    | count           | max count          | waiting tasks     | 0
+ * `#TN_ID_MUTEX`        | holder task     | lock count         | `enum #TN_MutexProtocol` | waiting tasks
+ * `#TN_ID_DATAQUEUE`    | capacity        | filled items       | tasks waiting to send | tasks waiting to receive
+ * `#TN_ID_EVENTGRP`     | pattern         | waiting tasks      | 0                 | 0
+ * `#TN_ID_FSMEMORYPOOL` | block size, in bytes | blocks count  | free blocks       | waiting tasks
+ * `#TN_ID_TIMER`        | timer function  | user data          | 1 if active, 0 otherwise | ticks left
+ * `#TN_ID_RWLOCK`       | writer task     | readers count      | holds count       | waiting tasks
+ * `#TN_ID_CONDVAR`      | mutex of waiters | waiting tasks     | 0                 | 0
+ * `#TN_ID_RPC`          | server task     | client task        | waiting clients (including the one waiting for reply) | waiting servers
+ */
+struct TN_ObjRegistryRec {
+   ///
+   /// Object type, `enum #TN_ObjId`
+   TN_UWord       id;
+   ///
+   /// Address of the object
+   TN_UWord       obj;
+   ///
+   /// Object state, see the table above
+   TN_UWord       args[4];
+};
+
+/**
+ * Header of the registry snapshot, followed by `recs_cnt` records `struct
+ * #TN_ObjRegistryRec`. All fields are machine words, so that the decoder is
+ * able to figure out the word size and endianness by the `magic` value.
+ */
+struct TN_ObjRegistrySnapshotHdr {
+   ///
+   /// Always equals to `#TN_OBJ_REGISTRY_MAGIC`
+   TN_UWord       magic;
+   ///
+   /// Format version, `#TN_OBJ_REGISTRY_FORMAT_VERSION`
+   TN_UWord       version;
+   ///
+   /// Number of records which follow the header
+   TN_UWord       recs_cnt;
+   ///
+   /// Number of objects that exist; if it is larger than `recs_cnt`, then
+   /// the buffer given to `#tn_obj_registry_snapshot()` was too small.
+   TN_UWord       objs_cnt;
+   ///
+   /// Bitmask of `TN_OBJ_REGISTRY_SNAPSHOT_FLAG_...` values, available since
+   /// format version 3.
+   TN_UWord       flags;
+};
+
+
+
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+/**
+ * Value of `magic` field of `struct #TN_ObjRegistrySnapshotHdr` (on 16-bit
+ * platforms, it is truncated to the lower 16 bits)
+ */
+#define  TN_OBJ_REGISTRY_MAGIC            ((TN_UWord)0x524F4E54UL)
+
+/**
+ * Current snapshot format version. Version 2 has added records for rwlocks,
+ * condition variables and RPC objects; the layout is the same. Version 3 has
+ * added the `flags` field to the header.
+ */
+#define  TN_OBJ_REGISTRY_FORMAT_VERSION   3
+
+/**
+ * Flag of `struct #TN_ObjRegistrySnapshotHdr`: some object was deleted
+ * while the snapshot was being made, so the rest of objects of that type are
+ * missed (and not counted in `objs_cnt`). See `#tn_obj_registry_snapshot()`.
+ */
+#define  TN_OBJ_REGISTRY_SNAPSHOT_FLAG_INCOMPLETE   (1 << 0)
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC FUNCTION PROTOTYPES
+ ******************************************************************************/
+
+#if TN_OBJ_REGISTRY || DOXYGEN_ACTIVE
+
+/**
+ * Iterate over all existing objects of the given type, in the order of
+ * creation:
+ *
+ * \code{.c}
+ *    const void *obj = TN_NULL;
+ *
+ *    while ((obj = tn_obj_registry_next(TN_ID_MUTEX, obj)) != TN_NULL){
+ *       const struct TN_Mutex *mutex = obj;
+ *       //-- ...
+ *    }
+ * \endcode
+ *
+ * If the object given as `obj` is deleted before this function is called,
+ * the iteration stops (`#TN_NULL` is returned).
+ *
+ * Available if only `#TN_OBJ_REGISTRY` option is non-zero.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_CALL_FROM_MAIN)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param type
+ *    Type of objects: `#TN_ID_TASK`, `#TN_ID_SEMAPHORE`, `#TN_ID_MUTEX`,
+ *    `#TN_ID_DATAQUEUE`, `#TN_ID_EVENTGRP`, `#TN_ID_FSMEMORYPOOL`,
+ *    `#TN_ID_TIMER`, `#TN_ID_RWLOCK`, `#TN_ID_CONDVAR` or `#TN_ID_RPC`
+ * @param obj
+ *    Previous object returned by this function, or `#TN_NULL` to get the
+ *    first one
+ *
+ * @return
+ *    Next object, or `#TN_NULL` if there are no more objects (or if `type`
+ *    is wrong).
+ */
+const void *tn_obj_registry_next(enum TN_ObjId type, const void *obj);
+
+/**
+ * Make the binary snapshot of all existing objects: tasks, semaphores,
+ * mutexes, data queues, event groups, fixed memory pools, timers, rwlocks,
+ * condition variables and RPC objects (in this order), see `struct
+ * #TN_ObjRegistrySnapshotHdr`.
+ *
+ * Each record is made with interrupts disabled, but interrupts are enabled
+ * between records, so the snapshot isn't atomic as a whole; and if an object
+ * is deleted while the snapshot is being made, the rest of objects of that
+ * type are missed: then, `#TN_OBJ_REGISTRY_SNAPSHOT_FLAG_INCOMPLETE` is set
+ * in the header. Just make the snapshot again if it matters.
+ *
+ * Available if only `#TN_OBJ_REGISTRY` option is non-zero.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_MAIN)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param buf
+ *    Buffer to write snapshot to
+ * @param words_cnt
+ *    Size of the buffer, in words (`#TN_UWord`)
+ *
+ * @return
+ *    Number of words written; 0 if the buffer is too small even for the
+ *    header.
+ */
+unsigned int tn_obj_registry_snapshot(TN_UWord *buf, unsigned int words_cnt);
+
+#endif   // TN_OBJ_REGISTRY
+
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+
+#endif // _TN_OBJ_REGISTRY_H
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
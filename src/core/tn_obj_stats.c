@@ -0,0 +1,430 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+//-- common tnkernel headers
+#include "tn_common.h"
+#include "tn_sys.h"
+
+//-- internal tnkernel headers
+#include "_tn_sys.h"
+#include "_tn_list.h"
+
+#include "tn_tasks.h"
+#include "tn_sem.h"
+#include "tn_mutex.h"
+#include "tn_dqueue.h"
+#include "tn_fmem.h"
+#include "tn_rwlock.h"
+#include "tn_condvar.h"
+#include "tn_rpc.h"
+
+//-- header of current module
+#include "tn_obj_stats.h"
+#include "_tn_obj_stats.h"
+
+//-- std header for memset() and memcpy()
+#include <string.h>
+
+
+#if TN_OBJ_STATS
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+/// List of all objects with statistics, see `#tn_obj_stats_next()`.
+/// It is initialized statically, since objects might be created before
+/// `#tn_sys_start()`.
+static struct TN_ListItem _obj_stats_list = {
+   &_obj_stats_list,    //-- prev
+   &_obj_stats_list,    //-- next
+};
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+//-- Additional param checking {{{
+#if TN_CHECK_PARAM
+_TN_STATIC_INLINE enum TN_RCode _check_param_get(
+      const void                 *obj,
+      const struct TN_ObjStats   *tgt
+      )
+{
+   enum TN_RCode rc = TN_RC_OK;
+
+   if (obj == TN_NULL || tgt == TN_NULL){
+      rc = TN_RC_WPARAM;
+   }
+
+   return rc;
+}
+
+_TN_STATIC_INLINE enum TN_RCode _check_param_reset(const void *obj)
+{
+   enum TN_RCode rc = TN_RC_OK;
+
+   if (obj == TN_NULL){
+      rc = TN_RC_WPARAM;
+   }
+
+   return rc;
+}
+
+#else
+#  define _check_param_get(obj, tgt)      (TN_RC_OK)
+#  define _check_param_reset(obj)         (TN_RC_OK)
+#endif
+// }}}
+
+/**
+ * Returns statistics of the object, or `#TN_NULL` if the object isn't valid.
+ *
+ * All the objects have `enum #TN_ObjId` as the first field, so the type of
+ * the object is determined by it.
+ */
+static struct _TN_ObjStats *_obj_stats_get(const void *obj)
+{
+   struct _TN_ObjStats *ret = TN_NULL;
+
+   switch (*(const enum TN_ObjId *)obj){
+      case TN_ID_SEMAPHORE:
+         ret = &((struct TN_Sem *)obj)->obj_stats;
+         break;
+      case TN_ID_MUTEX:
+         ret = &((struct TN_Mutex *)obj)->obj_stats;
+         break;
+      case TN_ID_DATAQUEUE:
+         ret = &((struct TN_DQueue *)obj)->obj_stats;
+         break;
+      case TN_ID_FSMEMORYPOOL:
+         ret = &((struct TN_FMem *)obj)->obj_stats;
+         break;
+      case TN_ID_RWLOCK:
+         ret = &((struct TN_RWLock *)obj)->obj_stats;
+         break;
+      case TN_ID_CONDVAR:
+         ret = &((struct TN_CondVar *)obj)->obj_stats;
+         break;
+      case TN_ID_RPC:
+         ret = &((struct TN_RPC *)obj)->obj_stats;
+         break;
+      default:
+         //-- not an object with statistics
+         break;
+   }
+
+   return ret;
+}
+
+/**
+ * Returns statistics of the object the task is waiting for, determined by
+ * the wait reason and wait queue, or `#TN_NULL` if task doesn't wait for
+ * any object with statistics.
+ */
+static struct _TN_ObjStats *_wait_obj_stats_get(struct TN_Task *task)
+{
+   struct _TN_ObjStats *ret = TN_NULL;
+   struct TN_ListItem *wait_queue = task->pwait_queue;
+
+   if (wait_queue != TN_NULL){
+      switch (task->task_wait_reason){
+         case TN_WAIT_REASON_SEM:
+            ret = &container_of(
+                  wait_queue, struct TN_Sem, wait_queue
+                  )->obj_stats;
+            break;
+         case TN_WAIT_REASON_MUTEX_C:
+         case TN_WAIT_REASON_MUTEX_I:
+            ret = &container_of(
+                  wait_queue, struct TN_Mutex, wait_queue
+                  )->obj_stats;
+            break;
+         case TN_WAIT_REASON_DQUE_WSEND:
+            ret = &container_of(
+                  wait_queue, struct TN_DQueue, wait_send_list
+                  )->obj_stats;
+            break;
+         case TN_WAIT_REASON_DQUE_WRECEIVE:
+            ret = &container_of(
+                  wait_queue, struct TN_DQueue, wait_receive_list
+                  )->obj_stats;
+            break;
+         case TN_WAIT_REASON_WFIXMEM:
+            ret = &container_of(
+                  wait_queue, struct TN_FMem, wait_queue
+                  )->obj_stats;
+            break;
+         case TN_WAIT_REASON_RWLOCK_R:
+         case TN_WAIT_REASON_RWLOCK_W:
+            ret = &container_of(
+                  wait_queue, struct TN_RWLock, wait_queue
+                  )->obj_stats;
+            break;
+         case TN_WAIT_REASON_CONDVAR:
+            ret = &container_of(
+                  wait_queue, struct TN_CondVar, wait_queue
+                  )->obj_stats;
+            break;
+         case TN_WAIT_REASON_RPC_CALL:
+            //-- NOTE: only waiting for the server to receive the call is
+            //   accounted: waiting for the reply is the call itself, and
+            //   the server waiting for calls is just idle.
+            ret = &container_of(
+                  wait_queue, struct TN_RPC, wait_queue
+                  )->obj_stats;
+            break;
+         default:
+            //-- task doesn't wait for any object with statistics
+            break;
+      }
+   }
+
+   return ret;
+}
+
+/**
+ * Returns current "level" of the object: number of items in the data queue,
+ * or used blocks in the memory pool; 0 for other objects.
+ */
+static unsigned int _obj_level_get(const void *obj)
+{
+   unsigned int ret = 0;
+
+   switch (*(const enum TN_ObjId *)obj){
+      case TN_ID_DATAQUEUE:
+         ret = ((const struct TN_DQueue *)obj)->filled_items_cnt;
+         break;
+      case TN_ID_FSMEMORYPOOL:
+         ret = ((const struct TN_FMem *)obj)->blocks_cnt
+            - ((const struct TN_FMem *)obj)->free_blocks_cnt;
+         break;
+      default:
+         break;
+   }
+
+   return ret;
+}
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC FUNCTIONS
+ ******************************************************************************/
+
+/*
+ * See comments in the header file (tn_obj_stats.h)
+ */
+enum TN_RCode tn_obj_stats_get(
+      const void           *obj,
+      struct TN_ObjStats   *tgt
+      )
+{
+   enum TN_RCode rc = _check_param_get(obj, tgt);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else {
+      struct _TN_ObjStats *obj_stats;
+      TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+
+      obj_stats = _obj_stats_get(obj);
+      if (obj_stats == TN_NULL){
+         rc = TN_RC_INVALID_OBJ;
+      } else {
+         memcpy(tgt, &obj_stats->stats, sizeof(*tgt));
+      }
+
+      tn_arch_sr_restore(sr_saved);
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_obj_stats.h)
+ */
+enum TN_RCode tn_obj_stats_reset(const void *obj)
+{
+   enum TN_RCode rc = _check_param_reset(obj);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else {
+      struct _TN_ObjStats *obj_stats;
+      TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+
+      obj_stats = _obj_stats_get(obj);
+      if (obj_stats == TN_NULL){
+         rc = TN_RC_INVALID_OBJ;
+      } else {
+         memset(&obj_stats->stats, 0x00, sizeof(obj_stats->stats));
+         obj_stats->stats.waiters_max = obj_stats->waiters_cnt;
+         obj_stats->stats.level_max   = _obj_level_get(obj);
+      }
+
+      tn_arch_sr_restore(sr_saved);
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_obj_stats.h)
+ */
+const void *tn_obj_stats_next(const void *obj)
+{
+   const void *ret = TN_NULL;
+   struct TN_ListItem *item = TN_NULL;
+   TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+
+   if (obj == TN_NULL){
+      item = _obj_stats_list.next;
+   } else {
+      struct _TN_ObjStats *obj_stats = _obj_stats_get(obj);
+
+      //-- if the object is deleted, its list item is reset (or the id is
+      //   wrong), and we can't go on
+      if (  obj_stats != TN_NULL
+            && !_tn_list_is_empty(&obj_stats->stats_list)
+         )
+      {
+         item = obj_stats->stats_list.next;
+      }
+   }
+
+   if (item != TN_NULL && item != &_obj_stats_list){
+      ret = container_of(item, struct _TN_ObjStats, stats_list)->obj;
+   }
+
+   tn_arch_sr_restore(sr_saved);
+
+   return ret;
+}
+
+
+
+
+/*******************************************************************************
+ *    PROTECTED FUNCTIONS
+ ******************************************************************************/
+
+/*
+ * See comments in the file _tn_obj_stats.h
+ */
+void _tn_obj_stats_create(struct _TN_ObjStats *obj_stats, const void *obj)
+{
+   TN_UWord sr_saved;
+
+   memset(&obj_stats->stats, 0x00, sizeof(obj_stats->stats));
+   obj_stats->waiters_cnt  = 0;
+   obj_stats->obj          = obj;
+
+   //-- object creation services don't disable interrupts by themselves,
+   //   so we should do that here
+   sr_saved = tn_arch_sr_save_int_dis();
+   _tn_list_add_tail(&_obj_stats_list, &obj_stats->stats_list);
+   tn_arch_sr_restore(sr_saved);
+}
+
+/*
+ * See comments in the file _tn_obj_stats.h
+ */
+void _tn_obj_stats_delete(struct _TN_ObjStats *obj_stats)
+{
+   _tn_list_remove_entry(&obj_stats->stats_list);
+   _tn_list_reset(&obj_stats->stats_list);
+}
+
+/*
+ * See comments in the file _tn_obj_stats.h
+ */
+void _tn_obj_stats_on_wait(struct TN_Task *task)
+{
+   struct _TN_ObjStats *obj_stats = _wait_obj_stats_get(task);
+
+   if (obj_stats != TN_NULL){
+      task->obj_stats_wait_ts = _tn_sys_timestamp_get();
+
+      obj_stats->stats.contended_cnt++;
+      obj_stats->waiters_cnt++;
+      if (obj_stats->stats.waiters_max < obj_stats->waiters_cnt){
+         obj_stats->stats.waiters_max = obj_stats->waiters_cnt;
+      }
+   }
+}
+
+/*
+ * See comments in the file _tn_obj_stats.h
+ */
+void _tn_obj_stats_on_wait_end(struct TN_Task *task)
+{
+   struct _TN_ObjStats *obj_stats = _wait_obj_stats_get(task);
+
+   if (obj_stats != TN_NULL){
+      TN_UWord wait_time = _tn_sys_timestamp_get() - task->obj_stats_wait_ts;
+
+      obj_stats->stats.wait_time_total += wait_time;
+      if (obj_stats->stats.wait_time_max < wait_time){
+         obj_stats->stats.wait_time_max = wait_time;
+      }
+
+      if (obj_stats->waiters_cnt > 0){
+         obj_stats->waiters_cnt--;
+      }
+   }
+}
+
+
+#endif // TN_OBJ_STATS
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
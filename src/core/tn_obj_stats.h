@@ -0,0 +1,268 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/**
+ * \file
+ *
+ * Per-object contention statistics, available if only `#TN_OBJ_STATS` option
+ * is non-zero.
+ *
+ * When it's not clear which mutex or queue is the bottleneck of the system,
+ * this option helps: each semaphore, mutex, data queue, fixed memory pool,
+ * rwlock, condition variable and RPC object keeps a few counters (see
+ * `struct #TN_ObjStats`):
+ *
+ * - how many times the object was acquired (mutex locked, semaphore
+ *   acquired, message received from data queue, memory block allocated,
+ *   rwlock locked, condition variable signaled, RPC call received);
+ * - how many times some task had to wait for the object (that is, the
+ *   object was contended), and how long the waiting took, in total and at
+ *   most;
+ * - maximum number of tasks waiting for the object simultaneously;
+ * - for data queues and memory pools: high-watermark of the number of items
+ *   in the queue, or of used memory blocks, respectively.
+ *
+ * All the expensive work (timestamps, wait time accounting) is done on the
+ * slow path only, i.e. when the task goes to wait and when it finishes
+ * waiting; the fast path just increments the acquire counter (and, for data
+ * queues and memory pools, updates the high-watermark), which is done
+ * inside the critical section that is already there.
+ *
+ * Statistics can be read by `#tn_obj_stats_get()`, for any object, since the
+ * type of the object is determined by its id. All the objects with
+ * statistics can be enumerated by `#tn_obj_stats_next()`, like this:
+ *
+ * \code{.c}
+ *    const void *obj = TN_NULL;
+ *    struct TN_ObjStats stats;
+ *
+ *    while ((obj = tn_obj_stats_next(obj)) != TN_NULL){
+ *       if (tn_obj_stats_get(obj, &stats) == TN_RC_OK){
+ *          //-- the type of obj can be figured out by its id:
+ *          //   *(const enum TN_ObjId *)obj
+ *          my_report(obj, &stats);
+ *       }
+ *    }
+ * \endcode
+ *
+ * Wait times are in timestamp units, see `#tn_callback_timestamp_set()`; if
+ * the callback isn't set, system ticks are used.
+ */
+
+#ifndef _TN_OBJ_STATS_H
+#define _TN_OBJ_STATS_H
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "../arch/tn_arch.h"
+#include "tn_common.h"
+#include "tn_list.h"
+
+
+
+#ifdef __cplusplus
+extern "C"  {     /*}*/
+#endif
+
+/*******************************************************************************
+ *    PUBLIC TYPES
+ ******************************************************************************/
+
+#if TN_OBJ_STATS || DOXYGEN_ACTIVE
+
+/**
+ * Contention statistics of the object.
+ *
+ * Available if only `#TN_OBJ_STATS` option is non-zero.
+ */
+struct TN_ObjStats {
+   ///
+   /// How many times the object was acquired: mutex locked (recursive
+   /// locks aren't counted), semaphore acquired, message received from
+   /// data queue, memory block allocated from the pool, rwlock locked
+   /// (either for reading or for writing); either immediately or after
+   /// waiting. For condition variable: how many waiters were signaled; for
+   /// RPC object: how many calls were received by servers.
+   unsigned long        acquire_cnt;
+   ///
+   /// How many times some task had to wait for the object. For data queue,
+   /// both waiting for sending and for receiving are counted. For condition
+   /// variable, each `#tn_condvar_wait()` is counted (waiting for the mutex
+   /// after the signal is accounted for the mutex). For RPC object, only
+   /// clients waiting for the server to receive the call are counted: neither
+   /// waiting for the reply nor servers waiting for calls are.
+   unsigned long        contended_cnt;
+   ///
+   /// Total time spent by tasks waiting for the object
+   unsigned long long   wait_time_total;
+   ///
+   /// Maximum time spent by a task waiting for the object
+   TN_UWord             wait_time_max;
+   ///
+   /// Maximum number of tasks waiting for the object simultaneously
+   unsigned int         waiters_max;
+   ///
+   /// For data queue: maximum number of items in the queue; for memory
+   /// pool: maximum number of used blocks. For other objects, it is 0.
+   unsigned int         level_max;
+};
+
+/**
+ * Internal kernel structure for contention statistics of the object.
+ *
+ * Available if only `#TN_OBJ_STATS` option is non-zero.
+ */
+struct _TN_ObjStats {
+   ///
+   /// Statistics, can be read by `#tn_obj_stats_get()`
+   struct TN_ObjStats   stats;
+   ///
+   /// Number of tasks which are currently waiting for the object
+   unsigned int         waiters_cnt;
+   ///
+   /// Item of the list of all objects with statistics, see
+   /// `#tn_obj_stats_next()`
+   struct TN_ListItem   stats_list;
+   ///
+   /// Object which contains this structure
+   const void          *obj;
+};
+
+#endif   // TN_OBJ_STATS
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC FUNCTION PROTOTYPES
+ ******************************************************************************/
+
+#if TN_OBJ_STATS || DOXYGEN_ACTIVE
+
+/**
+ * Read contention statistics of the object. The object should be one of
+ * semaphore, mutex, data queue, fixed memory pool, rwlock, condition
+ * variable or RPC object; the type is determined by the object id.
+ *
+ * Available if only `#TN_OBJ_STATS` option is non-zero.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_CALL_FROM_MAIN)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param obj
+ *    Pointer to the object: `struct #TN_Sem`, `struct #TN_Mutex`, etc.
+ * @param tgt
+ *    Pointer to the location where statistics should be stored
+ *
+ * @return
+ *    * `#TN_RC_OK` if statistics was successfully copied;
+ *    * `#TN_RC_INVALID_OBJ` if `obj` doesn't point to any of the supported
+ *      objects;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return code
+ *      is available: `#TN_RC_WPARAM`.
+ */
+enum TN_RCode tn_obj_stats_get(
+      const void           *obj,
+      struct TN_ObjStats   *tgt
+      );
+
+/**
+ * Reset contention statistics of the object. Note that current number of
+ * items in the data queue (or used blocks in the pool) becomes the new
+ * high-watermark.
+ *
+ * Available if only `#TN_OBJ_STATS` option is non-zero.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_CALL_FROM_MAIN)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param obj
+ *    Pointer to the object, see `#tn_obj_stats_get()`
+ *
+ * @return
+ *    * `#TN_RC_OK` if statistics was successfully reset;
+ *    * `#TN_RC_INVALID_OBJ` if `obj` doesn't point to any of the supported
+ *      objects;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return code
+ *      is available: `#TN_RC_WPARAM`.
+ */
+enum TN_RCode tn_obj_stats_reset(const void *obj);
+
+/**
+ * Iterate over all existing objects with statistics: semaphores, mutexes,
+ * data queues, fixed memory pools, rwlocks, condition variables and RPC
+ * objects, in the order of creation. See the example in the file
+ * description.
+ *
+ * If the object given as `obj` is deleted before this function is called,
+ * the iteration stops (`#TN_NULL` is returned).
+ *
+ * Available if only `#TN_OBJ_STATS` option is non-zero.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_CALL_FROM_MAIN)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param obj
+ *    Previous object returned by this function, or `#TN_NULL` to get the
+ *    first one
+ *
+ * @return
+ *    Next object, or `#TN_NULL` if there are no more objects.
+ */
+const void *tn_obj_stats_next(const void *obj);
+
+#endif   // TN_OBJ_STATS
+
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+
+#endif // _TN_OBJ_STATS_H
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
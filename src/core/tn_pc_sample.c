@@ -0,0 +1,187 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+//-- common tnkernel headers
+#include "tn_common.h"
+#include "tn_sys.h"
+
+//-- internal tnkernel headers
+#include "_tn_sys.h"
+
+
+//-- header of current module
+#include "tn_pc_sample.h"
+#include "_tn_pc_sample.h"
+
+
+#if TN_PC_SAMPLE
+
+
+
+
+/*******************************************************************************
+ *    PROTECTED DATA
+ ******************************************************************************/
+
+//-- see comments in the file _tn_pc_sample.h
+struct TN_PCSampleBuf _tn_pc_sample_buf = {
+   TN_PC_SAMPLE_MAGIC,           //-- magic
+   TN_PC_SAMPLE_FORMAT_VERSION,  //-- version
+   TN_PC_SAMPLE_RECS_CNT,        //-- recs_cnt
+   0,                            //-- wr_idx
+   0,                            //-- wrapped
+   1,                            //-- enabled
+   {{0}},                        //-- recs
+};
+
+
+
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+//-- configuration check
+#if (TN_PC_SAMPLE_RECS_CNT < 2)
+#  error TN_PC_SAMPLE_RECS_CNT must be >= 2
+#endif
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+/**
+ * Write the sample to the buffer; interrupts should be disabled.
+ */
+static void _sample_add(TN_UWord pc)
+{
+   if (_tn_pc_sample_buf.enabled){
+      struct TN_PCSample *rec
+         = &_tn_pc_sample_buf.recs[ _tn_pc_sample_buf.wr_idx ];
+
+      rec->pc     = pc;
+      rec->task   = (TN_UWord)(TN_UIntPtr)_tn_curr_run_task;
+
+      //-- advance write index only after the sample is completely written,
+      //   like the kernel tracer does (see comments in tn_trace.h)
+      if (_tn_pc_sample_buf.wr_idx >= (TN_PC_SAMPLE_RECS_CNT - 1)){
+         _tn_pc_sample_buf.wr_idx  = 0;
+         _tn_pc_sample_buf.wrapped = 1;
+      } else {
+         _tn_pc_sample_buf.wr_idx++;
+      }
+   }
+}
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC FUNCTIONS
+ ******************************************************************************/
+
+/*
+ * See comments in the header file (tn_pc_sample.h)
+ */
+void tn_pc_sample_enable_set(TN_BOOL enabled)
+{
+   _tn_pc_sample_buf.enabled = !!enabled;
+}
+
+/*
+ * See comments in the header file (tn_pc_sample.h)
+ */
+void tn_pc_sample_add(void *pc)
+{
+   TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+   _sample_add((TN_UWord)(TN_UIntPtr)pc);
+   tn_arch_sr_restore(sr_saved);
+}
+
+#if defined(__TN_ARCH_CORTEX_M__)
+/*
+ * See comments in the header file (tn_pc_sample.h)
+ */
+void tn_pc_sample_isr(void)
+{
+   TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+   _sample_add(_tn_arch_isr_interrupted_pc_get());
+   tn_arch_sr_restore(sr_saved);
+}
+#endif
+
+/*
+ * See comments in the header file (tn_pc_sample.h)
+ */
+const struct TN_PCSampleBuf *tn_pc_sample_buf_get(void)
+{
+   return &_tn_pc_sample_buf;
+}
+
+
+
+
+/*******************************************************************************
+ *    PROTECTED FUNCTIONS
+ ******************************************************************************/
+
+#if TN_PC_SAMPLE_ON_TICK
+/*
+ * See comments in the file _tn_pc_sample.h
+ */
+void _tn_pc_sample_on_tick(void)
+{
+   //-- interrupts are already disabled by tn_tick_int_processing()
+   _sample_add(_tn_arch_isr_interrupted_pc_get());
+}
+#endif
+
+
+#endif // TN_PC_SAMPLE
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
@@ -0,0 +1,255 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/**
+ * \file
+ *
+ * Statistical PC-sampling profiler, available if only `#TN_PC_SAMPLE` option
+ * is non-zero.
+ *
+ * While `#TN_PROFILER` tells which task consumes CPU time, it doesn't tell
+ * which code inside the task is hot. PC-sampling profiler addresses that:
+ * periodically, in some interrupt, it takes the address of the interrupted
+ * instruction (PC) together with the currently running task, and writes that
+ * sample into the RAM ring buffer. Having enough samples, the host tool
+ * `stuff/tntrace/tnpcprof.py` maps them to function names by the symbol
+ * table of the ELF file, and shows flat profile: which functions the CPU
+ * spends its time in, and how much. No debugger needs to be attached, so
+ * it is applicable to production builds.
+ *
+ * Samples can be taken in two ways:
+ *
+ * - Automatically by `#tn_tick_int_processing()`, if
+ *   `#TN_PC_SAMPLE_ON_TICK` is non-zero. This is the simplest way, but
+ *   beware that code which runs synchronously with the system tick (say,
+ *   tasks woken up by timeouts) will be skewed in the profile.
+ * - From some dedicated timer interrupt, by calling `#tn_pc_sample_isr()`.
+ *   Typically, this timer runs at a rate which isn't a multiple of system
+ *   tick rate, and, preferably, at a higher rate, so that enough samples are
+ *   collected faster.
+ *
+ * Both of these ways rely on the arch-dependent code that finds out the PC
+ * of the interrupted code, which is available on Cortex-M only: there, the
+ * PC is taken from the exception frame on the process stack. If the
+ * interrupted code is an another interrupt (that is, interrupts are nested),
+ * the PC isn't available, and the sample has PC 0; the host tool reports such
+ * samples as `[interrupt]`. (On Cortex-M0/M0+, nesting can't be detected, so
+ * the sample contains the PC of the task which was interrupted by the outer
+ * interrupt)
+ *
+ * On other architectures, the application may figure out the PC by its own,
+ * and call `#tn_pc_sample_add()`.
+ *
+ * The layout of the buffer follows the one of the kernel tracer (see
+ * tn_trace.h): the whole buffer is a single structure `struct
+ * #TN_PCSampleBuf`, with a small header that allows the host tool to decode
+ * it. So, get it in any way you like (say, dump the memory occupied by the
+ * symbol `_tn_pc_sample_buf` with the debugger, or send `sizeof(struct
+ * #TN_PCSampleBuf)` bytes starting from `#tn_pc_sample_buf_get()` via UART),
+ * and then feed it to the tool together with the ELF file:
+ *
+ *     tnpcprof.py --elf app.elf samples.bin
+ *
+ * Taking a sample is just a few dozens of instructions.
+ */
+
+#ifndef _TN_PC_SAMPLE_H
+#define _TN_PC_SAMPLE_H
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "../arch/tn_arch.h"
+#include "tn_common.h"
+
+
+
+#ifdef __cplusplus
+extern "C"  {     /*}*/
+#endif
+
+/*******************************************************************************
+ *    PUBLIC TYPES
+ ******************************************************************************/
+
+/**
+ * Single PC sample.
+ */
+struct TN_PCSample {
+   ///
+   /// Address of the interrupted instruction, or 0 if it is unknown
+   /// (e.g. the interrupted code is an interrupt as well)
+   TN_UWord       pc;
+   ///
+   /// Address of the task which was running (`struct #TN_Task`)
+   TN_UWord       task;
+};
+
+/**
+ * PC samples ring buffer, together with the header that allows the host tool
+ * to decode it. All header fields are machine words, so that the decoder is
+ * able to figure out the word size and endianness by the `magic` value.
+ */
+struct TN_PCSampleBuf {
+   ///
+   /// Always equals to `#TN_PC_SAMPLE_MAGIC`
+   TN_UWord                magic;
+   ///
+   /// Format version, `#TN_PC_SAMPLE_FORMAT_VERSION`
+   TN_UWord                version;
+   ///
+   /// Capacity of the buffer, `#TN_PC_SAMPLE_RECS_CNT`
+   TN_UWord                recs_cnt;
+   ///
+   /// Index of the sample which will be written next time
+   volatile TN_UWord       wr_idx;
+   ///
+   /// Non-zero if the buffer has wrapped at least once (so, all the
+   /// samples are valid)
+   volatile TN_UWord       wrapped;
+   ///
+   /// Non-zero if sampling is enabled, see `#tn_pc_sample_enable_set()`.
+   /// Can also be altered with the debugger.
+   volatile TN_UWord       enabled;
+   ///
+   /// Samples
+   struct TN_PCSample      recs[ TN_PC_SAMPLE_RECS_CNT ];
+};
+
+
+
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+/**
+ * Value of `magic` field of `struct #TN_PCSampleBuf` (on 16-bit platforms, it
+ * is truncated to the lower 16 bits)
+ */
+#define  TN_PC_SAMPLE_MAGIC            ((TN_UWord)0x53435054UL)
+
+/**
+ * Current PC samples format version
+ */
+#define  TN_PC_SAMPLE_FORMAT_VERSION   1
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC FUNCTION PROTOTYPES
+ ******************************************************************************/
+
+#if TN_PC_SAMPLE || DOXYGEN_ACTIVE
+
+/**
+ * Enable or disable sampling at runtime. Sampling is enabled by default;
+ * disabling it is useful to measure some particular part of the application
+ * activity, or to freeze the buffer while it is being sent to the host.
+ *
+ * Available if only `#TN_PC_SAMPLE` option is non-zero.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_CALL_FROM_MAIN)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param enabled
+ *    Whether samples should be written
+ */
+void tn_pc_sample_enable_set(TN_BOOL enabled);
+
+/**
+ * Write the sample with the given PC and currently running task to the
+ * buffer. Useful on architectures where the kernel is unable to get PC of
+ * the interrupted code by itself, see `#tn_pc_sample_isr()`.
+ *
+ * Available if only `#TN_PC_SAMPLE` option is non-zero.
+ *
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param pc
+ *    Address of the interrupted instruction, or `TN_NULL` if unknown
+ */
+void tn_pc_sample_add(void *pc);
+
+#if defined(__TN_ARCH_CORTEX_M__) || DOXYGEN_ACTIVE
+/**
+ * Take a sample of the code interrupted by the current interrupt: should be
+ * called from some periodic timer interrupt. See the file description for
+ * details.
+ *
+ * Available if only `#TN_PC_SAMPLE` option is non-zero, on Cortex-M only.
+ *
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_LEGEND_LINK)
+ */
+void tn_pc_sample_isr(void);
+#endif
+
+/**
+ * Returns pointer to the samples buffer. Application may send its contents
+ * to the host by any means; decoder expects exactly `sizeof(struct
+ * #TN_PCSampleBuf)` bytes as they are in RAM. Note that the buffer might be
+ * modified while it is being sent, so it is a good idea to disable sampling
+ * by `#tn_pc_sample_enable_set()` before that.
+ *
+ * Available if only `#TN_PC_SAMPLE` option is non-zero.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_CALL_FROM_MAIN)
+ * $(TN_LEGEND_LINK)
+ */
+const struct TN_PCSampleBuf *tn_pc_sample_buf_get(void);
+
+#endif   // TN_PC_SAMPLE
+
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+
+#endif // _TN_PC_SAMPLE_H
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
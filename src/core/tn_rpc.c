@@ -0,0 +1,610 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+//-- common tnkernel headers
+#include "tn_common.h"
+#include "tn_sys.h"
+
+//-- internal tnkernel headers
+#include "_tn_tasks.h"
+#include "_tn_list.h"
+#include "_tn_mutex.h"
+#include "_tn_wakeup_latency.h"
+#include "_tn_obj_stats.h"
+#include "_tn_obj_registry.h"
+
+
+//-- header of current module
+#include "_tn_rpc.h"
+
+//-- header of other needed modules
+#include "tn_tasks.h"
+
+
+#if TN_USE_RPC
+
+
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+#define _get_rpc_by_wait_queue(que)                \
+   container_of(que, struct TN_RPC, wait_queue)
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+//-- Additional param checking {{{
+#if TN_CHECK_PARAM
+_TN_STATIC_INLINE enum TN_RCode _check_param_generic(
+      const struct TN_RPC *rpc
+      )
+{
+   enum TN_RCode rc = TN_RC_OK;
+
+   if (rpc == TN_NULL){
+      rc = TN_RC_WPARAM;
+   } else if (!_tn_rpc_is_valid(rpc)){
+      rc = TN_RC_INVALID_OBJ;
+   }
+
+   return rc;
+}
+
+/**
+ * Additional param checking when creating RPC object
+ */
+_TN_STATIC_INLINE enum TN_RCode _check_param_create(
+      const struct TN_RPC *rpc
+      )
+{
+   enum TN_RCode rc = TN_RC_OK;
+
+   if (rpc == TN_NULL || _tn_rpc_is_valid(rpc)){
+      rc = TN_RC_WPARAM;
+   }
+
+   return rc;
+}
+
+/**
+ * Additional param checking when receiving the call
+ */
+_TN_STATIC_INLINE enum TN_RCode _check_param_receive(
+      const struct TN_RPC *rpc,
+      void **pp_request
+      )
+{
+   enum TN_RCode rc = _check_param_generic(rpc);
+
+   if (rc == TN_RC_OK && pp_request == TN_NULL){
+      rc = TN_RC_WPARAM;
+   }
+
+   return rc;
+}
+
+#else
+#  define _check_param_generic(rpc)                         (TN_RC_OK)
+#  define _check_param_create(rpc)                          (TN_RC_OK)
+#  define _check_param_receive(rpc, pp_request)             (TN_RC_OK)
+#endif
+// }}}
+
+
+/**
+ * Start handling the call: `server` handles the call of `client`, and
+ * RPC object is added to the server's list, so that the server inherits
+ * priorities of the clients.
+ *
+ * Priority of the server isn't updated here.
+ */
+static void _call_start(
+      struct TN_RPC *rpc,
+      struct TN_Task *server,
+      struct TN_Task *client
+      )
+{
+   rpc->server = server;
+   rpc->client = client;
+
+   _tn_list_add_tail(&(server->rpc_queue), &(rpc->rpc_queue));
+
+   _TN_OBJ_STATS_ACQUIRED(rpc);
+}
+
+/**
+ * Finish handling the call: RPC object is removed from the server's list.
+ *
+ * Priority of the server isn't updated here.
+ *
+ * @return the client which waits for the reply, or `#TN_NULL` if it has
+ * already stopped waiting.
+ */
+static struct TN_Task *_call_finish(struct TN_RPC *rpc)
+{
+   struct TN_Task *client = rpc->client;
+
+   _tn_list_remove_entry(&(rpc->rpc_queue));
+   _tn_list_reset(&(rpc->rpc_queue));
+
+   rpc->server = TN_NULL;
+   rpc->client = TN_NULL;
+
+   return client;
+}
+
+/**
+ * If no call is being handled, but there are both clients and servers
+ * waiting, hand the call of the first client to the first server.
+ */
+static void _call_hand_over(struct TN_RPC *rpc)
+{
+   if (     rpc->server == TN_NULL
+         && !_tn_list_is_empty(&(rpc->wait_queue))
+         && !_tn_list_is_empty(&(rpc->server_wait_queue))
+      )
+   {
+      struct TN_Task *client = _tn_list_first_entry(
+            &(rpc->wait_queue), struct TN_Task, task_queue
+            );
+      struct TN_Task *server = _tn_list_first_entry(
+            &(rpc->server_wait_queue), struct TN_Task, task_queue
+            );
+
+      server->subsys_wait.rpc.msg = client->subsys_wait.rpc.msg;
+
+      //-- client now waits for the reply, without timeout
+      _tn_task_wait_move(
+            client, &(rpc->wait_queue),
+            TN_WAIT_REASON_RPC_REPLY, TN_WAIT_INFINITE
+            );
+
+      _call_start(rpc, server, client);
+      _tn_task_wait_complete(server, TN_RC_OK);
+
+      //-- server inherits priorities of all the clients
+      _tn_mutex_task_priority_update(server);
+   }
+}
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC FUNCTIONS
+ ******************************************************************************/
+
+/*
+ * See comments in the header file (tn_rpc.h)
+ */
+enum TN_RCode tn_rpc_create(struct TN_RPC *rpc)
+{
+   enum TN_RCode rc = _check_param_create(rpc);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else {
+      _tn_list_reset(&(rpc->wait_queue));
+      _tn_list_reset(&(rpc->server_wait_queue));
+      _tn_list_reset(&(rpc->rpc_queue));
+
+      rpc->server    = TN_NULL;
+      rpc->client    = TN_NULL;
+      rpc->id_rpc    = TN_ID_RPC;
+
+#if TN_WAKEUP_LATENCY
+      _tn_wakeup_latency_reset(&rpc->wakeup_latency);
+#endif
+#if TN_OBJ_STATS
+      _tn_obj_stats_create(&rpc->obj_stats, rpc);
+#endif
+#if TN_OBJ_REGISTRY
+      _tn_obj_registry_add(TN_ID_RPC, &rpc->registry_item);
+#endif
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_rpc.h)
+ */
+enum TN_RCode tn_rpc_delete(struct TN_RPC *rpc)
+{
+   enum TN_RCode rc = _check_param_generic(rpc);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (!tn_is_task_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      TN_INTSAVE_DATA;
+
+      TN_INT_DIS_SAVE();
+
+      //-- NOTE: RPC object should be invalidated before waking tasks up,
+      //   so that _tn_rpc_on_task_wait_complete() doesn't touch it.
+      rpc->id_rpc = TN_ID_NONE; //-- RPC object does not exist now
+
+      if (rpc->server != TN_NULL){
+         //-- some call is being handled: server loses inherited priority
+         struct TN_Task *server = rpc->server;
+
+         _call_finish(rpc);
+         _tn_mutex_task_priority_update(server);
+      }
+
+      _tn_wait_queue_notify_deleted(&(rpc->wait_queue));
+      _tn_wait_queue_notify_deleted(&(rpc->server_wait_queue));
+#if TN_OBJ_STATS
+      _tn_obj_stats_delete(&rpc->obj_stats);
+#endif
+#if TN_OBJ_REGISTRY
+      _tn_obj_registry_remove(&rpc->registry_item);
+#endif
+
+      TN_INT_RESTORE();
+
+      //-- we might need to switch context if _tn_wait_queue_notify_deleted()
+      //   has woken up some high-priority task
+      _tn_context_switch_pend_if_needed();
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_rpc.h)
+ */
+enum TN_RCode tn_rpc_call(
+      struct TN_RPC    *rpc,
+      void             *request,
+      void            **p_reply,
+      TN_TickCnt        timeout
+      )
+{
+   enum TN_RCode rc = _check_param_generic(rpc);
+   TN_BOOL waited = TN_FALSE;
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (!tn_is_task_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      TN_INTSAVE_DATA;
+
+      TN_INT_DIS_SAVE();
+
+      if (     rpc->server == TN_NULL
+            && !_tn_list_is_empty(&(rpc->server_wait_queue))
+         )
+      {
+         //-- some server waits for the call: hand the request to it
+         //   directly, and wait for the reply
+         struct TN_Task *server = _tn_list_first_entry(
+               &(rpc->server_wait_queue), struct TN_Task, task_queue
+               );
+
+         server->subsys_wait.rpc.msg = request;
+         _call_start(rpc, server, _tn_curr_run_task);
+         _tn_task_wait_complete(server, TN_RC_OK);
+
+         _tn_task_curr_to_wait_action(
+               &(rpc->wait_queue),
+               TN_WAIT_REASON_RPC_REPLY,
+               TN_WAIT_INFINITE
+               );
+
+         //-- server inherits priority of the current task
+         _tn_mutex_task_priority_elevate(server, _tn_curr_run_task->priority);
+
+         waited = TN_TRUE;
+
+      } else if (timeout == 0){
+         //-- in polling mode, just return TN_RC_TIMEOUT
+         rc = TN_RC_TIMEOUT;
+
+      } else {
+         //-- wait until some server receives the call
+         _tn_curr_run_task->subsys_wait.rpc.msg = request;
+
+         _tn_task_curr_to_wait_action(
+               &(rpc->wait_queue),
+               TN_WAIT_REASON_RPC_CALL,
+               timeout
+               );
+
+         //-- if some call is being handled, its server inherits priority
+         //   of the current task as well
+         if (rpc->server != TN_NULL){
+            _tn_mutex_task_priority_elevate(
+                  rpc->server, _tn_curr_run_task->priority
+                  );
+         }
+
+         waited = TN_TRUE;
+      }
+
+#if TN_DEBUG
+      if (!_tn_need_context_switch() && waited){
+         _TN_FATAL_ERROR("");
+      }
+#endif
+
+      TN_INT_RESTORE();
+      _tn_context_switch_pend_if_needed();
+      if (waited){
+         //-- get wait result
+         rc = _tn_curr_run_task->task_wait_rc;
+
+         if (rc == TN_RC_OK && p_reply != TN_NULL){
+            *p_reply = _tn_curr_run_task->subsys_wait.rpc.msg;
+         }
+      }
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_rpc.h)
+ */
+enum TN_RCode tn_rpc_call_polling(
+      struct TN_RPC    *rpc,
+      void             *request,
+      void            **p_reply
+      )
+{
+   return tn_rpc_call(rpc, request, p_reply, 0);
+}
+
+/*
+ * See comments in the header file (tn_rpc.h)
+ */
+enum TN_RCode tn_rpc_receive(
+      struct TN_RPC    *rpc,
+      void            **pp_request,
+      TN_TickCnt        timeout
+      )
+{
+   enum TN_RCode rc = _check_param_receive(rpc, pp_request);
+   TN_BOOL waited = TN_FALSE;
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (!tn_is_task_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      TN_INTSAVE_DATA;
+
+      TN_INT_DIS_SAVE();
+
+      if (rpc->server == _tn_curr_run_task){
+         //-- previous call isn't replied yet
+         rc = TN_RC_ILLEGAL_USE;
+
+      } else if (
+               rpc->server == TN_NULL
+            && !_tn_list_is_empty(&(rpc->wait_queue))
+            )
+      {
+         //-- there is a client waiting: take its call
+         struct TN_Task *client = _tn_list_first_entry(
+               &(rpc->wait_queue), struct TN_Task, task_queue
+               );
+
+         *pp_request = client->subsys_wait.rpc.msg;
+
+         //-- client now waits for the reply, without timeout
+         _tn_task_wait_move(
+               client, &(rpc->wait_queue),
+               TN_WAIT_REASON_RPC_REPLY, TN_WAIT_INFINITE
+               );
+
+         _call_start(rpc, _tn_curr_run_task, client);
+
+         //-- current task inherits priorities of all the clients
+         _tn_mutex_task_priority_update(_tn_curr_run_task);
+
+      } else if (timeout == 0){
+         //-- in polling mode, just return TN_RC_TIMEOUT
+         rc = TN_RC_TIMEOUT;
+
+      } else {
+         //-- wait until some client calls the RPC object
+         _tn_task_curr_to_wait_action(
+               &(rpc->server_wait_queue),
+               TN_WAIT_REASON_RPC_RECEIVE,
+               timeout
+               );
+
+         waited = TN_TRUE;
+      }
+
+#if TN_DEBUG
+      if (!_tn_need_context_switch() && waited){
+         _TN_FATAL_ERROR("");
+      }
+#endif
+
+      TN_INT_RESTORE();
+      _tn_context_switch_pend_if_needed();
+      if (waited){
+         //-- get wait result
+         rc = _tn_curr_run_task->task_wait_rc;
+
+         if (rc == TN_RC_OK){
+            *pp_request = _tn_curr_run_task->subsys_wait.rpc.msg;
+         }
+      }
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_rpc.h)
+ */
+enum TN_RCode tn_rpc_receive_polling(
+      struct TN_RPC    *rpc,
+      void            **pp_request
+      )
+{
+   return tn_rpc_receive(rpc, pp_request, 0);
+}
+
+/*
+ * See comments in the header file (tn_rpc.h)
+ */
+enum TN_RCode tn_rpc_reply(struct TN_RPC *rpc, void *reply)
+{
+   enum TN_RCode rc = _check_param_generic(rpc);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (!tn_is_task_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      TN_INTSAVE_DATA;
+
+      TN_INT_DIS_SAVE();
+
+      //-- replying is enabled only for the server of the current call
+      if (rpc->server != _tn_curr_run_task){
+         rc = TN_RC_ILLEGAL_USE;
+      } else {
+         struct TN_Task *client = _call_finish(rpc);
+
+         if (client == TN_NULL){
+            //-- client has stopped waiting for the reply
+            rc = TN_RC_FORCED;
+         } else {
+            client->subsys_wait.rpc.msg = reply;
+            _tn_task_wait_complete(client, TN_RC_OK);
+         }
+
+         //-- update priority for the ex-server
+         _tn_mutex_task_priority_update(_tn_curr_run_task);
+
+         //-- other servers might handle the next call now
+         _call_hand_over(rpc);
+      }
+
+      TN_INT_RESTORE();
+      _tn_context_switch_pend_if_needed();
+   }
+
+   return rc;
+}
+
+
+
+
+
+/*******************************************************************************
+ *    INTERNAL TNKERNEL FUNCTIONS
+ ******************************************************************************/
+
+/**
+ * See comments in _tn_rpc.h file
+ */
+void _tn_rpc_abort_all_by_task(struct TN_Task *task)
+{
+   struct TN_RPC *rpc;      //-- "cursor" for the loop iteration
+   struct TN_RPC *tmp_rpc;  //-- we need for temporary item because
+                            //   item is removed from the list
+                            //   in _call_finish().
+
+   _tn_list_for_each_entry_safe(
+         rpc, struct TN_RPC, tmp_rpc, &(task->rpc_queue), rpc_queue
+         )
+   {
+      struct TN_Task *client = _call_finish(rpc);
+
+      if (client != TN_NULL){
+         _tn_task_wait_complete(client, TN_RC_FORCED);
+      }
+
+      //-- other servers might handle the next call now
+      _call_hand_over(rpc);
+   }
+}
+
+/**
+ * See comments in _tn_rpc.h file
+ */
+void _tn_rpc_on_task_wait_complete(struct TN_Task *task)
+{
+   struct TN_RPC *rpc = _get_rpc_by_wait_queue(task->pwait_queue);
+
+   if (!_tn_rpc_is_valid(rpc)){
+      //-- RPC object is deleted, nothing to do
+   } else {
+      if (rpc->client == task){
+         //-- client has stopped waiting for the reply before the server
+         //   replied (e.g. it's released or terminated)
+         rpc->client = TN_NULL;
+      }
+
+      //-- since the task doesn't wait anymore, priority of the server
+      //   should be recalculated
+      if (rpc->server != TN_NULL){
+         _tn_mutex_task_priority_update(rpc->server);
+      }
+   }
+}
+
+/**
+ * See comments in _tn_rpc.h file
+ */
+struct TN_Task *_tn_rpc_server_get(struct TN_ListItem *wait_queue)
+{
+   return _get_rpc_by_wait_queue(wait_queue)->server;
+}
+
+
+#endif //-- TN_USE_RPC
+
@@ -0,0 +1,379 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/**
+ * \file
+ *
+ * RPC object: synchronous send-receive-reply message passing between the
+ * client tasks and the server task.
+ *
+ * Client calls the RPC object with `tn_rpc_call()`, giving the pointer to
+ * the request, and is blocked until the server replies. Server receives the
+ * request with `tn_rpc_receive()`, handles it and replies with
+ * `tn_rpc_reply()`, giving the pointer to the reply: this pointer is
+ * returned to the client from `tn_rpc_call()`. Messages are passed by
+ * reference, nothing is copied: since the client is blocked until the reply,
+ * the request (and the buffer for the reply) may well live on the client's
+ * stack.
+ *
+ * If the server waits in `tn_rpc_receive()` at the moment of call, the
+ * request is handed to it directly. Otherwise, the client is put in the
+ * queue, and the next `tn_rpc_receive()` takes the first client from it.
+ * So, the whole round trip takes just three kernel calls and two context
+ * switches.
+ *
+ * While the server handles the call (i.e. from `tn_rpc_receive()` until
+ * `tn_rpc_reply()`), it inherits the priority of the client, and of all the
+ * other clients queued on the same RPC object, in the same way as the
+ * holder of the mutex with `#TN_MUTEX_PROT_INHERIT` does (and they share
+ * the implementation). If the server calls another RPC object or waits for
+ * the mutex when handling the call, the priority is propagated further,
+ * transitively.
+ *
+ * Only one call of the RPC object may be handled at a time: until the
+ * received call is replied, other clients wait in the queue. Several server
+ * tasks may wait for calls of the same RPC object (the call is handed to the
+ * first of them), and the server task may handle calls of several RPC
+ * objects at once; but the task which has received the call should reply to
+ * it before receiving the next call of the same RPC object.
+ *
+ * If the server task is terminated while handling the call, client wakes up
+ * with `#TN_RC_FORCED`. If the client stops waiting for the reply (e.g. it
+ * is released by `tn_task_release_wait()` or terminated), the server loses
+ * inherited priority, and its `tn_rpc_reply()` returns `#TN_RC_FORCED`, so
+ * that the server knows the reply wasn't delivered.
+ *
+ * Limitations:
+ *
+ * - The timeout given to `tn_rpc_call()` applies until the server receives
+ *   the call; after that, client waits for the reply without the timeout;
+ * - Just like for rwlocks, when priority of the server drops, the change
+ *   isn't propagated to the server of another RPC object which it has
+ *   called: that server keeps elevated priority until it replies.
+ *
+ * RPC objects are available if only `#TN_USE_RPC` is non-zero.
+ */
+
+#ifndef _TN_RPC_H
+#define _TN_RPC_H
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "tn_list.h"
+#include "tn_common.h"
+#include "tn_wakeup_latency.h"
+#include "tn_obj_stats.h"
+#include "tn_obj_registry.h"
+
+
+
+#ifdef __cplusplus
+extern "C"  {     /*}*/
+#endif
+
+/*******************************************************************************
+ *    PUBLIC TYPES
+ ******************************************************************************/
+
+struct TN_Task;
+
+/**
+ * RPC object
+ */
+struct TN_RPC {
+   ///
+   /// id for object validity verification.
+   /// This field is in the beginning of the structure to make it easier
+   /// to detect memory corruption.
+   enum TN_ObjId id_rpc;
+   ///
+   /// List of client tasks: both the ones waiting for the server to receive
+   /// the call, and the one waiting for the reply
+   struct TN_ListItem wait_queue;
+   ///
+   /// List of server tasks waiting for the call in `tn_rpc_receive()`
+   struct TN_ListItem server_wait_queue;
+   ///
+   /// Task which handles the call now, or `#TN_NULL`
+   struct TN_Task *server;
+   ///
+   /// Task whose call is handled now, or `#TN_NULL`
+   struct TN_Task *client;
+   ///
+   /// To include in the server's list of RPC objects being served
+   struct TN_ListItem rpc_queue;
+#if TN_WAKEUP_LATENCY || DOXYGEN_ACTIVE
+   ///
+   /// Wake-up latency histogram, available if only `#TN_WAKEUP_LATENCY`
+   /// option is non-zero. See `#tn_wakeup_latency_obj_get()`
+   struct TN_WakeupLatency wakeup_latency;
+#endif
+#if TN_OBJ_STATS || DOXYGEN_ACTIVE
+   ///
+   /// Contention statistics, available if only `#TN_OBJ_STATS` option is
+   /// non-zero. See `#tn_obj_stats_get()`
+   struct _TN_ObjStats obj_stats;
+#endif
+#if TN_OBJ_REGISTRY || DOXYGEN_ACTIVE
+   ///
+   /// List item for the registry of kernel objects, available if only
+   /// `#TN_OBJ_REGISTRY` option is non-zero. See `#tn_obj_registry_next()`
+   struct TN_ListItem registry_item;
+#endif
+};
+
+/**
+ * RPC-specific fields related to waiting task,
+ * to be included in struct TN_Task.
+ */
+struct TN_RPCTaskWait {
+   ///
+   /// Message being passed: the request, while the client waits for the
+   /// server to receive the call, or while the server waits for the call;
+   /// or the reply, when the client is woken up by `tn_rpc_reply()`.
+   void *msg;
+};
+
+
+/*******************************************************************************
+ *    PROTECTED GLOBAL DATA
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    PUBLIC FUNCTION PROTOTYPES
+ ******************************************************************************/
+
+#if TN_USE_RPC || DOXYGEN_ACTIVE
+
+/**
+ * Construct the RPC object. The field `id_rpc` should not contain
+ * `#TN_ID_RPC`, otherwise, `#TN_RC_WPARAM` is returned.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param rpc
+ *    Pointer to already allocated `struct TN_RPC`
+ *
+ * @return 
+ *    * `#TN_RC_OK` if RPC object was successfully created;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return code
+ *      is available: `#TN_RC_WPARAM`.
+ */
+enum TN_RCode tn_rpc_create(struct TN_RPC *rpc);
+
+/**
+ * Destruct the RPC object.
+ *
+ * All tasks that wait for the RPC object (clients and servers) become
+ * runnable with `#TN_RC_DELETED` code returned. If some call is being
+ * handled at the moment, the server loses the inherited priority, and its
+ * `tn_rpc_reply()` returns `#TN_RC_INVALID_OBJ`.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param rpc     RPC object to destruct
+ *
+ * @return 
+ *    * `#TN_RC_OK` if RPC object was successfully deleted;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_rpc_delete(struct TN_RPC *rpc);
+
+/**
+ * Call the RPC object: pass the request to the server and wait for the
+ * reply.
+ *
+ * If some server waits in `tn_rpc_receive()`, the request is handed to it
+ * directly. Otherwise, behavior depends on `timeout` value: task switches to
+ * $(TN_TASK_STATE_WAIT) state until the server receives the call or until
+ * the `timeout` expired. Once the call is received, task waits for the
+ * reply without the timeout, and the server inherits its priority.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_CAN_SLEEP)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param rpc
+ *    RPC object to call
+ * @param request
+ *    Pointer to the request: it is returned to the server from
+ *    `tn_rpc_receive()` as it is.
+ * @param p_reply
+ *    Pointer to the location where the reply pointer (given by the server
+ *    to `tn_rpc_reply()`) is stored. If `#TN_NULL`, the reply pointer is
+ *    discarded.
+ * @param timeout
+ *    Timeout to wait for the server to receive the call, refer to
+ *    `#TN_TickCnt`
+ *
+ * @return
+ *    * `#TN_RC_OK` if the call is replied;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * `#TN_RC_FORCED` if the server was terminated while handling the call;
+ *    * Other possible return codes depend on `timeout` value,
+ *      refer to `#TN_TickCnt`
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_rpc_call(
+      struct TN_RPC    *rpc,
+      void             *request,
+      void            **p_reply,
+      TN_TickCnt        timeout
+      );
+
+/**
+ * The same as `tn_rpc_call()` with zero timeout: the call is made if only
+ * some server waits in `tn_rpc_receive()` at the moment, but even then the
+ * current task waits for the reply.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_CAN_SLEEP)
+ * $(TN_LEGEND_LINK)
+ */
+enum TN_RCode tn_rpc_call_polling(
+      struct TN_RPC    *rpc,
+      void             *request,
+      void            **p_reply
+      );
+
+/**
+ * Receive the call from some client. If there are clients waiting (and no
+ * other call of the RPC object is being handled), the first one is taken.
+ * Otherwise, behavior depends on `timeout` value: task might switch to
+ * $(TN_TASK_STATE_WAIT) state until the call can be received or until the
+ * `timeout` expired.
+ *
+ * Once the call is received, current task inherits priority of the
+ * clients of the RPC object, until it replies with `tn_rpc_reply()`.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_CAN_SLEEP)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param rpc
+ *    RPC object to receive the call from
+ * @param pp_request
+ *    Pointer to the location where the request pointer (given by the
+ *    client to `tn_rpc_call()`) is stored.
+ * @param timeout
+ *    refer to `#TN_TickCnt`
+ *
+ * @return
+ *    * `#TN_RC_OK` if the call is received;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * `#TN_RC_ILLEGAL_USE` if the call of this RPC object previously
+ *      received by the current task isn't replied yet;
+ *    * Other possible return codes depend on `timeout` value,
+ *      refer to `#TN_TickCnt`
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_rpc_receive(
+      struct TN_RPC    *rpc,
+      void            **pp_request,
+      TN_TickCnt        timeout
+      );
+
+/**
+ * The same as `tn_rpc_receive()` with zero timeout
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ */
+enum TN_RCode tn_rpc_receive_polling(
+      struct TN_RPC    *rpc,
+      void            **pp_request
+      );
+
+/**
+ * Reply to the call received by the current task: the client becomes
+ * runnable, and its `tn_rpc_call()` returns `#TN_RC_OK`, with the `reply`
+ * pointer stored to its `p_reply`. The current task loses the priority
+ * inherited from the clients.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param rpc
+ *    RPC object whose call is replied
+ * @param reply
+ *    Pointer to the reply, returned to the client from `tn_rpc_call()`
+ *    as it is.
+ *
+ * @return
+ *    * `#TN_RC_OK` if the reply is delivered to the client;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * `#TN_RC_ILLEGAL_USE` if the current task doesn't handle the call of
+ *      the RPC object;
+ *    * `#TN_RC_FORCED` if the client has stopped waiting for the reply
+ *      (so, the reply isn't delivered), but the call is finished anyway;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_rpc_reply(struct TN_RPC *rpc, void *reply);
+
+#endif   // TN_USE_RPC
+
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+
+#endif // _TN_RPC_H
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
@@ -0,0 +1,616 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+//-- common tnkernel headers
+#include "tn_common.h"
+#include "tn_sys.h"
+
+//-- internal tnkernel headers
+#include "_tn_tasks.h"
+#include "_tn_list.h"
+#include "_tn_mutex.h"
+#include "_tn_wakeup_latency.h"
+#include "_tn_obj_stats.h"
+#include "_tn_obj_registry.h"
+
+
+//-- header of current module
+#include "_tn_rwlock.h"
+
+//-- header of other needed modules
+#include "tn_tasks.h"
+
+
+#if TN_USE_RWLOCKS
+
+
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+#define _get_rwlock_by_wait_queue(que)                \
+   container_of(que, struct TN_RWLock, wait_queue)
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+//-- Additional param checking {{{
+#if TN_CHECK_PARAM
+_TN_STATIC_INLINE enum TN_RCode _check_param_generic(
+      const struct TN_RWLock *rwlock
+      )
+{
+   enum TN_RCode rc = TN_RC_OK;
+
+   if (rwlock == TN_NULL){
+      rc = TN_RC_WPARAM;
+   } else if (!_tn_rwlock_is_valid(rwlock)){
+      rc = TN_RC_INVALID_OBJ;
+   }
+
+   return rc;
+}
+
+/**
+ * Additional param checking when creating rwlock
+ */
+_TN_STATIC_INLINE enum TN_RCode _check_param_create(
+      const struct TN_RWLock       *rwlock,
+      enum TN_RWLockPolicy          policy,
+      const struct TN_RWLockHold   *holds,
+      int                           holds_cnt
+      )
+{
+   enum TN_RCode rc = TN_RC_OK;
+
+   if (rwlock == TN_NULL){
+      rc = TN_RC_WPARAM;
+   } else if (0
+         || _tn_rwlock_is_valid(rwlock)
+         || (     policy != TN_RWLOCK_PREF_WRITER
+               && policy != TN_RWLOCK_PREF_READER
+            )
+         || holds == TN_NULL
+         || holds_cnt < 1
+         )
+   {
+      rc = TN_RC_WPARAM;
+   }
+
+   return rc;
+}
+
+#else
+#  define _check_param_generic(rwlock)                               (TN_RC_OK)
+#  define _check_param_create(rwlock, policy, holds, holds_cnt)      (TN_RC_OK)
+#endif
+// }}}
+
+
+/**
+ * Find the hold item of the given task, or, if `task` is `#TN_NULL`, the
+ * first free item.
+ *
+ * @return the item, or `#TN_NULL` if not found.
+ */
+static struct TN_RWLockHold *_hold_find(
+      struct TN_RWLock *rwlock,
+      struct TN_Task *task
+      )
+{
+   struct TN_RWLockHold *ret = TN_NULL;
+   int i;
+
+   for (i = 0; i < rwlock->holds_cnt; i++){
+      if (rwlock->holds[i].task == task){
+         ret = &rwlock->holds[i];
+         break;
+      }
+   }
+
+   return ret;
+}
+
+/**
+ * Lock rwlock by the given task, using given (free) hold item.
+ */
+static void _rwlock_do_lock(
+      struct TN_RWLock *rwlock,
+      struct TN_RWLockHold *hold,
+      struct TN_Task *task,
+      TN_BOOL for_writing
+      )
+{
+   hold->task = task;
+
+   //-- Add rwlock to task's locked rwlocks queue
+   _tn_list_add_tail(&(task->rwlock_queue), &(hold->rwlock_queue));
+
+   if (for_writing){
+      rwlock->writer = task;
+   } else {
+      rwlock->readers_cnt++;
+   }
+
+   _TN_OBJ_STATS_ACQUIRED(rwlock);
+}
+
+/**
+ * Recalculate priorities of all the holders of the rwlock: it should be done
+ * whenever the set of waiting tasks or the set of holders is changed.
+ */
+static void _holders_priority_update(struct TN_RWLock *rwlock)
+{
+   int i;
+
+   for (i = 0; i < rwlock->holds_cnt; i++){
+      if (rwlock->holds[i].task != TN_NULL){
+         _tn_mutex_task_priority_update(rwlock->holds[i].task);
+      }
+   }
+}
+
+/**
+ * Let waiting tasks lock the rwlock, as much as possible: walk the wait
+ * queue in the FIFO order, and:
+ *
+ * - readers lock the rwlock if only it isn't locked for writing;
+ * - writer locks the rwlock if only nobody holds it. For
+ *   `#TN_RWLOCK_PREF_WRITER` policy, nobody behind the writer may lock the
+ *   rwlock; for `#TN_RWLOCK_PREF_READER`, readers behind the writer may.
+ *
+ * Priorities of holders aren't updated here, call
+ * `_holders_priority_update()` afterwards.
+ */
+static void _rwlock_grant(struct TN_RWLock *rwlock)
+{
+   struct TN_Task *task;      //-- "cursor" for the loop iteration
+   struct TN_Task *tmp_task;  //-- we need for temporary item because
+                              //   item is removed from the list
+                              //   in _tn_task_wait_complete().
+
+   _tn_list_for_each_entry_safe(
+         task, struct TN_Task, tmp_task, &(rwlock->wait_queue), task_queue
+         )
+   {
+      struct TN_RWLockHold *hold = _hold_find(rwlock, TN_NULL);
+
+      if (hold == TN_NULL || rwlock->writer != TN_NULL){
+         //-- rwlock is locked for writing, or there are no free hold items
+         break;
+      } else if (task->task_wait_reason == TN_WAIT_REASON_RWLOCK_W){
+         if (rwlock->readers_cnt == 0){
+            //-- NOTE: the task should hold the rwlock before
+            //   _tn_task_wait_complete() is called, so that
+            //   _tn_rwlock_on_task_wait_complete() knows that task has got
+            //   the rwlock.
+            _rwlock_do_lock(rwlock, hold, task, TN_TRUE);
+            _tn_task_wait_complete(task, TN_RC_OK);
+         }
+
+         if (rwlock->policy == TN_RWLOCK_PREF_WRITER){
+            //-- nobody may overtake the writer
+            break;
+         }
+      } else {
+         _rwlock_do_lock(rwlock, hold, task, TN_FALSE);
+         _tn_task_wait_complete(task, TN_RC_OK);
+      }
+   }
+}
+
+/**
+ * Unlock rwlock held by the task (which is pointed to by the given hold
+ * item), and let the waiting tasks lock it.
+ */
+static void _rwlock_do_unlock(
+      struct TN_RWLock *rwlock,
+      struct TN_RWLockHold *hold
+      )
+{
+   struct TN_Task *task = hold->task;
+
+   //-- Delete rwlock from task's locked rwlocks queue
+   _tn_list_remove_entry(&(hold->rwlock_queue));
+   hold->task = TN_NULL;
+
+   if (rwlock->writer == task){
+      rwlock->writer = TN_NULL;
+   } else {
+      rwlock->readers_cnt--;
+   }
+
+   //-- update priority for the ex-holder
+   _tn_mutex_task_priority_update(task);
+
+   //-- let waiting tasks lock the rwlock
+   _rwlock_grant(rwlock);
+   _holders_priority_update(rwlock);
+}
+
+/**
+ * Whether the current task may lock the rwlock right away
+ */
+_TN_STATIC_INLINE TN_BOOL _can_lock(
+      struct TN_RWLock *rwlock,
+      TN_BOOL for_writing
+      )
+{
+   TN_BOOL ret;
+
+   if (rwlock->writer != TN_NULL){
+      //-- locked for writing: nobody may lock it
+      ret = TN_FALSE;
+   } else if (for_writing){
+      //-- writer needs all the readers to unlock the rwlock
+      ret = (rwlock->readers_cnt == 0);
+   } else {
+      //-- reader may lock it unless writers are preferred and some of them
+      //   are waiting
+      ret = (     rwlock->policy == TN_RWLOCK_PREF_READER
+               || rwlock->writers_waiting_cnt == 0
+            );
+   }
+
+   return ret;
+}
+
+static enum TN_RCode _rwlock_lock(
+      struct TN_RWLock *rwlock,
+      TN_BOOL for_writing,
+      TN_TickCnt timeout
+      )
+{
+   enum TN_RCode rc = _check_param_generic(rwlock);
+   TN_BOOL waited_for_rwlock = TN_FALSE;
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (!tn_is_task_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      struct TN_RWLockHold *hold;
+      TN_INTSAVE_DATA;
+
+      TN_INT_DIS_SAVE();
+
+      hold = _hold_find(rwlock, TN_NULL);
+
+      if (_hold_find(rwlock, _tn_curr_run_task) != TN_NULL){
+         //-- rwlock is already locked by current task: recursive locking
+         //   isn't supported
+         rc = TN_RC_ILLEGAL_USE;
+
+      } else if (hold != TN_NULL && _can_lock(rwlock, for_writing)){
+         //-- lock it
+         _rwlock_do_lock(rwlock, hold, _tn_curr_run_task, for_writing);
+
+         //-- with reader preference, new reader might get the rwlock while
+         //   writers are waiting, so it should inherit their priority
+         _tn_mutex_task_priority_update(_tn_curr_run_task);
+
+      } else if (timeout == 0){
+         //-- in polling mode, just return TN_RC_TIMEOUT
+         rc = TN_RC_TIMEOUT;
+
+      } else {
+         //-- timeout specified, so, wait until rwlock can be locked or
+         //   timeout expired
+         if (for_writing){
+            rwlock->writers_waiting_cnt++;
+         }
+
+         _tn_task_curr_to_wait_action(
+               &(rwlock->wait_queue),
+               for_writing
+                  ? TN_WAIT_REASON_RWLOCK_W
+                  : TN_WAIT_REASON_RWLOCK_R,
+               timeout
+               );
+
+         //-- all the holders inherit priority of the current task
+         _tn_rwlock_holders_priority_elevate(
+               &(rwlock->wait_queue), _tn_curr_run_task->priority
+               );
+
+         waited_for_rwlock = TN_TRUE;
+
+         //-- rc will be set later to _tn_curr_run_task->task_wait_rc;
+      }
+
+#if TN_DEBUG
+      if (!_tn_need_context_switch() && waited_for_rwlock){
+         _TN_FATAL_ERROR("");
+      }
+#endif
+
+      TN_INT_RESTORE();
+      _tn_context_switch_pend_if_needed();
+      if (waited_for_rwlock){
+         //-- get wait result
+         rc = _tn_curr_run_task->task_wait_rc;
+      }
+   }
+
+   return rc;
+}
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC FUNCTIONS
+ ******************************************************************************/
+
+/*
+ * See comments in the header file (tn_rwlock.h)
+ */
+enum TN_RCode tn_rwlock_create(
+      struct TN_RWLock       *rwlock,
+      enum TN_RWLockPolicy    policy,
+      struct TN_RWLockHold   *holds,
+      int                     holds_cnt
+      )
+{
+   enum TN_RCode rc = _check_param_create(rwlock, policy, holds, holds_cnt);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else {
+      int i;
+
+      _tn_list_reset(&(rwlock->wait_queue));
+
+      for (i = 0; i < holds_cnt; i++){
+         _tn_list_reset(&(holds[i].rwlock_queue));
+         holds[i].rwlock = rwlock;
+         holds[i].task   = TN_NULL;
+      }
+
+      rwlock->policy                = policy;
+      rwlock->holds                 = holds;
+      rwlock->holds_cnt             = holds_cnt;
+      rwlock->writer                = TN_NULL;
+      rwlock->readers_cnt           = 0;
+      rwlock->writers_waiting_cnt   = 0;
+      rwlock->id_rwlock             = TN_ID_RWLOCK;
+
+#if TN_WAKEUP_LATENCY
+      _tn_wakeup_latency_reset(&rwlock->wakeup_latency);
+#endif
+#if TN_OBJ_STATS
+      _tn_obj_stats_create(&rwlock->obj_stats, rwlock);
+#endif
+#if TN_OBJ_REGISTRY
+      _tn_obj_registry_add(TN_ID_RWLOCK, &rwlock->registry_item);
+#endif
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_rwlock.h)
+ */
+enum TN_RCode tn_rwlock_delete(struct TN_RWLock *rwlock)
+{
+   enum TN_RCode rc = _check_param_generic(rwlock);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (!tn_is_task_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      TN_INTSAVE_DATA;
+
+      TN_INT_DIS_SAVE();
+
+      //-- rwlock can be deleted if only it isn't held
+      if (rwlock->writer != TN_NULL || rwlock->readers_cnt != 0){
+         rc = TN_RC_ILLEGAL_USE;
+      } else {
+         //-- NOTE: rwlock should be invalidated before waking tasks up,
+         //   so that _tn_rwlock_on_task_wait_complete() doesn't try to
+         //   let them lock it.
+         //
+         //   (actually, nobody should wait for the rwlock which isn't held,
+         //   but let's be on the safe side)
+         rwlock->id_rwlock = TN_ID_NONE; //-- rwlock does not exist now
+
+         _tn_wait_queue_notify_deleted(&(rwlock->wait_queue));
+#if TN_OBJ_STATS
+         _tn_obj_stats_delete(&rwlock->obj_stats);
+#endif
+#if TN_OBJ_REGISTRY
+         _tn_obj_registry_remove(&rwlock->registry_item);
+#endif
+      }
+
+      TN_INT_RESTORE();
+
+      //-- we might need to switch context if _tn_wait_queue_notify_deleted()
+      //   has woken up some high-priority task
+      _tn_context_switch_pend_if_needed();
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_rwlock.h)
+ */
+enum TN_RCode tn_rwlock_rdlock(struct TN_RWLock *rwlock, TN_TickCnt timeout)
+{
+   return _rwlock_lock(rwlock, TN_FALSE, timeout);
+}
+
+/*
+ * See comments in the header file (tn_rwlock.h)
+ */
+enum TN_RCode tn_rwlock_rdlock_polling(struct TN_RWLock *rwlock)
+{
+   return _rwlock_lock(rwlock, TN_FALSE, 0);
+}
+
+/*
+ * See comments in the header file (tn_rwlock.h)
+ */
+enum TN_RCode tn_rwlock_wrlock(struct TN_RWLock *rwlock, TN_TickCnt timeout)
+{
+   return _rwlock_lock(rwlock, TN_TRUE, timeout);
+}
+
+/*
+ * See comments in the header file (tn_rwlock.h)
+ */
+enum TN_RCode tn_rwlock_wrlock_polling(struct TN_RWLock *rwlock)
+{
+   return _rwlock_lock(rwlock, TN_TRUE, 0);
+}
+
+/*
+ * See comments in the header file (tn_rwlock.h)
+ */
+enum TN_RCode tn_rwlock_unlock(struct TN_RWLock *rwlock)
+{
+   enum TN_RCode rc = _check_param_generic(rwlock);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (!tn_is_task_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      struct TN_RWLockHold *hold;
+      TN_INTSAVE_DATA;
+
+      TN_INT_DIS_SAVE();
+
+      //-- unlocking is enabled only for the holder
+      hold = _hold_find(rwlock, _tn_curr_run_task);
+      if (hold == TN_NULL){
+         rc = TN_RC_ILLEGAL_USE;
+      } else {
+         _rwlock_do_unlock(rwlock, hold);
+      }
+
+      TN_INT_RESTORE();
+      _tn_context_switch_pend_if_needed();
+   }
+
+   return rc;
+}
+
+
+
+
+
+/*******************************************************************************
+ *    INTERNAL TNKERNEL FUNCTIONS
+ ******************************************************************************/
+
+/**
+ * See comment in _tn_rwlock.h file
+ */
+void _tn_rwlock_unlock_all_by_task(struct TN_Task *task)
+{
+   struct TN_RWLockHold *hold;      //-- "cursor" for the loop iteration
+   struct TN_RWLockHold *tmp_hold;  //-- we need for temporary item because
+                                    //   item is removed from the list
+                                    //   in _rwlock_do_unlock().
+
+   _tn_list_for_each_entry_safe(
+         hold, struct TN_RWLockHold, tmp_hold,
+         &(task->rwlock_queue), rwlock_queue
+         )
+   {
+      _rwlock_do_unlock(hold->rwlock, hold);
+   }
+}
+
+/**
+ * See comments in _tn_rwlock.h file
+ */
+void _tn_rwlock_on_task_wait_complete(struct TN_Task *task)
+{
+   struct TN_RWLock *rwlock = _get_rwlock_by_wait_queue(task->pwait_queue);
+
+   if (task->task_wait_reason == TN_WAIT_REASON_RWLOCK_W){
+      rwlock->writers_waiting_cnt--;
+   }
+
+   if (_hold_find(rwlock, task) != TN_NULL){
+      //-- task has just locked the rwlock in _rwlock_grant(),
+      //   priorities are handled there
+   } else if (_tn_rwlock_is_valid(rwlock)){
+      //-- task stopped waiting because of timeout or forced release. Since
+      //   it doesn't wait anymore, priorities of the holders should be
+      //   recalculated; and if it was a writer, readers behind it might
+      //   lock the rwlock now.
+      _rwlock_grant(rwlock);
+      _holders_priority_update(rwlock);
+   }
+}
+
+/**
+ * See comments in _tn_rwlock.h file
+ */
+void _tn_rwlock_holders_priority_elevate(
+      struct TN_ListItem  *wait_queue,
+      int                  priority
+      )
+{
+   struct TN_RWLock *rwlock = _get_rwlock_by_wait_queue(wait_queue);
+   int i;
+
+   for (i = 0; i < rwlock->holds_cnt; i++){
+      if (rwlock->holds[i].task != TN_NULL){
+         _tn_mutex_task_priority_elevate(rwlock->holds[i].task, priority);
+      }
+   }
+}
+
+
+#endif //-- TN_USE_RWLOCKS
+
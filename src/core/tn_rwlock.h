@@ -0,0 +1,367 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/**
+ * \file
+ *
+ * Reader-writer lock (rwlock): an object to protect the shared resource which
+ * is read by many tasks and rarely modified.
+ *
+ * Unlike the mutex, rwlock might be locked by several tasks at once, if only
+ * all of them lock it for reading (`tn_rwlock_rdlock()`). Locking for
+ * writing (`tn_rwlock_wrlock()`) is exclusive: while rwlock is locked for
+ * writing, nobody else may lock it, and writer has to wait until all the
+ * readers unlock it.
+ *
+ * When both readers and writers wait for the rwlock, the policy given to
+ * `tn_rwlock_create()` decides who wins, see `enum #TN_RWLockPolicy`. Among
+ * the waiters of the same kind, the order is FIFO, just like for other
+ * kernel objects.
+ *
+ * Rwlocks use priority inheritance protocol, in the same way as mutexes with
+ * `#TN_MUTEX_PROT_INHERIT` do (and they share the implementation): when some
+ * task has to wait for the rwlock, all its current holders (i.e. possibly
+ * several readers) inherit the priority of the waiting task, transitively.
+ * Each task's priority is calculated from its base priority and all the
+ * mutexes and rwlocks it holds.
+ *
+ * Since there might be several readers at once, the kernel needs some
+ * memory to remember each of them: it is the array of `struct
+ * #TN_RWLockHold` given to `tn_rwlock_create()`. Its size is the maximum
+ * number of tasks that hold the rwlock at the same time; if all the items
+ * are in use, the next reader waits until some item is free.
+ *
+ * Limitations:
+ *
+ * - Recursive locking isn't supported: if the task tries to lock the rwlock
+ *   it already holds (either for reading or for writing), `#TN_RC_ILLEGAL_USE`
+ *   is returned. Upgrading the read lock to the write one isn't supported
+ *   either;
+ * - Deadlock detection (`#TN_MUTEX_DEADLOCK_DETECT`) doesn't handle rwlocks;
+ * - When priority of the holder drops, the change is propagated through the
+ *   chain of mutexes, but not through the rwlocks the holder itself waits
+ *   for: holders of such rwlocks keep elevated priority until they unlock
+ *   it. This never leads to priority inversion, just to the priority being
+ *   elevated a bit longer than necessary.
+ *
+ * Rwlocks are available if only `#TN_USE_RWLOCKS` is non-zero.
+ */
+
+#ifndef _TN_RWLOCK_H
+#define _TN_RWLOCK_H
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "tn_list.h"
+#include "tn_common.h"
+#include "tn_wakeup_latency.h"
+#include "tn_obj_stats.h"
+#include "tn_obj_registry.h"
+
+
+
+#ifdef __cplusplus
+extern "C"  {     /*}*/
+#endif
+
+/*******************************************************************************
+ *    PUBLIC TYPES
+ ******************************************************************************/
+
+/**
+ * Rwlock policy: which tasks should lock the rwlock first, readers or
+ * writers.
+ */
+enum TN_RWLockPolicy {
+   ///
+   /// Writer preference: once some task waits to lock the rwlock for writing,
+   /// new readers wait as well. So, writers can't starve, and the data is
+   /// updated as soon as possible.
+   TN_RWLOCK_PREF_WRITER = 1,
+   ///
+   /// Reader preference: readers lock the rwlock whenever it isn't locked for
+   /// writing, even if some writers are waiting for it. Gives the best
+   /// throughput for readers, but writers might starve if readers hold the
+   /// rwlock all the time.
+   TN_RWLOCK_PREF_READER = 2,
+};
+
+/**
+ * The item which represents a task holding the rwlock. The array of these
+ * items should be given to `tn_rwlock_create()`; the application shouldn't
+ * touch its contents.
+ */
+struct TN_RWLockHold {
+   ///
+   /// To include in task's locked rwlocks list
+   struct TN_ListItem rwlock_queue;
+   ///
+   /// Rwlock which this item belongs to
+   struct TN_RWLock *rwlock;
+   ///
+   /// Task which holds the rwlock, or `#TN_NULL` if the item is free
+   struct TN_Task *task;
+};
+
+/**
+ * Reader-writer lock
+ */
+struct TN_RWLock {
+   ///
+   /// id for object validity verification.
+   /// This field is in the beginning of the structure to make it easier
+   /// to detect memory corruption.
+   enum TN_ObjId id_rwlock;
+   ///
+   /// List of tasks that wait for the rwlock, both readers and writers
+   struct TN_ListItem wait_queue;
+   ///
+   /// Rwlock policy: writer preference or reader preference
+   enum TN_RWLockPolicy policy;
+   ///
+   /// Array of items for the tasks holding the rwlock
+   struct TN_RWLockHold *holds;
+   ///
+   /// Number of items in the `holds` array
+   int holds_cnt;
+   ///
+   /// Task which holds the rwlock for writing, or `#TN_NULL`
+   struct TN_Task *writer;
+   ///
+   /// Number of tasks which hold the rwlock for reading
+   int readers_cnt;
+   ///
+   /// Number of tasks which wait to lock the rwlock for writing
+   int writers_waiting_cnt;
+#if TN_WAKEUP_LATENCY || DOXYGEN_ACTIVE
+   ///
+   /// Wake-up latency histogram, available if only `#TN_WAKEUP_LATENCY`
+   /// option is non-zero. See `#tn_wakeup_latency_obj_get()`
+   struct TN_WakeupLatency wakeup_latency;
+#endif
+#if TN_OBJ_STATS || DOXYGEN_ACTIVE
+   ///
+   /// Contention statistics, available if only `#TN_OBJ_STATS` option is
+   /// non-zero. See `#tn_obj_stats_get()`
+   struct _TN_ObjStats obj_stats;
+#endif
+#if TN_OBJ_REGISTRY || DOXYGEN_ACTIVE
+   ///
+   /// List item for the registry of kernel objects, available if only
+   /// `#TN_OBJ_REGISTRY` option is non-zero. See `#tn_obj_registry_next()`
+   struct TN_ListItem registry_item;
+#endif
+};
+
+
+/*******************************************************************************
+ *    PROTECTED GLOBAL DATA
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    PUBLIC FUNCTION PROTOTYPES
+ ******************************************************************************/
+
+#if TN_USE_RWLOCKS || DOXYGEN_ACTIVE
+
+/**
+ * Construct the rwlock. The field `id_rwlock` should not contain
+ * `#TN_ID_RWLOCK`, otherwise, `#TN_RC_WPARAM` is returned.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param rwlock
+ *    Pointer to already allocated `struct TN_RWLock`
+ * @param policy
+ *    Rwlock policy: writer preference or reader preference.
+ *    See `enum #TN_RWLockPolicy`.
+ * @param holds
+ *    Array of items for the tasks holding the rwlock
+ * @param holds_cnt
+ *    Number of items in the `holds` array, i.e. maximum number of tasks
+ *    that may hold the rwlock at the same time. Must be at least 1.
+ *
+ * @return 
+ *    * `#TN_RC_OK` if rwlock was successfully created;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return code
+ *      is available: `#TN_RC_WPARAM`.
+ */
+enum TN_RCode tn_rwlock_create(
+      struct TN_RWLock       *rwlock,
+      enum TN_RWLockPolicy    policy,
+      struct TN_RWLockHold   *holds,
+      int                     holds_cnt
+      );
+
+/**
+ * Destruct the rwlock.
+ *
+ * The rwlock can be deleted if only it isn't locked by anyone, otherwise
+ * `#TN_RC_ILLEGAL_USE` is returned.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param rwlock     rwlock to destruct
+ *
+ * @return 
+ *    * `#TN_RC_OK` if rwlock was successfully deleted;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * `#TN_RC_ILLEGAL_USE` if rwlock is locked;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_rwlock_delete(struct TN_RWLock *rwlock);
+
+/**
+ * Lock the rwlock for reading.
+ *
+ * If the rwlock isn't locked for writing (and, for `#TN_RWLOCK_PREF_WRITER`
+ * policy, nobody waits to lock it for writing), it is locked by the current
+ * task, possibly together with other readers, and `#TN_RC_OK` is returned
+ * immediately. Otherwise, behavior depends on `timeout` value: task might
+ * switch to $(TN_TASK_STATE_WAIT) state until the rwlock can be locked or
+ * until the `timeout` expired. Current holders of the rwlock inherit the
+ * priority of the waiting task.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_CAN_SLEEP)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param rwlock     rwlock to lock
+ * @param timeout    refer to `#TN_TickCnt`
+ *
+ * @return
+ *    * `#TN_RC_OK` if rwlock is successfully locked;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * `#TN_RC_ILLEGAL_USE` if rwlock is already locked by the current task;
+ *    * Other possible return codes depend on `timeout` value,
+ *      refer to `#TN_TickCnt`
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_rwlock_rdlock(struct TN_RWLock *rwlock, TN_TickCnt timeout);
+
+/**
+ * The same as `tn_rwlock_rdlock()` with zero timeout
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ */
+enum TN_RCode tn_rwlock_rdlock_polling(struct TN_RWLock *rwlock);
+
+/**
+ * Lock the rwlock for writing.
+ *
+ * If the rwlock isn't locked by anyone, it is locked by the current task
+ * and `#TN_RC_OK` is returned immediately. Otherwise, behavior depends on
+ * `timeout` value: task might switch to $(TN_TASK_STATE_WAIT) state until all
+ * the holders unlock the rwlock or until the `timeout` expired. Current
+ * holders of the rwlock (say, all the readers) inherit the priority of the
+ * waiting task.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_CAN_SLEEP)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param rwlock     rwlock to lock
+ * @param timeout    refer to `#TN_TickCnt`
+ *
+ * @return
+ *    * `#TN_RC_OK` if rwlock is successfully locked;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * `#TN_RC_ILLEGAL_USE` if rwlock is already locked by the current task;
+ *    * Other possible return codes depend on `timeout` value,
+ *      refer to `#TN_TickCnt`
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_rwlock_wrlock(struct TN_RWLock *rwlock, TN_TickCnt timeout);
+
+/**
+ * The same as `tn_rwlock_wrlock()` with zero timeout
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ */
+enum TN_RCode tn_rwlock_wrlock_polling(struct TN_RWLock *rwlock);
+
+/**
+ * Unlock the rwlock locked by the current task (either for reading or for
+ * writing). Priority of the current task is recalculated, and waiting tasks
+ * lock the rwlock, if possible, according to the policy.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param rwlock     rwlock to unlock
+ *
+ * @return
+ *    * `#TN_RC_OK` if rwlock is unlocked;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * `#TN_RC_ILLEGAL_USE` if rwlock isn't locked by the current task;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_rwlock_unlock(struct TN_RWLock *rwlock);
+
+#endif   // TN_USE_RWLOCKS
+
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+
+#endif // _TN_RWLOCK_H
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
@@ -0,0 +1,382 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+//-- common tnkernel headers
+#include "tn_common.h"
+#include "tn_sys.h"
+
+//-- internal tnkernel headers
+#include "_tn_tasks.h"
+#include "_tn_list.h"
+#include "_tn_sem.h"
+#include "_tn_dqueue.h"
+#include "_tn_fmem.h"
+#include "_tn_eventgrp.h"
+
+
+//-- header of current module
+#include "_tn_select.h"
+
+//-- header of other needed modules
+#include "tn_tasks.h"
+
+
+#if TN_USE_SELECT
+
+
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+/**
+ * Returns id of the object: all kernel objects have it as the first field.
+ */
+_TN_STATIC_INLINE enum TN_ObjId _obj_id_get(const void *obj)
+{
+   return *(const enum TN_ObjId *)obj;
+}
+
+/**
+ * Returns `select_queue` of the given object, or `TN_NULL` if the object
+ * isn't supported by `tn_select()` (or isn't valid at all).
+ */
+static struct TN_ListItem *_select_queue_get(void *obj)
+{
+   struct TN_ListItem *ret = TN_NULL;
+
+   switch (_obj_id_get(obj)){
+      case TN_ID_SEMAPHORE:
+         ret = &((struct TN_Sem *)obj)->select_queue;
+         break;
+      case TN_ID_DATAQUEUE:
+         ret = &((struct TN_DQueue *)obj)->select_queue;
+         break;
+      case TN_ID_FSMEMORYPOOL:
+         ret = &((struct TN_FMem *)obj)->select_queue;
+         break;
+      case TN_ID_EVENTGRP:
+         ret = &((struct TN_EventGrp *)obj)->select_queue;
+         break;
+      default:
+         break;
+   }
+
+   return ret;
+}
+
+//-- Additional param checking {{{
+#if TN_CHECK_PARAM
+_TN_STATIC_INLINE enum TN_RCode _check_param_item(
+      const struct TN_SelectItem *item
+      )
+{
+   enum TN_RCode rc = TN_RC_OK;
+   enum TN_EGrpWaitMode wait_mode;
+
+   if (item->obj == TN_NULL){
+      rc = TN_RC_WPARAM;
+   } else if (_select_queue_get(item->obj) == TN_NULL){
+      rc = TN_RC_INVALID_OBJ;
+   } else if (_obj_id_get(item->obj) == TN_ID_EVENTGRP){
+      wait_mode = item->wait_mode
+         & (TN_EVENTGRP_WMODE_OR | TN_EVENTGRP_WMODE_AND);
+
+      if (     item->wait_pattern == 0
+            || (     wait_mode != TN_EVENTGRP_WMODE_OR
+                  && wait_mode != TN_EVENTGRP_WMODE_AND)
+         )
+      {
+         rc = TN_RC_WPARAM;
+      }
+   }
+
+   return rc;
+}
+
+_TN_STATIC_INLINE enum TN_RCode _check_param_select(
+      const struct TN_SelectItem *items,
+      int items_cnt
+      )
+{
+   enum TN_RCode rc = TN_RC_OK;
+   int i, j;
+
+   if (items == TN_NULL || items_cnt <= 0){
+      rc = TN_RC_WPARAM;
+   } else {
+      for (i = 0; i < items_cnt && rc == TN_RC_OK; i++){
+         rc = _check_param_item(&items[i]);
+
+         //-- the same object can't be given twice
+         for (j = 0; j < i && rc == TN_RC_OK; j++){
+            if (items[j].obj == items[i].obj){
+               rc = TN_RC_WPARAM;
+            }
+         }
+      }
+   }
+
+   return rc;
+}
+
+#else
+#  define _check_param_select(items, items_cnt)    (TN_RC_OK)
+#endif
+// }}}
+
+
+/**
+ * Try to take the object of the given item without waiting.
+ *
+ * @return
+ *    - `#TN_RC_OK` if the object is taken, the result (if any) is stored in
+ *      the item;
+ *    - `#TN_RC_TIMEOUT` if the object isn't available;
+ *    - other codes in case of errors.
+ */
+static enum TN_RCode _item_try(struct TN_SelectItem *item)
+{
+   enum TN_RCode rc = TN_RC_INVALID_OBJ;
+
+   switch (_obj_id_get(item->obj)){
+      case TN_ID_SEMAPHORE:
+         rc = _tn_sem_select_try((struct TN_Sem *)item->obj);
+         break;
+      case TN_ID_DATAQUEUE:
+         rc = _tn_dqueue_select_try(
+               (struct TN_DQueue *)item->obj, &item->data
+               );
+         break;
+      case TN_ID_FSMEMORYPOOL:
+         rc = _tn_fmem_select_try((struct TN_FMem *)item->obj, &item->data);
+         break;
+      case TN_ID_EVENTGRP:
+         rc = _tn_eventgrp_select_try(
+               (struct TN_EventGrp *)item->obj,
+               item->wait_pattern, item->wait_mode, &item->flags_pattern
+               );
+         break;
+      default:
+         //-- may happen if only TN_CHECK_PARAM is zero
+         break;
+   }
+
+   return rc;
+}
+
+/**
+ * Put all the items to the select queues of their objects, on behalf of the
+ * current task.
+ */
+static void _items_link(struct TN_SelectItem *items, int items_cnt)
+{
+   int i;
+   struct TN_Task *task = _tn_curr_run_task;
+
+   task->subsys_wait.select.items      = items;
+   task->subsys_wait.select.items_cnt  = items_cnt;
+   task->subsys_wait.select.idx        = -1;
+
+   for (i = 0; i < items_cnt; i++){
+      items[i].task = task;
+      _tn_list_add_tail(
+            _select_queue_get(items[i].obj), &items[i].select_queue
+            );
+   }
+}
+
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC FUNCTIONS
+ ******************************************************************************/
+
+/*
+ * See comments in the header file (tn_select.h)
+ */
+enum TN_RCode tn_select(
+      struct TN_SelectItem *items,
+      int items_cnt,
+      TN_TickCnt timeout,
+      int *p_idx
+      )
+{
+   enum TN_RCode rc = _check_param_select(items, items_cnt);
+   TN_BOOL waited = TN_FALSE;
+   int idx = -1;
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (!tn_is_task_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      TN_INTSAVE_DATA;
+
+      TN_INT_DIS_SAVE();
+
+      //-- try to take objects one by one, until some of them is taken
+      //   or some error occurs
+      rc = TN_RC_TIMEOUT;
+      for (idx = 0; idx < items_cnt && rc == TN_RC_TIMEOUT; idx++){
+         rc = _item_try(&items[idx]);
+      }
+
+      if (rc == TN_RC_TIMEOUT){
+         idx = -1;
+
+         if (timeout != 0){
+            //-- nothing is available: wait for all the objects at once
+            _items_link(items, items_cnt);
+            _tn_task_curr_to_wait_action(
+                  TN_NULL, TN_WAIT_REASON_SELECT, timeout
+                  );
+
+            //-- rc and idx will be set later thanks to `waited`
+            waited = TN_TRUE;
+         }
+      } else {
+         //-- the loop has incremented idx after the last item checked
+         idx--;
+      }
+
+#if TN_DEBUG
+      //-- if we're going to wait, _tn_need_context_switch() must return TN_TRUE
+      if (!_tn_need_context_switch() && waited){
+         _TN_FATAL_ERROR("");
+      }
+#endif
+
+      TN_INT_RESTORE();
+      _tn_context_switch_pend_if_needed();
+      if (waited){
+         //-- get wait result
+         rc  = _tn_curr_run_task->task_wait_rc;
+         idx = _tn_curr_run_task->subsys_wait.select.idx;
+      }
+   }
+
+   if (p_idx != TN_NULL){
+      *p_idx = idx;
+   }
+
+   return rc;
+}
+
+
+
+
+/*******************************************************************************
+ *    PROTECTED FUNCTIONS
+ ******************************************************************************/
+
+/*
+ * See comments in the file _tn_select.h
+ */
+void _tn_select_item_complete(struct TN_SelectItem *item, enum TN_RCode rc)
+{
+   struct TN_Task *task = item->task;
+
+   task->subsys_wait.select.idx = (int)(item - task->subsys_wait.select.items);
+
+   //-- all the items of the task are removed from the select queues
+   //   in `_tn_select_on_task_wait_complete()`
+   _tn_task_wait_complete(task, rc);
+}
+
+/*
+ * See comments in the file _tn_select.h
+ */
+TN_BOOL _tn_select_first_complete(
+      struct TN_ListItem  *select_queue,
+      void                *data
+      )
+{
+   TN_BOOL ret = TN_FALSE;
+   struct TN_SelectItem *item;
+
+   if (!_tn_list_is_empty(select_queue)){
+      item = _tn_list_first_entry(
+            select_queue, struct TN_SelectItem, select_queue
+            );
+
+      item->data = data;
+      _tn_select_item_complete(item, TN_RC_OK);
+
+      ret = TN_TRUE;
+   }
+
+   return ret;
+}
+
+/*
+ * See comments in the file _tn_select.h
+ */
+void _tn_select_notify_deleted(struct TN_ListItem *select_queue)
+{
+   struct TN_SelectItem *item;
+
+   while (!_tn_list_is_empty(select_queue)){
+      item = _tn_list_first_entry(
+            select_queue, struct TN_SelectItem, select_queue
+            );
+      _tn_select_item_complete(item, TN_RC_DELETED);
+   }
+}
+
+/*
+ * See comments in the file _tn_select.h
+ */
+void _tn_select_on_task_wait_complete(struct TN_Task *task)
+{
+   int i;
+   struct TN_SelectItem *items = task->subsys_wait.select.items;
+
+   for (i = 0; i < task->subsys_wait.select.items_cnt; i++){
+      _tn_list_remove_entry(&items[i].select_queue);
+   }
+}
+
+
+
+#endif //-- TN_USE_SELECT
+
@@ -0,0 +1,255 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/**
+ * \file
+ *
+ * Wait for any of several kernel objects at once (select).
+ *
+ * Sometimes a task needs to wait for "a message in the queue A, or the
+ * semaphore B, or a free block in the memory pool C". Without select, it is
+ * only possible with an extra event group: each object should set some flag
+ * in the event group (for the data queue, it can be done by
+ * `tn_queue_eventgrp_connect()`), the task waits for the event group, and
+ * then takes the resource from the particular object. So every event is
+ * signaled twice, and the task has to make one more call to the kernel.
+ *
+ * `tn_select()` puts the task to the wait lists of several objects at once,
+ * and the task is woken up as soon as one of them is satisfied. The resource
+ * is handed to the task right by the signaling call, just like it is done for
+ * regular waiters: the task receives the semaphore unit, the queue item, the
+ * memory block, or the event group flags, and the index of the satisfied item
+ * is returned.
+ *
+ * Supported objects:
+ *
+ * - `struct #TN_Sem`: waits for the semaphore, as `tn_sem_wait()` does;
+ * - `struct #TN_DQueue`: receives data from the queue, as `tn_queue_receive()`
+ *   does. Received item is stored in `#TN_SelectItem::data`;
+ * - `struct #TN_FMem`: gets a block from the pool, as `tn_fmem_get()` does.
+ *   The block is stored in `#TN_SelectItem::data`;
+ * - `struct #TN_EventGrp`: waits for the flags given in
+ *   `#TN_SelectItem::wait_pattern` and `#TN_SelectItem::wait_mode`, as
+ *   `tn_eventgrp_wait()` does. The pattern that caused the task to finish
+ *   waiting is stored in `#TN_SelectItem::flags_pattern`.
+ *
+ * Typical usage:
+ *
+ * \code{.c}
+ *    struct TN_SelectItem items[] = {
+ *       { .obj = &my_queue },
+ *       { .obj = &my_sem },
+ *       { .obj = &my_eventgrp,
+ *         .wait_pattern = MY_FLAG_STOP, .wait_mode = TN_EVENTGRP_WMODE_OR },
+ *    };
+ *    int idx;
+ *
+ *    if (tn_select(items, 3, TN_WAIT_INFINITE, &idx) == TN_RC_OK){
+ *       switch (idx){
+ *          case 0:  handle_msg(items[0].data);       break;
+ *          case 1:  handle_sem();                    break;
+ *          case 2:  handle_stop(items[2].flags_pattern); break;
+ *       }
+ *    }
+ * \endcode
+ *
+ * Each object keeps one more list, `select_queue`, of select items which wait
+ * for it. Regular waiters (e.g. the ones in `tn_sem_wait()`) always have
+ * precedence over the tasks waiting in `tn_select()`: the resource is given
+ * to the select waiter if only there are no regular waiters.
+ *
+ * Select is available if only `#TN_USE_SELECT` is non-zero.
+ */
+
+#ifndef _TN_SELECT_H
+#define _TN_SELECT_H
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "tn_list.h"
+#include "tn_common.h"
+#include "tn_eventgrp.h"
+
+
+
+#ifdef __cplusplus
+extern "C"  {     /*}*/
+#endif
+
+/*******************************************************************************
+ *    EXTERNAL TYPES
+ ******************************************************************************/
+
+struct TN_Task;
+
+
+
+/*******************************************************************************
+ *    PUBLIC TYPES
+ ******************************************************************************/
+
+/**
+ * One of the objects given to `tn_select()`.
+ *
+ * Before calling `tn_select()`, user should set `obj` field (and, for the
+ * event group, `wait_pattern` and `wait_mode` fields as well). The rest of
+ * the fields are set by the kernel.
+ */
+struct TN_SelectItem {
+   ///
+   /// Object to wait for: pointer to `struct #TN_Sem`, `struct #TN_DQueue`,
+   /// `struct #TN_FMem` or `struct #TN_EventGrp`. The type of the object is
+   /// determined by its id field.
+   void *obj;
+   ///
+   /// For the event group only: wait pattern, see `tn_eventgrp_wait()`
+   TN_UWord wait_pattern;
+   ///
+   /// For the event group only: wait mode, see `tn_eventgrp_wait()`
+   enum TN_EGrpWaitMode wait_mode;
+   ///
+   /// Result: for the data queue, the received item; for the memory pool,
+   /// the allocated block. Valid if only this item has satisfied the select.
+   void *data;
+   ///
+   /// Result: for the event group, the pattern that caused the task to finish
+   /// waiting. Valid if only this item has satisfied the select.
+   TN_UWord flags_pattern;
+   ///
+   /// Private: list item to include in the `select_queue` of the object
+   struct TN_ListItem select_queue;
+   ///
+   /// Private: the task which waits for this item
+   struct TN_Task *task;
+};
+
+/**
+ * Select-specific fields related to waiting task,
+ * to be included in struct TN_Task.
+ */
+struct TN_SelectTaskWait {
+   ///
+   /// Array of items given to `tn_select()`
+   struct TN_SelectItem *items;
+   ///
+   /// Number of items in the `items` array
+   int items_cnt;
+   ///
+   /// Index of the item that caused task to finish waiting
+   int idx;
+};
+
+
+
+/*******************************************************************************
+ *    PROTECTED GLOBAL DATA
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    PUBLIC FUNCTION PROTOTYPES
+ ******************************************************************************/
+
+#if TN_USE_SELECT || DOXYGEN_ACTIVE
+
+/**
+ * Wait for any of the given objects.
+ *
+ * Objects are checked in the order they are given in `items`; the first one
+ * which can be taken right away (the semaphore counter is non-zero, the queue
+ * is not empty, etc) is taken, and `#TN_RC_OK` is returned. Otherwise,
+ * behavior depends on `timeout` value: task might switch to
+ * $(TN_TASK_STATE_WAIT) state until one of the objects is signaled or until
+ * the `timeout` expired. Refer to `#TN_TickCnt`.
+ *
+ * Only one of the objects is taken: the semaphores, queues and pools which
+ * didn't satisfy the select are not touched.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_CAN_SLEEP)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param items
+ *    Array of objects to wait for, see `struct #TN_SelectItem`. It should
+ *    stay valid until `tn_select()` returns. The same object can't be given
+ *    twice.
+ * @param items_cnt
+ *    Number of items in the `items` array, should be positive.
+ * @param timeout
+ *    refer to `#TN_TickCnt`
+ * @param p_idx
+ *    Pointer to where the index of the satisfied item should be stored; can
+ *    be `TN_NULL`. If `#TN_RC_DELETED` is returned, it is the index of the
+ *    deleted object; if `#TN_RC_TIMEOUT` or `#TN_RC_FORCED` is returned, it
+ *    is `-1`.
+ *
+ * @return
+ *    * `#TN_RC_OK` if one of the objects was successfully taken;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * `#TN_RC_DELETED` if one of the objects was deleted while task
+ *      was waiting for it;
+ *    * Other possible return codes depend on `timeout` value,
+ *      refer to `#TN_TickCnt`
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_select(
+      struct TN_SelectItem *items,
+      int items_cnt,
+      TN_TickCnt timeout,
+      int *p_idx
+      );
+
+#endif // TN_USE_SELECT
+
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+
+#endif // _TN_SELECT_H
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
@@ -44,8 +44,14 @@
 #include "tn_sys.h"
 
 //-- internal tnkernel headers
+#include "_tn_eventgrp.h"
 #include "_tn_tasks.h"
 #include "_tn_list.h"
+#include "_tn_trace.h"
+#include "_tn_wakeup_latency.h"
+#include "_tn_obj_stats.h"
+#include "_tn_obj_registry.h"
+#include "_tn_select.h"
 
 
 //-- header of current module
@@ -57,6 +63,15 @@
 
 
 
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+#define _get_sem_by_wait_queue(que)                \
+   container_of(que, struct TN_Sem, wait_queue)
+
+
+
 /*******************************************************************************
  *    PRIVATE FUNCTIONS
  ******************************************************************************/
@@ -104,9 +119,29 @@ _TN_STATIC_INLINE enum TN_RCode _check_param_create(
    return rc;
 }
 
+/**
+ * Additional param checking when waiting for or signaling the semaphore
+ */
+_TN_STATIC_INLINE enum TN_RCode _check_param_job_perform(
+      const struct TN_Sem *sem,
+      int cnt
+      )
+{
+   enum TN_RCode rc = _check_param_generic(sem);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (cnt <= 0 || cnt > sem->max_count){
+      rc = TN_RC_WPARAM;
+   }
+
+   return rc;
+}
+
 #else
 #  define _check_param_generic(sem)                            (TN_RC_OK)
 #  define _check_param_create(sem, start_count, max_count)     (TN_RC_OK)
+#  define _check_param_job_perform(sem, cnt)                   (TN_RC_OK)
 #endif
 // }}}
 
@@ -116,15 +151,17 @@ _TN_STATIC_INLINE enum TN_RCode _check_param_create(
  *
  * @param sem        semaphore to perform job on
  * @param p_worker   pointer to actual worker function
+ * @param cnt        number of units
  * @param timeout    see `#TN_TickCnt`
  */
 _TN_STATIC_INLINE enum TN_RCode _sem_job_perform(
       struct TN_Sem *sem,
-      enum TN_RCode (p_worker)(struct TN_Sem *sem),
+      enum TN_RCode (p_worker)(struct TN_Sem *sem, int cnt),
+      int cnt,
       TN_TickCnt timeout
       )
 {
-   enum TN_RCode rc = _check_param_generic(sem);
+   enum TN_RCode rc = _check_param_job_perform(sem, cnt);
    TN_BOOL waited_for_sem = TN_FALSE;
 
    if (rc != TN_RC_OK){
@@ -134,11 +171,14 @@ _TN_STATIC_INLINE enum TN_RCode _sem_job_perform(
    } else {
       TN_INTSAVE_DATA;
 
-      TN_INT_DIS_SAVE();      //-- disable interrupts
-      rc = p_worker(sem);     //-- call actual worker function
+      TN_INT_DIS_SAVE();         //-- disable interrupts
+      rc = p_worker(sem, cnt);   //-- call actual worker function
 
       //-- if we should wait, put current task to wait
       if (rc == TN_RC_TIMEOUT && timeout != 0){
+         //-- remember how many units we wait for,
+         //   see _sem_waiters_serve()
+         _tn_curr_run_task->subsys_wait.sem.cnt = cnt;
          _tn_task_curr_to_wait_action(
                &(sem->wait_queue), TN_WAIT_REASON_SEM, timeout
                );
@@ -170,13 +210,15 @@ _TN_STATIC_INLINE enum TN_RCode _sem_job_perform(
  *
  * @param sem        semaphore to perform job on
  * @param p_worker   pointer to actual worker function
+ * @param cnt        number of units
  */
 _TN_STATIC_INLINE enum TN_RCode _sem_job_iperform(
       struct TN_Sem *sem,
-      enum TN_RCode (p_worker)(struct TN_Sem *sem)
+      enum TN_RCode (p_worker)(struct TN_Sem *sem, int cnt),
+      int cnt
       )
 {
-   enum TN_RCode rc = _check_param_generic(sem);
+   enum TN_RCode rc = _check_param_job_perform(sem, cnt);
 
    //-- perform additional params checking (if enabled by TN_CHECK_PARAM)
    if (rc != TN_RC_OK){
@@ -186,46 +228,159 @@ _TN_STATIC_INLINE enum TN_RCode _sem_job_iperform(
    } else {
       TN_INTSAVE_DATA_INT;
 
-      TN_INT_IDIS_SAVE();     //-- disable interrupts
-      rc = p_worker(sem);     //-- call actual worker function
-      TN_INT_IRESTORE();      //-- restore previous interrupts state
+      TN_INT_IDIS_SAVE();        //-- disable interrupts
+      rc = p_worker(sem, cnt);   //-- call actual worker function
+      TN_INT_IRESTORE();         //-- restore previous interrupts state
       _TN_CONTEXT_SWITCH_IPEND_IF_NEEDED();
    }
    return rc;
 }
 
-_TN_STATIC_INLINE enum TN_RCode _sem_signal(struct TN_Sem *sem)
+/**
+ * Should be called whenever semaphore counter is changed: if the counter has
+ * become zero or non-zero, set or clear flag in the connected event group (if
+ * any).
+ *
+ * @param sem           semaphore whose counter is changed
+ * @param count_prev    previous value of the counter
+ */
+_TN_STATIC_INLINE void _sem_eventgrp_link_update(
+      struct TN_Sem *sem,
+      int count_prev
+      )
 {
-   enum TN_RCode rc = TN_RC_OK;
+   if ((count_prev == 0) != (sem->count == 0)){
+      _tn_eventgrp_link_manage(&sem->eventgrp_link, (sem->count > 0));
+   }
+}
+
+/**
+ * Give units from the counter to the waiting tasks.
+ *
+ * Tasks are served in FIFO order: tasks from the head of the wait queue are
+ * woken up as long as the counter is enough for them; the rest of the tasks
+ * (if any) stay waiting, even if the counter is enough for some of them.
+ * If all the tasks are served, remaining units are given to the tasks
+ * waiting in tn_select() (if any), one unit per task.
+ */
+static void _sem_waiters_serve(struct TN_Sem *sem)
+{
+   struct TN_Task *task;
+
+   while (!_tn_list_is_empty(&sem->wait_queue)){
+      task = _tn_list_first_entry(
+            &sem->wait_queue, struct TN_Task, task_queue
+            );
+
+      if (task->subsys_wait.sem.cnt > sem->count){
+         //-- not enough units for the first task, so nobody may
+         //   take them
+         break;
+      }
 
-   //-- wake up first (if any) task from the semaphore wait queue
-   if (  !_tn_task_first_wait_complete(
-            &sem->wait_queue, TN_RC_OK,
-            TN_NULL, TN_NULL, TN_NULL
+      sem->count -= task->subsys_wait.sem.cnt;
+
+      //-- zero `cnt` indicates that the units are given to the task, so
+      //   that _tn_sem_on_task_wait_complete() doesn't serve others
+      task->subsys_wait.sem.cnt = 0;
+      _tn_task_wait_complete(task, TN_RC_OK);
+
+      //-- semaphore is acquired by the waiting task
+      _TN_OBJ_STATS_ACQUIRED(sem);
+   }
+
+   if (_tn_list_is_empty(&sem->wait_queue)){
+      while (     sem->count > 0
+               && _tn_select_first_complete(&sem->select_queue, TN_NULL)
             )
-      )
+      {
+         sem->count--;
+         _TN_OBJ_STATS_ACQUIRED(sem);
+      }
+   }
+}
+
+/**
+ * Returns how many units out of `avail` would be taken by the waiting tasks,
+ * see `_sem_waiters_serve()`.
+ */
+static int _sem_waiters_demand_get(struct TN_Sem *sem, int avail)
+{
+   struct TN_Task *task;
+   int taken = 0;
+   TN_BOOL all_served = TN_TRUE;
+
+   _tn_list_for_each_entry(
+         task, struct TN_Task, &sem->wait_queue, task_queue
+         )
    {
-      //-- no tasks are waiting for that semaphore,
-      //   so, just increase its count if possible.
-      if (sem->count < sem->max_count){
-         sem->count++;
-      } else {
-         rc = TN_RC_OVERFLOW;
+      if (task->subsys_wait.sem.cnt > (avail - taken)){
+         all_served = TN_FALSE;
+         break;
       }
+      taken += task->subsys_wait.sem.cnt;
+   }
+
+#if TN_USE_SELECT
+   if (all_served){
+      struct TN_ListItem *item;
+
+      _tn_list_for_each(item, &sem->select_queue){
+         if (taken < avail){
+            taken++;
+         }
+      }
+   }
+#else
+   _TN_UNUSED(all_served);
+#endif
+
+   return taken;
+}
+
+_TN_STATIC_INLINE enum TN_RCode _sem_signal(struct TN_Sem *sem, int cnt)
+{
+   enum TN_RCode rc = TN_RC_OK;
+   int count_prev = sem->count;
+
+   //-- units are added all at once, or not at all: if they don't fit in the
+   //   counter, check how many of them would be taken by the waiting tasks.
+   //   (usually it's not needed, so we don't walk through the tasks then)
+   if (     (sem->count + cnt) > sem->max_count
+         && (sem->count + cnt
+               - _sem_waiters_demand_get(sem, sem->count + cnt))
+            > sem->max_count
+      )
+   {
+      rc = TN_RC_OVERFLOW;
+   } else {
+      //-- add units to the counter, and give them to the waiting tasks
+      //   (if any)
+      sem->count += cnt;
+      _sem_waiters_serve(sem);
+      _sem_eventgrp_link_update(sem, count_prev);
+
+      _TN_TRACE(TN_TRACE_EV_SEM_SIGNAL, 0, sem, sem->count);
    }
 
    return rc;
 }
 
-_TN_STATIC_INLINE enum TN_RCode _sem_wait(struct TN_Sem *sem)
+_TN_STATIC_INLINE enum TN_RCode _sem_wait(struct TN_Sem *sem, int cnt)
 {
    enum TN_RCode rc = TN_RC_OK;
+   int count_prev = sem->count;
 
-   //-- decrement semaphore count if possible.
+   //-- decrement semaphore count if possible (if there are other tasks
+   //   waiting, we should wait after them, see _sem_waiters_serve()).
    //   If not, return TN_RC_TIMEOUT
    //   (it is handled in _sem_job_perform() / _sem_job_iperform())
-   if (sem->count > 0){
-      sem->count--;
+   if (sem->count >= cnt && _tn_list_is_empty(&sem->wait_queue)){
+      sem->count -= cnt;
+      _sem_eventgrp_link_update(sem, count_prev);
+
+      _TN_OBJ_STATS_ACQUIRED(sem);
+      _TN_TRACE(TN_TRACE_EV_SEM_ACQUIRE, 0, sem, sem->count);
    } else {
       rc = TN_RC_TIMEOUT;
    }
@@ -258,11 +413,28 @@ enum TN_RCode tn_sem_create(
    } else {
 
       _tn_list_reset(&(sem->wait_queue));
+#if TN_USE_SELECT
+      _tn_list_reset(&(sem->select_queue));
+#endif
+
+      _tn_eventgrp_link_reset(&sem->eventgrp_link);
 
       sem->count     = start_count;
       sem->max_count = max_count;
       sem->id_sem    = TN_ID_SEMAPHORE;
 
+#if TN_WAKEUP_LATENCY
+      _tn_wakeup_latency_reset(&sem->wakeup_latency);
+#endif
+#if TN_OBJ_STATS
+      _tn_obj_stats_create(&sem->obj_stats, sem);
+#endif
+#if TN_OBJ_REGISTRY
+      _tn_obj_registry_add(TN_ID_SEMAPHORE, &sem->registry_item);
+#endif
+
+      _TN_TRACE(TN_TRACE_EV_SEM_CREATE, 0, sem, start_count);
+
    }
    return rc;
 }
@@ -284,10 +456,21 @@ enum TN_RCode tn_sem_delete(struct TN_Sem * sem)
 
       TN_INT_DIS_SAVE();
 
+      //-- Semaphore does not exist now. It should be done before waking up
+      //   waiting tasks, so that _tn_sem_on_task_wait_complete() doesn't try
+      //   to give units to them.
+      sem->id_sem = TN_ID_NONE;
+
       //-- Remove all tasks from wait queue, returning the TN_RC_DELETED code.
       _tn_wait_queue_notify_deleted(&(sem->wait_queue));
-
-      sem->id_sem = TN_ID_NONE;        //-- Semaphore does not exist now
+      _tn_select_notify_deleted(&(sem->select_queue));
+#if TN_OBJ_STATS
+      _tn_obj_stats_delete(&sem->obj_stats);
+#endif
+#if TN_OBJ_REGISTRY
+      _tn_obj_registry_remove(&sem->registry_item);
+#endif
+      _TN_TRACE(TN_TRACE_EV_SEM_DELETE, 0, sem, 0);
       TN_INT_RESTORE();
 
       //-- we might need to switch context if _tn_wait_queue_notify_deleted()
@@ -302,7 +485,7 @@ enum TN_RCode tn_sem_delete(struct TN_Sem * sem)
  */
 enum TN_RCode tn_sem_signal(struct TN_Sem *sem)
 {
-   return _sem_job_perform(sem, _sem_signal, 0);
+   return _sem_job_perform(sem, _sem_signal, 1, 0);
 }
 
 /*
@@ -310,7 +493,7 @@ enum TN_RCode tn_sem_signal(struct TN_Sem *sem)
  */
 enum TN_RCode tn_sem_isignal(struct TN_Sem *sem)
 {
-   return _sem_job_iperform(sem, _sem_signal);
+   return _sem_job_iperform(sem, _sem_signal, 1);
 }
 
 /*
@@ -318,7 +501,7 @@ enum TN_RCode tn_sem_isignal(struct TN_Sem *sem)
  */
 enum TN_RCode tn_sem_wait(struct TN_Sem *sem, TN_TickCnt timeout)
 {
-   return _sem_job_perform(sem, _sem_wait, timeout);
+   return _sem_job_perform(sem, _sem_wait, 1, timeout);
 }
 
 /*
@@ -326,7 +509,7 @@ enum TN_RCode tn_sem_wait(struct TN_Sem *sem, TN_TickCnt timeout)
  */
 enum TN_RCode tn_sem_wait_polling(struct TN_Sem *sem)
 {
-   return _sem_job_perform(sem, _sem_wait, 0);
+   return _sem_job_perform(sem, _sem_wait, 1, 0);
 }
 
 /*
@@ -334,7 +517,130 @@ enum TN_RCode tn_sem_wait_polling(struct TN_Sem *sem)
  */
 enum TN_RCode tn_sem_iwait_polling(struct TN_Sem *sem)
 {
-   return _sem_job_iperform(sem, _sem_wait);
+   return _sem_job_iperform(sem, _sem_wait, 1);
+}
+
+/*
+ * See comments in the header file (tn_sem.h)
+ */
+enum TN_RCode tn_sem_signal_n(struct TN_Sem *sem, int cnt)
+{
+   return _sem_job_perform(sem, _sem_signal, cnt, 0);
+}
+
+/*
+ * See comments in the header file (tn_sem.h)
+ */
+enum TN_RCode tn_sem_isignal_n(struct TN_Sem *sem, int cnt)
+{
+   return _sem_job_iperform(sem, _sem_signal, cnt);
+}
+
+/*
+ * See comments in the header file (tn_sem.h)
+ */
+enum TN_RCode tn_sem_wait_n(struct TN_Sem *sem, int cnt, TN_TickCnt timeout)
+{
+   return _sem_job_perform(sem, _sem_wait, cnt, timeout);
+}
+
+/*
+ * See comments in the header file (tn_sem.h)
+ */
+enum TN_RCode tn_sem_wait_n_polling(struct TN_Sem *sem, int cnt)
+{
+   return _sem_job_perform(sem, _sem_wait, cnt, 0);
+}
+
+/*
+ * See comments in the header file (tn_sem.h)
+ */
+enum TN_RCode tn_sem_iwait_n_polling(struct TN_Sem *sem, int cnt)
+{
+   return _sem_job_iperform(sem, _sem_wait, cnt);
+}
+
+/*
+ * See comments in the header file (tn_sem.h)
+ */
+enum TN_RCode tn_sem_eventgrp_connect(
+      struct TN_Sem       *sem,
+      struct TN_EventGrp  *eventgrp,
+      TN_UWord             pattern
+      )
+{
+   TN_UWord sr_saved;
+   enum TN_RCode rc = _check_param_generic(sem);
+
+   if (rc == TN_RC_OK){
+      sr_saved = tn_arch_sr_save_int_dis();
+      rc = _tn_eventgrp_link_set(&sem->eventgrp_link, eventgrp, pattern);
+      if (rc == TN_RC_OK){
+         //-- set or clear flag(s) according to the current state
+         _tn_eventgrp_link_manage(&sem->eventgrp_link, (sem->count > 0));
+      }
+      tn_arch_sr_restore(sr_saved);
+
+      //-- we might need to switch context if some task waiting for the
+      //   flag(s) has been woken up
+      _tn_context_switch_pend_if_needed();
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_sem.h)
+ */
+enum TN_RCode tn_sem_eventgrp_disconnect(
+      struct TN_Sem       *sem
+      )
+{
+   TN_UWord sr_saved;
+   enum TN_RCode rc = _check_param_generic(sem);
+
+   if (rc == TN_RC_OK){
+      sr_saved = tn_arch_sr_save_int_dis();
+      rc = _tn_eventgrp_link_reset(&sem->eventgrp_link);
+      tn_arch_sr_restore(sr_saved);
+   }
+
+   return rc;
+}
+
+
+/*******************************************************************************
+ *    PROTECTED FUNCTIONS
+ ******************************************************************************/
+
+#if TN_USE_SELECT
+/*
+ * See comments in the file _tn_sem.h
+ */
+enum TN_RCode _tn_sem_select_try(struct TN_Sem *sem)
+{
+   return _sem_wait(sem, 1);
+}
+#endif
+
+/*
+ * See comments in the file _tn_sem.h
+ */
+void _tn_sem_on_task_wait_complete(struct TN_Task *task)
+{
+   struct TN_Sem *sem = _get_sem_by_wait_queue(task->pwait_queue);
+   int count_prev;
+
+   if (task->subsys_wait.sem.cnt == 0){
+      //-- task has just got units in _sem_waiters_serve(), nothing to do
+   } else if (_tn_sem_is_valid(sem)){
+      //-- task stopped waiting because of timeout or forced release. If it
+      //   was the first one in the queue, tasks behind it might take units
+      //   now.
+      count_prev = sem->count;
+      _sem_waiters_serve(sem);
+      _sem_eventgrp_link_update(sem, count_prev);
+   }
 }
 
 
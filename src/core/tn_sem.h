@@ -71,6 +71,10 @@
 
 #include "tn_list.h"
 #include "tn_common.h"
+#include "tn_wakeup_latency.h"
+#include "tn_obj_stats.h"
+#include "tn_obj_registry.h"
+#include "tn_eventgrp.h"
 
 
 
@@ -94,12 +98,50 @@ struct TN_Sem {
    ///
    /// List of tasks that wait for the semaphore
    struct TN_ListItem wait_queue;
+#if TN_USE_SELECT || DOXYGEN_ACTIVE
+   ///
+   /// List of `tn_select()` items that wait for the semaphore,
+   /// available if only `#TN_USE_SELECT` option is non-zero.
+   struct TN_ListItem select_queue;
+#endif
    ///
    /// Current semaphore counter value
    int count;
    ///
    /// Max value of `count`
    int max_count;
+   ///
+   /// connected event group
+   struct TN_EGrpLink eventgrp_link;
+#if TN_WAKEUP_LATENCY || DOXYGEN_ACTIVE
+   ///
+   /// Wake-up latency histogram, available if only `#TN_WAKEUP_LATENCY`
+   /// option is non-zero. See `#tn_wakeup_latency_obj_get()`
+   struct TN_WakeupLatency wakeup_latency;
+#endif
+#if TN_OBJ_STATS || DOXYGEN_ACTIVE
+   ///
+   /// Contention statistics, available if only `#TN_OBJ_STATS` option is
+   /// non-zero. See `#tn_obj_stats_get()`
+   struct _TN_ObjStats obj_stats;
+#endif
+#if TN_OBJ_REGISTRY || DOXYGEN_ACTIVE
+   ///
+   /// List item for the registry of kernel objects, available if only
+   /// `#TN_OBJ_REGISTRY` option is non-zero. See `#tn_obj_registry_next()`
+   struct TN_ListItem registry_item;
+#endif
+};
+
+/**
+ * Semaphore-specific fields related to waiting task,
+ * to be included in struct TN_Task.
+ */
+struct TN_SemTaskWait {
+   ///
+   /// Number of units the task waits for; it is set to 0 when the units
+   /// are given to the task.
+   int cnt;
 };
 
 
@@ -167,7 +209,8 @@ enum TN_RCode tn_sem_delete(struct TN_Sem *sem);
  * If current semaphore counter (`count`) is less than `max_count`, counter is
  * incremented by one, and first task (if any) that \ref tn_sem_wait() "waits"
  * for the semaphore becomes runnable with `#TN_RC_OK` returned from
- * `tn_sem_wait()`.
+ * `tn_sem_wait()`. If the first task waits for several units (see
+ * `tn_sem_wait_n()`), it becomes runnable when the counter is enough for it.
  *
  * if semaphore counter is already has its max value, no action performed and
  * `#TN_RC_OVERFLOW` is returned
@@ -200,8 +243,10 @@ enum TN_RCode tn_sem_isignal(struct TN_Sem *sem);
 /**
  * Wait for the semaphore.
  *
- * If the current semaphore counter (`count`) is non-zero, it is decremented
- * and `#TN_RC_OK` is returned. Otherwise, behavior depends on `timeout` value:
+ * If the current semaphore counter (`count`) is non-zero (and there are no
+ * other tasks waiting for the semaphore, see `tn_sem_wait_n()`), it is
+ * decremented and `#TN_RC_OK` is returned. Otherwise, behavior depends on
+ * `timeout` value:
  * task might switch to $(TN_TASK_STATE_WAIT) state until someone \ref
  * tn_sem_signal "signaled" the semaphore or until the `timeout` expired. refer
  * to `#TN_TickCnt`.
@@ -241,6 +286,139 @@ enum TN_RCode tn_sem_wait_polling(struct TN_Sem *sem);
  */
 enum TN_RCode tn_sem_iwait_polling(struct TN_Sem *sem);
 
+/**
+ * Signal the semaphore with `cnt` units at once.
+ *
+ * The same as calling `tn_sem_signal()` `cnt` times, but atomically, and
+ * in just one critical section: either all the units are added, or, if the
+ * counter would exceed `max_count`, nothing is changed and `#TN_RC_OVERFLOW`
+ * is returned.
+ *
+ * Waiting tasks are served in FIFO order, all in the same call: tasks from
+ * the head of the wait queue become runnable as long as the counter is
+ * enough for them.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param sem     semaphore to signal
+ * @param cnt     number of units to add, should be from `1` to `max_count`
+ * 
+ * @return
+ *    * `#TN_RC_OK` if successful
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * `#TN_RC_OVERFLOW` if units which aren't taken by the waiting tasks
+ *      don't fit in the counter
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_sem_signal_n(struct TN_Sem *sem, int cnt);
+
+/**
+ * The same as `tn_sem_signal_n()` but for using in the ISR.
+ *
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ */
+enum TN_RCode tn_sem_isignal_n(struct TN_Sem *sem, int cnt);
+
+/**
+ * Wait for `cnt` units of the semaphore at once.
+ *
+ * Units are taken atomically: either the task gets all `cnt` units, or none
+ * of them. So, unlike calling `tn_sem_wait()` in a loop, the task never
+ * holds part of the units while waiting for the rest.
+ *
+ * Waiting tasks are served in FIFO order: if some tasks already wait for the
+ * semaphore, new task waits as well, even if the counter is enough for it
+ * right now. This way, the task waiting for many units is never starved by
+ * the tasks waiting for just a few.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_CAN_SLEEP)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param sem     semaphore to wait for
+ * @param cnt     number of units to take, should be from `1` to `max_count`
+ * @param timeout refer to `#TN_TickCnt`
+ *
+ * @return
+ *    * `#TN_RC_OK` if waiting was successfull
+ *    * Other possible return codes depend on `timeout` value,
+ *      refer to `#TN_TickCnt`
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_sem_wait_n(struct TN_Sem *sem, int cnt, TN_TickCnt timeout);
+
+/**
+ * The same as `tn_sem_wait_n()` with zero timeout.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ */
+enum TN_RCode tn_sem_wait_n_polling(struct TN_Sem *sem, int cnt);
+
+/**
+ * The same as `tn_sem_wait_n()` with zero timeout, but for using in the ISR.
+ *
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ */
+enum TN_RCode tn_sem_iwait_n_polling(struct TN_Sem *sem, int cnt);
+
+/**
+ * Connect an event group to the semaphore.
+ * Refer to the section \ref eventgrp_connect for details.
+ *
+ * The flag(s) given in `pattern` are set while the semaphore counter is non-zero, and
+ * cleared otherwise. The flags are brought in line with the current state of
+ * the semaphore right when the event group is connected.
+ *
+ * Only one event group can be connected to the semaphore at a time. If you
+ * connect event group while another event group is already connected,
+ * the old link is discarded.
+ *
+ * @param sem
+ *    semaphore to which event group should be connected
+ * @param eventgrp 
+ *    event group to connect
+ * @param pattern
+ *    flags pattern that should be managed by the semaphore automatically
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ */
+enum TN_RCode tn_sem_eventgrp_connect(
+      struct TN_Sem       *sem,
+      struct TN_EventGrp  *eventgrp,
+      TN_UWord             pattern
+      );
+
+
+/**
+ * Disconnect a connected event group from the semaphore.
+ * Refer to the section \ref eventgrp_connect for details.
+ *
+ * If there is no event group connected, nothing is changed.
+ *
+ * @param sem     semaphore from which event group should be disconnected
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_LEGEND_LINK)
+ */
+enum TN_RCode tn_sem_eventgrp_disconnect(
+      struct TN_Sem       *sem
+      );
+
 
 #ifdef __cplusplus
 }  /* extern "C" */
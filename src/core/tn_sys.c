@@ -54,6 +54,10 @@
 #include "_tn_timer.h"
 #include "_tn_tasks.h"
 #include "_tn_list.h"
+#include "_tn_trace.h"
+#include "_tn_wakeup_latency.h"
+#include "_tn_cpu_load.h"
+#include "_tn_pc_sample.h"
 
 
 #include "tn_tasks.h"
@@ -79,6 +83,28 @@
  *    PRIVATE TYPES
  ******************************************************************************/
 
+#if TN_PROFILER_ISR_CNT
+/**
+ * Internal profiler data of a single interrupt ID, see `#TN_PROFILER_ISR_CNT`.
+ */
+struct _TN_ISRProfiler {
+   ///
+   /// Time (see `_TN_PROFILER_TIME_GET()`) of when the ISR got running or
+   /// got resumed (after nested ISR is done) last time.
+   TN_TickCnt        last_time;
+   ///
+   /// Time ISR is running since it was entered, nested ISRs excluded.
+   TN_TickCnt        cur_run_time;
+   ///
+   /// ID of the ISR that was preempted by this one, or -1 if ISR has
+   /// preempted a task.
+   int               prev_isr_id;
+   ///
+   /// Whether ISR is entered at the moment
+   TN_BOOL           is_running;
+};
+#endif
+
 
 /*******************************************************************************
  *    PROTECTED DATA
@@ -90,6 +116,11 @@ struct TN_ListItem _tn_tasks_ready_list[TN_PRIORITIES_CNT];
 // See comments in the internal/_tn_sys.h file
 struct TN_ListItem _tn_tasks_created_list;
 
+#if TN_USE_PREEMPT_THRESHOLD
+// See comments in the internal/_tn_sys.h file
+struct TN_ListItem _tn_tasks_preempted_list;
+#endif
+
 // See comments in the internal/_tn_sys.h file
 volatile int _tn_tasks_created_cnt;
 
@@ -136,6 +167,10 @@ TN_CBStackOverflow *_tn_cb_stack_overflow = TN_NULL;
 /// (see `#TN_MUTEX_DEADLOCK_DETECT`)
 TN_CBDeadlock *_tn_cb_deadlock = TN_NULL;
 
+/// User-provided callback function that returns timestamp for instrumentation
+/// features, see `#tn_callback_timestamp_set()`
+TN_CBTimestamp *_tn_cb_timestamp = TN_NULL;
+
 /// Time slice values for each available priority, in system ticks.
 unsigned short _tn_tslice_ticks[TN_PRIORITIES_CNT];
 
@@ -144,6 +179,24 @@ unsigned short _tn_tslice_ticks[TN_PRIORITIES_CNT];
 int _tn_deadlocks_cnt = 0;
 #endif
 
+#if TN_PROFILER_ISR_CNT
+/// System-level timing managed by profiler, see `#tn_sys_profiler_timing_get()`
+struct TN_SysTiming _tn_sys_timing;
+
+/// Profiler data of each interrupt ID
+struct _TN_ISRProfiler _tn_isr_profiler[ TN_PROFILER_ISR_CNT ];
+
+/// ID of the innermost ISR being executed at the moment, or -1 if none.
+int _tn_isr_profiler_cur_id = -1;
+
+/// Time of when the outermost accounted ISR was entered
+TN_TickCnt _tn_isr_profiler_nest_start;
+
+/// Time spent in accounted ISRs since currently running task got running;
+/// it is subtracted from task's run time on context switch.
+TN_TickCnt _tn_isr_profiler_task_time;
+#endif
+
 
 /*******************************************************************************
  *    PRIVATE DATA
@@ -172,6 +225,14 @@ static void _idle_task_body(void *par)
    //-- enter endless loop with calling user-provided hook function
    for(;;)
    {
+      //-- if `#TN_STACK_USAGE_IDLE_SCAN` is non-zero, scan a small piece
+      //   of some task's stack; otherwise it's a no-op
+      _tn_task_stack_scan_step();
+
+      //-- if `#TN_STACK_OVERFLOW_CANARY_CNT` is non-zero, check canary of
+      //   some task; otherwise it's a no-op
+      _tn_task_stack_canary_check_step();
+
       _tn_cb_idle_hook();
    }
    _TN_UNUSED(par);
@@ -193,8 +254,15 @@ _TN_STATIC_INLINE void _round_robin_manage(void) {
 _TN_STATIC_INLINE void _round_robin_manage(void)
 {
    //-- Manage round robin if only context switch is not already needed for
-   //   some other reason
-   if (_tn_curr_run_task == _tn_next_task_to_run) {
+   //   some other reason, and if preemption threshold of the current task
+   //   isn't in effect (if it is, tasks of the same priority may not
+   //   preempt it)
+   if (     _tn_curr_run_task == _tn_next_task_to_run
+#if TN_USE_PREEMPT_THRESHOLD
+         && _tn_curr_run_task->preempt_threshold >= _tn_curr_run_task->priority
+#endif
+      )
+   {
       //-- volatile is used here only to solve
       //   IAR(c) compiler's high optimization mode problem
       _TN_VOLATILE_WORKAROUND struct TN_ListItem *curr_que;
@@ -251,7 +319,7 @@ _TN_STATIC_INLINE void _tn_sys_on_context_switch_profiler(
    //-- interrupts should be disabled here
    _TN_BUG_ON(!TN_IS_INT_DISABLED());
 
-   TN_TickCnt cur_tick_cnt = _tn_timer_sys_time_get();
+   TN_TickCnt cur_time = _TN_PROFILER_TIME_GET();
 
    //-- handle task_prev (the one that was running and going to wait) {{{
    {
@@ -265,7 +333,18 @@ _TN_STATIC_INLINE void _tn_sys_on_context_switch_profiler(
       //-- get difference between current time and last saved time:
       //   this is the time task was running.
       TN_TickCnt cur_run_time
-         = (TN_TickCnt)(cur_tick_cnt - task_prev->profiler.last_tick_cnt);
+         = _TN_PROFILER_TIME_DIFF(cur_time, task_prev->profiler.last_tick_cnt);
+
+#if TN_PROFILER_ISR_CNT
+      //-- exclude time of accounted ISRs that have preempted the task
+      //   (it is accounted in `_tn_sys_timing` instead)
+      if (cur_run_time > _tn_isr_profiler_task_time){
+         cur_run_time -= _tn_isr_profiler_task_time;
+      } else {
+         cur_run_time = 0;
+      }
+      _tn_isr_profiler_task_time = 0;
+#endif
 
       //-- add it to total run time
       task_prev->profiler.timing.total_run_time += cur_run_time;
@@ -276,7 +355,7 @@ _TN_STATIC_INLINE void _tn_sys_on_context_switch_profiler(
       }
 
       //-- update current task state
-      task_prev->profiler.last_tick_cnt      = cur_tick_cnt;
+      task_prev->profiler.last_tick_cnt      = cur_time;
 #if TN_PROFILER_WAIT_TIME
       task_prev->profiler.last_wait_reason   = task_prev->task_wait_reason;
 #endif
@@ -296,7 +375,7 @@ _TN_STATIC_INLINE void _tn_sys_on_context_switch_profiler(
       //-- get difference between current time and last saved time:
       //   this is the time task was waiting.
       TN_TickCnt cur_wait_time
-         = (TN_TickCnt)(cur_tick_cnt - task_new->profiler.last_tick_cnt);
+         = _TN_PROFILER_TIME_DIFF(cur_time, task_new->profiler.last_tick_cnt);
 
       //-- add it to total total_wait_time for particular wait reason
       task_new->profiler.timing.total_wait_time
@@ -318,7 +397,7 @@ _TN_STATIC_INLINE void _tn_sys_on_context_switch_profiler(
       task_new->profiler.timing.got_running_cnt++;
 
       //-- update current task state
-      task_new->profiler.last_tick_cnt      = cur_tick_cnt;
+      task_new->profiler.last_tick_cnt      = cur_time;
    }
    // }}}
 }
@@ -367,12 +446,7 @@ _TN_STATIC_INLINE void _tn_sys_stack_overflow_check(
 
    if (*p_word != TN_FILL_STACK_VAL){
       //-- stack overflow is detected, so, notify the user about that.
-
-      if (_tn_cb_stack_overflow != NULL){
-         _tn_cb_stack_overflow(task);
-      } else {
-         _TN_FATAL_ERROR("stack overflow");
-      }
+      _tn_sys_stack_overflow_notify(task);
    }
 }
 #else
@@ -470,6 +544,10 @@ static void _build_cfg_check(void)
       _TN_FATAL_ERROR("TN_PROFILER_WAIT_TIME doesn't match");
    }
 
+   if (kernel_build_cfg.profiler_isr_cnt != app_build_cfg->profiler_isr_cnt){
+      _TN_FATAL_ERROR("TN_PROFILER_ISR_CNT doesn't match");
+   }
+
    if (kernel_build_cfg.stack_overflow_check != app_build_cfg->stack_overflow_check){
       _TN_FATAL_ERROR("TN_STACK_OVERFLOW_CHECK doesn't match");
    }
@@ -482,6 +560,82 @@ static void _build_cfg_check(void)
       _TN_FATAL_ERROR("TN_OLD_EVENT_API doesn't match");
    }
 
+   if (kernel_build_cfg.trace != app_build_cfg->trace){
+      _TN_FATAL_ERROR("TN_TRACE doesn't match");
+   }
+
+   if (kernel_build_cfg.wakeup_latency != app_build_cfg->wakeup_latency){
+      _TN_FATAL_ERROR("TN_WAKEUP_LATENCY doesn't match");
+   }
+
+   if (  kernel_build_cfg.wakeup_latency_bins_cnt
+         != app_build_cfg->wakeup_latency_bins_cnt
+      )
+   {
+      _TN_FATAL_ERROR("TN_WAKEUP_LATENCY_BINS_CNT doesn't match");
+   }
+
+   if (kernel_build_cfg.csect_measure != app_build_cfg->csect_measure){
+      _TN_FATAL_ERROR("TN_CSECT_MEASURE doesn't match");
+   }
+
+   if (  kernel_build_cfg.stack_usage_idle_scan
+         != app_build_cfg->stack_usage_idle_scan
+      )
+   {
+      _TN_FATAL_ERROR("TN_STACK_USAGE_IDLE_SCAN doesn't match");
+   }
+
+   if (  kernel_build_cfg.stack_overflow_canary_cnt
+         != app_build_cfg->stack_overflow_canary_cnt
+      )
+   {
+      _TN_FATAL_ERROR("TN_STACK_OVERFLOW_CANARY_CNT doesn't match");
+   }
+
+   if (  kernel_build_cfg.stack_overflow_mpu_guard
+         != app_build_cfg->stack_overflow_mpu_guard
+      )
+   {
+      _TN_FATAL_ERROR("TN_STACK_OVERFLOW_MPU_GUARD doesn't match");
+   }
+
+   if (kernel_build_cfg.cpu_load != app_build_cfg->cpu_load){
+      _TN_FATAL_ERROR("TN_CPU_LOAD doesn't match");
+   }
+
+   if (kernel_build_cfg.pc_sample != app_build_cfg->pc_sample){
+      _TN_FATAL_ERROR("TN_PC_SAMPLE doesn't match");
+   }
+
+   if (kernel_build_cfg.obj_stats != app_build_cfg->obj_stats){
+      _TN_FATAL_ERROR("TN_OBJ_STATS doesn't match");
+   }
+
+   if (kernel_build_cfg.obj_registry != app_build_cfg->obj_registry){
+      _TN_FATAL_ERROR("TN_OBJ_REGISTRY doesn't match");
+   }
+
+   if (kernel_build_cfg.compact_tcb != app_build_cfg->compact_tcb){
+      _TN_FATAL_ERROR("TN_COMPACT_TCB doesn't match");
+   }
+
+   if (kernel_build_cfg.use_rwlocks != app_build_cfg->use_rwlocks){
+      _TN_FATAL_ERROR("TN_USE_RWLOCKS doesn't match");
+   }
+
+   if (kernel_build_cfg.use_select != app_build_cfg->use_select){
+      _TN_FATAL_ERROR("TN_USE_SELECT doesn't match");
+   }
+
+   if (kernel_build_cfg.use_rpc != app_build_cfg->use_rpc){
+      _TN_FATAL_ERROR("TN_USE_RPC doesn't match");
+   }
+
+   if (kernel_build_cfg.use_preempt_threshold != app_build_cfg->use_preempt_threshold){
+      _TN_FATAL_ERROR("TN_USE_PREEMPT_THRESHOLD doesn't match");
+   }
+
 #if defined (__TN_ARCH_PIC24_DSPIC__)
    if (kernel_build_cfg.arch.p24.p24_sys_ipl != app_build_cfg->arch.p24.p24_sys_ipl){
       _TN_FATAL_ERROR("TN_P24_SYS_IPL doesn't match");
@@ -544,6 +698,11 @@ void tn_sys_start(
    _tn_list_reset(&_tn_tasks_created_list);
    _tn_tasks_created_cnt = 0;
 
+#if TN_USE_PREEMPT_THRESHOLD
+   //-- no tasks are preempted yet
+   _tn_list_reset(&_tn_tasks_preempted_list);
+#endif
+
    //-- initial system flags: no flags set (see enum TN_StateFlag)
    _tn_sys_state = (enum TN_StateFlag)(0);  
 
@@ -597,6 +756,14 @@ void tn_sys_start(
 #endif
 #endif
 
+#if TN_PROFILER_ISR_CNT
+   //-- reset ISR profiler data
+   memset(&_tn_sys_timing, 0x00, sizeof(_tn_sys_timing));
+   memset(_tn_isr_profiler, 0x00, sizeof(_tn_isr_profiler));
+   _tn_isr_profiler_cur_id    = -1;
+   _tn_isr_profiler_task_time = 0;
+#endif
+
    //-- now, we can create user's task(s)
    //   (by user-provided callback)
    cb_user_task_create();
@@ -633,6 +800,12 @@ void tn_tick_int_processing(void)
    //-- manage round-robin (if used)
    _round_robin_manage();
 
+   //-- account CPU load (if `#TN_CPU_LOAD` is non-zero)
+   _tn_cpu_load_on_tick();
+
+   //-- take PC sample (if `#TN_PC_SAMPLE_ON_TICK` is non-zero)
+   _tn_pc_sample_on_tick();
+
    TN_INT_IRESTORE();
    _TN_CONTEXT_SWITCH_IPEND_IF_NEEDED();
 }
@@ -700,6 +873,14 @@ void tn_callback_stack_overflow_set(TN_CBStackOverflow *cb)
    _tn_cb_stack_overflow = cb;
 }
 
+/*
+ * See comment in tn_sys.h file
+ */
+void tn_callback_timestamp_set(TN_CBTimestamp *cb)
+{
+   _tn_cb_timestamp = cb;
+}
+
 /*
  * See comment in tn_sys.h file
  */
@@ -735,6 +916,141 @@ TN_TaskBody *tn_cur_task_body_get(void)
 }
 
 
+#if TN_PROFILER_ISR_CNT
+/*
+ * See comment in tn_sys.h file
+ */
+enum TN_RCode tn_sys_profiler_isr_enter(int isr_id)
+{
+   enum TN_RCode rc = TN_RC_OK;
+
+   if (!tn_is_isr_context()){
+      rc = TN_RC_WCONTEXT;
+   } else if (isr_id < 0 || isr_id >= TN_PROFILER_ISR_CNT){
+      rc = TN_RC_WPARAM;
+   } else {
+      TN_INTSAVE_DATA_INT;
+      TN_TickCnt cur_time;
+      struct _TN_ISRProfiler *isr = &_tn_isr_profiler[isr_id];
+
+      TN_INT_IDIS_SAVE();
+
+      if (isr->is_running){
+         //-- the same ISR can't be entered twice
+         rc = TN_RC_WSTATE;
+      } else {
+         cur_time = _TN_PROFILER_TIME_GET();
+
+         if (_tn_isr_profiler_cur_id >= 0){
+            //-- we've preempted another accounted ISR: charge time it was
+            //   running so far to it
+            struct _TN_ISRProfiler *isr_prev
+               = &_tn_isr_profiler[_tn_isr_profiler_cur_id];
+            TN_TickCnt run_time
+               = _TN_PROFILER_TIME_DIFF(cur_time, isr_prev->last_time);
+
+            isr_prev->cur_run_time += run_time;
+            _tn_sys_timing.isr_timing[_tn_isr_profiler_cur_id]
+               .total_run_time += run_time;
+         } else {
+            //-- we've preempted a task: remember when the outermost ISR
+            //   has started
+            _tn_isr_profiler_nest_start = cur_time;
+         }
+
+         isr->prev_isr_id     = _tn_isr_profiler_cur_id;
+         isr->last_time       = cur_time;
+         isr->cur_run_time    = 0;
+         isr->is_running      = TN_TRUE;
+
+         _tn_isr_profiler_cur_id = isr_id;
+         _tn_sys_timing.isr_timing[isr_id].got_running_cnt++;
+      }
+
+      TN_INT_IRESTORE();
+   }
+
+   return rc;
+}
+
+/*
+ * See comment in tn_sys.h file
+ */
+enum TN_RCode tn_sys_profiler_isr_exit(void)
+{
+   enum TN_RCode rc = TN_RC_OK;
+
+   if (!tn_is_isr_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      TN_INTSAVE_DATA_INT;
+
+      TN_INT_IDIS_SAVE();
+
+      if (_tn_isr_profiler_cur_id < 0){
+         //-- there is no entered ISR
+         rc = TN_RC_WSTATE;
+      } else {
+         TN_TickCnt cur_time = _TN_PROFILER_TIME_GET();
+         int isr_id = _tn_isr_profiler_cur_id;
+         struct _TN_ISRProfiler *isr = &_tn_isr_profiler[isr_id];
+         struct TN_ISRTiming *timing = &_tn_sys_timing.isr_timing[isr_id];
+
+         TN_TickCnt run_time
+            = _TN_PROFILER_TIME_DIFF(cur_time, isr->last_time);
+
+         isr->cur_run_time += run_time;
+         timing->total_run_time += run_time;
+
+         //-- check if we should update consecutive max run time
+         if (timing->max_consecutive_run_time < isr->cur_run_time){
+            timing->max_consecutive_run_time = isr->cur_run_time;
+         }
+
+         isr->is_running = TN_FALSE;
+         _tn_isr_profiler_cur_id = isr->prev_isr_id;
+
+         if (_tn_isr_profiler_cur_id >= 0){
+            //-- resume preempted ISR
+            _tn_isr_profiler[_tn_isr_profiler_cur_id].last_time = cur_time;
+         } else {
+            //-- the outermost ISR is done: the whole nest time should be
+            //   excluded from the run time of the interrupted task
+            TN_TickCnt nest_time
+               = _TN_PROFILER_TIME_DIFF(cur_time, _tn_isr_profiler_nest_start);
+
+            _tn_isr_profiler_task_time    += nest_time;
+            _tn_sys_timing.total_isr_time += nest_time;
+         }
+      }
+
+      TN_INT_IRESTORE();
+   }
+
+   return rc;
+}
+
+/*
+ * See comment in tn_sys.h file
+ */
+enum TN_RCode tn_sys_profiler_timing_get(struct TN_SysTiming *tgt)
+{
+   enum TN_RCode rc = TN_RC_OK;
+
+   if (tgt == TN_NULL){
+      rc = TN_RC_WPARAM;
+   } else {
+      TN_UWord sr_saved;
+      sr_saved = tn_arch_sr_save_int_dis();
+      memcpy(tgt, &_tn_sys_timing, sizeof(*tgt));
+      tn_arch_sr_restore(sr_saved);
+   }
+
+   return rc;
+}
+#endif
+
+
 #if TN_DYNAMIC_TICK
 
 void tn_callback_dyn_tick_set(
@@ -783,6 +1099,50 @@ void _tn_wait_queue_notify_deleted(struct TN_ListItem *wait_queue)
 #endif
 }
 
+/**
+ * See comments in the file _tn_sys.h
+ */
+TN_UWord _tn_sys_timestamp_get(void)
+{
+   TN_UWord ret = 0;
+
+   if (_tn_cb_timestamp != TN_NULL){
+      ret = _tn_cb_timestamp();
+   } else {
+#if TN_DYNAMIC_TICK
+      //-- objects might be created before dynamic tick callbacks are set,
+      //   so, check it first
+      if (_tn_cb_tick_cnt_get != TN_NULL){
+         ret = (TN_UWord)_tn_timer_sys_time_get();
+      }
+#else
+      ret = (TN_UWord)_tn_timer_sys_time_get();
+#endif
+   }
+
+   return ret;
+}
+
+/**
+ * See comments in the file _tn_sys.h
+ */
+TN_BOOL _tn_sys_timestamp_is_precise(void)
+{
+   return (_tn_cb_timestamp != TN_NULL);
+}
+
+/**
+ * See comments in the file _tn_sys.h
+ */
+void _tn_sys_stack_overflow_notify(struct TN_Task *task)
+{
+   if (_tn_cb_stack_overflow != TN_NULL){
+      _tn_cb_stack_overflow(task);
+   } else {
+      _TN_FATAL_ERROR("stack overflow");
+   }
+}
+
 /**
  * See comments in the file _tn_sys.h
  */
@@ -846,6 +1206,10 @@ void _tn_sys_on_context_switch(
 {
    _tn_sys_stack_overflow_check(task_prev);
    _tn_sys_on_context_switch_profiler(task_prev, task_new);
+   _tn_wakeup_latency_on_context_switch(task_prev, task_new);
+   _tn_cpu_load_on_context_switch(task_prev, task_new);
+   _tn_task_preempt_threshold_on_context_switch(task_prev, task_new);
+   _TN_TRACE(TN_TRACE_EV_CONTEXT_SWITCH, 0, task_new, task_prev);
 }
 #endif
 
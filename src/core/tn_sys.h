@@ -130,9 +130,26 @@ struct TN_Mutex;
    (_p_struct)->api_make_alig_arg         = TN_API_MAKE_ALIG_ARG;       \
    (_p_struct)->profiler                  = TN_PROFILER;                \
    (_p_struct)->profiler_wait_time        = TN_PROFILER_WAIT_TIME;      \
+   (_p_struct)->profiler_isr_cnt          = TN_PROFILER_ISR_CNT;        \
    (_p_struct)->stack_overflow_check      = TN_STACK_OVERFLOW_CHECK;    \
    (_p_struct)->dynamic_tick              = TN_DYNAMIC_TICK;            \
    (_p_struct)->old_events_api            = TN_OLD_EVENT_API;           \
+   (_p_struct)->trace                     = TN_TRACE;                   \
+   (_p_struct)->wakeup_latency            = TN_WAKEUP_LATENCY;          \
+   (_p_struct)->wakeup_latency_bins_cnt   = TN_WAKEUP_LATENCY_BINS_CNT; \
+   (_p_struct)->csect_measure             = TN_CSECT_MEASURE;           \
+   (_p_struct)->stack_usage_idle_scan     = TN_STACK_USAGE_IDLE_SCAN;   \
+   (_p_struct)->stack_overflow_canary_cnt = TN_STACK_OVERFLOW_CANARY_CNT; \
+   (_p_struct)->stack_overflow_mpu_guard  = TN_STACK_OVERFLOW_MPU_GUARD; \
+   (_p_struct)->cpu_load                  = TN_CPU_LOAD;                \
+   (_p_struct)->pc_sample                 = TN_PC_SAMPLE;               \
+   (_p_struct)->obj_stats                 = TN_OBJ_STATS;               \
+   (_p_struct)->obj_registry              = TN_OBJ_REGISTRY;            \
+   (_p_struct)->compact_tcb               = TN_COMPACT_TCB;             \
+   (_p_struct)->use_rwlocks               = TN_USE_RWLOCKS;             \
+   (_p_struct)->use_select                = TN_USE_SELECT;              \
+   (_p_struct)->use_rpc                   = TN_USE_RPC;                 \
+   (_p_struct)->use_preempt_threshold     = TN_USE_PREEMPT_THRESHOLD;   \
                                                                         \
    _TN_BUILD_CFG_ARCH_STRUCT_FILL(_p_struct);                           \
 }
@@ -200,6 +217,9 @@ struct _TN_BuildCfg {
    /// Value of `#TN_PROFILER_WAIT_TIME`
    unsigned          profiler_wait_time         : 1;
    ///
+   /// Value of `#TN_PROFILER_ISR_CNT`
+   unsigned          profiler_isr_cnt           : 8;
+   ///
    /// Value of `#TN_STACK_OVERFLOW_CHECK`
    unsigned          stack_overflow_check       : 1;
    ///
@@ -209,6 +229,54 @@ struct _TN_BuildCfg {
    /// Value of `#TN_OLD_EVENT_API`
    unsigned          old_events_api             : 1;
    ///
+   /// Value of `#TN_TRACE`
+   unsigned          trace                      : 1;
+   ///
+   /// Value of `#TN_WAKEUP_LATENCY`
+   unsigned          wakeup_latency             : 1;
+   ///
+   /// Value of `#TN_WAKEUP_LATENCY_BINS_CNT`
+   unsigned          wakeup_latency_bins_cnt    : 6;
+   ///
+   /// Value of `#TN_CSECT_MEASURE`
+   unsigned          csect_measure              : 1;
+   ///
+   /// Value of `#TN_STACK_USAGE_IDLE_SCAN`
+   unsigned          stack_usage_idle_scan      : 1;
+   ///
+   /// Value of `#TN_STACK_OVERFLOW_CANARY_CNT`
+   unsigned          stack_overflow_canary_cnt  : 8;
+   ///
+   /// Value of `#TN_STACK_OVERFLOW_MPU_GUARD`
+   unsigned          stack_overflow_mpu_guard   : 1;
+   ///
+   /// Value of `#TN_CPU_LOAD`
+   unsigned          cpu_load                   : 1;
+   ///
+   /// Value of `#TN_PC_SAMPLE`
+   unsigned          pc_sample                  : 1;
+   ///
+   /// Value of `#TN_OBJ_STATS`
+   unsigned          obj_stats                  : 1;
+   ///
+   /// Value of `#TN_OBJ_REGISTRY`
+   unsigned          obj_registry               : 1;
+   ///
+   /// Value of `#TN_COMPACT_TCB`
+   unsigned          compact_tcb                : 1;
+   ///
+   /// Value of `#TN_USE_RWLOCKS`
+   unsigned          use_rwlocks                : 1;
+   ///
+   /// Value of `#TN_USE_SELECT`
+   unsigned          use_select                 : 1;
+   ///
+   /// Value of `#TN_USE_RPC`
+   unsigned          use_rpc                    : 1;
+   ///
+   /// Value of `#TN_USE_PREEMPT_THRESHOLD`
+   unsigned          use_preempt_threshold      : 1;
+   ///
    /// Architecture-dependent values
    union {
       ///
@@ -322,7 +390,12 @@ typedef void (TN_CBIdle)(void);
 
 /**
  * User-provided callback function that is called when the kernel detects stack
- * overflow (see `#TN_STACK_OVERFLOW_CHECK`).
+ * overflow (see `#TN_STACK_OVERFLOW_CHECK`, `#TN_STACK_OVERFLOW_CANARY_CNT`,
+ * `#TN_STACK_OVERFLOW_MPU_GUARD`).
+ *
+ * If overflow is detected by the MPU guard, the callback is called from the
+ * MemManage fault handler, and the overflowed task can't proceed: if the
+ * callback returns, `#_TN_FATAL_ERROR()` is called.
  *
  * @param task
  *    Task whose stack is overflowed
@@ -353,6 +426,70 @@ typedef void (TN_CBDeadlock)(
       struct TN_Task *task
       );
 
+/**
+ * User-provided callback function that returns timestamp for various
+ * instrumentation features of the kernel (`#TN_TRACE`, `#TN_WAKEUP_LATENCY`,
+ * `#TN_CSECT_MEASURE`, `#TN_CPU_LOAD`, `#TN_PROFILER_ISR_CNT`).
+ * Typically it is a value of some free-running hardware counter: on
+ * Cortex-M3/M4, `DWT->CYCCNT` is a good candidate. The counter is expected to
+ * wrap around at the width of `#TN_UWord`.
+ *
+ * See `#tn_callback_timestamp_set()`
+ */
+typedef TN_UWord (TN_CBTimestamp)(void);
+
+#if TN_PROFILER_ISR_CNT || DOXYGEN_ACTIVE
+/**
+ * Timing structure of a single interrupt ID, managed by profiler. It is a
+ * part of `struct #TN_SysTiming`.
+ *
+ * Available if only `#TN_PROFILER_ISR_CNT` option is non-zero.
+ */
+struct TN_ISRTiming {
+   ///
+   /// Total time when ISR was running. Time of other accounted ISRs that
+   /// preempted this one is not included.
+   unsigned long long   total_run_time;
+   ///
+   /// How many times ISR got running.
+   unsigned long long   got_running_cnt;
+   ///
+   /// Maximum consecutive time ISR was running (again, time of nested
+   /// accounted ISRs is not included).
+   unsigned long        max_consecutive_run_time;
+};
+
+/**
+ * System-level timing structure that is managed by profiler and can be read
+ * by `#tn_sys_profiler_timing_get()` function. Together with timing of each
+ * task (see `struct #TN_TaskTiming`), it gives the breakdown of CPU time.
+ *
+ * All the times are in timestamp units, see `#tn_callback_timestamp_set()`;
+ * when `#TN_PROFILER_ISR_CNT` is non-zero, times in `struct #TN_TaskTiming`
+ * are in the same units, so they can be compared.
+ *
+ * \attention If timestamp callback isn't set, timestamps are system ticks,
+ * which are way too coarse for ISRs: an ISR which starts and ends within the
+ * same tick is charged nothing. And if the ISR which calls
+ * `#tn_tick_int_processing()` is accounted itself, the tick count is
+ * incremented inside it, so this ISR is charged a whole tick each time (and
+ * the interrupted task is charged nothing). So, set the timestamp callback
+ * (e.g. `DWT->CYCCNT` on Cortex-M3/M4) if you account ISRs; then, the tick
+ * ISR can be accounted as any other one.
+ *
+ * Available if only `#TN_PROFILER_ISR_CNT` option is non-zero.
+ */
+struct TN_SysTiming {
+   ///
+   /// Total time spent in accounted ISRs, with nested ISRs counted just
+   /// once. This time is not included in the `total_run_time` of any task.
+   unsigned long long   total_isr_time;
+   ///
+   /// Timing of each interrupt ID, see `#tn_sys_profiler_isr_enter()`.
+   struct TN_ISRTiming  isr_timing[ TN_PROFILER_ISR_CNT ];
+};
+#endif
+
 
 
 
@@ -495,6 +632,19 @@ void tn_callback_deadlock_set(TN_CBDeadlock *cb);
  */
 void tn_callback_stack_overflow_set(TN_CBStackOverflow *cb);
 
+/**
+ * Set callback function that returns timestamp for kernel instrumentation
+ * features, see `#TN_CBTimestamp`. If callback isn't set, system tick count
+ * is used, which is usually too coarse.
+ *
+ * $(TN_CALL_FROM_MAIN)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param cb
+ *    Pointer to user-provided callback function, or `#TN_NULL`.
+ */
+void tn_callback_timestamp_set(TN_CBTimestamp *cb);
+
 /**
  * Returns current system state flags
  *
@@ -614,6 +764,69 @@ _TN_STATIC_INLINE void tn_sched_restore(TN_UWord sched_state)
 }
 
 
+#if TN_PROFILER_ISR_CNT || DOXYGEN_ACTIVE
+/**
+ * Tell the profiler that ISR with the given ID has started executing. Should
+ * be called in the very beginning of ISR, and should be paired with
+ * `#tn_sys_profiler_isr_exit()` in the end of it. Nested calls (that is,
+ * calls from higher-priority ISRs which preempted the accounted one) are
+ * allowed, but each ID can't be entered again before it's exited.
+ *
+ * Available if only `#TN_PROFILER_ISR_CNT` option is non-zero.
+ *
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param isr_id
+ *    ID of the ISR, should be in the range `[0, #TN_PROFILER_ISR_CNT)`.
+ *    Typically it is an interrupt vector number.
+ *
+ * @return
+ *    * `#TN_RC_OK` on success;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * `#TN_RC_WPARAM` if `isr_id` is out of range;
+ *    * `#TN_RC_WSTATE` if ISR with the given ID is already entered.
+ */
+enum TN_RCode tn_sys_profiler_isr_enter(int isr_id);
+
+/**
+ * Tell the profiler that the ISR most recently entered by
+ * `#tn_sys_profiler_isr_enter()` has finished executing. Should be called in
+ * the very end of ISR.
+ *
+ * Available if only `#TN_PROFILER_ISR_CNT` option is non-zero.
+ *
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_LEGEND_LINK)
+ *
+ * @return
+ *    * `#TN_RC_OK` on success;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * `#TN_RC_WSTATE` if there is no entered ISR.
+ */
+enum TN_RCode tn_sys_profiler_isr_exit(void);
+
+/**
+ * Read system-level profiler timing data. See `struct #TN_SysTiming` for
+ * details on timing data.
+ *
+ * Available if only `#TN_PROFILER_ISR_CNT` option is non-zero.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param tgt
+ *    Target structure to fill with data, should be allocated by caller
+ *
+ * @return
+ *    * `#TN_RC_OK` on success;
+ *    * `#TN_RC_WPARAM` if `tgt` is `#TN_NULL`.
+ */
+enum TN_RCode tn_sys_profiler_timing_get(struct TN_SysTiming *tgt);
+#endif
+
+
 #if TN_DYNAMIC_TICK || defined(DOXYGEN_ACTIVE)
 /**
  * $(TN_IF_ONLY_DYNAMIC_TICK_SET)
@@ -45,8 +45,15 @@
 //-- internal tnkernel headers
 #include "_tn_tasks.h"
 #include "_tn_mutex.h"
+#include "_tn_rwlock.h"
+#include "_tn_sem.h"
+#include "_tn_rpc.h"
+#include "_tn_select.h"
 #include "_tn_timer.h"
 #include "_tn_list.h"
+#include "_tn_trace.h"
+#include "_tn_wakeup_latency.h"
+#include "_tn_obj_stats.h"
 
 
 //-- header of current module
@@ -66,6 +73,33 @@
 
 
 
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+#if TN_STACK_USAGE_IDLE_SCAN
+///
+/// Task whose stack is being scanned by `_tn_task_stack_scan_step()`, or
+/// `#TN_NULL` if scanning should start over from the first created task.
+static struct TN_Task *_stack_scan_task = TN_NULL;
+
+///
+/// Number of words at the end of `_stack_scan_task`'s stack which are already
+/// checked to be untouched.
+static unsigned int _stack_scan_idx = 0;
+#endif
+
+#if TN_STACK_OVERFLOW_CANARY_CNT
+///
+/// Task whose canary is going to be checked by
+/// `_tn_task_stack_canary_check_step()`, or `#TN_NULL` if checking should
+/// start over from the first created task.
+static struct TN_Task *_stack_canary_task = TN_NULL;
+#endif
+
+
+
+
 /*******************************************************************************
  *    PRIVATE FUNCTIONS
  ******************************************************************************/
@@ -110,11 +144,118 @@ _TN_STATIC_INLINE void _init_deadlock_list(struct TN_Task *task)
 #  define   _init_deadlock_list(task)
 #endif
 
+#if TN_USE_RWLOCKS
+_TN_STATIC_INLINE void _init_rwlock_queue(struct TN_Task *task)
+{
+   _tn_list_reset(&(task->rwlock_queue));
+}
+#else
+#  define   _init_rwlock_queue(task)
+#endif
+
+#if TN_USE_RPC
+_TN_STATIC_INLINE void _init_rpc_queue(struct TN_Task *task)
+{
+   _tn_list_reset(&(task->rpc_queue));
+}
+#else
+#  define   _init_rpc_queue(task)
+#endif
+
 #else
 #  define   _init_mutex_queue(task)
 #  define   _init_deadlock_list(task)
+#  define   _init_rwlock_queue(task)
+#  define   _init_rpc_queue(task)
 #endif
 
+#if TN_USE_PREEMPT_THRESHOLD
+_TN_STATIC_INLINE void _init_preempted_queue(struct TN_Task *task)
+{
+   _tn_list_reset(&(task->preempted_queue));
+}
+
+/**
+ * Returns whether preemption threshold of the task is in effect: that is,
+ * the threshold is higher than the task's priority, and the task has
+ * started running and hasn't become non-runnable since then. It is true
+ * for the current task (if only it is runnable) and for the tasks in
+ * `#_tn_tasks_preempted_list`.
+ */
+_TN_STATIC_INLINE TN_BOOL _preempt_threshold_in_effect(struct TN_Task *task)
+{
+   return (
+            task->preempt_threshold < task->priority
+         && (     (task == _tn_curr_run_task && _tn_task_is_runnable(task))
+               || !_tn_list_is_empty(&(task->preempted_queue))
+            )
+         );
+}
+#else
+#  define   _init_preempted_queue(task)
+#endif
+
+/**
+ * Returns stack size of the task, in words
+ */
+_TN_STATIC_INLINE unsigned int _stack_size_get(const struct TN_Task *task)
+{
+   return (unsigned int)(task->stack_high_addr - task->stack_low_addr + 1);
+}
+
+#if _TN_TASK_CREATE_QUEUE
+/**
+ * Returns next created task after the given one, or `#TN_NULL` if the given
+ * task is the last one.
+ */
+_TN_STATIC_INLINE struct TN_Task *_created_task_next_get(
+      struct TN_Task *task
+      )
+{
+   struct TN_Task *ret = TN_NULL;
+
+   if (task->create_queue.next != &_tn_tasks_created_list){
+      ret = container_of(task->create_queue.next, struct TN_Task, create_queue);
+   }
+
+   return ret;
+}
+#endif
+
+/**
+ * Checks stack words of the task starting from the end of the stack (see
+ * `_tn_task_stack_end_get()`): words with indexes `[from_idx, to_idx)` are
+ * checked, and the index of the first word that doesn't have the value
+ * `#TN_FILL_STACK_VAL` is returned. If all of them are untouched, `to_idx` is
+ * returned.
+ */
+static unsigned int _stack_untouched_scan(
+      struct TN_Task *task,
+      unsigned int from_idx,
+      unsigned int to_idx
+      )
+{
+   unsigned int idx = from_idx;
+
+#if (_TN_ARCH_STACK_DIR == _TN_ARCH_STACK_DIR__ASC)
+   //-- ascending stack: its end is at the highest address
+   TN_UWord *p_word = task->stack_high_addr - from_idx;
+
+   while (idx < to_idx && *p_word-- == TN_FILL_STACK_VAL){
+      idx++;
+   }
+#else
+   //-- descending stack: its end is at the lowest address
+   TN_UWord *p_word = task->stack_low_addr + from_idx;
+
+   while (idx < to_idx && *p_word++ == TN_FILL_STACK_VAL){
+      idx++;
+   }
+#endif
+
+   return idx;
+}
+
 
 /**
  * Looks for first runnable task with highest priority,
@@ -150,6 +291,35 @@ static void _find_next_task_to_run(void)
    }
 #endif
 
+#if TN_USE_PREEMPT_THRESHOLD
+   {
+      //-- the task whose preemption threshold is in effect keeps running (or
+      //   gets the processor back, if it was preempted) unless some task
+      //   has priority higher than the threshold. It is the current task,
+      //   or, if its threshold isn't in effect, the most recently preempted
+      //   task: thresholds of other preempted tasks aren't higher than its
+      //   priority, so they can't win anyway.
+      struct TN_Task *task = _tn_curr_run_task;
+
+      if (task == TN_NULL || !_preempt_threshold_in_effect(task)){
+         task = _tn_list_is_empty(&_tn_tasks_preempted_list)
+            ? TN_NULL
+            : _tn_list_first_entry(
+                  &_tn_tasks_preempted_list, struct TN_Task, preempted_queue
+                  );
+      }
+
+      if (     task != TN_NULL
+            && _preempt_threshold_in_effect(task)
+            && priority >= task->preempt_threshold
+         )
+      {
+         _tn_next_task_to_run = task;
+         return;
+      }
+   }
+#endif
+
    //-- set task to run: fetch next task from ready list of appropriate
    //   priority.
    _tn_next_task_to_run = _tn_get_task_by_tsk_queue(
@@ -208,9 +378,15 @@ _TN_STATIC_INLINE enum TN_RCode _task_delete(struct TN_Task *task)
       //-- Cannot delete not-terminated task
       rc = TN_RC_WSTATE;
    } else {
+      _tn_task_stack_scan_on_delete(task);
+
+#if _TN_TASK_CREATE_QUEUE
       _tn_list_remove_entry(&(task->create_queue));
+#endif
       _tn_tasks_created_cnt--;
       task->id_task = TN_ID_NONE;
+
+      _TN_TRACE(TN_TRACE_EV_TASK_DELETE, 0, task, 0);
    }
 
    return rc;
@@ -339,6 +515,32 @@ static void _on_task_wait_complete(struct TN_Task *task)
       _tn_mutex_on_task_wait_complete(task);
    }
 
+   //-- for rwlock, call special handler
+   if (     (task->task_wait_reason == TN_WAIT_REASON_RWLOCK_R)
+         || (task->task_wait_reason == TN_WAIT_REASON_RWLOCK_W)
+      )
+   {
+      _tn_rwlock_on_task_wait_complete(task);
+   }
+
+   //-- for semaphore, call special handler
+   if (task->task_wait_reason == TN_WAIT_REASON_SEM){
+      _tn_sem_on_task_wait_complete(task);
+   }
+
+   //-- for RPC object, call special handler
+   if (     (task->task_wait_reason == TN_WAIT_REASON_RPC_CALL)
+         || (task->task_wait_reason == TN_WAIT_REASON_RPC_REPLY)
+      )
+   {
+      _tn_rpc_on_task_wait_complete(task);
+   }
+
+   //-- for tn_select(), remove task's items from all the objects
+   if (task->task_wait_reason == TN_WAIT_REASON_SELECT){
+      _tn_select_on_task_wait_complete(task);
+   }
+
 }
 
 /**
@@ -357,12 +559,17 @@ static void _task_terminate(struct TN_Task *task)
    }
 #endif
 
-   //-- Unlock all mutexes locked by the task
+   //-- Unlock all mutexes and rwlocks locked by the task, and abort all
+   //   the RPC calls it is serving
    _tn_mutex_unlock_all_by_task(task);
+   _tn_rwlock_unlock_all_by_task(task);
+   _tn_rpc_abort_all_by_task(task);
 
    //-- task is already in the state NONE, so, we just need 
    //   to set dormant state.
    _tn_task_set_dormant(task);
+
+   _TN_TRACE(TN_TRACE_EV_TASK_TERMINATE, 0, task, 0);
 }
 
 /**
@@ -463,6 +670,9 @@ enum TN_RCode tn_task_create(
    task->stack_high_addr = task_stack_low_addr + task_stack_size - 1;
 
    task->base_priority   = priority;
+#if TN_USE_PREEMPT_THRESHOLD
+   task->preempt_threshold = _TN_PREEMPT_THRESHOLD_NONE;
+#endif
    task->task_state      = TN_TASK_STATE_NONE;
    task->id_task         = TN_ID_TASK;
 
@@ -475,6 +685,10 @@ enum TN_RCode tn_task_create(
    memset(&task->profiler, 0x00, sizeof(task->profiler));
 #endif
 
+#if TN_WAKEUP_LATENCY
+   memset(&task->wakeup_latency, 0x00, sizeof(task->wakeup_latency));
+#endif
+
    //-- fill all task stack space by #TN_FILL_STACK_VAL
    {
       TN_UWord *ptr_stack;
@@ -488,6 +702,10 @@ enum TN_RCode tn_task_create(
       }
    }
 
+#if TN_STACK_USAGE_IDLE_SCAN
+   task->stack_free_cached = (unsigned int)task_stack_size;
+#endif
+
    //-- reset task_queue (the queue used to include task to runqueue or 
    //   waitqueue)
    _tn_list_reset(&(task->task_queue));
@@ -498,14 +716,21 @@ enum TN_RCode tn_task_create(
    //-- init auxiliary lists needed for tasks
    _init_mutex_queue(task);
    _init_deadlock_list(task);
+   _init_rwlock_queue(task);
+   _init_rpc_queue(task);
+   _init_preempted_queue(task);
 
    //-- Set initial task state: `TN_TASK_STATE_DORMANT`
    _tn_task_set_dormant(task);
 
+#if _TN_TASK_CREATE_QUEUE
    //-- Add task to created task queue
    _tn_list_add_tail(&_tn_tasks_created_list, &(task->create_queue));
+#endif
    _tn_tasks_created_cnt++;
 
+   _TN_TRACE(TN_TRACE_EV_TASK_CREATE, priority, task, task_func);
+
    if ((opts & TN_TASK_CREATE_OPT_START)){
       _tn_task_activate(task);
    }
@@ -581,6 +806,8 @@ enum TN_RCode tn_task_suspend(struct TN_Task *task)
          //-- set suspended state
          _tn_task_set_suspended(task);
 
+         _TN_TRACE(TN_TRACE_EV_TASK_SUSPEND, 0, task, 0);
+
       }
 
       TN_INT_RESTORE();
@@ -614,6 +841,8 @@ enum TN_RCode tn_task_resume(struct TN_Task *task)
          //-- clear suspended state
          _tn_task_clear_suspended(task);
 
+         _TN_TRACE(TN_TRACE_EV_TASK_RESUME, 0, task, 0);
+
          if (!_tn_task_is_waiting(task)){
             //-- The task is not in the WAIT-SUSPEND state,
             //   so we need to make it runnable and probably switch context
@@ -882,6 +1111,51 @@ enum TN_RCode tn_task_change_priority(struct TN_Task *task, int new_priority)
    return rc;
 }
 
+#if TN_USE_PREEMPT_THRESHOLD
+/*
+ * See comments in the header file (tn_tasks.h)
+ */
+enum TN_RCode tn_task_preempt_threshold_set(
+      struct TN_Task *task,
+      int threshold
+      )
+{
+   enum TN_RCode rc = _check_param_generic(task);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (threshold < 0 || threshold > task->base_priority){
+      rc = TN_RC_WPARAM;
+   } else if (!tn_is_task_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      TN_INTSAVE_DATA;
+
+      TN_INT_DIS_SAVE();
+
+      //-- threshold equal to the base priority means no threshold: it
+      //   shouldn't take effect if the task's priority is lowered by
+      //   `tn_task_change_priority()`
+      task->preempt_threshold = (threshold == task->base_priority)
+         ? _TN_PREEMPT_THRESHOLD_NONE
+         : threshold;
+
+      //-- if threshold of the current (or preempted) task is changed, some
+      //   other task might need to run now
+      if (     task == _tn_curr_run_task
+            || !_tn_list_is_empty(&(task->preempted_queue))
+         )
+      {
+         _find_next_task_to_run();
+      }
+
+      TN_INT_RESTORE();
+      _tn_context_switch_pend_if_needed();
+   }
+   return rc;
+}
+#endif
+
 #if TN_PROFILER
 enum TN_RCode tn_task_profiler_timing_get(
       const struct TN_Task *task,
@@ -906,6 +1180,57 @@ enum TN_RCode tn_task_profiler_timing_get(
 }
 #endif
 
+/*
+ * See comments in the header file (tn_tasks.h)
+ */
+enum TN_RCode tn_task_stack_free_get(
+      struct TN_Task *task,
+      unsigned int *p_free
+      )
+{
+   enum TN_RCode rc = _check_param_generic(task);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (p_free == TN_NULL){
+      rc = TN_RC_WPARAM;
+   } else {
+#if TN_STACK_USAGE_IDLE_SCAN
+      //-- the value is maintained by the idle task, just return it
+      *p_free = task->stack_free_cached;
+#else
+      //-- scan the stack right now. Interrupts aren't disabled, since it
+      //   might take a while; stack only grows, so the worst that could
+      //   happen is that the value is a bit outdated.
+      *p_free = _stack_untouched_scan(task, 0, _stack_size_get(task));
+#endif
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_tasks.h)
+ */
+enum TN_RCode tn_task_stack_used_get(
+      struct TN_Task *task,
+      unsigned int *p_used
+      )
+{
+   unsigned int free_cnt = 0;
+   enum TN_RCode rc = tn_task_stack_free_get(task, &free_cnt);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (p_used == TN_NULL){
+      rc = TN_RC_WPARAM;
+   } else {
+      *p_used = _stack_size_get(task) - free_cnt;
+   }
+
+   return rc;
+}
+
 
 
 
@@ -934,9 +1259,21 @@ void _tn_task_set_runnable(struct TN_Task * task)
    _add_entry_to_ready_queue(&(task->task_queue), priority);
 
    //-- less value - greater priority, so '<' operation is used here
-   if (priority < _tn_next_task_to_run->priority){
+   if (     priority < _tn_next_task_to_run->priority
+#if TN_USE_PREEMPT_THRESHOLD
+         //-- if the next task is the current or the preempted one, and its
+         //   preemption threshold is in effect, the new task should also
+         //   beat the threshold
+         && (     !_preempt_threshold_in_effect(_tn_next_task_to_run)
+               || priority < _tn_next_task_to_run->preempt_threshold
+            )
+#endif
+      )
+   {
       _tn_next_task_to_run = task;
    }
+
+   _tn_wakeup_latency_on_runnable(task);
 }
 
 /**
@@ -964,6 +1301,13 @@ void _tn_task_clear_runnable(struct TN_Task *task)
    //-- remove runnable state
    task->task_state &= ~TN_TASK_STATE_RUNNABLE;
 
+#if TN_USE_PREEMPT_THRESHOLD
+   //-- if the task was preempted, it isn't anymore: its threshold takes
+   //   effect again only when it runs next time
+   _tn_list_remove_entry(&(task->preempted_queue));
+   _tn_list_reset(&(task->preempted_queue));
+#endif
+
    //-- remove the curr task from any queue (now - from ready queue)
    if (_remove_entry_from_ready_queue(&(task->task_queue), priority)){
       //-- No ready tasks for the curr priority
@@ -979,9 +1323,16 @@ void _tn_task_clear_runnable(struct TN_Task *task)
       if (_tn_next_task_to_run == task){
          //-- the task that just became non-runnable was the "next task to run",
          //   so we should select new next task to run
+#if TN_USE_PREEMPT_THRESHOLD
+         //-- the task might have kept running because of its preemption
+         //   threshold, while some tasks with higher priority are runnable:
+         //   so, we have to look through all the priorities
+         _find_next_task_to_run();
+#else
          _tn_next_task_to_run = _tn_get_task_by_tsk_queue(
                _tn_tasks_ready_list[priority].next
                );
+#endif
 
          //-- _tn_next_task_to_run was just altered, so, we should return TN_TRUE
       }
@@ -1028,6 +1379,9 @@ void _tn_task_set_waiting(
 
    //-- Add to the timers queue, if timeout is neither 0 nor `TN_WAIT_INFINITE`.
    _tn_timer_start(&task->timer, timeout);
+
+   _TN_TRACE(TN_TRACE_EV_TASK_WAIT, wait_reason, task, wait_que);
+   _tn_obj_stats_on_wait(task);
 }
 
 /**
@@ -1064,6 +1418,10 @@ void _tn_task_clear_waiting(struct TN_Task *task, enum TN_RCode wait_rc)
    //-- and reset task's queue
    _tn_list_reset(&(task->task_queue));
 
+   _TN_TRACE(TN_TRACE_EV_TASK_WAIT_END, wait_rc, task, task->pwait_queue);
+   _tn_wakeup_latency_on_wait_end(task, wait_rc);
+   _tn_obj_stats_on_wait_end(task);
+
    //-- handle current wait_reason: say, for MUTEX_I, we should
    //   handle priorities of other involved tasks.
    _on_task_wait_complete(task);
@@ -1082,6 +1440,50 @@ void _tn_task_clear_waiting(struct TN_Task *task, enum TN_RCode wait_rc)
    task->task_wait_reason = TN_WAIT_REASON_NONE;
 }
 
+/**
+ * See comment in the _tn_tasks.h file
+ */
+void _tn_task_wait_move(
+      struct TN_Task *task,
+      struct TN_ListItem *wait_que,
+      enum TN_WaitReason wait_reason,
+      TN_TickCnt timeout
+      )
+{
+#if TN_DEBUG
+   //-- WAIT bit must be set
+   if (!(task->task_state & TN_TASK_STATE_WAIT)){
+      _TN_FATAL_ERROR("");
+   } else if (wait_que == TN_NULL){
+      _TN_FATAL_ERROR("");
+   }
+#endif
+
+   //-- finish waiting for the previous object: the same as in
+   //   _tn_task_clear_waiting(), but the task stays in the WAIT state,
+   //   and wakeup latency isn't accounted since task isn't woken up.
+   _tn_list_remove_entry(&task->task_queue);
+   _tn_list_reset(&(task->task_queue));
+
+   _TN_TRACE(TN_TRACE_EV_TASK_WAIT_END, TN_RC_OK, task, task->pwait_queue);
+   _tn_obj_stats_on_wait_end(task);
+
+   _on_task_wait_complete(task);
+
+   _tn_timer_cancel(&task->timer);
+
+   //-- and start waiting for the new one
+   task->task_wait_reason = wait_reason;
+
+   _tn_list_add_tail(wait_que, &(task->task_queue));
+   task->pwait_queue = wait_que;
+
+   _tn_timer_start(&task->timer, timeout);
+
+   _TN_TRACE(TN_TRACE_EV_TASK_WAIT, wait_reason, task, wait_que);
+   _tn_obj_stats_on_wait(task);
+}
+
 void _tn_task_set_suspended(struct TN_Task *task)
 {
 #if TN_DEBUG
@@ -1127,6 +1529,16 @@ void _tn_task_set_dormant(struct TN_Task* task)
       _TN_FATAL_ERROR("");
    }
 #endif // TN_MUTEX_DEADLOCK_DETECT
+#if TN_USE_RWLOCKS
+   else if (!_tn_list_is_empty(&task->rwlock_queue)){
+      _TN_FATAL_ERROR("");
+   }
+#endif // TN_USE_RWLOCKS
+#if TN_USE_RPC
+   else if (!_tn_list_is_empty(&task->rpc_queue)){
+      _TN_FATAL_ERROR("");
+   }
+#endif // TN_USE_RPC
 #endif // TN_USE_MUTEXES
 #endif // TN_DEBUG
 
@@ -1159,8 +1571,8 @@ void _tn_task_clear_dormant(struct TN_Task *task)
 
 #if TN_PROFILER
    //-- If profiler is present, set last tick count
-   //   to current tick count value
-   task->profiler.last_tick_cnt = _tn_timer_sys_time_get();
+   //   to current profiler time
+   task->profiler.last_tick_cnt = _TN_PROFILER_TIME_GET();
 #endif
 }
 
@@ -1174,6 +1586,8 @@ enum TN_RCode _tn_task_activate(struct TN_Task *task)
    if (_tn_task_is_dormant(task)){
       _tn_task_clear_dormant(task);
       _tn_task_set_runnable(task);
+
+      _TN_TRACE(TN_TRACE_EV_TASK_ACTIVATE, 0, task, 0);
    } else {
       rc = TN_RC_WSTATE;
    }
@@ -1222,6 +1636,8 @@ TN_BOOL _tn_task_first_wait_complete(
  */
 void _tn_change_task_priority(struct TN_Task *task, int new_priority)
 {
+   _TN_TRACE(TN_TRACE_EV_TASK_PRIORITY, new_priority, task, task->priority);
+
    if (_tn_task_is_runnable(task)){
       _tn_change_running_task_priority(task, new_priority);
    } else {
@@ -1297,6 +1713,140 @@ void _tn_task_exit_nodelete(void)
    tn_task_exit((enum TN_TaskExitOpt)(0));
 }
 
+#if TN_STACK_USAGE_IDLE_SCAN
+/*
+ * See comment in the _tn_tasks.h file
+ */
+void _tn_task_stack_scan_step(void)
+{
+   TN_INTSAVE_DATA;
+
+   TN_INT_DIS_SAVE();
+
+   if (_stack_scan_task == TN_NULL){
+      //-- start over from the first created task (there is at least idle
+      //   task, so the list is never empty)
+      _stack_scan_task = container_of(
+            _tn_tasks_created_list.next, struct TN_Task, create_queue
+            );
+      _stack_scan_idx = 0;
+   }
+
+   {
+      struct TN_Task *task = _stack_scan_task;
+
+      //-- words beyond the cached value are known to be touched already, so
+      //   there's no need to check them
+      unsigned int limit_idx = task->stack_free_cached;
+      unsigned int to_idx = _stack_scan_idx + TN_STACK_USAGE_SCAN_CHUNK;
+
+      if (to_idx > limit_idx){
+         to_idx = limit_idx;
+      }
+
+      _stack_scan_idx = _stack_untouched_scan(task, _stack_scan_idx, to_idx);
+
+      if (_stack_scan_idx < to_idx || _stack_scan_idx >= limit_idx){
+         //-- scanning of this task is done: either touched word is found, or
+         //   we've reached the previous watermark. Save the result and
+         //   proceed to the next task.
+         task->stack_free_cached = _stack_scan_idx;
+
+         _stack_scan_task = _created_task_next_get(task);
+         _stack_scan_idx = 0;
+      }
+   }
+
+   TN_INT_RESTORE();
+}
+#endif
+
+#if TN_STACK_OVERFLOW_CANARY_CNT
+/*
+ * See comment in the _tn_tasks.h file
+ */
+void _tn_task_stack_canary_check_step(void)
+{
+   TN_INTSAVE_DATA;
+
+   TN_INT_DIS_SAVE();
+
+   if (_stack_canary_task == TN_NULL){
+      //-- start over from the first created task (there is at least idle
+      //   task, so the list is never empty)
+      _stack_canary_task = container_of(
+            _tn_tasks_created_list.next, struct TN_Task, create_queue
+            );
+   }
+
+   {
+      struct TN_Task *task = _stack_canary_task;
+
+      _stack_canary_task = _created_task_next_get(task);
+
+      if (
+            _stack_untouched_scan(task, 0, TN_STACK_OVERFLOW_CANARY_CNT)
+            != TN_STACK_OVERFLOW_CANARY_CNT
+         )
+      {
+         _tn_sys_stack_overflow_notify(task);
+      }
+   }
+
+   TN_INT_RESTORE();
+}
+#endif
+
+#if TN_STACK_USAGE_IDLE_SCAN || TN_STACK_OVERFLOW_CANARY_CNT
+/*
+ * See comment in the _tn_tasks.h file
+ */
+void _tn_task_stack_scan_on_delete(struct TN_Task *task)
+{
+   //-- if the task is going to be checked next, start over on the next step
+#if TN_STACK_USAGE_IDLE_SCAN
+   if (_stack_scan_task == task){
+      _stack_scan_task = TN_NULL;
+   }
+#endif
+#if TN_STACK_OVERFLOW_CANARY_CNT
+   if (_stack_canary_task == task){
+      _stack_canary_task = TN_NULL;
+   }
+#endif
+}
+#endif
+
+#if TN_USE_PREEMPT_THRESHOLD
+/*
+ * See comment in the _tn_tasks.h file
+ */
+void _tn_task_preempt_threshold_on_context_switch(
+      struct TN_Task *task_prev,
+      struct TN_Task *task_new
+      )
+{
+   if (task_prev != task_new){
+      //-- the new task is running now, so it isn't preempted anymore
+      _tn_list_remove_entry(&(task_new->preempted_queue));
+      _tn_list_reset(&(task_new->preempted_queue));
+
+      //-- if the previous task is still runnable, it is preempted; if its
+      //   threshold is in effect, remember it, so that _find_next_task_to_run()
+      //   gives it the processor back before any task whose priority isn't
+      //   higher than the threshold
+      if (     _tn_task_is_runnable(task_prev)
+            && task_prev->preempt_threshold < task_prev->priority
+         )
+      {
+         _tn_list_add_head(
+               &_tn_tasks_preempted_list, &(task_prev->preempted_queue)
+               );
+      }
+   }
+}
+#endif
+
 
 
 #if !defined(_TN_ARCH_STACK_DIR)
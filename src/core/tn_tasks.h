@@ -97,6 +97,24 @@
  * Time slice is set separately for each priority. By default, round robin
  * is turned off for all priorities.
  *
+ * If `#TN_USE_PREEMPT_THRESHOLD` is non-zero, the task may have preemption
+ * threshold, see `tn_task_preempt_threshold_set()`: while it runs, it can be
+ * preempted only by the tasks whose priority is higher than the threshold.
+ * So, the task with priority 5 and threshold 3 behaves as the task with
+ * priority 3 once it has started running, but it starts running as the task
+ * with priority 5. If it is preempted by some task with priority higher
+ * than the threshold, it keeps the threshold: once there are no such tasks,
+ * it runs again, before any other task whose priority isn't higher than the
+ * threshold. If each task of some group has the threshold equal to
+ * the highest priority in the group, tasks of the group never preempt each
+ * other: it saves context switches, and, since they never run interleaved,
+ * allows them to share data without locking, as long as each task accesses
+ * the data only between its blocking calls. Note that this doesn't hold if
+ * priority of some task of the group is elevated above the threshold (by
+ * priority inheritance, or by `tn_task_change_priority()`).
+ * Round robin isn't applied to the running task whose threshold is in
+ * effect.
+ *
  * \section tn_tasks__idle Idle task
  *
  * TNeo has one system task: an idle task, which has lowest priority.
@@ -123,7 +141,12 @@
 #include "tn_eventgrp.h"
 #include "tn_dqueue.h"
 #include "tn_fmem.h"
+#include "tn_sem.h"
+#include "tn_select.h"
+#include "tn_rpc.h"
 #include "tn_timer.h"
+#include "tn_wakeup_latency.h"
+#include "tn_obj_stats.h"
 
 
 
@@ -208,6 +231,37 @@ enum TN_WaitReason {
    /// memory blocks
    /// @see tn_fmem.h
    TN_WAIT_REASON_WFIXMEM,
+   ///
+   /// Task waits for the condition variable to be signaled
+   /// @see tn_condvar.h
+   TN_WAIT_REASON_CONDVAR,
+   ///
+   /// Task wants to lock the rwlock for reading, but it is locked for
+   /// writing (or there are writers waiting, depending on the policy)
+   /// @see tn_rwlock.h
+   TN_WAIT_REASON_RWLOCK_R,
+   ///
+   /// Task wants to lock the rwlock for writing, but it is locked
+   /// @see tn_rwlock.h
+   TN_WAIT_REASON_RWLOCK_W,
+   ///
+   /// Task waits for any of several objects
+   /// @see tn_select.h
+   TN_WAIT_REASON_SELECT,
+   ///
+   /// Task has called the RPC object, and waits for the server to receive
+   /// the message
+   /// @see tn_rpc.h
+   TN_WAIT_REASON_RPC_CALL,
+   ///
+   /// Task has called the RPC object, the message is received by the server,
+   /// and the task waits for the reply
+   /// @see tn_rpc.h
+   TN_WAIT_REASON_RPC_REPLY,
+   ///
+   /// Server task waits for the message from some client
+   /// @see tn_rpc.h
+   TN_WAIT_REASON_RPC_RECEIVE,
 
 
    ///
@@ -248,6 +302,10 @@ enum TN_TaskExitOpt {
  * `#tn_task_profiler_timing_get()` function. This structure is contained in
  * each `struct #TN_Task` structure. 
  *
+ * Times are in system ticks; if `#TN_PROFILER_ISR_CNT` is non-zero, they are
+ * in timestamp units (see `#tn_callback_timestamp_set()`), as well as times of
+ * ISRs.
+ *
  * Available if only `#TN_PROFILER` option is non-zero, also depends on
  * `#TN_PROFILER_WAIT_TIME`.
  */
@@ -301,7 +359,8 @@ struct TN_TaskTiming {
  */
 struct _TN_TaskProfiler {
    ///
-   /// Tick count of when the task got running or non-running last time.
+   /// Tick count (or timestamp, if `#TN_PROFILER_ISR_CNT` is non-zero) of when
+   /// the task got running or non-running last time.
    TN_TickCnt        last_tick_cnt;
 #if TN_PROFILER_WAIT_TIME || DOXYGEN_ACTIVE
    ///
@@ -324,8 +383,41 @@ struct _TN_TaskProfiler {
 };
 #endif
 
+#if TN_COMPACT_TCB
+//-- Types of the narrow fields of `struct #TN_Task`, see `#TN_COMPACT_TCB`.
+//   Priorities never exceed `#TN_PRIORITIES_MAX_CNT` (which is at most 32),
+//   values of task state and wait reason are small positive numbers,
+//   and result codes are small negative ones.
+typedef unsigned char            _TN_TCBPriority;
+typedef unsigned char            _TN_TCBTaskState;
+typedef unsigned char            _TN_TCBWaitReason;
+typedef signed char              _TN_TCBRCode;
+typedef unsigned short           _TN_TCBTSliceCnt;
+#else
+typedef int                      _TN_TCBPriority;
+typedef enum TN_TaskState        _TN_TCBTaskState;
+typedef enum TN_WaitReason       _TN_TCBWaitReason;
+typedef enum TN_RCode            _TN_TCBRCode;
+typedef int                      _TN_TCBTSliceCnt;
+#endif
+
+/**
+ * Whether `struct #TN_Task` contains `create_queue` list item: it is needed
+ * unless `#TN_COMPACT_TCB` is set and no one iterates created tasks.
+ */
+#if !TN_COMPACT_TCB || TN_STACK_USAGE_IDLE_SCAN \
+   || TN_STACK_OVERFLOW_CANARY_CNT || TN_OBJ_REGISTRY
+#  define _TN_TASK_CREATE_QUEUE  1
+#else
+#  define _TN_TASK_CREATE_QUEUE  0
+#endif
+
 /**
  * Task
+ *
+ * Fields which are used by the scheduler on each context switch are grouped
+ * in the beginning of the structure. If `#TN_COMPACT_TCB` is non-zero,
+ * scalar fields are narrow, see the option description for details.
  */
 struct TN_Task {
    /// pointer to task's current top of the stack;
@@ -343,16 +435,61 @@ struct TN_Task {
    /// queue is used to include task in ready/wait lists
    struct TN_ListItem task_queue;     
    ///
-   /// timer object to implement task waiting for timeout
-   struct TN_Timer timer;
-   ///
    /// pointer to object's (semaphore, mutex, event, etc) wait list in which 
    /// task is included for waiting
    struct TN_ListItem *pwait_queue;
+   ///
+   /// current task priority
+   _TN_TCBPriority priority;
+   ///
+   /// base priority of the task (actual current priority may be higher than 
+   /// base priority because of mutex)
+   _TN_TCBPriority base_priority;
+#if TN_USE_PREEMPT_THRESHOLD || DOXYGEN_ACTIVE
+   ///
+   /// preemption threshold: while the task is running, it can be preempted
+   /// only by tasks whose priority is higher than this value. If it isn't
+   /// higher than the task's current priority, it has no effect; if the
+   /// threshold isn't set, it is the lowest priority (the one of the idle
+   /// task). See `tn_task_preempt_threshold_set()`.
+   _TN_TCBPriority preempt_threshold;
+#endif
+   ///
+   /// task state, see `enum #TN_TaskState`
+   _TN_TCBTaskState task_state;
+   ///
+   /// reason for waiting (relevant if only `task_state` is
+   /// $(TN_TASK_STATE_WAIT) or $(TN_TASK_STATE_WAITSUSP)), see
+   /// `enum #TN_WaitReason`
+   _TN_TCBWaitReason task_wait_reason;
+   ///
+   /// waiting result code (reason why waiting finished), see
+   /// `enum #TN_RCode`
+   _TN_TCBRCode task_wait_rc;
+
+   /// Internal flag used to optimize mutex priority algorithms.
+   /// For the comments on it, see file tn_mutex.c,
+   /// function `_mutex_do_unlock()`.
+   unsigned          priority_already_updated : 1;
+
+   /// Flag indicates that task waited for something
+   /// This flag is set automatially in `_tn_task_set_waiting()`
+   /// Must be cleared manually before calling any service that could sleep,
+   /// if the caller is interested in the relevant value of this flag.
+   unsigned          waited : 1;
+   ///
+   /// time slice counter
+   _TN_TCBTSliceCnt tslice_count;
+   ///
+   /// timer object to implement task waiting for timeout
+   struct TN_Timer timer;
+
+#if _TN_TASK_CREATE_QUEUE
    ///
    /// queue is used to include task in creation list
    /// (currently, this list is used for statistics only)
    struct TN_ListItem create_queue;
+#endif
 
 #if TN_USE_MUTEXES
    ///
@@ -367,6 +504,25 @@ struct TN_Task {
    /// @see `#TN_MUTEX_DEADLOCK_DETECT`
    struct TN_ListItem deadlock_list;
 #endif
+#if TN_USE_RWLOCKS
+   ///
+   /// list of all rwlocks that are locked by task (for reading or writing),
+   /// see `struct #TN_RWLockHold`
+   struct TN_ListItem rwlock_queue;
+#endif
+#if TN_USE_RPC
+   ///
+   /// list of all RPC objects whose calls are being served by the task
+   /// (i.e. received, but not replied yet)
+   struct TN_ListItem rpc_queue;
+#endif
+#endif
+#if TN_USE_PREEMPT_THRESHOLD || DOXYGEN_ACTIVE
+   ///
+   /// list item to include the task in the list of tasks preempted while
+   /// their preemption threshold was in effect (it is empty if the task
+   /// isn't preempted)
+   struct TN_ListItem preempted_queue;
 #endif
 
    ///-- lowest address of stack. It is independent of architecture:
@@ -383,29 +539,9 @@ struct TN_Task {
    ///
    /// pointer to task's parameter given to `tn_task_create()`
    void *task_func_param;
-   ///
-   /// base priority of the task (actual current priority may be higher than 
-   /// base priority because of mutex)
-   int base_priority;
-   ///
-   /// current task priority
-   int priority;
-   ///
-   /// task state
-   enum TN_TaskState task_state;
-   ///
-   /// reason for waiting (relevant if only `task_state` is
-   /// $(TN_TASK_STATE_WAIT) or $(TN_TASK_STATE_WAITSUSP))
-   enum TN_WaitReason task_wait_reason;
-   ///
-   /// waiting result code (reason why waiting finished)
-   enum TN_RCode task_wait_rc;
    //
    // remaining time until timeout; may be `#TN_WAIT_INFINITE`.
    //TN_TickCnt tick_count;
-   ///
-   /// time slice counter
-   int tslice_count;
 #if 0
    ///
    /// last operation result code, might be used if some service
@@ -426,6 +562,19 @@ struct TN_Task {
       ///
       /// fields specific to tn_fmem.h
       struct TN_FMemTaskWait fmem;
+      ///
+      /// fields specific to tn_sem.h
+      struct TN_SemTaskWait sem;
+#if TN_USE_SELECT || DOXYGEN_ACTIVE
+      ///
+      /// fields specific to tn_select.h
+      struct TN_SelectTaskWait select;
+#endif
+#if TN_USE_RPC || DOXYGEN_ACTIVE
+      ///
+      /// fields specific to tn_rpc.h
+      struct TN_RPCTaskWait rpc;
+#endif
    } subsys_wait;
    ///
    /// Task name for debug purposes, user may want to set it by hand
@@ -434,17 +583,23 @@ struct TN_Task {
    /// Profiler data, available if only `#TN_PROFILER` is non-zero.
    struct _TN_TaskProfiler    profiler;
 #endif
-
-   /// Internal flag used to optimize mutex priority algorithms.
-   /// For the comments on it, see file tn_mutex.c,
-   /// function `_mutex_do_unlock()`.
-   unsigned          priority_already_updated : 1;
-
-   /// Flag indicates that task waited for something
-   /// This flag is set automatially in `_tn_task_set_waiting()`
-   /// Must be cleared manually before calling any service that could sleep,
-   /// if the caller is interested in the relevant value of this flag.
-   unsigned          waited : 1;
+#if TN_WAKEUP_LATENCY || DOXYGEN_ACTIVE
+   /// Wake-up latency data, available if only `#TN_WAKEUP_LATENCY` is
+   /// non-zero.
+   struct _TN_TaskWakeupLatency  wakeup_latency;
+#endif
+#if TN_OBJ_STATS || DOXYGEN_ACTIVE
+   /// Timestamp of when the task started waiting for the object with
+   /// contention statistics, available if only `#TN_OBJ_STATS` is non-zero.
+   TN_UWord obj_stats_wait_ts;
+#endif
+#if TN_STACK_USAGE_IDLE_SCAN || DOXYGEN_ACTIVE
+   /// Number of stack words which were never touched by the task (that is,
+   /// stack high-watermark), as found by the incremental scanning performed
+   /// by the idle task. Available if only `#TN_STACK_USAGE_IDLE_SCAN` is
+   /// non-zero.
+   unsigned int               stack_free_cached;
+#endif
 
 
 // Other implementation specific fields may be added below
@@ -888,10 +1043,129 @@ enum TN_RCode tn_task_profiler_timing_get(
 #endif
 
 
+/**
+ * Get the number of stack words which were never used by the task so far,
+ * that is, the words at the end of the stack which still have the value
+ * `#TN_FILL_STACK_VAL` written there by `tn_task_create()`. Note that words
+ * reserved by the kernel (see `#TN_STACK_OVERFLOW_CHECK`) are counted as
+ * free as well, as long as they're untouched.
+ *
+ * If `#TN_STACK_USAGE_IDLE_SCAN` is non-zero, the value is taken from the
+ * cache updated by the idle task, so the call costs O(1), but the value might
+ * lag behind a bit. Otherwise, the stack is scanned right in the call, which
+ * costs O(n) where n is the number of free words.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param task
+ *    Task to get stack usage of
+ * @param p_free
+ *    Pointer to the location where the number of free words should be stored
+ *
+ * @return
+ *    * `#TN_RC_OK` if successful;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ *
+ * @see `tn_task_stack_used_get()`
+ */
+enum TN_RCode tn_task_stack_free_get(
+      struct TN_Task *task,
+      unsigned int *p_free
+      );
+
+/**
+ * Get the maximum number of stack words ever used by the task so far:
+ * that is, stack size minus the value returned by `tn_task_stack_free_get()`.
+ * See comments for it for details.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param task
+ *    Task to get stack usage of
+ * @param p_used
+ *    Pointer to the location where the number of used words should be stored
+ *
+ * @return
+ *    * `#TN_RC_OK` if successful;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ *
+ * @see `tn_task_stack_free_get()`
+ */
+enum TN_RCode tn_task_stack_used_get(
+      struct TN_Task *task,
+      unsigned int *p_used
+      );
+
+#if TN_USE_PREEMPT_THRESHOLD || DOXYGEN_ACTIVE
+/**
+ * Set preemption threshold of the task: while the task is running, it can
+ * be preempted only by the tasks whose priority is higher than `threshold`
+ * (i.e. whose priority value is less than `threshold`). Other tasks, even
+ * if they have higher priority than the task, wait until it becomes
+ * non-runnable (waits for something, sleeps, etc).
+ *
+ * Threshold doesn't affect the priority of the task itself: until the task
+ * starts running, it is scheduled as usual, and priority inheritance for
+ * mutexes works as usual. If the task's priority is (or is elevated to) the
+ * threshold or higher, threshold has no effect.
+ *
+ * Once the task has started running, the threshold is in effect until the
+ * task becomes non-runnable: if the task is preempted by some task with
+ * priority higher than the threshold, the preempted task gets the processor
+ * back before any task whose priority isn't higher than the threshold, even
+ * if such a task has become runnable in the meantime.
+ *
+ * Initially, the task has no threshold; setting the threshold to the base
+ * priority of the task (the one given to `tn_task_create()`) removes it.
+ * Threshold isn't affected by `tn_task_change_priority()`: the task without
+ * threshold stays without it, whatever priority it is given; and the set
+ * threshold keeps its value, which has no effect while the task's priority
+ * is equal to or higher than it.
+ *
+ * If the threshold of the running task is lowered, and there are runnable
+ * tasks which have higher priority than the new threshold, the current task
+ * is preempted right away.
+ *
+ * Available if only `#TN_USE_PREEMPT_THRESHOLD` is non-zero.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param task
+ *    Task to set threshold of
+ * @param threshold
+ *    New preemption threshold, from 0 to the base priority of the task.
+ *    **NOTE**: the lower value, the higher priority.
+ *
+ * @return
+ *    * `#TN_RC_OK` if successful;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * `#TN_RC_WPARAM` if `threshold` is negative or less privileged than
+ *      the base priority of the task;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_task_preempt_threshold_set(
+      struct TN_Task *task,
+      int threshold
+      );
+#endif
+
+
 /**
  * Set new priority for task.
  * If priority is 0, then task's base_priority is set.
  *
+ * If `#TN_USE_PREEMPT_THRESHOLD` is non-zero, preemption threshold of the
+ * task isn't changed, see `tn_task_preempt_threshold_set()`.
+ *
  * $(TN_CALL_FROM_TASK)
  * $(TN_LEGEND_LINK)
  *
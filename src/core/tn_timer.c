@@ -46,6 +46,7 @@
 //-- internal tnkernel headers
 #include "_tn_timer.h"
 #include "_tn_list.h"
+#include "_tn_obj_registry.h"
 
 
 
@@ -129,6 +130,14 @@ enum TN_RCode tn_timer_create(
       //-- just return rc as it is
    } else {
       rc = _tn_timer_create(timer, func, p_user_data);
+
+#if TN_OBJ_REGISTRY
+      //-- only timers created by the application are registered; timers
+      //   of tasks are created by _tn_timer_create() directly
+      if (rc == TN_RC_OK){
+         _tn_obj_registry_add(TN_ID_TIMER, &timer->registry_item);
+      }
+#endif
    }
 
    return rc;
@@ -149,6 +158,9 @@ enum TN_RCode tn_timer_delete(struct TN_Timer *timer)
 
       //-- now, delete timer
       timer->id_timer = TN_ID_NONE;
+#if TN_OBJ_REGISTRY
+      _tn_obj_registry_remove(&timer->registry_item);
+#endif
       tn_arch_sr_restore(sr_saved);
    }
 
@@ -162,6 +162,7 @@
 
 #include "tn_list.h"
 #include "tn_common.h"
+#include "tn_obj_registry.h"
 
 
 
@@ -237,6 +238,12 @@ struct TN_Timer {
    /// Current (left) timeout value
    TN_TickCnt timeout_cur;
 #endif
+#if TN_OBJ_REGISTRY || DOXYGEN_ACTIVE
+   ///
+   /// List item for the registry of kernel objects, available if only
+   /// `#TN_OBJ_REGISTRY` option is non-zero. See `#tn_obj_registry_next()`
+   struct TN_ListItem registry_item;
+#endif
 };
 
 
@@ -45,6 +45,7 @@
 //-- internal tnkernel headers
 #include "_tn_timer.h"
 #include "_tn_list.h"
+#include "_tn_trace.h"
 
 
 //-- header of current module
@@ -280,6 +281,8 @@ void _tn_timers_tick_proceed(TN_UWord TN_INTSAVE_VAR)
          //   that function could start it again if it wants to.
          _timer_cancel(timer);
 
+         _TN_TRACE(TN_TRACE_EV_TIMER_FIRE, 0, timer, timer->func);
+
          //-- call user callback function
          _tn_timer_callback_call(timer, TN_INTSAVE_VAR);
       }
@@ -348,6 +351,8 @@ enum TN_RCode _tn_timer_start(struct TN_Timer *timer, TN_TickCnt timeout)
       timer->timeout = timeout;
       timer->start_tick_cnt = cur_sys_tick_cnt;
 
+      _TN_TRACE(TN_TRACE_EV_TIMER_START, 0, timer, timeout);
+
       //-- find out when `tn_tick_int_processing()` should be called next time,
       //   and tell that to application
       _next_tick_schedule(cur_sys_tick_cnt);
@@ -371,6 +376,8 @@ enum TN_RCode _tn_timer_cancel(struct TN_Timer *timer)
       //-- cancel the timer
       _timer_cancel(timer);
 
+      _TN_TRACE(TN_TRACE_EV_TIMER_CANCEL, 0, timer, 0);
+
       //-- find out when `tn_tick_int_processing()` should be called next time,
       //   and tell that to application
       _next_tick_schedule( _tn_timer_sys_time_get() );
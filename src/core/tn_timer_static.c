@@ -45,6 +45,7 @@
 //-- internal tnkernel headers
 #include "_tn_timer.h"
 #include "_tn_list.h"
+#include "_tn_trace.h"
 
 
 //-- header of current module
@@ -116,6 +117,21 @@ volatile TN_TickCnt _tn_sys_time_count;
  *    PRIVATE FUNCTIONS
  ******************************************************************************/
 
+/**
+ * Cancel the timer: remove it from the list it is contained in (if any).
+ */
+static void _timer_cancel(struct TN_Timer *timer)
+{
+   //-- reset timeout to zero (but this is actually not necessary)
+   timer->timeout_cur = 0;
+
+   //-- remove entry from timer queue
+   _tn_list_remove_entry(&(timer->timer_queue));
+
+   //-- reset the list
+   _tn_list_reset(&(timer->timer_queue));
+}
+
 
 /*******************************************************************************
  *    PUBLIC FUNCTIONS
@@ -231,7 +247,9 @@ void _tn_timers_tick_proceed(TN_UWord TN_INTSAVE_VAR)
 
          //-- first of all, cancel timer, so that 
          //   callback function could start it again if it wants to.
-         _tn_timer_cancel(timer);
+         _timer_cancel(timer);
+
+         _TN_TRACE(TN_TRACE_EV_TIMER_FIRE, 0, timer, timer->func);
 
          //-- call user callback function
          _tn_timer_callback_call(timer, TN_INTSAVE_VAR);
@@ -257,25 +275,26 @@ enum TN_RCode _tn_timer_start(struct TN_Timer *timer, TN_TickCnt timeout)
    } else {
 
       //-- if timer is active, cancel it first
-      if ((rc = _tn_timer_cancel(timer)) == TN_RC_OK){
+      _timer_cancel(timer);
 
-         if (timeout < TN_TICK_LISTS_CNT){
-            //-- timer should be added to the one of "tick" lists.
-            int tick_list_index = _TICK_LIST_INDEX(timeout);
-            timer->timeout_cur = tick_list_index;
+      if (timeout < TN_TICK_LISTS_CNT){
+         //-- timer should be added to the one of "tick" lists.
+         int tick_list_index = _TICK_LIST_INDEX(timeout);
+         timer->timeout_cur = tick_list_index;
 
-            _tn_list_add_tail(
-                  &_tn_timer_list__tick[ tick_list_index ],
-                  &(timer->timer_queue)
-                  );
-         } else {
-            //-- timer should be added to the "generic" list.
-            //   We should set timeout_cur adding current "tick" index to it.
-            timer->timeout_cur = timeout + _TICK_LIST_INDEX(0);
+         _tn_list_add_tail(
+               &_tn_timer_list__tick[ tick_list_index ],
+               &(timer->timer_queue)
+               );
+      } else {
+         //-- timer should be added to the "generic" list.
+         //   We should set timeout_cur adding current "tick" index to it.
+         timer->timeout_cur = timeout + _TICK_LIST_INDEX(0);
 
-            _tn_list_add_tail(&_tn_timer_list__gen, &(timer->timer_queue));
-         }
+         _tn_list_add_tail(&_tn_timer_list__gen, &(timer->timer_queue));
       }
+
+      _TN_TRACE(TN_TRACE_EV_TIMER_START, 0, timer, timeout);
    }
 
    return rc;
@@ -292,14 +311,9 @@ enum TN_RCode _tn_timer_cancel(struct TN_Timer *timer)
    _TN_BUG_ON( !TN_IS_INT_DISABLED() );
 
    if (_tn_timer_is_active(timer)){
-      //-- reset timeout to zero (but this is actually not necessary)
-      timer->timeout_cur = 0;
-
-      //-- remove entry from timer queue
-      _tn_list_remove_entry(&(timer->timer_queue));
+      _timer_cancel(timer);
 
-      //-- reset the list
-      _tn_list_reset(&(timer->timer_queue));
+      _TN_TRACE(TN_TRACE_EV_TIMER_CANCEL, 0, timer, 0);
    }
 
    return rc;
@@ -0,0 +1,195 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+//-- common tnkernel headers
+#include "tn_common.h"
+#include "tn_sys.h"
+
+//-- internal tnkernel headers
+#include "_tn_sys.h"
+
+
+//-- header of current module
+#include "tn_trace.h"
+#include "_tn_trace.h"
+
+
+#if TN_TRACE
+
+
+
+
+/*******************************************************************************
+ *    PROTECTED DATA
+ ******************************************************************************/
+
+//-- see comments in the file _tn_trace.h
+struct TN_TraceBuf _tn_trace_buf = {
+   TN_TRACE_MAGIC,            //-- magic
+   TN_TRACE_FORMAT_VERSION,   //-- version
+   TN_TRACE_RECS_CNT,         //-- recs_cnt
+   0,                         //-- wr_idx
+   0,                         //-- wrapped
+   1,                         //-- enabled
+   {{0}},                     //-- recs
+};
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+//-- configuration check
+#if (TN_TRACE_RECS_CNT < 2)
+#  error TN_TRACE_RECS_CNT must be >= 2
+#endif
+
+/**
+ * Bit in the `info` field of `struct #TN_TraceRecord` which is set if event
+ * was recorded from ISR context.
+ */
+#define  _TN_TRACE_INFO_ISR            (1 << 7)
+
+/**
+ * Mask of event in the `info` field of `struct #TN_TraceRecord`
+ */
+#define  _TN_TRACE_INFO_EVENT_MASK     0x7f
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+
+/*******************************************************************************
+ *    PUBLIC FUNCTIONS
+ ******************************************************************************/
+
+/*
+ * See comments in the header file (tn_trace.h)
+ */
+void tn_trace_enable_set(TN_BOOL enabled)
+{
+   _tn_trace_buf.enabled = !!enabled;
+}
+
+/*
+ * See comments in the header file (tn_trace.h)
+ */
+void tn_trace_user(int id, const void *obj, TN_UWord arg)
+{
+   _tn_trace_rec(TN_TRACE_EV_USER, id, obj, arg);
+}
+
+/*
+ * See comments in the header file (tn_trace.h)
+ */
+const struct TN_TraceBuf *tn_trace_buf_get(void)
+{
+   return &_tn_trace_buf;
+}
+
+
+
+
+/*******************************************************************************
+ *    PROTECTED FUNCTIONS
+ ******************************************************************************/
+
+/*
+ * See comments in the file _tn_trace.h
+ */
+void _tn_trace_rec(
+      enum TN_TraceEvent   event,
+      int                  small_arg,
+      const void          *obj,
+      TN_UWord             arg
+      )
+{
+   TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+
+   if (_tn_trace_buf.enabled){
+      struct TN_TraceRecord *rec = &_tn_trace_buf.recs[ _tn_trace_buf.wr_idx ];
+
+      TN_UWord info = (event & _TN_TRACE_INFO_EVENT_MASK)
+         | ((TN_UWord)(small_arg & 0xff) << 8);
+
+      if (_tn_arch_inside_isr()){
+         info |= _TN_TRACE_INFO_ISR;
+      }
+
+      rec->timestamp = _tn_sys_timestamp_get();
+      rec->info      = info;
+      rec->obj       = (TN_UWord)(TN_UIntPtr)obj;
+      rec->arg       = arg;
+
+      //-- advance write index only after the record is completely written,
+      //   so that the snapshot taken at any moment has at most one
+      //   corrupted record (see comments in tn_trace.h)
+      if (_tn_trace_buf.wr_idx >= (TN_TRACE_RECS_CNT - 1)){
+         _tn_trace_buf.wr_idx  = 0;
+         _tn_trace_buf.wrapped = 1;
+      } else {
+         _tn_trace_buf.wr_idx++;
+      }
+   }
+
+   tn_arch_sr_restore(sr_saved);
+}
+
+
+#endif // TN_TRACE
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
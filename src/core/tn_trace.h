@@ -0,0 +1,360 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/**
+ * \file
+ *
+ * Kernel event tracer: a compact binary record of what the kernel does,
+ * available if only `#TN_TRACE` option is non-zero.
+ *
+ * When tracer is enabled, the kernel writes a record into the RAM ring buffer
+ * on each significant event: context switch, task started or finished
+ * waiting, mutex got locked or unlocked, semaphore signalled, timer fired,
+ * etc. The list of events is given by `enum #TN_TraceEvent`. Each record
+ * is just four machine words (see `struct #TN_TraceRecord`), and writing it
+ * takes a few dozens of instructions, so the tracer might be left enabled
+ * even in production builds.
+ *
+ * The whole ring buffer is a single structure `struct #TN_TraceBuf`, which
+ * starts with a small header that allows a host tool to decode it without
+ * any knowledge about the target. So, to get the trace, you may either:
+ *
+ * - dump the RAM occupied by the buffer with the debugger (the address of the
+ *   buffer is returned by `#tn_trace_buf_get()`, and it is also available as
+ *   the symbol `_tn_trace_buf`), or
+ * - send the buffer contents from the target by any means you like: say, via
+ *   UART.
+ *
+ * And then feed the binary data to the decoder
+ * `stuff/tntrace/tntrace.py`.
+ *
+ * The buffer is written with interrupts disabled, and the write index is
+ * advanced after the record is completely written. So, if the snapshot is
+ * taken while the record is being written, only that single record (the
+ * oldest one in the buffer) might be corrupted; the decoder ignores it.
+ *
+ * By default, timestamps are in system ticks, which is usually too coarse:
+ * you probably want to provide a callback that returns a value of some
+ * free-running hardware counter, see `#tn_callback_timestamp_set()`.
+ */
+
+#ifndef _TN_TRACE_H
+#define _TN_TRACE_H
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "../arch/tn_arch.h"
+#include "tn_common.h"
+
+
+
+#ifdef __cplusplus
+extern "C"  {     /*}*/
+#endif
+
+/*******************************************************************************
+ *    PUBLIC TYPES
+ ******************************************************************************/
+
+/**
+ * Kernel events recorded by tracer. Numeric values are a part of the trace
+ * format, so they never change; new events are added to the end.
+ *
+ * For each event, the meaning of the record fields `obj`, `arg` and the
+ * "small" argument (see `struct #TN_TraceRecord`) is specified.
+ */
+enum TN_TraceEvent {
+   ///
+   /// Context switch: `obj` is the task that is going to run, `arg` is the
+   /// task that was running.
+   TN_TRACE_EV_CONTEXT_SWITCH    = 1,
+   ///
+   /// Task created: `obj` is the task, small arg is its base priority, `arg`
+   /// is task body function.
+   TN_TRACE_EV_TASK_CREATE       = 2,
+   ///
+   /// Task deleted: `obj` is the task.
+   TN_TRACE_EV_TASK_DELETE       = 3,
+   ///
+   /// Task activated (became runnable after being dormant): `obj` is the
+   /// task.
+   TN_TRACE_EV_TASK_ACTIVATE     = 4,
+   ///
+   /// Task terminated (became dormant): `obj` is the task.
+   TN_TRACE_EV_TASK_TERMINATE    = 5,
+   ///
+   /// Task suspended: `obj` is the task.
+   TN_TRACE_EV_TASK_SUSPEND      = 6,
+   ///
+   /// Task resumed: `obj` is the task.
+   TN_TRACE_EV_TASK_RESUME       = 7,
+   ///
+   /// Task started waiting: `obj` is the task, small arg is the wait reason
+   /// (`enum #TN_WaitReason`), `arg` is the address of wait queue (or 0, if
+   /// there's no wait queue, e.g. when task sleeps).
+   TN_TRACE_EV_TASK_WAIT         = 8,
+   ///
+   /// Task finished waiting: `obj` is the task, small arg is the wait result
+   /// (`enum #TN_RCode`, as a signed 8-bit value), `arg` is the address of wait queue (or 0). If
+   /// this event is emitted not by the waiting task itself, then the task
+   /// that was running at the moment (or ISR) is the one that has woken the
+   /// waiting task up.
+   TN_TRACE_EV_TASK_WAIT_END     = 9,
+   ///
+   /// Task priority changed: `obj` is the task, small arg is new priority,
+   /// `arg` is the previous priority.
+   TN_TRACE_EV_TASK_PRIORITY     = 10,
+
+   ///
+   /// Mutex created: `obj` is the mutex, small arg is the protocol
+   /// (`enum #TN_MutexProtocol`), `arg` is the ceiling priority.
+   TN_TRACE_EV_MUTEX_CREATE      = 16,
+   ///
+   /// Mutex deleted: `obj` is the mutex.
+   TN_TRACE_EV_MUTEX_DELETE      = 17,
+   ///
+   /// Mutex locked: `obj` is the mutex, `arg` is the new holder task.
+   TN_TRACE_EV_MUTEX_LOCK        = 18,
+   ///
+   /// Mutex unlocked: `obj` is the mutex, `arg` is the former holder task.
+   TN_TRACE_EV_MUTEX_UNLOCK      = 19,
+
+   ///
+   /// Semaphore created: `obj` is the semaphore, `arg` is the start count.
+   TN_TRACE_EV_SEM_CREATE        = 24,
+   ///
+   /// Semaphore deleted: `obj` is the semaphore.
+   TN_TRACE_EV_SEM_DELETE        = 25,
+   ///
+   /// Semaphore signalled: `obj` is the semaphore, `arg` is the count after
+   /// signalling (if some task was waiting, count stays unchanged).
+   TN_TRACE_EV_SEM_SIGNAL        = 26,
+   ///
+   /// Semaphore acquired without waiting: `obj` is the semaphore, `arg` is
+   /// the count after acquiring.
+   TN_TRACE_EV_SEM_ACQUIRE       = 27,
+
+   ///
+   /// Data queue created: `obj` is the queue, `arg` is its capacity.
+   TN_TRACE_EV_DQUEUE_CREATE     = 32,
+   ///
+   /// Data queue deleted: `obj` is the queue.
+   TN_TRACE_EV_DQUEUE_DELETE     = 33,
+   ///
+   /// Data sent to the queue without waiting: `obj` is the queue, `arg` is
+   /// the data pointer.
+   TN_TRACE_EV_DQUEUE_SEND       = 34,
+   ///
+   /// Data received from the queue without waiting: `obj` is the queue,
+   /// `arg` is the data pointer.
+   TN_TRACE_EV_DQUEUE_RECEIVE    = 35,
+
+   ///
+   /// Event group created: `obj` is the event group, `arg` is the initial
+   /// pattern.
+   TN_TRACE_EV_EVENTGRP_CREATE   = 40,
+   ///
+   /// Event group deleted: `obj` is the event group.
+   TN_TRACE_EV_EVENTGRP_DELETE   = 41,
+   ///
+   /// Event group modified: `obj` is the event group, small arg is the
+   /// operation (`enum #TN_EGrpOp`), `arg` is the resulting pattern.
+   TN_TRACE_EV_EVENTGRP_MODIFY   = 42,
+
+   ///
+   /// Timer started: `obj` is the timer, `arg` is the timeout.
+   TN_TRACE_EV_TIMER_START       = 48,
+   ///
+   /// Active timer cancelled: `obj` is the timer.
+   TN_TRACE_EV_TIMER_CANCEL      = 49,
+   ///
+   /// Timer fired: `obj` is the timer, `arg` is the timer function.
+   TN_TRACE_EV_TIMER_FIRE        = 50,
+
+   ///
+   /// User event, see `#tn_trace_user()`: small arg, `obj` and `arg` are
+   /// user-provided.
+   TN_TRACE_EV_USER              = 127,
+};
+
+/**
+ * Single trace record.
+ */
+struct TN_TraceRecord {
+   ///
+   /// Timestamp, see `#tn_callback_timestamp_set()`
+   TN_UWord       timestamp;
+   ///
+   /// Packed event info:
+   ///
+   /// - bits 0 .. 6: event, see `enum #TN_TraceEvent`;
+   /// - bit 7: set if event was recorded from ISR context;
+   /// - bits 8 .. 15: "small" argument, meaning depends on event.
+   TN_UWord       info;
+   ///
+   /// Address of the object the event relates to (task, mutex, etc)
+   TN_UWord       obj;
+   ///
+   /// Argument, meaning depends on event
+   TN_UWord       arg;
+};
+
+/**
+ * Trace ring buffer, together with the header that allows the host tool to
+ * decode it. All header fields are machine words, so that the decoder is
+ * able to figure out the word size and endianness by the `magic` value.
+ */
+struct TN_TraceBuf {
+   ///
+   /// Always equals to `#TN_TRACE_MAGIC`
+   TN_UWord                magic;
+   ///
+   /// Format version, `#TN_TRACE_FORMAT_VERSION`
+   TN_UWord                version;
+   ///
+   /// Capacity of the buffer, `#TN_TRACE_RECS_CNT`
+   TN_UWord                recs_cnt;
+   ///
+   /// Index of the record which will be written next time
+   volatile TN_UWord       wr_idx;
+   ///
+   /// Non-zero if the buffer has wrapped at least once (so, all the
+   /// records are valid)
+   volatile TN_UWord       wrapped;
+   ///
+   /// Non-zero if tracing is enabled, see `#tn_trace_enable_set()`. Can also
+   /// be altered with the debugger.
+   volatile TN_UWord       enabled;
+   ///
+   /// Records
+   struct TN_TraceRecord   recs[ TN_TRACE_RECS_CNT ];
+};
+
+
+
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+/**
+ * Value of `magic` field of `struct #TN_TraceBuf` (on 16-bit platforms, it is
+ * truncated to the lower 16 bits)
+ */
+#define  TN_TRACE_MAGIC             ((TN_UWord)0x54524E54UL)
+
+/**
+ * Current trace format version
+ */
+#define  TN_TRACE_FORMAT_VERSION    1
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC FUNCTION PROTOTYPES
+ ******************************************************************************/
+
+#if TN_TRACE || DOXYGEN_ACTIVE
+
+/**
+ * Enable or disable tracing at runtime. Tracing is enabled by default;
+ * disabling it is useful to "freeze" the buffer contents: say, when some
+ * error is detected, so that interesting records aren't overwritten.
+ *
+ * Available if only `#TN_TRACE` option is non-zero.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_CALL_FROM_MAIN)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param enabled
+ *    Whether trace records should be written
+ */
+void tn_trace_enable_set(TN_BOOL enabled);
+
+/**
+ * Write user event to the trace buffer, see `#TN_TRACE_EV_USER`.
+ *
+ * Available if only `#TN_TRACE` option is non-zero.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_CALL_FROM_MAIN)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param id
+ *    User event id, 0 .. 255
+ * @param obj
+ *    Arbitrary pointer
+ * @param arg
+ *    Arbitrary value
+ */
+void tn_trace_user(int id, const void *obj, TN_UWord arg);
+
+/**
+ * Returns pointer to the trace buffer. Application may send its contents to
+ * the host by any means; decoder expects exactly `sizeof(struct
+ * #TN_TraceBuf)` bytes as they are in RAM. Note that the buffer might be
+ * modified while it is being sent, so it is a good idea to disable tracing
+ * by `#tn_trace_enable_set()` before that.
+ *
+ * Available if only `#TN_TRACE` option is non-zero.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_CALL_FROM_MAIN)
+ * $(TN_LEGEND_LINK)
+ */
+const struct TN_TraceBuf *tn_trace_buf_get(void);
+
+#endif   // TN_TRACE
+
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+
+#endif // _TN_TRACE_H
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
@@ -0,0 +1,403 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+//-- common tnkernel headers
+#include "tn_common.h"
+#include "tn_sys.h"
+
+//-- internal tnkernel headers
+#include "_tn_sys.h"
+#include "_tn_tasks.h"
+
+#include "tn_tasks.h"
+#include "tn_sem.h"
+#include "tn_mutex.h"
+#include "tn_dqueue.h"
+#include "tn_eventgrp.h"
+#include "tn_fmem.h"
+#include "tn_condvar.h"
+#include "tn_rwlock.h"
+#include "tn_rpc.h"
+
+//-- header of current module
+#include "tn_wakeup_latency.h"
+#include "_tn_wakeup_latency.h"
+
+//-- std header for memset() and memcpy()
+#include <string.h>
+
+
+#if TN_WAKEUP_LATENCY
+
+
+
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+//-- configuration check
+#if (TN_WAKEUP_LATENCY_BINS_CNT < 2) || (TN_WAKEUP_LATENCY_BINS_CNT > 32)
+#  error TN_WAKEUP_LATENCY_BINS_CNT must be in the range [2, 32]
+#endif
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+//-- Additional param checking {{{
+#if TN_CHECK_PARAM
+_TN_STATIC_INLINE enum TN_RCode _check_param_task_get(
+      const struct TN_Task            *task,
+      const struct TN_WakeupLatency   *tgt
+      )
+{
+   enum TN_RCode rc = TN_RC_OK;
+
+   if (task == TN_NULL || tgt == TN_NULL){
+      rc = TN_RC_WPARAM;
+   } else if (!_tn_task_is_valid(task)){
+      rc = TN_RC_INVALID_OBJ;
+   }
+
+   return rc;
+}
+
+_TN_STATIC_INLINE enum TN_RCode _check_param_obj_get(
+      const void                      *obj,
+      const struct TN_WakeupLatency   *tgt
+      )
+{
+   enum TN_RCode rc = TN_RC_OK;
+
+   if (obj == TN_NULL || tgt == TN_NULL){
+      rc = TN_RC_WPARAM;
+   }
+
+   return rc;
+}
+
+#else
+#  define _check_param_task_get(task, tgt)      (TN_RC_OK)
+#  define _check_param_obj_get(obj, tgt)        (TN_RC_OK)
+#endif
+// }}}
+
+/**
+ * Returns histogram of the waitable object, or `#TN_NULL` if the object
+ * isn't valid.
+ *
+ * All waitable objects have `enum #TN_ObjId` as the first field, so the type
+ * of the object is determined by it.
+ */
+static struct TN_WakeupLatency *_obj_hist_get(const void *obj)
+{
+   struct TN_WakeupLatency *ret = TN_NULL;
+
+   switch (*(const enum TN_ObjId *)obj){
+      case TN_ID_SEMAPHORE:
+         ret = &((struct TN_Sem *)obj)->wakeup_latency;
+         break;
+      case TN_ID_MUTEX:
+         ret = &((struct TN_Mutex *)obj)->wakeup_latency;
+         break;
+      case TN_ID_DATAQUEUE:
+         ret = &((struct TN_DQueue *)obj)->wakeup_latency;
+         break;
+      case TN_ID_EVENTGRP:
+         ret = &((struct TN_EventGrp *)obj)->wakeup_latency;
+         break;
+      case TN_ID_FSMEMORYPOOL:
+         ret = &((struct TN_FMem *)obj)->wakeup_latency;
+         break;
+      case TN_ID_CONDVAR:
+         ret = &((struct TN_CondVar *)obj)->wakeup_latency;
+         break;
+      case TN_ID_RWLOCK:
+         ret = &((struct TN_RWLock *)obj)->wakeup_latency;
+         break;
+      case TN_ID_RPC:
+         ret = &((struct TN_RPC *)obj)->wakeup_latency;
+         break;
+      default:
+         //-- not a waitable object
+         break;
+   }
+
+   return ret;
+}
+
+/**
+ * Returns histogram of the object the task is waiting for, determined by
+ * the wait reason and wait queue, or `#TN_NULL` if task doesn't wait for
+ * any object (say, sleeps).
+ */
+static struct TN_WakeupLatency *_wait_obj_hist_get(struct TN_Task *task)
+{
+   struct TN_WakeupLatency *ret = TN_NULL;
+   struct TN_ListItem *wait_queue = task->pwait_queue;
+
+   if (wait_queue != TN_NULL){
+      switch (task->task_wait_reason){
+         case TN_WAIT_REASON_SEM:
+            ret = &container_of(
+                  wait_queue, struct TN_Sem, wait_queue
+                  )->wakeup_latency;
+            break;
+         case TN_WAIT_REASON_MUTEX_C:
+         case TN_WAIT_REASON_MUTEX_I:
+            ret = &container_of(
+                  wait_queue, struct TN_Mutex, wait_queue
+                  )->wakeup_latency;
+            break;
+         case TN_WAIT_REASON_DQUE_WSEND:
+            ret = &container_of(
+                  wait_queue, struct TN_DQueue, wait_send_list
+                  )->wakeup_latency;
+            break;
+         case TN_WAIT_REASON_DQUE_WRECEIVE:
+            ret = &container_of(
+                  wait_queue, struct TN_DQueue, wait_receive_list
+                  )->wakeup_latency;
+            break;
+         case TN_WAIT_REASON_EVENT:
+            ret = &container_of(
+                  wait_queue, struct TN_EventGrp, wait_queue
+                  )->wakeup_latency;
+            break;
+         case TN_WAIT_REASON_WFIXMEM:
+            ret = &container_of(
+                  wait_queue, struct TN_FMem, wait_queue
+                  )->wakeup_latency;
+            break;
+         case TN_WAIT_REASON_CONDVAR:
+            //-- NOTE: if the mutex isn't free when the condition variable
+            //   is signaled, the task is moved to the wait queue of the
+            //   mutex, and it's the mutex which wakes the task up.
+            ret = &container_of(
+                  wait_queue, struct TN_CondVar, wait_queue
+                  )->wakeup_latency;
+            break;
+         case TN_WAIT_REASON_RWLOCK_R:
+         case TN_WAIT_REASON_RWLOCK_W:
+            ret = &container_of(
+                  wait_queue, struct TN_RWLock, wait_queue
+                  )->wakeup_latency;
+            break;
+         case TN_WAIT_REASON_RPC_CALL:
+         case TN_WAIT_REASON_RPC_REPLY:
+            //-- clients wait in the same queue both for the server to
+            //   receive the call and for the reply
+            ret = &container_of(
+                  wait_queue, struct TN_RPC, wait_queue
+                  )->wakeup_latency;
+            break;
+         case TN_WAIT_REASON_RPC_RECEIVE:
+            ret = &container_of(
+                  wait_queue, struct TN_RPC, server_wait_queue
+                  )->wakeup_latency;
+            break;
+         default:
+            //-- task doesn't wait for any object
+            break;
+      }
+   }
+
+   return ret;
+}
+
+/**
+ * Account latency in the histogram
+ */
+static void _hist_add(struct TN_WakeupLatency *hist, TN_UWord latency)
+{
+   int idx = 0;
+
+   if (hist->max < latency){
+      hist->max = latency;
+   }
+
+   //-- bin index is the number of significant bits of the latency
+   while (latency != 0 && idx < (TN_WAKEUP_LATENCY_BINS_CNT - 1)){
+      latency >>= 1;
+      idx++;
+   }
+
+   hist->bins[idx]++;
+   hist->cnt++;
+}
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC FUNCTIONS
+ ******************************************************************************/
+
+/*
+ * See comments in the header file (tn_wakeup_latency.h)
+ */
+enum TN_RCode tn_wakeup_latency_task_get(
+      const struct TN_Task      *task,
+      struct TN_WakeupLatency   *tgt
+      )
+{
+   enum TN_RCode rc = _check_param_task_get(task, tgt);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else {
+      TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+
+      memcpy(tgt, &task->wakeup_latency.hist, sizeof(*tgt));
+
+      tn_arch_sr_restore(sr_saved);
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_wakeup_latency.h)
+ */
+enum TN_RCode tn_wakeup_latency_obj_get(
+      const void                *obj,
+      struct TN_WakeupLatency   *tgt
+      )
+{
+   enum TN_RCode rc = _check_param_obj_get(obj, tgt);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else {
+      struct TN_WakeupLatency *hist;
+      TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+
+      hist = _obj_hist_get(obj);
+      if (hist == TN_NULL){
+         rc = TN_RC_INVALID_OBJ;
+      } else {
+         memcpy(tgt, hist, sizeof(*tgt));
+      }
+
+      tn_arch_sr_restore(sr_saved);
+   }
+
+   return rc;
+}
+
+
+
+
+/*******************************************************************************
+ *    PROTECTED FUNCTIONS
+ ******************************************************************************/
+
+/*
+ * See comments in the file _tn_wakeup_latency.h
+ */
+void _tn_wakeup_latency_reset(struct TN_WakeupLatency *hist)
+{
+   memset(hist, 0x00, sizeof(*hist));
+}
+
+/*
+ * See comments in the file _tn_wakeup_latency.h
+ */
+void _tn_wakeup_latency_on_runnable(struct TN_Task *task)
+{
+   task->wakeup_latency.runnable_ts = _tn_sys_timestamp_get();
+   task->wakeup_latency.pending     = TN_TRUE;
+}
+
+/*
+ * See comments in the file _tn_wakeup_latency.h
+ */
+void _tn_wakeup_latency_on_wait_end(
+      struct TN_Task   *task,
+      enum TN_RCode     wait_rc
+      )
+{
+   task->wakeup_latency.obj_hist = (wait_rc == TN_RC_DELETED)
+      ? TN_NULL
+      : _wait_obj_hist_get(task);
+}
+
+/*
+ * See comments in the file _tn_wakeup_latency.h
+ */
+void _tn_wakeup_latency_on_context_switch(
+      struct TN_Task *task_prev,
+      struct TN_Task *task_new
+      )
+{
+   struct _TN_TaskWakeupLatency *lat = &task_new->wakeup_latency;
+
+   //-- if previous task became runnable again before it was switched out
+   //   (say, it was woken up by ISR right after it started waiting, so that
+   //   context switch didn't happen), there's nothing to account
+   task_prev->wakeup_latency.pending  = TN_FALSE;
+   task_prev->wakeup_latency.obj_hist = TN_NULL;
+
+   if (lat->pending){
+      TN_UWord latency = _tn_sys_timestamp_get() - lat->runnable_ts;
+
+      _hist_add(&lat->hist, latency);
+      if (lat->obj_hist != TN_NULL){
+         _hist_add(lat->obj_hist, latency);
+      }
+
+      lat->pending  = TN_FALSE;
+      lat->obj_hist = TN_NULL;
+   }
+}
+
+
+#endif // TN_WAKEUP_LATENCY
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
@@ -0,0 +1,218 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/**
+ * \file
+ *
+ * Wake-up latency measurement, available if only `#TN_WAKEUP_LATENCY` option
+ * is non-zero.
+ *
+ * Wake-up latency is the time from the moment the task becomes runnable
+ * (say, because the semaphore it waits for got signalled) until the moment it
+ * actually gets running. Even if the woken task has the highest priority, the
+ * latency is not zero: there's context switch overhead, and there might be
+ * interrupts and critical sections which delay the switch; and if the woken
+ * task has lower priority than the running one, it has to wait until higher
+ * priority tasks finish their jobs.
+ *
+ * When `#TN_WAKEUP_LATENCY` is non-zero, the kernel takes a timestamp when
+ * the task becomes runnable, and another one when the task gets switched
+ * in. The difference is accounted in the log-scale histogram (see `struct
+ * #TN_WakeupLatency`) of the task, and, if the task was woken up by some
+ * object (semaphore, mutex, data queue, event group, fixed memory pool,
+ * condition variable, rwlock or RPC object), in the histogram of that object
+ * as well. Histograms can be read with `#tn_wakeup_latency_task_get()` and
+ * `#tn_wakeup_latency_obj_get()`.
+ *
+ * Wake-ups of tasks waiting in `#tn_select()` (`#TN_WAIT_REASON_SELECT`) are
+ * accounted in the histogram of the task only: such a task waits for several
+ * objects at once and isn't queued to the wait queue of any of them, and
+ * accounting the wake-up to whichever object happened to be ready first
+ * would mix select latencies into the object's histogram.
+ *
+ * Timestamps are taken from the callback set by
+ * `#tn_callback_timestamp_set()`; if it isn't set, system ticks are used,
+ * which is typically too coarse for this purpose.
+ *
+ * \attention Object which has woken up a task should not be deleted until the
+ * woken task actually gets running, since the kernel updates the object's
+ * histogram at that moment.
+ */
+
+#ifndef _TN_WAKEUP_LATENCY_H
+#define _TN_WAKEUP_LATENCY_H
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "../arch/tn_arch.h"
+#include "tn_common.h"
+
+
+
+#ifdef __cplusplus
+extern "C"  {     /*}*/
+#endif
+
+/*******************************************************************************
+ *    PUBLIC TYPES
+ ******************************************************************************/
+
+struct TN_Task;
+
+#if TN_WAKEUP_LATENCY || DOXYGEN_ACTIVE
+
+/**
+ * Log-scale histogram of wake-up latencies, in timestamp units (see
+ * `#tn_callback_timestamp_set()`).
+ *
+ * Available if only `#TN_WAKEUP_LATENCY` option is non-zero.
+ */
+struct TN_WakeupLatency {
+   ///
+   /// Histogram bins: `bins[0]` counts zero latencies, and `bins[i]` (for
+   /// `i > 0`) counts latencies in the range `[2^(i-1), 2^i)`. The last bin
+   /// also counts all latencies larger than that.
+   unsigned long     bins[ TN_WAKEUP_LATENCY_BINS_CNT ];
+   ///
+   /// Total number of wake-ups accounted
+   unsigned long     cnt;
+   ///
+   /// Maximum latency ever seen
+   TN_UWord          max;
+};
+
+/**
+ * Internal kernel structure for wake-up latency data of task.
+ *
+ * Available if only `#TN_WAKEUP_LATENCY` option is non-zero.
+ */
+struct _TN_TaskWakeupLatency {
+   ///
+   /// Histogram of the task, can be read by `#tn_wakeup_latency_task_get()`
+   struct TN_WakeupLatency    hist;
+   ///
+   /// Histogram of the object that has woken the task up, or `#TN_NULL`
+   struct TN_WakeupLatency   *obj_hist;
+   ///
+   /// Timestamp of when the task became runnable
+   TN_UWord                   runnable_ts;
+   ///
+   /// Whether the task became runnable and hasn't been switched in yet
+   TN_BOOL                    pending;
+};
+
+#endif   // TN_WAKEUP_LATENCY
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC FUNCTION PROTOTYPES
+ ******************************************************************************/
+
+#if TN_WAKEUP_LATENCY || DOXYGEN_ACTIVE
+
+/**
+ * Read wake-up latency histogram of the task.
+ *
+ * Available if only `#TN_WAKEUP_LATENCY` option is non-zero.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_CALL_FROM_MAIN)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param task
+ *    Task to get histogram of
+ * @param tgt
+ *    Pointer to the location where histogram should be stored
+ *
+ * @return
+ *    * `#TN_RC_OK` if histogram was successfully copied;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_wakeup_latency_task_get(
+      const struct TN_Task      *task,
+      struct TN_WakeupLatency   *tgt
+      );
+
+/**
+ * Read wake-up latency histogram of the object: that is, latencies of all
+ * tasks that were woken up by this object. The object should be one of
+ * semaphore, mutex, data queue, event group, fixed memory pool, condition
+ * variable, rwlock or RPC object; the type is determined by the object id.
+ *
+ * Available if only `#TN_WAKEUP_LATENCY` option is non-zero.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_CALL_FROM_MAIN)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param obj
+ *    Pointer to the object: `struct #TN_Sem`, `struct #TN_Mutex`, etc.
+ * @param tgt
+ *    Pointer to the location where histogram should be stored
+ *
+ * @return
+ *    * `#TN_RC_OK` if histogram was successfully copied;
+ *    * `#TN_RC_INVALID_OBJ` if `obj` doesn't point to any of the supported
+ *      objects;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return code
+ *      is available: `#TN_RC_WPARAM`.
+ */
+enum TN_RCode tn_wakeup_latency_obj_get(
+      const void                *obj,
+      struct TN_WakeupLatency   *tgt
+      );
+
+#endif   // TN_WAKEUP_LATENCY
+
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+
+#endif // _TN_WAKEUP_LATENCY_H
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
@@ -0,0 +1,626 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/**
+ * \file
+ *
+ * C++ wrappers for the kernel objects, with the storage embedded in the
+ * object.
+ *
+ * In C, the task stack, the data queue FIFO and the memory pool buffer
+ * should be defined separately from the object itself (see
+ * `TN_STACK_ARR_DEF()`, `TN_FMEM_BUF_DEF()`), and their sizes should be
+ * given once again on creation; it's easy to get them out of sync. Here,
+ * the storage is a part of the object, and sizes are template parameters,
+ * so:
+ *
+ * - a size can't be given wrong;
+ * - the parameters which can be checked at compile time are checked by
+ *   `static_assert` (stack size, priority, number of blocks, mutex
+ *   ceiling priority), instead of getting `#TN_RC_WPARAM` at run time;
+ * - message types are checked by the compiler: `tn::Queue<T, N>` carries
+ *   pointers to `T`, `tn::Pool<T, N>` gives out blocks for `T`.
+ *
+ * All the functions are inline one-liners calling the C API, so the
+ * generated code is the same as for the direct C calls. Classes are
+ * standard-layout, and constructors are `constexpr`, so static instances
+ * (which is the intended use, like for C objects) are initialized at
+ * compile time and don't need C++ runtime startup code; declare them
+ * `constinit` to be sure. Objects are created and deleted explicitly, by
+ * `create()` and `remove()`, like in C.
+ *
+ * \code{.cpp}
+ *     struct Msg {
+ *        int cmd;
+ *        int arg;
+ *     };
+ *
+ *     constinit tn::Task<TN_MIN_STACK_SIZE + 96> my_task;
+ *     constinit tn::Queue<Msg, 8> my_queue;
+ *     constinit tn::Pool<Msg, 8> my_pool;
+ *     constinit tn::Mutex my_mutex;
+ *
+ *     void init(void)
+ *     {
+ *        my_queue.create();
+ *        my_pool.create();
+ *        my_mutex.create_inherit();
+ *        my_task.create<MY_TASK_PRIORITY>(my_task_body);
+ *     }
+ *
+ *     void send_cmd(int cmd, int arg)
+ *     {
+ *        Msg *msg;
+ *        if (my_pool.get(&msg, TN_WAIT_INFINITE) == TN_RC_OK){
+ *           msg->cmd = cmd;
+ *           msg->arg = arg;
+ *           my_queue.send(msg, TN_WAIT_INFINITE);
+ *        }
+ *     }
+ *
+ *     void shared_data_modify(void)
+ *     {
+ *        tn::MutexLock lock(my_mutex);
+ *        if (lock){
+ *           //-- the mutex is locked until the end of the scope
+ *        }
+ *     }
+ * \endcode
+ *
+ * The underlying C object is available by `get()`, so, any C API function
+ * can be used with it as well.
+ */
+
+#ifndef _TN_HPP
+#define _TN_HPP
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "../tn.h"
+
+
+
+namespace tn {
+
+/*******************************************************************************
+ *    TASK
+ ******************************************************************************/
+
+/**
+ * Task with the embedded stack of `StackWords` words (`#TN_UWord`).
+ */
+template <int StackWords>
+class Task {
+   static_assert(
+         StackWords >= TN_MIN_STACK_SIZE,
+         "stack size should be at least TN_MIN_STACK_SIZE"
+         );
+
+public:
+   constexpr Task() noexcept = default;
+
+   Task(const Task &) = delete;
+   Task &operator=(const Task &) = delete;
+
+   /**
+    * Create task, see `tn_task_create()`; the priority is checked at
+    * compile time.
+    */
+   template <int Priority>
+   enum TN_RCode create(
+         TN_TaskBody            *task_func,
+         void                   *param = TN_NULL,
+         enum TN_TaskCreateOpt   opts = TN_TASK_CREATE_OPT_START
+         ) noexcept
+   {
+      static_assert(
+            Priority >= 0 && Priority < (TN_PRIORITIES_CNT - 1),
+            "priority should be in the range [0 .. (TN_PRIORITIES_CNT - 2)]"
+            );
+      return create(task_func, Priority, param, opts);
+   }
+
+   /**
+    * Create task, see `tn_task_create()`; the priority is checked at run
+    * time.
+    */
+   enum TN_RCode create(
+         TN_TaskBody            *task_func,
+         int                     priority,
+         void                   *param = TN_NULL,
+         enum TN_TaskCreateOpt   opts = TN_TASK_CREATE_OPT_START
+         ) noexcept
+   {
+      return tn_task_create(
+            &task, task_func, priority, stack, StackWords, param, opts
+            );
+   }
+
+   /// See `tn_task_delete()`
+   enum TN_RCode remove() noexcept
+   {
+      return tn_task_delete(&task);
+   }
+
+   /// See `tn_task_activate()`
+   enum TN_RCode activate() noexcept
+   {
+      return tn_task_activate(&task);
+   }
+
+   /// See `tn_task_iactivate()`
+   enum TN_RCode iactivate() noexcept
+   {
+      return tn_task_iactivate(&task);
+   }
+
+   /// See `tn_task_suspend()`
+   enum TN_RCode suspend() noexcept
+   {
+      return tn_task_suspend(&task);
+   }
+
+   /// See `tn_task_resume()`
+   enum TN_RCode resume() noexcept
+   {
+      return tn_task_resume(&task);
+   }
+
+   /// See `tn_task_wakeup()`
+   enum TN_RCode wakeup() noexcept
+   {
+      return tn_task_wakeup(&task);
+   }
+
+   /// See `tn_task_iwakeup()`
+   enum TN_RCode iwakeup() noexcept
+   {
+      return tn_task_iwakeup(&task);
+   }
+
+   /// See `tn_task_release_wait()`
+   enum TN_RCode release_wait() noexcept
+   {
+      return tn_task_release_wait(&task);
+   }
+
+   /// See `tn_task_irelease_wait()`
+   enum TN_RCode irelease_wait() noexcept
+   {
+      return tn_task_irelease_wait(&task);
+   }
+
+   /// See `tn_task_terminate()`
+   enum TN_RCode terminate() noexcept
+   {
+      return tn_task_terminate(&task);
+   }
+
+   /// See `tn_task_change_priority()`
+   enum TN_RCode change_priority(int new_priority) noexcept
+   {
+      return tn_task_change_priority(&task, new_priority);
+   }
+
+   /// See `tn_task_state_get()`
+   enum TN_RCode state_get(enum TN_TaskState *p_state) noexcept
+   {
+      return tn_task_state_get(&task, p_state);
+   }
+
+   /// The C object, to use with any other C API function
+   struct TN_Task *get() noexcept
+   {
+      return &task;
+   }
+
+private:
+   struct TN_Task task = {};
+   TN_STACK_ARR_DEF(stack, StackWords) = {};
+};
+
+
+
+/*******************************************************************************
+ *    DATA QUEUE
+ ******************************************************************************/
+
+/**
+ * Data queue of `ItemsCnt` items, which carries pointers to `T` (just like
+ * C data queue carries `void *`). `ItemsCnt` may be 0: then, the sender
+ * waits for the receiver, see `tn_queue_create()`.
+ */
+template <typename T, int ItemsCnt>
+class Queue {
+   static_assert(ItemsCnt >= 0, "items count can't be negative");
+
+public:
+   constexpr Queue() noexcept = default;
+
+   Queue(const Queue &) = delete;
+   Queue &operator=(const Queue &) = delete;
+
+   /// See `tn_queue_create()`
+   enum TN_RCode create() noexcept
+   {
+      return tn_queue_create(&dque, fifo, ItemsCnt);
+   }
+
+   /// See `tn_queue_delete()`
+   enum TN_RCode remove() noexcept
+   {
+      return tn_queue_delete(&dque);
+   }
+
+   /// See `tn_queue_send()`
+   enum TN_RCode send(T *p_data, TN_TickCnt timeout) noexcept
+   {
+      return tn_queue_send(&dque, p_data, timeout);
+   }
+
+   /// See `tn_queue_send_polling()`
+   enum TN_RCode send_polling(T *p_data) noexcept
+   {
+      return tn_queue_send_polling(&dque, p_data);
+   }
+
+   /// See `tn_queue_isend_polling()`
+   enum TN_RCode isend_polling(T *p_data) noexcept
+   {
+      return tn_queue_isend_polling(&dque, p_data);
+   }
+
+   /// See `tn_queue_receive()`
+   enum TN_RCode receive(T **pp_data, TN_TickCnt timeout) noexcept
+   {
+      return tn_queue_receive(&dque, _pp_void(pp_data), timeout);
+   }
+
+   /// See `tn_queue_receive_polling()`
+   enum TN_RCode receive_polling(T **pp_data) noexcept
+   {
+      return tn_queue_receive_polling(&dque, _pp_void(pp_data));
+   }
+
+   /// See `tn_queue_ireceive_polling()`
+   enum TN_RCode ireceive_polling(T **pp_data) noexcept
+   {
+      return tn_queue_ireceive_polling(&dque, _pp_void(pp_data));
+   }
+
+   /// See `tn_queue_free_items_cnt_get()`
+   int free_items_cnt_get() noexcept
+   {
+      return tn_queue_free_items_cnt_get(&dque);
+   }
+
+   /// See `tn_queue_used_items_cnt_get()`
+   int used_items_cnt_get() noexcept
+   {
+      return tn_queue_used_items_cnt_get(&dque);
+   }
+
+   /// See `tn_queue_eventgrp_connect()`
+   enum TN_RCode eventgrp_connect(
+         struct TN_EventGrp  *eventgrp,
+         TN_UWord             pattern
+         ) noexcept
+   {
+      return tn_queue_eventgrp_connect(&dque, eventgrp, pattern);
+   }
+
+   /// See `tn_queue_eventgrp_disconnect()`
+   enum TN_RCode eventgrp_disconnect() noexcept
+   {
+      return tn_queue_eventgrp_disconnect(&dque);
+   }
+
+   /// The C object, to use with any other C API function
+   struct TN_DQueue *get() noexcept
+   {
+      return &dque;
+   }
+
+private:
+   //-- the kernel writes `void *` to `*pp_data`; `T *` and `void *` have the
+   //   same representation on all supported platforms
+   static void **_pp_void(T **pp_data) noexcept
+   {
+      return reinterpret_cast<void **>(pp_data);
+   }
+
+   struct TN_DQueue dque = {};
+   //-- (at least one item, since zero-sized arrays aren't allowed)
+   void *fifo[ (ItemsCnt > 0) ? ItemsCnt : 1 ] = {};
+};
+
+
+
+/*******************************************************************************
+ *    FIXED MEMORY POOL
+ ******************************************************************************/
+
+/**
+ * Fixed memory pool of `BlocksCnt` blocks, each one is large enough and
+ * aligned properly for `T`. Just like C pool, it gives out raw memory: no
+ * constructors or destructors of `T` are called.
+ */
+template <typename T, int BlocksCnt>
+class Pool {
+   static_assert(BlocksCnt >= 2, "pool should have at least 2 blocks");
+
+   //-- blocks should be aligned for `T`, and the block size should be a
+   //   multiple of `sizeof(TN_UWord)` (see `tn_fmem_create()`)
+   static constexpr unsigned int ALIGN =
+      (alignof(T) > sizeof(TN_UWord)) ? alignof(T) : sizeof(TN_UWord);
+
+   static_assert(
+         ALIGN % sizeof(TN_UWord) == 0,
+         "alignment of T should be a multiple of sizeof(TN_UWord)"
+         );
+
+public:
+   ///
+   /// Block size, in bytes
+   static constexpr unsigned int BLOCK_SIZE =
+      (sizeof(T) + ALIGN - 1) / ALIGN * ALIGN;
+
+   constexpr Pool() noexcept = default;
+
+   Pool(const Pool &) = delete;
+   Pool &operator=(const Pool &) = delete;
+
+   /// See `tn_fmem_create()`
+   enum TN_RCode create() noexcept
+   {
+      return tn_fmem_create(&fmem, buf, BLOCK_SIZE, BlocksCnt);
+   }
+
+   /// See `tn_fmem_delete()`
+   enum TN_RCode remove() noexcept
+   {
+      return tn_fmem_delete(&fmem);
+   }
+
+   /// See `tn_fmem_get()`
+   enum TN_RCode get(T **pp_block, TN_TickCnt timeout) noexcept
+   {
+      return tn_fmem_get(&fmem, _pp_void(pp_block), timeout);
+   }
+
+   /// See `tn_fmem_get_polling()`
+   enum TN_RCode get_polling(T **pp_block) noexcept
+   {
+      return tn_fmem_get_polling(&fmem, _pp_void(pp_block));
+   }
+
+   /// See `tn_fmem_iget_polling()`
+   enum TN_RCode iget_polling(T **pp_block) noexcept
+   {
+      return tn_fmem_iget_polling(&fmem, _pp_void(pp_block));
+   }
+
+   /// See `tn_fmem_release()`
+   enum TN_RCode release(T *p_block) noexcept
+   {
+      return tn_fmem_release(&fmem, p_block);
+   }
+
+   /// See `tn_fmem_irelease()`
+   enum TN_RCode irelease(T *p_block) noexcept
+   {
+      return tn_fmem_irelease(&fmem, p_block);
+   }
+
+   /// See `tn_fmem_free_blocks_cnt_get()`
+   int free_blocks_cnt_get() noexcept
+   {
+      return tn_fmem_free_blocks_cnt_get(&fmem);
+   }
+
+   /// See `tn_fmem_used_blocks_cnt_get()`
+   int used_blocks_cnt_get() noexcept
+   {
+      return tn_fmem_used_blocks_cnt_get(&fmem);
+   }
+
+   /// See `tn_fmem_eventgrp_connect()`
+   enum TN_RCode eventgrp_connect(
+         struct TN_EventGrp  *eventgrp,
+         TN_UWord             pattern
+         ) noexcept
+   {
+      return tn_fmem_eventgrp_connect(&fmem, eventgrp, pattern);
+   }
+
+   /// See `tn_fmem_eventgrp_disconnect()`
+   enum TN_RCode eventgrp_disconnect() noexcept
+   {
+      return tn_fmem_eventgrp_disconnect(&fmem);
+   }
+
+   /// The C object, to use with any other C API function
+   struct TN_FMem *get() noexcept
+   {
+      return &fmem;
+   }
+
+private:
+   //-- see comment for `Queue::_pp_void()`
+   static void **_pp_void(T **pp_block) noexcept
+   {
+      return reinterpret_cast<void **>(pp_block);
+   }
+
+   struct TN_FMem fmem = {};
+   alignas(ALIGN) TN_UWord buf[
+      BlocksCnt * (BLOCK_SIZE / sizeof(TN_UWord))
+   ] = {};
+};
+
+
+
+/*******************************************************************************
+ *    MUTEX
+ ******************************************************************************/
+
+/**
+ * Mutex; use `tn::MutexLock` to lock it for the scope.
+ */
+class Mutex {
+public:
+   constexpr Mutex() noexcept = default;
+
+   Mutex(const Mutex &) = delete;
+   Mutex &operator=(const Mutex &) = delete;
+
+   /// Create mutex with priority inheritance protocol, see
+   /// `tn_mutex_create()`
+   enum TN_RCode create_inherit() noexcept
+   {
+      return tn_mutex_create(&mutex, TN_MUTEX_PROT_INHERIT, 0);
+   }
+
+   /// Create mutex with priority ceiling protocol, see `tn_mutex_create()`;
+   /// the ceiling priority is checked at compile time.
+   template <int CeilPriority>
+   enum TN_RCode create_ceiling() noexcept
+   {
+      static_assert(
+            CeilPriority >= 0 && CeilPriority < (TN_PRIORITIES_CNT - 1),
+            "ceiling priority should be in the range "
+            "[0 .. (TN_PRIORITIES_CNT - 2)]"
+            );
+      return tn_mutex_create(&mutex, TN_MUTEX_PROT_CEILING, CeilPriority);
+   }
+
+   /// See `tn_mutex_delete()`
+   enum TN_RCode remove() noexcept
+   {
+      return tn_mutex_delete(&mutex);
+   }
+
+   /// See `tn_mutex_lock()`
+   enum TN_RCode lock(TN_TickCnt timeout) noexcept
+   {
+      return tn_mutex_lock(&mutex, timeout);
+   }
+
+   /// See `tn_mutex_lock_polling()`
+   enum TN_RCode lock_polling() noexcept
+   {
+      return tn_mutex_lock_polling(&mutex);
+   }
+
+   /// See `tn_mutex_unlock()`
+   enum TN_RCode unlock() noexcept
+   {
+      return tn_mutex_unlock(&mutex);
+   }
+
+   /// The C object, to use with any other C API function
+   struct TN_Mutex *get() noexcept
+   {
+      return &mutex;
+   }
+
+private:
+   struct TN_Mutex mutex = {};
+};
+
+/**
+ * Scoped mutex lock: locks the mutex on construction, and unlocks it on
+ * destruction if only it was locked. Since the lock can fail (timeout,
+ * deadlock, deleted mutex, etc), check the result before touching the
+ * protected data:
+ *
+ * \code{.cpp}
+ *     tn::MutexLock lock(my_mutex, 10);
+ *     if (lock){
+ *        //-- locked
+ *     } else {
+ *        //-- lock.rc_get() tells what went wrong
+ *     }
+ * \endcode
+ */
+class MutexLock {
+public:
+   explicit MutexLock(
+         Mutex       &mutex,
+         TN_TickCnt   timeout = TN_WAIT_INFINITE
+         ) noexcept
+      : mutex(mutex), rc(mutex.lock(timeout))
+   {}
+
+   ~MutexLock()
+   {
+      if (rc == TN_RC_OK){
+         mutex.unlock();
+      }
+   }
+
+   MutexLock(const MutexLock &) = delete;
+   MutexLock &operator=(const MutexLock &) = delete;
+
+   /// Whether the mutex is locked
+   explicit operator bool() const noexcept
+   {
+      return rc == TN_RC_OK;
+   }
+
+   /// Result of `tn_mutex_lock()`
+   enum TN_RCode rc_get() const noexcept
+   {
+      return rc;
+   }
+
+private:
+   Mutex &mutex;
+   enum TN_RCode rc;
+};
+
+} // namespace tn
+
+#endif // _TN_HPP
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
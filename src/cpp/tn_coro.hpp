@@ -0,0 +1,1118 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/**
+ * \file
+ *
+ * C++20 coroutine executor: many stackless coroutines running inside one
+ * kernel task.
+ *
+ * When there are lots of concurrent activities which spend most of their
+ * time waiting (say, protocol sessions), having a task per activity is
+ * expensive: each task needs its own stack sized for the worst case.
+ * Instead, activities can be written as C++20 coroutines (`tn::coro::Task`)
+ * and run by the executor (`tn::coro::Executor`), which is a regular kernel
+ * task. When a coroutine waits for something (`co_await`), just the
+ * coroutine is suspended, and the executor runs other ones; the state of the
+ * suspended coroutine is kept in its frame, which is allocated when the
+ * coroutine is called, typically from a fixed memory pool (see
+ * `tn::coro::FMemFrameAllocator`). So, the RAM needed per activity is the
+ * frame size (the local variables living across suspension points plus a
+ * few words), instead of `sizeof(struct #TN_Task)` plus the stack.
+ *
+ * The coroutine should take the executor as its first parameter (so that
+ * its frame is allocated by the executor's allocator), and wait by
+ * awaitables obtained from the executor:
+ *
+ * \code{.cpp}
+ *     tn::coro::Task session(tn::coro::Executor &exec, struct TN_DQueue *queue)
+ *     {
+ *        for (;;){
+ *           void *p_msg;
+ *           if (co_await exec.receive(queue, &p_msg, 100) == TN_RC_OK){
+ *              //-- handle the message
+ *           } else {
+ *              //-- no messages for 100 ticks
+ *           }
+ *        }
+ *     }
+ *
+ *     //-- somewhere in the task context:
+ *     exec.spawn(session(exec, &my_queue));
+ * \endcode
+ *
+ * Awaitables are:
+ *
+ * - `tn::coro::Executor::receive()`: `tn_queue_receive()`;
+ * - `tn::coro::Executor::wait()`: `tn_sem_wait()` or `tn_eventgrp_wait()`;
+ * - `tn::coro::Executor::sleep()`: expiry of the timeout;
+ * - `tn::coro::Task`: another coroutine, which is run until it finishes.
+ *
+ * `co_await` returns the same code as the corresponding blocking call would
+ * return, e.g. `#TN_RC_TIMEOUT` if the timeout expired.
+ *
+ * The executor task sleeps on its own event group, and the awaited objects
+ * should wake it up. Queues and semaphores connected to the executor by
+ * `tn::coro::Executor::connect()` do that by themselves (see
+ * `tn_queue_eventgrp_connect()` and `tn_sem_eventgrp_connect()`), and the
+ * awaiting coroutine is resumed as soon as the message arrives or the
+ * semaphore is signaled; since each connected object takes one bit of the
+ * event group, there can be at most `(TN_INT_WIDTH - 1)` connected objects
+ * per executor. Other awaited objects (not connected queues and
+ * semaphores, and event groups) are polled by the executor each
+ * `poll_period` ticks (see `tn::coro::Executor::start()`), and whoever
+ * makes them ready may call `tn::coro::Executor::notify()` (or
+ * `tn::coro::Executor::inotify()` from ISR) to get the waiting coroutine
+ * resumed immediately.
+ *
+ * Limitations:
+ *
+ * - awaitables must be awaited by coroutines run by the same executor, and
+ *   objects such as queues shouldn't be waited for by the coroutines and
+ *   regular tasks simultaneously: tasks would always win;
+ * - coroutines of one executor are not preempted by each other: a coroutine
+ *   which doesn't `co_await` blocks all the others, and a coroutine must not
+ *   call blocking kernel services (with non-zero timeout), since that blocks
+ *   the whole executor;
+ * - coroutines return nothing (`co_return;`), and exceptions aren't
+ *   supported (it's supposed to be built with `-fno-exceptions`);
+ * - the executor, once started, runs forever.
+ *
+ * Needs a compiler with C++20 coroutines support, e.g. GCC 11 or newer with
+ * `-std=c++20`.
+ */
+
+#ifndef _TN_CORO_HPP
+#define _TN_CORO_HPP
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <new>
+
+#include "../tn.h"
+
+
+
+namespace tn {
+namespace coro {
+
+class Executor;
+class Task;
+
+/*******************************************************************************
+ *    FRAME ALLOCATORS
+ ******************************************************************************/
+
+/**
+ * Allocator of coroutine frames, given to the `tn::coro::Executor`.
+ * Both functions are called from the task context only.
+ */
+class FrameAllocator {
+public:
+   ///
+   /// Allocate the frame of the given size; return `nullptr` if there's no
+   /// memory: in this case, the coroutine call returns empty
+   /// `tn::coro::Task`.
+   virtual void *alloc(std::size_t size) noexcept = 0;
+   ///
+   /// Free the frame allocated by `alloc()`.
+   virtual void free(void *ptr) noexcept = 0;
+
+protected:
+   ~FrameAllocator() = default;
+};
+
+/**
+ * Frame allocator which takes frames from the fixed memory pool, so that no
+ * heap is needed. The pool's block size should be large enough for the
+ * largest coroutine frame plus `alignof(std::max_align_t)` bytes of the
+ * header; the frame size is known to the compiler only, so, in doubt, check
+ * `size_max()` after all the coroutines are spawned.
+ */
+class FMemFrameAllocator : public FrameAllocator {
+public:
+   constexpr explicit FMemFrameAllocator(struct TN_FMem &fmem) noexcept
+      : fmem(fmem)
+   {}
+
+   void *alloc(std::size_t size) noexcept override
+   {
+      void *ptr = nullptr;
+      if (size > max_size){
+         max_size = size;
+      }
+      if (     size > fmem.block_size
+            || tn_fmem_get_polling(&fmem, &ptr) != TN_RC_OK)
+      {
+         ptr = nullptr;
+      }
+      return ptr;
+   }
+
+   void free(void *ptr) noexcept override
+   {
+      tn_fmem_release(&fmem, ptr);
+   }
+
+   ///
+   /// The largest size requested so far, in bytes (even if it didn't fit in
+   /// the block)
+   std::size_t size_max() const noexcept
+   {
+      return max_size;
+   }
+
+private:
+   struct TN_FMem &fmem;
+   std::size_t max_size = 0;
+};
+
+/**
+ * Frame allocator which takes frames from the heap (non-throwing global
+ * `operator new`).
+ */
+class HeapFrameAllocator : public FrameAllocator {
+public:
+   void *alloc(std::size_t size) noexcept override
+   {
+      return ::operator new(size, std::nothrow);
+   }
+
+   void free(void *ptr) noexcept override
+   {
+      ::operator delete(ptr);
+   }
+};
+
+
+
+/*******************************************************************************
+ *    INTERNAL TYPES
+ ******************************************************************************/
+
+namespace detail {
+
+/**
+ * Item of the executor's lists: suspended coroutine which waits for its
+ * turn to be resumed.
+ */
+struct Node {
+   Node *next = nullptr;
+   std::coroutine_handle<> handle;
+};
+
+/**
+ * Singly-linked FIFO list of nodes.
+ */
+struct List {
+   Node *head = nullptr;
+   Node *tail = nullptr;
+
+   bool is_empty() const noexcept
+   {
+      return head == nullptr;
+   }
+
+   void push(Node *node) noexcept
+   {
+      node->next = nullptr;
+      if (tail != nullptr){
+         tail->next = node;
+      } else {
+         head = node;
+      }
+      tail = node;
+   }
+
+   Node *pop() noexcept
+   {
+      Node *node = head;
+      if (node != nullptr){
+         head = node->next;
+         if (head == nullptr){
+            tail = nullptr;
+         }
+      }
+      return node;
+   }
+
+   //-- remove the node which follows `prev` (or the head, if `prev` is
+   //   `nullptr`)
+   void remove_next(Node *prev, Node *node) noexcept
+   {
+      if (prev != nullptr){
+         prev->next = node->next;
+      } else {
+         head = node->next;
+      }
+      if (tail == node){
+         tail = prev;
+      }
+   }
+
+   //-- move all the nodes of `other` to the tail of this list
+   void splice(List &other) noexcept
+   {
+      if (other.head != nullptr){
+         if (tail != nullptr){
+            tail->next = other.head;
+         } else {
+            head = other.head;
+         }
+         tail = other.tail;
+         other.head = other.tail = nullptr;
+      }
+   }
+};
+
+/**
+ * Coroutine suspended by some awaitable of the executor.
+ */
+struct Waiter : Node {
+   ///
+   /// Check whether the wait is over: returns `#TN_RC_TIMEOUT` if not yet,
+   /// or the result of the wait otherwise. `nullptr` means that there's
+   /// nothing to wait for but the timeout.
+   enum TN_RCode (*poll)(Waiter *waiter);
+   ///
+   /// Flags of the executor's event group which get set when the wait might
+   /// be over; 0 means that the waiter should be polled each poll period.
+   TN_UWord flags = 0;
+   ///
+   /// Timeout, and the system tick count when the wait was started
+   TN_TickCnt timeout;
+   TN_TickCnt start = 0;
+   ///
+   /// Result of the wait
+   enum TN_RCode rc = TN_RC_TIMEOUT;
+};
+
+} // namespace detail
+
+
+
+/*******************************************************************************
+ *    COROUTINE TYPE
+ ******************************************************************************/
+
+/**
+ * Return type of the coroutine run by `tn::coro::Executor`.
+ *
+ * It is the owning handle of the coroutine, which isn't started yet. It
+ * should be either given to `tn::coro::Executor::spawn()`, or awaited by
+ * another coroutine of the same executor (then the awaiting coroutine
+ * resumes when the awaited one finishes). If it's destroyed unstarted, the
+ * coroutine frame is just freed.
+ *
+ * If the frame allocation failed, the returned object is empty (`false` in
+ * boolean context); awaiting the empty `Task` returns immediately.
+ */
+class Task {
+public:
+   class promise_type;
+   using Handle = std::coroutine_handle<promise_type>;
+
+   Task() noexcept = default;
+
+   Task(Task &&other) noexcept
+      : handle(other.handle)
+   {
+      other.handle = nullptr;
+   }
+
+   Task &operator=(Task &&other) noexcept
+   {
+      if (this != &other){
+         if (handle){
+            handle.destroy();
+         }
+         handle = other.handle;
+         other.handle = nullptr;
+      }
+      return *this;
+   }
+
+   Task(const Task &) = delete;
+   Task &operator=(const Task &) = delete;
+
+   ~Task()
+   {
+      if (handle){
+         handle.destroy();
+      }
+   }
+
+   explicit operator bool() const noexcept
+   {
+      return static_cast<bool>(handle);
+   }
+
+   //-- awaiting another coroutine: it is started right away (without going
+   //   through the executor's ready list), and when it finishes, it
+   //   transfers control back to the awaiting one.
+   bool await_ready() const noexcept
+   {
+      return !handle;
+   }
+
+   std::coroutine_handle<> await_suspend(
+         std::coroutine_handle<> awaiting
+         ) noexcept;
+
+   void await_resume() const noexcept
+   {}
+
+private:
+   friend class Executor;
+
+   explicit Task(Handle handle) noexcept
+      : handle(handle)
+   {}
+
+   Handle handle;
+};
+
+/**
+ * Promise of `tn::coro::Task`. Frames are allocated by the allocator of the
+ * executor given as the first argument of the coroutine; the allocator
+ * pointer is kept in the header preceding the frame.
+ */
+class Task::promise_type {
+public:
+   Task get_return_object() noexcept
+   {
+      return Task(Handle::from_promise(*this));
+   }
+
+   static Task get_return_object_on_allocation_failure() noexcept
+   {
+      return Task();
+   }
+
+   std::suspend_always initial_suspend() const noexcept
+   {
+      return {};
+   }
+
+   //-- when the coroutine finishes, it either resumes the awaiting one, or,
+   //   if it was spawned, destroys itself (the executor doesn't touch the
+   //   coroutine after resuming it)
+   struct FinalAwaiter {
+      bool await_ready() const noexcept
+      {
+         return false;
+      }
+
+      std::coroutine_handle<> await_suspend(Handle handle) noexcept
+      {
+         std::coroutine_handle<> next = handle.promise().awaiting;
+         if (!next){
+            handle.destroy();
+            next = std::noop_coroutine();
+         }
+         return next;
+      }
+
+      void await_resume() const noexcept
+      {}
+   };
+
+   FinalAwaiter final_suspend() const noexcept
+   {
+      return {};
+   }
+
+   void return_void() const noexcept
+   {}
+
+   void unhandled_exception() const noexcept
+   {
+      std::terminate();
+   }
+
+   template <typename... Args>
+   static void *operator new(
+         std::size_t size, Executor &exec, Args &...
+         ) noexcept;
+
+   //-- coroutines which don't take the executor as the first parameter are
+   //   not supported
+   static void *operator new(std::size_t size) = delete;
+
+   static void operator delete(void *ptr, std::size_t size) noexcept;
+
+private:
+   friend class Task;
+   friend class Executor;
+
+   //-- size of the frame header (allocator pointer), it keeps the frame
+   //   aligned
+   static constexpr std::size_t FRAME_HDR_SIZE = alignof(std::max_align_t);
+   static_assert(
+         FRAME_HDR_SIZE >= sizeof(FrameAllocator *),
+         "frame header is too small"
+         );
+
+   //-- item of the executor's ready list, used when the coroutine is spawned
+   detail::Node node;
+
+   //-- coroutine which awaits this one
+   std::coroutine_handle<> awaiting;
+};
+
+
+
+/*******************************************************************************
+ *    AWAITABLES
+ ******************************************************************************/
+
+/**
+ * Awaitable returned by the executor's functions: `co_await` on it returns
+ * `enum #TN_RCode`.
+ */
+class Awaitable : protected detail::Waiter {
+public:
+   bool await_ready() noexcept
+   {
+      this->rc = (this->poll != nullptr) ? this->poll(this) : TN_RC_TIMEOUT;
+      return this->rc != TN_RC_TIMEOUT || this->timeout == 0;
+   }
+
+   void await_suspend(std::coroutine_handle<> handle) noexcept;
+
+   enum TN_RCode await_resume() const noexcept
+   {
+      return this->rc;
+   }
+
+   Awaitable(const Awaitable &) = delete;
+   Awaitable &operator=(const Awaitable &) = delete;
+
+protected:
+   Awaitable(
+         Executor &exec,
+         enum TN_RCode (*poll)(detail::Waiter *waiter),
+         TN_TickCnt timeout
+         ) noexcept
+      : exec(exec)
+   {
+      this->poll = poll;
+      this->timeout = timeout;
+   }
+
+   Executor &exec;
+};
+
+
+namespace detail {
+
+struct QueueReceive : Awaitable {
+   QueueReceive(
+         Executor &exec, struct TN_DQueue *queue, void **pp_data,
+         TN_TickCnt timeout, TN_UWord flag
+         ) noexcept
+      : Awaitable(exec, _poll, timeout), queue(queue), pp_data(pp_data)
+   {
+      this->flags = flag;
+   }
+
+   static enum TN_RCode _poll(Waiter *waiter) noexcept
+   {
+      QueueReceive *self = static_cast<QueueReceive *>(waiter);
+      return tn_queue_receive_polling(self->queue, self->pp_data);
+   }
+
+   struct TN_DQueue *queue;
+   void **pp_data;
+};
+
+struct SemWait : Awaitable {
+   SemWait(
+         Executor &exec, struct TN_Sem *sem, TN_TickCnt timeout,
+         TN_UWord flag
+         ) noexcept
+      : Awaitable(exec, _poll, timeout), sem(sem)
+   {
+      this->flags = flag;
+   }
+
+   static enum TN_RCode _poll(Waiter *waiter) noexcept
+   {
+      return tn_sem_wait_polling(static_cast<SemWait *>(waiter)->sem);
+   }
+
+   struct TN_Sem *sem;
+};
+
+struct EventGrpWait : Awaitable {
+   EventGrpWait(
+         Executor &exec, struct TN_EventGrp *eventgrp, TN_UWord wait_pattern,
+         enum TN_EGrpWaitMode wait_mode, TN_UWord *p_flags_pattern,
+         TN_TickCnt timeout
+         ) noexcept
+      : Awaitable(exec, _poll, timeout), eventgrp(eventgrp),
+        wait_pattern(wait_pattern), wait_mode(wait_mode),
+        p_flags_pattern(p_flags_pattern)
+   {}
+
+   static enum TN_RCode _poll(Waiter *waiter) noexcept
+   {
+      EventGrpWait *self = static_cast<EventGrpWait *>(waiter);
+      return tn_eventgrp_wait_polling(
+            self->eventgrp, self->wait_pattern, self->wait_mode,
+            self->p_flags_pattern
+            );
+   }
+
+   struct TN_EventGrp *eventgrp;
+   TN_UWord wait_pattern;
+   enum TN_EGrpWaitMode wait_mode;
+   TN_UWord *p_flags_pattern;
+};
+
+struct Sleep : Awaitable {
+   Sleep(Executor &exec, TN_TickCnt timeout) noexcept
+      : Awaitable(exec, nullptr, timeout)
+   {}
+};
+
+} // namespace detail
+
+
+
+/*******************************************************************************
+ *    EXECUTOR
+ ******************************************************************************/
+
+/**
+ * Executor: the task which runs coroutines, see `tn_coro.hpp` for details.
+ *
+ * It's supposed to be statically allocated, like other kernel objects; the
+ * constructor is `constexpr`, so the static instance (as well as the
+ * static frame allocator) is initialized at compile time and doesn't need
+ * C++ runtime startup code. Declare it `constinit` to make sure.
+ */
+class Executor {
+public:
+   constexpr explicit Executor(FrameAllocator &allocator) noexcept
+      : allocator(allocator)
+   {}
+
+   Executor(const Executor &) = delete;
+   Executor &operator=(const Executor &) = delete;
+
+   /**
+    * Create the executor's event group and start its task. Should be called
+    * before any other function of the executor.
+    *
+    * $(TN_CALL_FROM_TASK)
+    * $(TN_CAN_SWITCH_CONTEXT)
+    * $(TN_LEGEND_LINK)
+    *
+    * @param priority
+    *    Priority of the executor task, all the coroutines run with it.
+    * @param stack_low_addr
+    *    Stack of the executor task, see `tn_task_create()`. It should be
+    *    large enough for the deepest coroutine (coroutines use the stack
+    *    while running, and just the frame while suspended).
+    * @param stack_size
+    *    Stack size, in words.
+    * @param poll_period
+    *    Period (in system ticks) of polling awaited objects which can't
+    *    wake the executor by themselves: event groups, and queues and
+    *    semaphores which aren't connected by `connect()` (see
+    *    `tn_coro.hpp`). While there is at least one such waiter, the
+    *    executor task wakes up each `poll_period` ticks: that costs a
+    *    context switch per period, the waiter is resumed up to
+    *    `poll_period` ticks late (unless `notify()` is called), and the
+    *    system tick can't be suppressed for longer than that (see
+    *    `#TN_DYNAMIC_TICK`). `#TN_WAIT_INFINITE` means that the objects
+    *    are never polled, and only `notify()` / `inotify()` wakes the
+    *    executor to check them. If all the awaited queues and semaphores
+    *    are connected and no event groups are awaited, the value doesn't
+    *    matter.
+    *
+    * @return
+    *    The same as `tn_eventgrp_create()` and `tn_task_create()`.
+    */
+   enum TN_RCode start(
+         int            priority,
+         TN_UWord      *stack_low_addr,
+         int            stack_size,
+         TN_TickCnt     poll_period
+         ) noexcept
+   {
+      this->poll_period = poll_period;
+
+      enum TN_RCode rc = tn_eventgrp_create(&eventgrp, 0);
+      if (rc == TN_RC_OK){
+         rc = tn_task_create(
+               &task, _task_body, priority, stack_low_addr, stack_size,
+               this, TN_TASK_CREATE_OPT_START
+               );
+      }
+
+      return rc;
+   }
+
+   /**
+    * Hand the coroutine over to the executor: it will be started from the
+    * executor task, after the coroutines which are currently ready to run.
+    * When the coroutine finishes, its frame is freed.
+    *
+    * $(TN_CALL_FROM_TASK)
+    * $(TN_CAN_SWITCH_CONTEXT)
+    * $(TN_LEGEND_LINK)
+    *
+    * @return
+    *    * `#TN_RC_OK` on success;
+    *    * `#TN_RC_WPARAM` if the `coro` is empty (frame allocation failed).
+    */
+   enum TN_RCode spawn(Task coro) noexcept
+   {
+      enum TN_RCode rc = TN_RC_WPARAM;
+
+      if (coro.handle){
+         detail::Node *node = &coro.handle.promise().node;
+         node->handle = coro.handle;
+         coro.handle = nullptr;
+
+         TN_UWord sr = tn_arch_sr_save_int_dis();
+         incoming.push(node);
+         tn_arch_sr_restore(sr);
+
+         rc = notify();
+      }
+
+      return rc;
+   }
+
+   /**
+    * Connect the queue to the executor: when the coroutine awaits
+    * `receive()` from the connected queue, it is resumed as soon as the
+    * message arrives (otherwise, the queue is polled). Each connected queue
+    * takes one flag of the executor's event group, so, there can be at most
+    * `(TN_INT_WIDTH - 1)` connected queues and semaphores (see
+    * `connect(struct TN_Sem *)`). The queue should not be
+    * connected to any other event group.
+    *
+    * $(TN_CALL_FROM_TASK)
+    * $(TN_LEGEND_LINK)
+    *
+    * @return
+    *    * `#TN_RC_OK` on success;
+    *    * `#TN_RC_OVERFLOW` if there are no free flags left;
+    *    * other codes are the same as for `tn_queue_eventgrp_connect()`.
+    */
+   enum TN_RCode connect(struct TN_DQueue *queue) noexcept
+   {
+      enum TN_RCode rc = TN_RC_OVERFLOW;
+
+      //-- lowest free flag
+      TN_UWord flag = flags_free & (~flags_free + 1);
+      if (flag != 0){
+         rc = tn_queue_eventgrp_connect(queue, &eventgrp, flag);
+         if (rc == TN_RC_OK){
+            flags_free &= ~flag;
+         }
+      }
+
+      return rc;
+   }
+
+   /**
+    * Connect the semaphore to the executor: when the coroutine awaits
+    * `wait()` for the connected semaphore, it is resumed as soon as the
+    * semaphore is signaled (otherwise, the semaphore is polled). The
+    * semaphore takes one flag of the executor's event group, shared with
+    * connected queues (see `connect(struct TN_DQueue *)`), and should not
+    * be connected to any other event group.
+    *
+    * $(TN_CALL_FROM_TASK)
+    * $(TN_LEGEND_LINK)
+    *
+    * @return
+    *    * `#TN_RC_OK` on success;
+    *    * `#TN_RC_OVERFLOW` if there are no free flags left;
+    *    * other codes are the same as for `tn_sem_eventgrp_connect()`.
+    */
+   enum TN_RCode connect(struct TN_Sem *sem) noexcept
+   {
+      enum TN_RCode rc = TN_RC_OVERFLOW;
+
+      //-- lowest free flag
+      TN_UWord flag = flags_free & (~flags_free + 1);
+      if (flag != 0){
+         rc = tn_sem_eventgrp_connect(sem, &eventgrp, flag);
+         if (rc == TN_RC_OK){
+            flags_free &= ~flag;
+         }
+      }
+
+      return rc;
+   }
+
+   /**
+    * Wake up the executor, so that it polls awaited objects (see
+    * `tn_coro.hpp`) right away.
+    *
+    * $(TN_CALL_FROM_TASK)
+    * $(TN_CAN_SWITCH_CONTEXT)
+    * $(TN_LEGEND_LINK)
+    */
+   enum TN_RCode notify() noexcept
+   {
+      return tn_eventgrp_modify(&eventgrp, TN_EVENTGRP_OP_SET, FLAG_KICK);
+   }
+
+   /**
+    * The same as `notify()`, but for using in the ISR.
+    *
+    * $(TN_CALL_FROM_ISR)
+    * $(TN_CAN_SWITCH_CONTEXT)
+    * $(TN_LEGEND_LINK)
+    */
+   enum TN_RCode inotify() noexcept
+   {
+      return tn_eventgrp_imodify(&eventgrp, TN_EVENTGRP_OP_SET, FLAG_KICK);
+   }
+
+   /**
+    * Awaitable: receive the message from the queue, like
+    * `tn_queue_receive()`.
+    */
+   detail::QueueReceive receive(
+         struct TN_DQueue *queue,
+         void **pp_data,
+         TN_TickCnt timeout = TN_WAIT_INFINITE
+         ) noexcept
+   {
+      return detail::QueueReceive(
+            *this, queue, pp_data, timeout, _queue_flag_get(queue)
+            );
+   }
+
+   /**
+    * Awaitable: wait for the semaphore, like `tn_sem_wait()`.
+    */
+   detail::SemWait wait(
+         struct TN_Sem *sem,
+         TN_TickCnt timeout = TN_WAIT_INFINITE
+         ) noexcept
+   {
+      return detail::SemWait(*this, sem, timeout, _sem_flag_get(sem));
+   }
+
+   /**
+    * Awaitable: wait for the event(s) in the event group, like
+    * `tn_eventgrp_wait()`.
+    */
+   detail::EventGrpWait wait(
+         struct TN_EventGrp  *eventgrp,
+         TN_UWord             wait_pattern,
+         enum TN_EGrpWaitMode wait_mode,
+         TN_UWord            *p_flags_pattern = nullptr,
+         TN_TickCnt           timeout = TN_WAIT_INFINITE
+         ) noexcept
+   {
+      return detail::EventGrpWait(
+            *this, eventgrp, wait_pattern, wait_mode, p_flags_pattern,
+            timeout
+            );
+   }
+
+   /**
+    * Awaitable: wait for the given number of system ticks, like
+    * `tn_task_sleep()`; `co_await` returns `#TN_RC_TIMEOUT`.
+    */
+   detail::Sleep sleep(TN_TickCnt timeout) noexcept
+   {
+      return detail::Sleep(*this, timeout);
+   }
+
+   /**
+    * Allocator of the coroutine frames
+    */
+   FrameAllocator &frame_allocator() noexcept
+   {
+      return allocator;
+   }
+
+   /**
+    * The executor task
+    */
+   struct TN_Task &get_task() noexcept
+   {
+      return task;
+   }
+
+private:
+   friend class Awaitable;
+
+   //-- flag of the event group which just wakes up the executor
+   static constexpr TN_UWord FLAG_KICK = 1;
+
+   static void _task_body(void *param)
+   {
+      static_cast<Executor *>(param)->_run();
+   }
+
+   void _run() noexcept
+   {
+      for (;;){
+         //-- take coroutines spawned by the others
+         TN_UWord sr = tn_arch_sr_save_int_dis();
+         ready.splice(incoming);
+         tn_arch_sr_restore(sr);
+
+         //-- run all the ready coroutines. Note that the node can't be
+         //   touched after the coroutine is resumed: it lives in the
+         //   coroutine frame.
+         detail::Node *node;
+         while ((node = ready.pop()) != nullptr){
+            node->handle.resume();
+         }
+
+         //-- sleep until something happens, or until the nearest deadline
+         TN_UWord wait_pattern = FLAG_KICK;
+         TN_TickCnt timeout = _timeout_get(&wait_pattern);
+         TN_UWord flags = 0;
+
+         tn_eventgrp_wait(
+               &eventgrp, wait_pattern, TN_EVENTGRP_WMODE_OR, &flags,
+               timeout
+               );
+
+         //-- the kick flag is cleared before polling, so that the kick
+         //   which happens after that isn't missed
+         if (flags & FLAG_KICK){
+            tn_eventgrp_modify(&eventgrp, TN_EVENTGRP_OP_CLEAR, FLAG_KICK);
+         }
+
+         _waiters_poll(flags);
+      }
+   }
+
+   //-- returns timeout for the executor wait, and adds flags of the waiters
+   //   to `*p_pattern`
+   TN_TickCnt _timeout_get(TN_UWord *p_pattern) noexcept
+   {
+      TN_TickCnt timeout = TN_WAIT_INFINITE;
+      TN_TickCnt now = tn_sys_time_get();
+
+      for (
+            detail::Node *node = waiters.head;
+            node != nullptr;
+            node = node->next
+          )
+      {
+         detail::Waiter *waiter = static_cast<detail::Waiter *>(node);
+         TN_TickCnt cur = TN_WAIT_INFINITE;
+
+         if (waiter->flags != 0){
+            *p_pattern |= waiter->flags;
+         } else if (waiter->poll != nullptr){
+            cur = poll_period;
+         }
+
+         if (waiter->timeout != TN_WAIT_INFINITE){
+            TN_TickCnt elapsed = now - waiter->start;
+            TN_TickCnt left =
+               (elapsed < waiter->timeout) ? (waiter->timeout - elapsed) : 0;
+            if (left < cur){
+               cur = left;
+            }
+         }
+
+         if (cur < timeout){
+            timeout = cur;
+         }
+      }
+
+      return timeout;
+   }
+
+   //-- check the waiters which might be done (given the flags of the event
+   //   group), and move them to the ready list
+   void _waiters_poll(TN_UWord flags) noexcept
+   {
+      TN_TickCnt now = tn_sys_time_get();
+      detail::Node *prev = nullptr;
+      detail::Node *node = waiters.head;
+
+      while (node != nullptr){
+         detail::Waiter *waiter = static_cast<detail::Waiter *>(node);
+         detail::Node *next = node->next;
+         bool done = false;
+
+         if (     waiter->poll != nullptr
+               && (waiter->flags == 0 || (waiter->flags & flags)))
+         {
+            waiter->rc = waiter->poll(waiter);
+            done = (waiter->rc != TN_RC_TIMEOUT);
+         }
+
+         if (     !done
+               && waiter->timeout != TN_WAIT_INFINITE
+               && (TN_TickCnt)(now - waiter->start) >= waiter->timeout)
+         {
+            waiter->rc = TN_RC_TIMEOUT;
+            done = true;
+         }
+
+         if (done){
+            waiters.remove_next(prev, node);
+            ready.push(node);
+         } else {
+            prev = node;
+         }
+
+         node = next;
+      }
+   }
+
+   void _waiter_add(detail::Waiter *waiter) noexcept
+   {
+      waiter->start = tn_sys_time_get();
+      waiters.push(waiter);
+   }
+
+   //-- returns the flag of the queue if it's connected to this executor, or
+   //   0 otherwise
+   TN_UWord _queue_flag_get(struct TN_DQueue *queue) const noexcept
+   {
+      return (queue->eventgrp_link.eventgrp == &eventgrp)
+         ? queue->eventgrp_link.pattern
+         : 0;
+   }
+
+   //-- returns the flag of the semaphore if it's connected to this
+   //   executor, or 0 otherwise
+   TN_UWord _sem_flag_get(struct TN_Sem *sem) const noexcept
+   {
+      return (sem->eventgrp_link.eventgrp == &eventgrp)
+         ? sem->eventgrp_link.pattern
+         : 0;
+   }
+
+   FrameAllocator &allocator;
+
+   struct TN_Task task = {};
+   struct TN_EventGrp eventgrp = {};
+
+   //-- spawned coroutines, not yet taken by the executor task; accessed
+   //   with interrupts disabled
+   detail::List incoming;
+
+   //-- coroutines ready to run; accessed by the executor task only
+   detail::List ready;
+
+   //-- suspended coroutines (`detail::Waiter`); accessed by the executor
+   //   task only
+   detail::List waiters;
+
+   //-- flags of the event group which aren't yet taken by connected queues
+   //   and semaphores
+   TN_UWord flags_free = ~FLAG_KICK;
+
+   TN_TickCnt poll_period = TN_WAIT_INFINITE;
+};
+
+
+
+
+
+
+/*******************************************************************************
+ *    INLINE FUNCTIONS
+ ******************************************************************************/
+
+inline std::coroutine_handle<> Task::await_suspend(
+      std::coroutine_handle<> awaiting
+      ) noexcept
+{
+   handle.promise().awaiting = awaiting;
+   return handle;
+}
+
+template <typename... Args>
+inline void *Task::promise_type::operator new(
+      std::size_t size, Executor &exec, Args &...
+      ) noexcept
+{
+   FrameAllocator *allocator = &exec.frame_allocator();
+   unsigned char *ptr = static_cast<unsigned char *>(
+         allocator->alloc(FRAME_HDR_SIZE + size)
+         );
+
+   if (ptr != nullptr){
+      *reinterpret_cast<FrameAllocator **>(ptr) = allocator;
+      ptr += FRAME_HDR_SIZE;
+   }
+
+   return ptr;
+}
+
+inline void Task::promise_type::operator delete(
+      void *ptr, std::size_t
+      ) noexcept
+{
+   unsigned char *hdr = static_cast<unsigned char *>(ptr) - FRAME_HDR_SIZE;
+   (*reinterpret_cast<FrameAllocator **>(hdr))->free(hdr);
+}
+
+inline void Awaitable::await_suspend(std::coroutine_handle<> handle) noexcept
+{
+   this->handle = handle;
+   exec._waiter_add(this);
+}
+
+} // namespace coro
+} // namespace tn
+
+#endif // _TN_CORO_HPP
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
@@ -57,6 +57,18 @@
 #include "core/tn_sem.h"
 #include "core/tn_tasks.h"
 #include "core/tn_timer.h"
+#include "core/tn_trace.h"
+#include "core/tn_wakeup_latency.h"
+#include "core/tn_csect.h"
+#include "core/tn_cpu_load.h"
+#include "core/tn_pc_sample.h"
+#include "core/tn_obj_stats.h"
+#include "core/tn_obj_registry.h"
+#include "core/tn_btask.h"
+#include "core/tn_condvar.h"
+#include "core/tn_rwlock.h"
+#include "core/tn_select.h"
+#include "core/tn_rpc.h"
 
 
 //-- include old symbols for compatibility with old projects
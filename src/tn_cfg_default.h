@@ -192,6 +192,60 @@
 #  define TN_MUTEX_DEADLOCK_DETECT  1
 #endif
 
+/**
+ * Whether reader-writer locks API should be available, see `tn_rwlock.h`.
+ * Requires `#TN_USE_MUTEXES` to be set, since rwlocks use the same priority
+ * inheritance machinery as mutexes.
+ *
+ * When set, `struct #TN_Task` gets one more list: the list of rwlocks held by
+ * the task.
+ */
+#ifndef TN_USE_RWLOCKS
+#  define TN_USE_RWLOCKS         0
+#endif
+
+/**
+ * Whether `tn_select()` should be available: wait for any of several
+ * semaphores, data queues, memory pools and event groups at once, see
+ * `tn_select.h`.
+ *
+ * When set, each of these objects gets one more list: the list of
+ * `tn_select()` items that wait for it.
+ */
+#ifndef TN_USE_SELECT
+#  define TN_USE_SELECT          0
+#endif
+
+/**
+ * Whether synchronous message passing (send-receive-reply) API should be
+ * available, see `tn_rpc.h`. Requires `#TN_USE_MUTEXES` to be set, since
+ * the server inherits priorities of its clients by the same machinery as
+ * for mutexes.
+ *
+ * When set, `struct #TN_Task` gets one more list: the list of RPC objects
+ * whose calls are being served by the task.
+ */
+#ifndef TN_USE_RPC
+#  define TN_USE_RPC             0
+#endif
+
+/**
+ * Whether per-task preemption threshold should be available, see
+ * `tn_task_preempt_threshold_set()`. When the running task has the
+ * threshold set, it can be preempted only by the tasks whose priority is
+ * higher than the threshold, so, groups of tasks may run non-preemptively
+ * with respect to each other, with less context switches.
+ *
+ * When set, `struct #TN_Task` gets the threshold field and one more list
+ * item, the scheduler does a couple of extra comparisons when the task
+ * becomes runnable, and `_tn_sys_on_context_switch()` is called at each
+ * context switch to keep track of the tasks preempted while their threshold
+ * was in effect.
+ */
+#ifndef TN_USE_PREEMPT_THRESHOLD
+#  define TN_USE_PREEMPT_THRESHOLD   0
+#endif
+
 /**
  *
  * <i>Takes effect if only `#TN_DYNAMIC_TICK` is <B>not set</B></i>.
@@ -270,6 +324,232 @@
 #  define TN_PROFILER_WAIT_TIME  0
 #endif
 
+/**
+ * Number of interrupt IDs the profiler should account time for. If zero (the
+ * default), the profiler isn't aware of interrupts at all, and time spent in
+ * ISRs is charged to whichever task was interrupted.
+ *
+ * If non-zero, the application may call `#tn_sys_profiler_isr_enter()` in the
+ * beginning of each ISR it wants to account, and `#tn_sys_profiler_isr_exit()`
+ * in the end of it. Each ISR is identified by an ID in the range `[0,
+ * TN_PROFILER_ISR_CNT)`: it might be an interrupt vector number, or some
+ * arbitrary user-defined value. The time spent in these ISRs is then
+ * subtracted from the run time of interrupted tasks, and is available via
+ * `#tn_sys_profiler_timing_get()`, see `struct #TN_SysTiming`.
+ *
+ * Since ISRs usually take way less than a system tick, when this option is
+ * non-zero, the profiler measures time of both ISRs and tasks in timestamp
+ * units (see `#tn_callback_timestamp_set()`) instead of system ticks. The
+ * timestamp callback should be set then, see `struct #TN_SysTiming` for what
+ * happens if it isn't.
+ *
+ * Each ID takes about 24 bytes of RAM. Maximum value is 255.
+ *
+ * Relevant if only `#TN_PROFILER` is non-zero.
+ */
+#ifndef TN_PROFILER_ISR_CNT
+#  define TN_PROFILER_ISR_CNT    0
+#endif
+
+/**
+ * Whether kernel event tracer should be enabled. If it is, the kernel writes
+ * compact binary records about context switches, waits, mutex locks and other
+ * events into the RAM ring buffer, which can be decoded on the host. See
+ * `tn_trace.h` for details.
+ *
+ * If this option is zero, trace hooks expand to nothing, so there is no
+ * overhead at all.
+ *
+ * @see `#TN_TRACE_RECS_CNT`
+ */
+#ifndef TN_TRACE
+#  define TN_TRACE               0
+#endif
+
+/**
+ * Capacity of the trace ring buffer, in records. Each record takes 4 words
+ * (`#TN_UWord`), see `struct #TN_TraceRecord`.
+ *
+ * Relevant if only `#TN_TRACE` is non-zero.
+ */
+#ifndef TN_TRACE_RECS_CNT
+#  define TN_TRACE_RECS_CNT      128
+#endif
+
+/**
+ * Whether wake-up latency should be measured: the time from the moment the
+ * task becomes runnable until it actually gets running. Latencies are
+ * accounted in log-scale histograms of each task and of each object that
+ * wakes tasks up (semaphore, mutex, etc). See `tn_wakeup_latency.h` for
+ * details.
+ *
+ * Timestamps are taken by the callback set with
+ * `#tn_callback_timestamp_set()`.
+ *
+ * @see `#TN_WAKEUP_LATENCY_BINS_CNT`
+ */
+#ifndef TN_WAKEUP_LATENCY
+#  define TN_WAKEUP_LATENCY      0
+#endif
+
+/**
+ * Number of bins in each wake-up latency histogram, see `struct
+ * #TN_WakeupLatency`. Should be in the range `[2, 32]`.
+ *
+ * Relevant if only `#TN_WAKEUP_LATENCY` is non-zero.
+ */
+#ifndef TN_WAKEUP_LATENCY_BINS_CNT
+#  define TN_WAKEUP_LATENCY_BINS_CNT   16
+#endif
+
+/**
+ * Whether kernel critical sections (made with `TN_INT_DIS_SAVE()` /
+ * `TN_INT_RESTORE()`) should be measured: each section is timestamped, and
+ * the longest ones are kept in the table together with the call site. See
+ * `tn_csect.h` for details.
+ *
+ * It adds noticeable overhead to every critical section, so it's intended
+ * for finding the sections that hurt interrupt latency, not for production.
+ *
+ * Timestamps are taken by the callback set with
+ * `#tn_callback_timestamp_set()`.
+ *
+ * @see `#TN_CSECT_MEASURE_TOP_CNT`
+ */
+#ifndef TN_CSECT_MEASURE
+#  define TN_CSECT_MEASURE       0
+#endif
+
+/**
+ * Number of records in the table of the longest critical sections, see
+ * `#tn_csect_top_get()`. Should be in the range `[1, 255]`.
+ *
+ * Relevant if only `#TN_CSECT_MEASURE` is non-zero.
+ */
+#ifndef TN_CSECT_MEASURE_TOP_CNT
+#  define TN_CSECT_MEASURE_TOP_CNT     8
+#endif
+
+/**
+ * Whether CPU load should be measured, see `tn_cpu_load.h` for details.
+ *
+ * If timestamp callback is set by `#tn_callback_timestamp_set()`, idle time is
+ * measured precisely; otherwise, it is sampled at each system tick.
+ *
+ * Not available together with `#TN_DYNAMIC_TICK`.
+ *
+ * @see `#TN_CPU_LOAD_PERIOD_TICKS`
+ * @see `#TN_CPU_LOAD_PERIODS_CNT`
+ */
+#ifndef TN_CPU_LOAD
+#  define TN_CPU_LOAD            0
+#endif
+
+/**
+ * Length of the CPU load measurement period, in system ticks. Typically you
+ * want it to be 1 second.
+ *
+ * Relevant if only `#TN_CPU_LOAD` is non-zero.
+ */
+#ifndef TN_CPU_LOAD_PERIOD_TICKS
+#  define TN_CPU_LOAD_PERIOD_TICKS     1000
+#endif
+
+/**
+ * Number of the most recent periods whose load is kept, so that load can be
+ * averaged over up to this number of periods, see `#tn_cpu_load_get()`.
+ * Should be in the range `[1, 255]`. Each period takes 2 bytes of RAM.
+ *
+ * Relevant if only `#TN_CPU_LOAD` is non-zero.
+ */
+#ifndef TN_CPU_LOAD_PERIODS_CNT
+#  define TN_CPU_LOAD_PERIODS_CNT      60
+#endif
+
+/**
+ * Whether statistical PC-sampling profiler is enabled, see `tn_pc_sample.h`
+ * for details.
+ *
+ * @see `#TN_PC_SAMPLE_RECS_CNT`
+ * @see `#TN_PC_SAMPLE_ON_TICK`
+ */
+#ifndef TN_PC_SAMPLE
+#  define TN_PC_SAMPLE           0
+#endif
+
+/**
+ * Number of samples in the PC samples ring buffer, should be at least 2.
+ * Each sample takes 2 words (`#TN_UWord`) of RAM.
+ *
+ * Relevant if only `#TN_PC_SAMPLE` is non-zero.
+ */
+#ifndef TN_PC_SAMPLE_RECS_CNT
+#  define TN_PC_SAMPLE_RECS_CNT  256
+#endif
+
+/**
+ * Whether PC sample should be taken at each system tick by
+ * `#tn_tick_int_processing()`. If zero, the application should take samples
+ * by itself, see `#tn_pc_sample_isr()`.
+ *
+ * Supported on Cortex-M only, so it is on by default on Cortex-M, and off on
+ * other architectures.
+ *
+ * Relevant if only `#TN_PC_SAMPLE` is non-zero.
+ */
+#ifndef TN_PC_SAMPLE_ON_TICK
+#  if defined(__TN_ARCH_CORTEX_M__)
+#     define TN_PC_SAMPLE_ON_TICK   1
+#  else
+#     define TN_PC_SAMPLE_ON_TICK   0
+#  endif
+#endif
+
+/**
+ * Whether semaphores, mutexes, data queues and fixed memory pools should
+ * keep contention statistics, see `tn_obj_stats.h` for details.
+ *
+ * Each of these objects gets about 11 words bigger, and each task gets one
+ * word bigger.
+ */
+#ifndef TN_OBJ_STATS
+#  define TN_OBJ_STATS           0
+#endif
+
+/**
+ * Whether the kernel should keep the registry of all created objects
+ * (semaphores, mutexes, data queues, event groups, fixed memory pools and
+ * timers; tasks are tracked by the kernel anyway), so that the application or
+ * the debugger can enumerate them, see `tn_obj_registry.h` for details.
+ *
+ * Each of these objects gets 2 words bigger.
+ */
+#ifndef TN_OBJ_REGISTRY
+#  define TN_OBJ_REGISTRY        0
+#endif
+
+/**
+ * Whether `struct #TN_Task` should have compact layout: priorities, task
+ * state, wait reason, wait result and time slice counter are stored in
+ * `unsigned char` / `signed char` / `unsigned short` fields instead of
+ * full-width ints and enums, and the list item which includes task in the
+ * list of created tasks is dropped if nobody needs it (i.e. if all of
+ * `#TN_STACK_USAGE_IDLE_SCAN`, `#TN_STACK_OVERFLOW_CANARY_CNT` and
+ * `#TN_OBJ_REGISTRY` are zero).
+ *
+ * On 32-bit platforms, it saves 20 bytes per task (28 bytes if the list
+ * item is dropped). The price is that the debugger shows these fields as
+ * plain numbers instead of enum names, and some architectures need an extra
+ * zero-/sign-extension instruction here and there when these fields are
+ * accessed.
+ *
+ * The hot fields which are used by the scheduler are at the beginning of
+ * the structure regardless of this option.
+ */
+#ifndef TN_COMPACT_TCB
+#  define TN_COMPACT_TCB         0
+#endif
+
 /**
  * Whether interrupt stack space should be initialized with
  * `#TN_FILL_STACK_VAL` on system start. It is useful to disable this option if
@@ -309,6 +589,32 @@
  *
  * Nevertheless, from my personal experience, it helps to catch stack overflow
  * bugs a lot.
+ *
+ * There are alternative strategies, which can be used instead of this one,
+ * or together with it:
+ *
+ * - `#TN_STACK_OVERFLOW_CANARY_CNT`: multi-word canary at the end of each
+ *   stack, checked by the idle task;
+ * - `#TN_STACK_OVERFLOW_MPU_GUARD`: MPU region at the end of the stack of the
+ *   running task (Cortex-M3/M4/M4F only).
+ *
+ * Their costs, in instructions, as per the current code for Cortex-M3 (for
+ * actual cycle counts on your hardware, measure context switch time with
+ * `DWT->CYCCNT`, with each option enabled in turn):
+ *
+ * | Strategy        | Per context switch | Per system tick | In idle task
+ * |-----------------|--------------------|-----------------|----------------
+ * | This option     | ~15 (incl. call to `_tn_sys_on_context_switch()`, if it's the only handler) | ~8 | -
+ * | Canary          | -                  | -               | ~(6 + 4*N) per task
+ * | MPU guard       | ~11 (call, 4 ALU ops, one store to `MPU->RBAR`, DSB + ISB) | - | -
+ *
+ * Detection capabilities differ as well: this option catches only overflows
+ * that corrupt the very last word of the stack, and only at the next context
+ * switch or tick; the canary catches overflows that touch any of the last N
+ * words, but only when the idle task gets running; the MPU guard catches
+ * any write to the guard region immediately, by the MemManage fault, but
+ * it doesn't catch overflows that jump over the guard (e.g. a large array
+ * on stack which isn't written to the guarded part).
  */
 #ifndef TN_STACK_OVERFLOW_CHECK
 #  if defined(__TN_ARCH_PIC24_DSPIC__)
@@ -325,6 +631,75 @@
 #  endif
 #endif
 
+/**
+ * Whether the idle task should scan stacks of all tasks incrementally and
+ * cache stack high-watermark of each task, so that `tn_task_stack_free_get()`
+ * and `tn_task_stack_used_get()` cost O(1).
+ *
+ * Each time the idle task loop runs, it checks at most
+ * `#TN_STACK_USAGE_SCAN_CHUNK` words of some task's stack with interrupts
+ * disabled, so the impact on interrupt latency is bounded.
+ *
+ * If this option is zero, the mentioned functions scan the stack right away.
+ *
+ * @see `#TN_STACK_USAGE_SCAN_CHUNK`
+ */
+#ifndef TN_STACK_USAGE_IDLE_SCAN
+#  define TN_STACK_USAGE_IDLE_SCAN     0
+#endif
+
+/**
+ * Maximum number of stack words checked by a single step of the incremental
+ * stack scanning performed by the idle task. Should be at least 1.
+ *
+ * Relevant if only `#TN_STACK_USAGE_IDLE_SCAN` is non-zero.
+ */
+#ifndef TN_STACK_USAGE_SCAN_CHUNK
+#  define TN_STACK_USAGE_SCAN_CHUNK    16
+#endif
+
+/**
+ * Number of words at the end of each task's stack that serve as a canary: they
+ * are filled with `#TN_FILL_STACK_VAL` when task is created (as the rest of
+ * the stack), and the idle task checks them: one task per each iteration of
+ * the idle loop. If some of them is corrupted, the user-provided callback
+ * (see `#tn_callback_stack_overflow_set()`) is called, just like for
+ * `#TN_STACK_OVERFLOW_CHECK`.
+ *
+ * Zero means canary is not used. This way of overflow detection has no
+ * overhead on the context switch and tick processing, at the cost of
+ * detection delay: overflow is only detected when the system is idle.
+ *
+ * Canary words are added to `#TN_MIN_STACK_SIZE`. Should be in the range
+ * `[0, 255]`.
+ */
+#ifndef TN_STACK_OVERFLOW_CANARY_CNT
+#  define TN_STACK_OVERFLOW_CANARY_CNT    0
+#endif
+
+/**
+ * Whether the MPU should be used for stack overflow detection: a read-only
+ * guard region of 32 bytes is placed at the end of the stack of the running
+ * task; the region is reprogrammed at every context switch. Any write to the
+ * guard (which is what stack overflow typically does) causes MemManage fault
+ * immediately; the kernel provides `MemManage_Handler()` which calls
+ * user-provided callback (see `#tn_callback_stack_overflow_set()`), and then
+ * `#_TN_FATAL_ERROR()`. Make sure your code doesn't define its own
+ * `MemManage_Handler()`.
+ *
+ * The guard region occupies the first 32-byte aligned 32 bytes of the stack,
+ * so it takes up to 15 words of each stack; they are added to
+ * `#TN_MIN_STACK_SIZE`. MPU region 7 is used; background region is enabled,
+ * so that the rest of the memory map is not affected, unless you configure
+ * other regions.
+ *
+ * Currently supported on Cortex-M3/M4/M4F only (ARMv7-M MPU). Can be tried
+ * on QEMU with `-M mps2-an385`.
+ */
+#ifndef TN_STACK_OVERFLOW_MPU_GUARD
+#  define TN_STACK_OVERFLOW_MPU_GUARD     0
+#endif
+
 
 /**
  * Whether the kernel should use \ref time_ticks__dynamic_tick scheme instead of
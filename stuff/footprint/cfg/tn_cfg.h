@@ -0,0 +1,42 @@
+/*******************************************************************************
+ *    TNeo configuration for the footprint report
+ *
+ *    Every option can be overridden by the variant (see variants.txt), so
+ *    that the cost of each option can be seen against this baseline
+ *    configuration.
+ *
+ ******************************************************************************/
+
+
+#ifndef _TN_CFG_H
+#define _TN_CFG_H
+
+
+#ifndef TN_CHECK_PARAM
+#  define TN_CHECK_PARAM            1
+#endif
+
+#ifndef TN_DEBUG
+#  define TN_DEBUG                  0
+#endif
+
+#ifndef TN_OLD_TNKERNEL_NAMES
+#  define TN_OLD_TNKERNEL_NAMES     0
+#endif
+
+#ifndef TN_USE_MUTEXES
+#  define TN_USE_MUTEXES            1
+#endif
+
+#ifndef TN_MUTEX_REC
+#  define TN_MUTEX_REC              0
+#endif
+
+#ifndef TN_MUTEX_DEADLOCK_DETECT
+#  define TN_MUTEX_DEADLOCK_DETECT  0
+#endif
+
+
+#endif // _TN_CFG_H
+
+
@@ -0,0 +1,372 @@
+#!/usr/bin/env python3
+#
+# TNeo: real-time kernel initially based on TNKernel
+#
+# Code size and RAM footprint report across the configuration matrix.
+#
+# For each given architecture and each configuration variant (see
+# variants.txt), the kernel is built by the top-level Makefile with the
+# baseline configuration cfg/tn_cfg.h plus the variant's flags; then, the
+# object files are examined:
+#
+#   - per-object-file and per-function sizes are taken from the symbol tables
+#     (by `nm`);
+#   - sizes of the kernel structures (struct TN_Task, TN_Mutex, etc) are
+#     taken from the debug info (by `readelf`), so nothing has to be run on
+#     the target.
+#
+# The report is plain text, with stable ordering and one fact per line, so
+# that reports for two revisions can be just diffed.
+#
+# Usage (normally invoked by `make -f Makefile-all-arch footprint`):
+#
+#    footprint.py --arch cortex_m3:arm-none-eabi-gcc -o footprint.txt
+#    footprint.py --arch cortex_m3:arm-none-eabi-gcc --arch pic32mx:xc32 \
+#          --variants my_variants.txt
+#
+
+import argparse
+import os
+import re
+import shutil
+import subprocess
+import sys
+
+
+_TOP_DIR = os.path.abspath(
+    os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..")
+)
+_THIS_DIR_REL = os.path.relpath(
+    os.path.dirname(os.path.abspath(__file__)), _TOP_DIR
+)
+
+#-- structures whose sizes are reported
+STRUCTS = [
+    "TN_Task", "TN_Mutex", "TN_Timer", "TN_Sem", "TN_DQueue",
+    "TN_EventGrp", "TN_FMem",
+]
+
+#-- nm symbol types: code (read-only data is counted as code as well, since
+#   it lives in flash), initialized data, zero-initialized data
+_NM_TEXT_TYPES = "TtWwRrVv"
+_NM_DATA_TYPES = "DdGg"
+_NM_BSS_TYPES = "BbSsCc"
+_NM_FUNC_TYPES = "TtWw"
+
+#-- prefix of binutils for each compiler
+_TOOLS_PREFIX = {
+    "arm-none-eabi-gcc": "arm-none-eabi-",
+    "clang": "llvm-",
+    "xc32": "xc32-",
+    "xc16": "xc16-",
+}
+
+
+class FootprintError(Exception):
+    pass
+
+
+def variants_load(filename):
+    """Returns list of (name, flags) tuples."""
+    variants = []
+    with open(filename) as f:
+        for line in f:
+            line = line.split("#", 1)[0].strip()
+            if not line:
+                continue
+            fields = line.split(None, 1)
+            variants.append((fields[0], fields[1] if len(fields) > 1 else ""))
+    if not variants:
+        raise FootprintError("no variants in {}".format(filename))
+    return variants
+
+
+def tool_get(compiler, name):
+    """Returns target-specific tool if available, host one otherwise."""
+    prefixed = _TOOLS_PREFIX.get(compiler, "") + name
+    if shutil.which(prefixed):
+        return prefixed
+    return name
+
+
+def kernel_build(arch, compiler, variant, flags, log):
+    """Builds the kernel, returns the directory with object files."""
+    build_name = "footprint_" + variant
+    cmd = [
+        "make", "-C", _TOP_DIR, "all-actual",
+        "TN_ARCH=" + arch, "TN_COMPILER=" + compiler,
+        "TN_CFG_DIR=" + os.path.join(_THIS_DIR_REL, "cfg"),
+        "TN_BUILD_NAME=" + build_name,
+        "TN_CFLAGS_EXTRA=" + flags,
+    ]
+    proc = subprocess.run(
+        cmd, stdout=log, stderr=subprocess.STDOUT, universal_newlines=True
+    )
+    if proc.returncode != 0:
+        raise FootprintError("build failed")
+
+    return os.path.join(_TOP_DIR, "_obj", arch, compiler, build_name)
+
+
+def objects_sizes_get(obj_dir, nm):
+    """
+    Returns tuple (objs, funcs):
+      objs: dict object file name -> [text, data, bss]
+      funcs: dict function name -> size
+    """
+    objs = {}
+    funcs = {}
+
+    for obj in sorted(os.listdir(obj_dir)):
+        if not obj.endswith(".o"):
+            continue
+        out = subprocess.check_output(
+            [nm, "--print-size", "--defined-only", os.path.join(obj_dir, obj)],
+            universal_newlines=True,
+        )
+        sizes = [0, 0, 0]
+        for line in out.splitlines():
+            fields = line.split()
+            if len(fields) != 4:
+                #-- symbols without size aren't interesting
+                continue
+            size, typ, name = int(fields[1], 16), fields[2], fields[3]
+            if typ in _NM_TEXT_TYPES:
+                sizes[0] += size
+            elif typ in _NM_DATA_TYPES:
+                sizes[1] += size
+            elif typ in _NM_BSS_TYPES:
+                sizes[2] += size
+            if typ in _NM_FUNC_TYPES:
+                funcs[name] = size
+        objs[obj] = sizes
+
+    return objs, funcs
+
+
+_RE_DIE = re.compile(r"^\s*<\d+><[0-9a-f]+>: Abbrev Number: \d+ \((\w+)\)")
+_RE_NAME = re.compile(r"^\s*<[0-9a-f]+>\s+DW_AT_name\s*:.*?([A-Za-z_]\w*)\s*$")
+_RE_BYTE_SIZE = re.compile(r"^\s*<[0-9a-f]+>\s+DW_AT_byte_size\s*:\s*(\S+)")
+
+
+def structs_sizes_get(obj_dir, readelf):
+    """Returns dict struct name -> size, for the names from STRUCTS."""
+    res = {}
+
+    for obj in sorted(os.listdir(obj_dir)):
+        if not obj.endswith(".o") or len(res) == len(STRUCTS):
+            continue
+        out = subprocess.check_output(
+            [readelf, "--debug-dump=info", os.path.join(obj_dir, obj)],
+            universal_newlines=True, stderr=subprocess.DEVNULL,
+        )
+
+        #-- attributes of the current DIE may come in any order, so, they
+        #   are collected until the next DIE starts
+        in_struct = False
+        name = None
+        size = None
+        for line in out.splitlines() + [" <0><0>: Abbrev Number: 0 (end)"]:
+            m = _RE_DIE.match(line)
+            if m:
+                if in_struct and name in STRUCTS and size is not None:
+                    res.setdefault(name, size)
+                in_struct = (m.group(1) == "DW_TAG_structure_type")
+                name = None
+                size = None
+                continue
+            if not in_struct:
+                continue
+            m = _RE_NAME.match(line)
+            if m:
+                name = m.group(1)
+                continue
+            m = _RE_BYTE_SIZE.match(line)
+            if m:
+                size = int(m.group(1), 0)
+
+    return res
+
+
+class Report(object):
+    def __init__(self):
+        #-- (arch, variant) -> dict
+        self.totals = {}
+        self.structs = {}
+        self.objs = {}
+        self.funcs = {}
+        self.failed = {}
+        self.archs = []
+        self.variants = []
+
+    def add(self, arch, variant, objs, funcs, structs):
+        key = (arch, variant)
+        self.objs[key] = objs
+        self.funcs[key] = funcs
+        self.structs[key] = structs
+        self.totals[key] = [sum(s[i] for s in objs.values()) for i in range(3)]
+
+    def fail(self, arch, variant, reason):
+        self.failed[(arch, variant)] = reason
+
+    @staticmethod
+    def _rows_write(out, header, rows, labels_cnt=2):
+        """Writes table; first `labels_cnt` columns are left-aligned, other
+        ones (numbers) are right-aligned."""
+        widths = [
+            max(len(str(r[i])) for r in rows + [header])
+            for i in range(len(header))
+        ]
+        for row in [header] + rows:
+            cells = [
+                str(cell).ljust(widths[i]) if i < labels_cnt
+                else str(cell).rjust(widths[i])
+                for i, cell in enumerate(row)
+            ]
+            out.write("  ".join(cells).rstrip() + "\n")
+        out.write("\n")
+
+    def write(self, out):
+        base_variant = self.variants[0]
+
+        out.write(
+            "# TNeo footprint report, generated by "
+            "stuff/footprint/footprint.py\n"
+            "#\n"
+            "# Sizes are in bytes (as reported by the toolchain); \"text\" "
+            "includes read-only data.\n"
+            "# Deltas are against the \"{}\" variant.\n\n"
+            .format(base_variant)
+        )
+
+        #-- totals
+        out.write("## Totals\n\n")
+        rows = []
+        for arch in self.archs:
+            base = self.totals.get((arch, base_variant))
+            for variant in self.variants:
+                key = (arch, variant)
+                if key in self.failed:
+                    rows.append([arch, variant, "-", "-", "-", "FAILED:",
+                                 self.failed[key]])
+                    continue
+                t = self.totals[key]
+                if base is None or variant == base_variant:
+                    deltas = ["-", "-"]
+                else:
+                    deltas = ["{:+d}".format(t[0] - base[0]),
+                              "{:+d}".format(t[1] + t[2] - base[1] - base[2])]
+                rows.append([arch, variant] + t + deltas)
+        self._rows_write(
+            out,
+            ["arch", "variant", "text", "data", "bss", "d_text", "d_ram"],
+            rows,
+        )
+
+        #-- struct sizes
+        out.write("## Structures\n\n")
+        rows = []
+        for arch in self.archs:
+            for variant in self.variants:
+                s = self.structs.get((arch, variant))
+                if s is None:
+                    continue
+                rows.append(
+                    [arch, variant] + [s.get(name, "?") for name in STRUCTS]
+                )
+        self._rows_write(out, ["arch", "variant"] + STRUCTS, rows)
+
+        #-- object files
+        out.write("## Object files\n\n")
+        rows = []
+        for arch in self.archs:
+            for variant in self.variants:
+                objs = self.objs.get((arch, variant), {})
+                for obj in sorted(objs):
+                    rows.append([arch, variant, obj] + objs[obj])
+        self._rows_write(
+            out, ["arch", "variant", "object", "text", "data", "bss"], rows,
+            labels_cnt=3
+        )
+
+        #-- functions
+        out.write("## Functions\n\n")
+        rows = []
+        for arch in self.archs:
+            for variant in self.variants:
+                funcs = self.funcs.get((arch, variant), {})
+                for func in sorted(funcs):
+                    rows.append([arch, variant, func, funcs[func]])
+        self._rows_write(
+            out, ["arch", "variant", "function", "size"], rows, labels_cnt=3
+        )
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(
+        description="TNeo code size and RAM footprint report"
+    )
+    parser.add_argument(
+        "--arch", action="append", required=True, metavar="ARCH:COMPILER",
+        help="architecture and compiler, as given to the Makefile "
+             "(e.g. cortex_m3:arm-none-eabi-gcc); may be given several times"
+    )
+    parser.add_argument(
+        "--variants", default=os.path.join(
+            os.path.dirname(os.path.abspath(__file__)), "variants.txt"
+        ),
+        help="file with configuration variants (default: variants.txt)"
+    )
+    parser.add_argument(
+        "-o", "--output", default="-",
+        help="output file (default: stdout)"
+    )
+    parser.add_argument(
+        "--log", default=os.devnull,
+        help="file for the build output (default: discard)"
+    )
+    args = parser.parse_args(argv)
+
+    try:
+        variants = variants_load(args.variants)
+    except (IOError, FootprintError) as e:
+        sys.stderr.write("error: {}\n".format(e))
+        return 1
+
+    report = Report()
+    report.variants = [v[0] for v in variants]
+
+    with open(args.log, "a") as log:
+        for arch_compiler in args.arch:
+            arch, _, compiler = arch_compiler.partition(":")
+            if not compiler:
+                parser.error("wrong --arch value: " + arch_compiler)
+            arch_name = "{}/{}".format(arch, compiler)
+            report.archs.append(arch_name)
+
+            nm = tool_get(compiler, "nm")
+            readelf = tool_get(compiler, "readelf")
+
+            for variant, flags in variants:
+                sys.stderr.write("{} {} ...\n".format(arch_name, variant))
+                try:
+                    obj_dir = kernel_build(arch, compiler, variant, flags, log)
+                    objs, funcs = objects_sizes_get(obj_dir, nm)
+                    structs = structs_sizes_get(obj_dir, readelf)
+                except (FootprintError, OSError,
+                        subprocess.CalledProcessError) as e:
+                    report.fail(arch_name, variant, str(e))
+                    continue
+                report.add(arch_name, variant, objs, funcs, structs)
+
+    if args.output == "-":
+        report.write(sys.stdout)
+    else:
+        with open(args.output, "w") as f:
+            report.write(f)
+
+    return 1 if report.failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,310 @@
+#!/usr/bin/env python3
+#
+# TNeo: real-time kernel initially based on TNKernel
+#
+# Shows the snapshot of the registry of kernel objects, see
+# src/core/tn_obj_registry.h.
+#
+# The input is the raw contents of the buffer filled by
+# `tn_obj_registry_snapshot()`, obtained in the same way as the kernel trace
+# (see tntrace.py), e.g. with gdb:
+#
+#    (gdb) call tn_obj_registry_snapshot(my_buf, sizeof(my_buf) / sizeof(TN_UWord))
+#    (gdb) dump binary value objs.bin my_buf
+#
+# Object addresses are mapped to the names of the variables holding the
+# objects, if only they are statically allocated (needs the ELF file);
+# otherwise, use the names file (same format as for tntrace_perfetto.py).
+#
+# Usage:
+#
+#    tnobjreg.py objs.bin
+#    tnobjreg.py --elf app.elf --nm arm-none-eabi-nm objs.bin
+#    tnobjreg.py --names names.txt --serial /dev/ttyUSB0 --baud 115200
+#
+
+import argparse
+import os
+import struct
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+import tntrace
+
+
+TN_OBJ_REGISTRY_MAGIC = 0x524F4E54
+TN_OBJ_REGISTRY_FORMAT_VERSION = 3
+#-- version 1 is the same as 2, just without rwlocks, condvars and RPC
+#   objects; version 3 has added the flags field to the header
+_FORMAT_VERSIONS_SUPPORTED = (1, 2, 3)
+
+#-- header fields: magic, version, recs_cnt, objs_cnt, flags (since
+#   version 3)
+_HDR_WORDS_CNT = 5
+_HDR_WORDS_CNT_V2 = 4
+
+#-- header flags
+TN_OBJ_REGISTRY_SNAPSHOT_FLAG_INCOMPLETE = (1 << 0)
+#-- record fields: id, obj, args[4]
+_REC_WORDS_CNT = 6
+
+#-- enum TN_ObjId
+TN_ID_TASK = 0x47ABCF69
+TN_ID_SEMAPHORE = 0x6FA173EB
+TN_ID_EVENTGRP = 0x5E224F25
+TN_ID_DATAQUEUE = 0x0C8A6C89
+TN_ID_FSMEMORYPOOL = 0x26B7CE8B
+TN_ID_MUTEX = 0x17129E45
+TN_ID_TIMER = 0x1A937FBC
+TN_ID_CONDVAR = 0x4B1D3E27
+TN_ID_RWLOCK = 0x7E0A5C93
+TN_ID_RPC = 0x1C7B49E6
+
+#-- enum TN_TaskState (bit flags)
+TASK_STATES = {
+    0: "NONE", 1: "RUNNABLE", 2: "WAIT", 4: "SUSPEND", 6: "WAITSUSP",
+    8: "DORMANT",
+}
+
+
+class ObjRegistryCodecError(Exception):
+    pass
+
+
+def _hex(value):
+    return "0x{:08x}".format(value)
+
+
+#-- per type: title, column names, and function which formats arguments
+_TYPES = [
+    (TN_ID_TASK, "Tasks",
+     ("priority", "state", "wait reason", "stack words"),
+     lambda a, n: (
+         str(a[0]),
+         tntrace.enum_name_get(TASK_STATES, a[1]),
+         tntrace.enum_name_get(tntrace.WAIT_REASONS, a[2]),
+         str(a[3]),
+     )),
+    (TN_ID_SEMAPHORE, "Semaphores",
+     ("count", "max count", "waiters"),
+     lambda a, n: (str(a[0]), str(a[1]), str(a[2]))),
+    (TN_ID_MUTEX, "Mutexes",
+     ("holder", "lock cnt", "protocol", "waiters"),
+     lambda a, n: (
+         n(a[0]) if a[0] else "-",
+         str(a[1]),
+         tntrace.enum_name_get(tntrace.MUTEX_PROTOCOLS, a[2]),
+         str(a[3]),
+     )),
+    (TN_ID_DATAQUEUE, "Data queues",
+     ("capacity", "filled", "send waiters", "receive waiters"),
+     lambda a, n: (str(a[0]), str(a[1]), str(a[2]), str(a[3]))),
+    (TN_ID_EVENTGRP, "Event groups",
+     ("pattern", "waiters"),
+     lambda a, n: (_hex(a[0]), str(a[1]))),
+    (TN_ID_FSMEMORYPOOL, "Fixed memory pools",
+     ("block size", "blocks", "free", "waiters"),
+     lambda a, n: (str(a[0]), str(a[1]), str(a[2]), str(a[3]))),
+    (TN_ID_TIMER, "Timers",
+     ("func", "user data", "active", "ticks left"),
+     lambda a, n: (
+         n(a[0]),
+         n(a[1]) if a[1] else "-",
+         "yes" if a[2] else "no",
+         str(a[3]) if a[2] else "-",
+     )),
+    (TN_ID_RWLOCK, "Rwlocks",
+     ("writer", "readers", "holds", "waiters"),
+     lambda a, n: (
+         n(a[0]) if a[0] else "-", str(a[1]), str(a[2]), str(a[3]),
+     )),
+    (TN_ID_CONDVAR, "Condition variables",
+     ("mutex", "waiters"),
+     lambda a, n: (n(a[0]) if a[0] else "-", str(a[1]))),
+    (TN_ID_RPC, "RPC objects",
+     ("server", "client", "client waiters", "server waiters"),
+     lambda a, n: (
+         n(a[0]) if a[0] else "-",
+         n(a[1]) if a[1] else "-",
+         str(a[2]),
+         str(a[3]),
+     )),
+]
+
+
+def snapshot_decode(data):
+    """
+    Decodes the snapshot, returns tuple (objs_cnt, records, incomplete),
+    where records is the list of (id, obj, args) tuples. If objs_cnt is
+    larger than the number of records, the buffer on the target was too
+    small; if incomplete is True, some object was deleted while the snapshot
+    was being made, and the rest of objects of its type are missed.
+    """
+    for word_size, fmt in ((4, "I"), (2, "H")):
+        magic = TN_OBJ_REGISTRY_MAGIC & ((1 << (word_size * 8)) - 1)
+        for endian in ("<", ">"):
+            if len(data) < word_size:
+                continue
+            (value,) = struct.unpack_from(endian + fmt, data, 0)
+            if value == magic:
+                break
+        else:
+            continue
+        break
+    else:
+        raise ObjRegistryCodecError(
+            "magic value not found: not a TNeo objects registry snapshot"
+        )
+
+    ws = word_size
+    if len(data) < 2 * ws:
+        raise ObjRegistryCodecError("data is too short")
+
+    (version,) = struct.unpack_from(endian + fmt, data, ws)
+    if version not in _FORMAT_VERSIONS_SUPPORTED:
+        raise ObjRegistryCodecError(
+            "unsupported format version: {}".format(version)
+        )
+
+    hdr_words_cnt = _HDR_WORDS_CNT if version >= 3 else _HDR_WORDS_CNT_V2
+    hdr_size = hdr_words_cnt * ws
+    if len(data) < hdr_size:
+        raise ObjRegistryCodecError("data is too short")
+
+    hdr = struct.unpack_from(endian + fmt * hdr_words_cnt, data, 0)
+    recs_cnt, objs_cnt = hdr[2], hdr[3]
+    flags = hdr[4] if version >= 3 else 0
+
+    rec_size = _REC_WORDS_CNT * ws
+    avail = (len(data) - hdr_size) // rec_size
+    if avail < recs_cnt:
+        sys.stderr.write(
+            "warning: snapshot is truncated: {} records instead of {}\n"
+            .format(avail, recs_cnt)
+        )
+        recs_cnt = avail
+
+    #-- on 16-bit targets, ids are truncated to the word size
+    id_mask = (1 << (ws * 8)) - 1
+
+    recs = []
+    for idx in range(recs_cnt):
+        words = struct.unpack_from(
+            endian + fmt * _REC_WORDS_CNT, data, hdr_size + idx * rec_size
+        )
+        type_id = None
+        for t in _TYPES:
+            if (t[0] & id_mask) == words[0]:
+                type_id = t[0]
+                break
+        if type_id is None:
+            raise ObjRegistryCodecError(
+                "unknown object id: {}".format(_hex(words[0]))
+            )
+        recs.append((type_id, words[1], words[2:]))
+
+    incomplete = bool(flags & TN_OBJ_REGISTRY_SNAPSHOT_FLAG_INCOMPLETE)
+    return objs_cnt, recs, incomplete
+
+
+def report(objs_cnt, recs, name_get, out=sys.stdout, incomplete=False):
+    for type_id, title, columns, args_fmt in _TYPES:
+        rows = [
+            (name_get(obj),) + tuple(args_fmt(args, name_get))
+            for t, obj, args in recs if t == type_id
+        ]
+        if not rows:
+            continue
+
+        header = ("object",) + columns
+        widths = [
+            max(len(row[i]) for row in rows + [header])
+            for i in range(len(header))
+        ]
+
+        out.write("# {} ({})\n".format(title, len(rows)))
+        out.write("  ".join(
+            h.ljust(w) for h, w in zip(header, widths)
+        ).rstrip() + "\n")
+        for row in rows:
+            out.write("  ".join(
+                c.ljust(w) for c, w in zip(row, widths)
+            ).rstrip() + "\n")
+        out.write("\n")
+
+    if objs_cnt > len(recs):
+        out.write(
+            "# {} of {} objects are not shown: the buffer is too small\n"
+            .format(objs_cnt - len(recs), objs_cnt)
+        )
+    if incomplete:
+        out.write(
+            "# snapshot is incomplete: some object was deleted while the "
+            "snapshot was being made, the rest of objects of its type are "
+            "missed\n"
+        )
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(
+        description="Show snapshot of TNeo objects registry "
+                    "(see tn_obj_registry_snapshot())"
+    )
+    parser.add_argument(
+        "snapshot", nargs="?",
+        help="file with the raw contents of the snapshot buffer"
+    )
+    parser.add_argument(
+        "--serial", metavar="PORT",
+        help="read the snapshot from the serial port instead of the file"
+    )
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument(
+        "--elf", metavar="FILE",
+        help="ELF file of the application, to name the objects"
+    )
+    parser.add_argument(
+        "--nm", default="nm",
+        help="nm utility of the target toolchain (default: nm)"
+    )
+    parser.add_argument(
+        "--names", metavar="FILE",
+        help="file with \"address name\" lines, to name the objects"
+    )
+    args = parser.parse_args(argv)
+
+    if args.serial:
+        data_src = tntrace.DataSrcSerial(args.serial, args.baud)
+    elif args.snapshot:
+        data_src = tntrace.DataSrcSnapshot(args.snapshot)
+    else:
+        parser.error("either snapshot file or --serial should be given")
+
+    try:
+        objs_cnt, recs, incomplete = snapshot_decode(data_src.read())
+    except ObjRegistryCodecError as e:
+        sys.stderr.write("error: {}\n".format(e))
+        return 1
+
+    symtab = None
+    if args.elf:
+        import tnpcprof
+        symtab = tnpcprof.SymbolTable(args.elf, args.nm)
+    names = {}
+    if args.names:
+        import tntrace_perfetto
+        names = tntrace_perfetto.names_load(args.names)
+
+    def name_get(addr):
+        name = names.get(addr)
+        if name is None and symtab is not None:
+            name = symtab.data_get(addr) or symtab.func_get(addr)
+        return name or _hex(addr)
+
+    report(objs_cnt, recs, name_get, incomplete=incomplete)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
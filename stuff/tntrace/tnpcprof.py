@@ -0,0 +1,301 @@
+#!/usr/bin/env python3
+#
+# TNeo: real-time kernel initially based on TNKernel
+#
+# Flat profile from the PC samples buffer, see src/core/tn_pc_sample.h.
+#
+# The input is the raw contents of `struct TN_PCSampleBuf` (i.e. of the
+# `_tn_pc_sample_buf` variable), obtained in the same way as the kernel trace
+# (see tntrace.py), e.g. with gdb:
+#
+#    (gdb) dump binary value samples.bin _tn_pc_sample_buf
+#
+# Sampled PCs are mapped to functions by the symbol table of the ELF file,
+# which is read with `nm` from the target toolchain. Task addresses are
+# mapped to the names of the variables holding the tasks, if only they are
+# statically allocated; otherwise, use the names file (same format as for
+# tntrace_perfetto.py).
+#
+# Usage:
+#
+#    tnpcprof.py --elf app.elf samples.bin
+#    tnpcprof.py --elf app.elf --nm arm-none-eabi-nm --per-task samples.bin
+#    tnpcprof.py --elf app.elf --serial /dev/ttyUSB0 --baud 115200
+#
+
+import argparse
+import bisect
+import os
+import struct
+import subprocess
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+import tntrace
+
+
+TN_PC_SAMPLE_MAGIC = 0x53435054
+TN_PC_SAMPLE_FORMAT_VERSION = 1
+
+#-- header fields: magic, version, recs_cnt, wr_idx, wrapped, enabled
+_HDR_WORDS_CNT = 6
+#-- sample fields: pc, task
+_REC_WORDS_CNT = 2
+
+#-- nm symbol types which denote code and data, respectively
+_NM_CODE_TYPES = "TtWw"
+_NM_DATA_TYPES = "DdBbRrVvGgSs"
+
+_NAME_INTERRUPT = "[interrupt]"
+_NAME_UNKNOWN = "[unknown]"
+
+
+class PCSampleCodecError(Exception):
+    pass
+
+
+def samples_decode(data):
+    """
+    Decodes raw `struct TN_PCSampleBuf`, returns the list of (pc, task)
+    tuples, from the oldest sample to the newest one.
+    """
+    for word_size, fmt in ((4, "I"), (2, "H")):
+        magic = TN_PC_SAMPLE_MAGIC & ((1 << (word_size * 8)) - 1)
+        for endian in ("<", ">"):
+            if len(data) < word_size:
+                continue
+            (value,) = struct.unpack_from(endian + fmt, data, 0)
+            if value == magic:
+                break
+        else:
+            continue
+        break
+    else:
+        raise PCSampleCodecError(
+            "magic value not found: not a TNeo PC samples buffer"
+        )
+
+    ws = word_size
+    word_fmt = endian + fmt
+    hdr_size = _HDR_WORDS_CNT * ws
+    if len(data) < hdr_size:
+        raise PCSampleCodecError("data is too short")
+
+    magic, version, recs_cnt, wr_idx, wrapped, enabled = struct.unpack_from(
+        word_fmt[0] + word_fmt[1] * _HDR_WORDS_CNT, data, 0
+    )
+
+    if version != TN_PC_SAMPLE_FORMAT_VERSION:
+        raise PCSampleCodecError(
+            "unsupported format version: {}".format(version)
+        )
+
+    rec_size = _REC_WORDS_CNT * ws
+    avail = (len(data) - hdr_size) // rec_size
+    if avail < recs_cnt:
+        sys.stderr.write(
+            "warning: buffer is truncated: {} samples instead of {}\n"
+            .format(avail, recs_cnt)
+        )
+        recs_cnt = avail
+
+    if wr_idx >= max(recs_cnt, 1):
+        raise PCSampleCodecError("write index is out of range")
+
+    if wrapped:
+        #-- the sample at wr_idx is the oldest one, but it might be
+        #   half-written at the moment of snapshot, so, skip it.
+        indices = list(range(wr_idx + 1, recs_cnt)) + list(range(0, wr_idx))
+    else:
+        indices = range(0, wr_idx)
+
+    rec_fmt = word_fmt[0] + word_fmt[1] * _REC_WORDS_CNT
+    return [
+        struct.unpack_from(rec_fmt, data, hdr_size + idx * rec_size)
+        for idx in indices
+    ]
+
+
+class SymbolTable(object):
+    """Symbols of the ELF file, obtained by `nm`."""
+
+    def __init__(self, elf, nm="nm"):
+        out = subprocess.check_output(
+            [nm, "--defined-only", "--print-size", "--numeric-sort", elf],
+            universal_newlines=True,
+        )
+        self.code = self._parse(out, _NM_CODE_TYPES)
+        self.data = dict(
+            (addr, name) for addr, size, name in self._parse(out, _NM_DATA_TYPES)
+        )
+        self.code_addrs = [s[0] for s in self.code]
+
+    @staticmethod
+    def _parse(out, types):
+        syms = []
+        for line in out.splitlines():
+            fields = line.split()
+            if len(fields) == 4:
+                addr, size, typ, name = fields
+                size = int(size, 16)
+            elif len(fields) == 3:
+                addr, typ, name = fields
+                size = 0
+            else:
+                continue
+            if typ not in types:
+                continue
+            addr = int(addr, 16)
+            if typ in _NM_CODE_TYPES:
+                #-- Thumb (and microMIPS) functions have the lowest bit set
+                addr &= ~1
+            syms.append((addr, size, name))
+        syms.sort()
+        return syms
+
+    def func_get(self, pc):
+        """Returns name of the function containing the given address."""
+        idx = bisect.bisect_right(self.code_addrs, pc) - 1
+        if idx < 0:
+            return None
+        addr, size, name = self.code[idx]
+        if size and pc >= addr + size:
+            return None
+        return name
+
+    def data_get(self, addr):
+        """Returns name of the variable at exactly the given address."""
+        return self.data.get(addr)
+
+
+class Profile(object):
+    """Flat profile: number of samples per function, and, optionally, per
+    task."""
+
+    def __init__(self, symtab, names=None):
+        self.symtab = symtab
+        self.names = names or {}
+        self.total = 0
+        self.funcs = {}
+        self.tasks = {}
+
+    def task_name_get(self, task):
+        name = self.names.get(task)
+        if name is None and self.symtab is not None:
+            name = self.symtab.data_get(task)
+        return name or "0x{:08x}".format(task)
+
+    def func_name_get(self, pc):
+        if pc == 0:
+            return _NAME_INTERRUPT
+        if self.symtab is None:
+            #-- no ELF: just show raw addresses
+            return "0x{:08x}".format(pc)
+        return self.symtab.func_get(pc) or _NAME_UNKNOWN
+
+    def add(self, pc, task):
+        func = self.func_name_get(pc)
+        self.total += 1
+        self.funcs[func] = self.funcs.get(func, 0) + 1
+
+        per_task = self.tasks.setdefault(task, {})
+        per_task[func] = per_task.get(func, 0) + 1
+
+    def _print_table(self, funcs, total, limit, out):
+        out.write("{:>8} {:>7}  {}\n".format("samples", "%", "function"))
+        items = sorted(funcs.items(), key=lambda kv: (-kv[1], kv[0]))
+        if limit:
+            items = items[:limit]
+        for func, cnt in items:
+            out.write("{:8d} {:6.2f}%  {}\n".format(
+                cnt, 100.0 * cnt / total, func
+            ))
+
+    def report(self, per_task=False, limit=0, out=sys.stdout):
+        if not self.total:
+            out.write("no samples\n")
+            return
+
+        out.write("# {} samples total\n".format(self.total))
+        self._print_table(self.funcs, self.total, limit, out)
+
+        if per_task:
+            tasks = sorted(
+                self.tasks.items(), key=lambda kv: -sum(kv[1].values())
+            )
+            for task, funcs in tasks:
+                cnt = sum(funcs.values())
+                out.write("\n# task {}: {} samples ({:.2f}%)\n".format(
+                    self.task_name_get(task), cnt, 100.0 * cnt / self.total
+                ))
+                self._print_table(funcs, cnt, limit, out)
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(
+        description="Flat profile from TNeo PC samples buffer "
+                    "(struct TN_PCSampleBuf)"
+    )
+    parser.add_argument(
+        "snapshot", nargs="?",
+        help="file with the raw contents of the samples buffer"
+    )
+    parser.add_argument(
+        "--serial", metavar="PORT",
+        help="read the buffer from the serial port instead of the file"
+    )
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument(
+        "--elf", metavar="FILE",
+        help="ELF file of the application; without it, raw addresses "
+             "are shown"
+    )
+    parser.add_argument(
+        "--nm", default="nm",
+        help="nm utility of the target toolchain (default: nm)"
+    )
+    parser.add_argument(
+        "--names", metavar="FILE",
+        help="file with \"address name\" lines, to name the tasks"
+    )
+    parser.add_argument(
+        "--per-task", action="store_true",
+        help="additionally show profile of each task"
+    )
+    parser.add_argument(
+        "--limit", type=int, default=0, metavar="N",
+        help="show only N hottest functions in each table"
+    )
+    args = parser.parse_args(argv)
+
+    if args.serial:
+        data_src = tntrace.DataSrcSerial(args.serial, args.baud)
+    elif args.snapshot:
+        data_src = tntrace.DataSrcSnapshot(args.snapshot)
+    else:
+        parser.error("either snapshot file or --serial should be given")
+
+    try:
+        samples = samples_decode(data_src.read())
+    except PCSampleCodecError as e:
+        sys.stderr.write("error: {}\n".format(e))
+        return 1
+
+    symtab = SymbolTable(args.elf, args.nm) if args.elf else None
+    names = {}
+    if args.names:
+        import tntrace_perfetto
+        names = tntrace_perfetto.names_load(args.names)
+
+    profile = Profile(symtab, names)
+
+    for pc, task in samples:
+        profile.add(pc, task)
+
+    profile.report(per_task=args.per_task, limit=args.limit)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,600 @@
+#!/usr/bin/env python3
+#
+# TNeo: real-time kernel initially based on TNKernel
+#
+# Decoder of the binary kernel trace, see src/core/tn_trace.h.
+#
+# The input is the raw contents of `struct TN_TraceBuf` (i.e. of the
+# `_tn_trace_buf` variable). It can be obtained with the debugger, e.g. with
+# gdb:
+#
+#    (gdb) dump binary value trace.bin _tn_trace_buf
+#
+# or sent by the target itself via serial port: in this case, the target
+# should just send `sizeof(struct TN_TraceBuf)` bytes starting from the
+# address returned by `tn_trace_buf_get()`.
+#
+# Word size and endianness of the target are figured out automatically by the
+# `magic` value in the buffer header.
+#
+# Usage:
+#
+#    tntrace.py trace.bin
+#    tntrace.py --ts-freq 72000000 trace.bin
+#    tntrace.py --serial /dev/ttyUSB0 --baud 115200
+#
+# The module can also be imported by other tools: see `TNTracerCore`.
+#
+
+import argparse
+import struct
+import sys
+
+
+TN_TRACE_MAGIC = 0x54524E54
+TN_TRACE_FORMAT_VERSION = 1
+
+#-- header fields: magic, version, recs_cnt, wr_idx, wrapped, enabled
+_HDR_WORDS_CNT = 6
+#-- record fields: timestamp, info, obj, arg
+_REC_WORDS_CNT = 4
+
+_INFO_EVENT_MASK = 0x7f
+_INFO_ISR = (1 << 7)
+
+
+#-- enum TN_RCode
+RCODES = {
+    0: "OK",
+    -1: "TIMEOUT",
+    -2: "OVERFLOW",
+    -3: "WCONTEXT",
+    -4: "WSTATE",
+    -5: "WPARAM",
+    -6: "ILLEGAL_USE",
+    -7: "INVALID_OBJ",
+    -8: "DELETED",
+    -9: "FORCED",
+    -10: "INTERNAL",
+}
+
+#-- enum TN_WaitReason
+WAIT_REASONS = [
+    "NONE", "SLEEP", "SEM", "EVENT", "DQUE_WSEND", "DQUE_WRECEIVE",
+    "MUTEX_C", "MUTEX_I", "WFIXMEM", "CONDVAR",
+    "RWLOCK_R", "RWLOCK_W", "SELECT",
+    "RPC_CALL", "RPC_REPLY", "RPC_RECEIVE",
+]
+
+#-- enum TN_EGrpOp
+EGRP_OPS = ["SET", "CLEAR", "TOGGLE"]
+
+#-- enum TN_MutexProtocol
+MUTEX_PROTOCOLS = {1: "CEILING", 2: "INHERIT"}
+
+
+def enum_name_get(table, value):
+    try:
+        return table[value]
+    except (IndexError, KeyError):
+        return str(value)
+
+
+def _sign_extend_8(value):
+    return value - 0x100 if value & 0x80 else value
+
+
+# ---------------------------------------------------------------------------
+# Data sources
+# ---------------------------------------------------------------------------
+
+class DataSrc(object):
+    """Source of the raw trace buffer contents."""
+
+    def read(self):
+        """Returns raw bytes of `struct TN_TraceBuf`."""
+        raise NotImplementedError
+
+
+class DataSrcSnapshot(DataSrc):
+    """Memory dump saved to the file."""
+
+    def __init__(self, filename):
+        self.filename = filename
+
+    def read(self):
+        with open(self.filename, "rb") as f:
+            return f.read()
+
+
+class DataSrcSerial(DataSrc):
+    """Buffer sent by the target via serial port; needs pyserial."""
+
+    def __init__(self, port, baud=115200, timeout=1.0):
+        self.port = port
+        self.baud = baud
+        self.timeout = timeout
+
+    def read(self):
+        import serial
+
+        chunks = []
+        with serial.Serial(self.port, self.baud, timeout=self.timeout) as s:
+            #-- read until the target stops sending
+            while True:
+                chunk = s.read(4096)
+                if not chunk:
+                    break
+                chunks.append(chunk)
+        return b"".join(chunks)
+
+
+# ---------------------------------------------------------------------------
+# Events
+# ---------------------------------------------------------------------------
+
+class TNTracerEvent(object):
+    """Single decoded trace record; see `enum TN_TraceEvent`."""
+
+    code = None
+    name = "UNKNOWN"
+
+    def __init__(self, timestamp, code, isr, small, obj, arg):
+        self.timestamp = timestamp
+        self.code = code
+        self.isr = isr
+        self.small = small
+        self.obj = obj
+        self.arg = arg
+
+    def details(self):
+        return "small={} arg=0x{:x}".format(self.small, self.arg)
+
+    def __str__(self):
+        return "{:<16} obj=0x{:08x} {}".format(
+            self.name, self.obj, self.details()
+        )
+
+
+_events_by_code = {}
+
+
+def _event(code):
+    def register(cls):
+        cls.code = code
+        _events_by_code[code] = cls
+        return cls
+    return register
+
+
+@_event(1)
+class TNTracerEventContextSwitch(TNTracerEvent):
+    name = "CONTEXT_SWITCH"
+
+    def details(self):
+        return "from=0x{:08x}".format(self.arg)
+
+
+@_event(2)
+class TNTracerEventTaskCreated(TNTracerEvent):
+    name = "TASK_CREATE"
+
+    def details(self):
+        return "priority={} func=0x{:08x}".format(self.small, self.arg)
+
+
+@_event(3)
+class TNTracerEventTaskDestroyed(TNTracerEvent):
+    name = "TASK_DELETE"
+
+    def details(self):
+        return ""
+
+
+@_event(4)
+class TNTracerEventTaskActivated(TNTracerEvent):
+    name = "TASK_ACTIVATE"
+
+    def details(self):
+        return ""
+
+
+@_event(5)
+class TNTracerEventTaskTerminated(TNTracerEvent):
+    name = "TASK_TERMINATE"
+
+    def details(self):
+        return ""
+
+
+@_event(6)
+class TNTracerEventTaskSuspended(TNTracerEvent):
+    name = "TASK_SUSPEND"
+
+    def details(self):
+        return ""
+
+
+@_event(7)
+class TNTracerEventTaskResumed(TNTracerEvent):
+    name = "TASK_RESUME"
+
+    def details(self):
+        return ""
+
+
+@_event(8)
+class TNTracerEventTaskWait(TNTracerEvent):
+    name = "TASK_WAIT"
+
+    def details(self):
+        return "reason={} queue=0x{:08x}".format(
+            enum_name_get(WAIT_REASONS, self.small), self.arg
+        )
+
+
+@_event(9)
+class TNTracerEventTaskWaitEnd(TNTracerEvent):
+    name = "TASK_WAIT_END"
+
+    def __init__(self, *args):
+        super(TNTracerEventTaskWaitEnd, self).__init__(*args)
+        self.small = _sign_extend_8(self.small)
+
+    def details(self):
+        return "rc={} queue=0x{:08x}".format(
+            enum_name_get(RCODES, self.small), self.arg
+        )
+
+
+@_event(10)
+class TNTracerEventTaskPriority(TNTracerEvent):
+    name = "TASK_PRIORITY"
+
+    def details(self):
+        return "priority={} (was {})".format(self.small, self.arg)
+
+
+@_event(16)
+class TNTracerEventMutexCreated(TNTracerEvent):
+    name = "MUTEX_CREATE"
+
+    def details(self):
+        return "protocol={} ceil_priority={}".format(
+            enum_name_get(MUTEX_PROTOCOLS, self.small), self.arg
+        )
+
+
+@_event(17)
+class TNTracerEventMutexDestroyed(TNTracerEvent):
+    name = "MUTEX_DELETE"
+
+    def details(self):
+        return ""
+
+
+@_event(18)
+class TNTracerEventMutexLocked(TNTracerEvent):
+    name = "MUTEX_LOCK"
+
+    def details(self):
+        return "holder=0x{:08x}".format(self.arg)
+
+
+@_event(19)
+class TNTracerEventMutexUnlocked(TNTracerEvent):
+    name = "MUTEX_UNLOCK"
+
+    def details(self):
+        return "holder=0x{:08x}".format(self.arg)
+
+
+@_event(24)
+class TNTracerEventSemCreated(TNTracerEvent):
+    name = "SEM_CREATE"
+
+    def details(self):
+        return "count={}".format(self.arg)
+
+
+@_event(25)
+class TNTracerEventSemDestroyed(TNTracerEvent):
+    name = "SEM_DELETE"
+
+    def details(self):
+        return ""
+
+
+@_event(26)
+class TNTracerEventSemSignal(TNTracerEvent):
+    name = "SEM_SIGNAL"
+
+    def details(self):
+        return "count={}".format(self.arg)
+
+
+@_event(27)
+class TNTracerEventSemAcquire(TNTracerEvent):
+    name = "SEM_ACQUIRE"
+
+    def details(self):
+        return "count={}".format(self.arg)
+
+
+@_event(32)
+class TNTracerEventDQueueCreated(TNTracerEvent):
+    name = "DQUEUE_CREATE"
+
+    def details(self):
+        return "items_cnt={}".format(self.arg)
+
+
+@_event(33)
+class TNTracerEventDQueueDestroyed(TNTracerEvent):
+    name = "DQUEUE_DELETE"
+
+    def details(self):
+        return ""
+
+
+@_event(34)
+class TNTracerEventDQueueSend(TNTracerEvent):
+    name = "DQUEUE_SEND"
+
+    def details(self):
+        return "data=0x{:08x}".format(self.arg)
+
+
+@_event(35)
+class TNTracerEventDQueueReceive(TNTracerEvent):
+    name = "DQUEUE_RECEIVE"
+
+    def details(self):
+        return "data=0x{:08x}".format(self.arg)
+
+
+@_event(40)
+class TNTracerEventEventGrpCreated(TNTracerEvent):
+    name = "EVENTGRP_CREATE"
+
+    def details(self):
+        return "pattern=0x{:x}".format(self.arg)
+
+
+@_event(41)
+class TNTracerEventEventGrpDestroyed(TNTracerEvent):
+    name = "EVENTGRP_DELETE"
+
+    def details(self):
+        return ""
+
+
+@_event(42)
+class TNTracerEventEventGrpModify(TNTracerEvent):
+    name = "EVENTGRP_MODIFY"
+
+    def details(self):
+        return "op={} pattern=0x{:x}".format(
+            enum_name_get(EGRP_OPS, self.small), self.arg
+        )
+
+
+@_event(48)
+class TNTracerEventTimerStart(TNTracerEvent):
+    name = "TIMER_START"
+
+    def details(self):
+        return "timeout={}".format(self.arg)
+
+
+@_event(49)
+class TNTracerEventTimerCancel(TNTracerEvent):
+    name = "TIMER_CANCEL"
+
+    def details(self):
+        return ""
+
+
+@_event(50)
+class TNTracerEventTimerFire(TNTracerEvent):
+    name = "TIMER_FIRE"
+
+    def details(self):
+        return "func=0x{:08x}".format(self.arg)
+
+
+@_event(127)
+class TNTracerEventUser(TNTracerEvent):
+    name = "USER"
+
+    def details(self):
+        return "id={} arg=0x{:x}".format(self.small, self.arg)
+
+
+def event_create(timestamp, code, isr, small, obj, arg):
+    cls = _events_by_code.get(code, TNTracerEvent)
+    ev = cls(timestamp, code, isr, small, obj, arg)
+    return ev
+
+
+# ---------------------------------------------------------------------------
+# Codecs
+# ---------------------------------------------------------------------------
+
+class DataCodecError(Exception):
+    pass
+
+
+class DataCodec(object):
+    """Converts raw bytes from `DataSrc` into the list of `TNTracerEvent`."""
+
+    def decode(self, data):
+        raise NotImplementedError
+
+
+class DataCodecTN(DataCodec):
+    """Codec for `struct TN_TraceBuf`, format version 1."""
+
+    def __init__(self):
+        self.word_size = None
+        self.endian = None
+        self.recs_cnt = 0
+        self.enabled = False
+
+    def _detect(self, data):
+        for word_size, fmt in ((4, "I"), (2, "H")):
+            magic = TN_TRACE_MAGIC & ((1 << (word_size * 8)) - 1)
+            for endian in ("<", ">"):
+                if len(data) < word_size:
+                    continue
+                (value,) = struct.unpack_from(endian + fmt, data, 0)
+                if value == magic:
+                    return word_size, endian + fmt
+        raise DataCodecError("magic value not found: not a TNeo trace buffer")
+
+    def decode(self, data):
+        self.word_size, word_fmt = self._detect(data)
+        ws = self.word_size
+        endian = word_fmt[0]
+        fmt = word_fmt[1]
+
+        hdr_size = _HDR_WORDS_CNT * ws
+        if len(data) < hdr_size:
+            raise DataCodecError("data is too short")
+
+        magic, version, recs_cnt, wr_idx, wrapped, enabled = struct.unpack_from(
+            endian + fmt * _HDR_WORDS_CNT, data, 0
+        )
+
+        if version != TN_TRACE_FORMAT_VERSION:
+            raise DataCodecError(
+                "unsupported trace format version: {}".format(version)
+            )
+
+        rec_size = _REC_WORDS_CNT * ws
+        avail = (len(data) - hdr_size) // rec_size
+        if avail < recs_cnt:
+            sys.stderr.write(
+                "warning: buffer is truncated: {} records instead of {}\n"
+                .format(avail, recs_cnt)
+            )
+            recs_cnt = avail
+
+        if wr_idx >= max(recs_cnt, 1):
+            raise DataCodecError("write index is out of range")
+
+        self.endian = endian
+        self.recs_cnt = recs_cnt
+        self.enabled = bool(enabled)
+
+        if wrapped:
+            #-- the record at wr_idx is the oldest one, but it might be
+            #   half-written at the moment of snapshot, so, skip it.
+            indices = list(range(wr_idx + 1, recs_cnt)) + list(range(0, wr_idx))
+        else:
+            indices = range(0, wr_idx)
+
+        rec_fmt = endian + fmt * _REC_WORDS_CNT
+        ts_modulo = 1 << (ws * 8)
+        ts_high = 0
+        ts_prev = None
+
+        events = []
+        for idx in indices:
+            ts, info, obj, arg = struct.unpack_from(
+                rec_fmt, data, hdr_size + idx * rec_size
+            )
+
+            #-- timestamps wrap around: make them monotonic
+            if ts_prev is not None and ts < ts_prev:
+                ts_high += ts_modulo
+            ts_prev = ts
+
+            events.append(event_create(
+                timestamp=ts_high + ts,
+                code=info & _INFO_EVENT_MASK,
+                isr=bool(info & _INFO_ISR),
+                small=(info >> 8) & 0xff,
+                obj=obj,
+                arg=arg,
+            ))
+
+        return events
+
+
+# ---------------------------------------------------------------------------
+# Core
+# ---------------------------------------------------------------------------
+
+class TNTracerCore(object):
+    """Glues data source and codec together, and keeps decoded events."""
+
+    def __init__(self, data_src, data_codec=None):
+        self.data_src = data_src
+        self.data_codec = data_codec or DataCodecTN()
+        self.events = []
+
+    def load(self):
+        self.events = self.data_codec.decode(self.data_src.read())
+        return self.events
+
+
+def _ts_format(ts, ts_freq):
+    if ts_freq:
+        return "{:14.6f}".format(float(ts) / ts_freq)
+    return "{:14d}".format(ts)
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(
+        description="Decode TNeo kernel trace buffer (struct TN_TraceBuf)"
+    )
+    parser.add_argument(
+        "snapshot", nargs="?",
+        help="file with the raw contents of the trace buffer"
+    )
+    parser.add_argument(
+        "--serial", metavar="PORT",
+        help="read the buffer from the serial port instead of the file"
+    )
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument(
+        "--ts-freq", type=float, default=0, metavar="HZ",
+        help="timestamp frequency; if given, timestamps are shown in seconds"
+    )
+    args = parser.parse_args(argv)
+
+    if args.serial:
+        data_src = DataSrcSerial(args.serial, args.baud)
+    elif args.snapshot:
+        data_src = DataSrcSnapshot(args.snapshot)
+    else:
+        parser.error("either snapshot file or --serial should be given")
+
+    core = TNTracerCore(data_src)
+    try:
+        events = core.load()
+    except DataCodecError as e:
+        sys.stderr.write("error: {}\n".format(e))
+        return 1
+
+    codec = core.data_codec
+    print("# word size: {}, {} endian, {} records of {}{}".format(
+        codec.word_size,
+        "little" if codec.endian == "<" else "big",
+        len(events), codec.recs_cnt,
+        "" if codec.enabled else ", tracing disabled",
+    ))
+
+    for ev in events:
+        print("{} {:3} {}".format(
+            _ts_format(ev.timestamp, args.ts_freq),
+            "ISR" if ev.isr else "",
+            ev,
+        ))
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,294 @@
+#!/usr/bin/env python3
+#
+# TNeo: real-time kernel initially based on TNKernel
+#
+# Converts the binary kernel trace (see src/core/tn_trace.h and tntrace.py)
+# to the Chrome JSON trace format, which can be opened by the Perfetto UI
+# (https://ui.perfetto.dev) or by chrome://tracing.
+#
+# What is shown:
+#
+#   - one track per task, with a slice for each interval during which the
+#     task was running (derived from CONTEXT_SWITCH records);
+#   - a separate "ISR / startup" track, with a short slice for each record
+#     made from interrupt context (or before the first context switch);
+#   - blocking intervals (TASK_WAIT .. TASK_WAIT_END) as async slices named
+#     after the wait reason;
+#   - kernel events (mutex lock/unlock, semaphore signal, queue send/receive,
+#     etc) as instant events on the track of the task (or ISR) that caused
+#     them;
+#   - flow arrows from the signaller (the task or ISR that was running when
+#     a waiting task got woken up) to the next running slice of the woken
+#     task. So, e.g. mutex hand-off looks like an arrow from the unlocking
+#     task to the new holder.
+#
+# Usage:
+#
+#    tntrace_perfetto.py trace.bin -o trace.json
+#    tntrace_perfetto.py --ts-freq 72000000 --names names.txt trace.bin
+#
+# The names file contains lines like "0x20000100 task_a", giving
+# human-readable names to object addresses.
+#
+
+import argparse
+import json
+import os
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+import tntrace
+
+
+_PID = 1
+_TID_ISR = 1
+
+#-- events which are shown as instant events on the causing track
+_INSTANT_EVENTS = {
+    tntrace.TNTracerEventTaskCreated,
+    tntrace.TNTracerEventTaskDestroyed,
+    tntrace.TNTracerEventTaskActivated,
+    tntrace.TNTracerEventTaskTerminated,
+    tntrace.TNTracerEventTaskSuspended,
+    tntrace.TNTracerEventTaskResumed,
+    tntrace.TNTracerEventTaskPriority,
+    tntrace.TNTracerEventMutexLocked,
+    tntrace.TNTracerEventMutexUnlocked,
+    tntrace.TNTracerEventSemSignal,
+    tntrace.TNTracerEventSemAcquire,
+    tntrace.TNTracerEventDQueueSend,
+    tntrace.TNTracerEventDQueueReceive,
+    tntrace.TNTracerEventEventGrpModify,
+    tntrace.TNTracerEventTimerFire,
+    tntrace.TNTracerEventUser,
+}
+
+
+def names_load(filename):
+    """Loads "address name" pairs from the file."""
+    names = {}
+    with open(filename) as f:
+        for line in f:
+            line = line.split("#", 1)[0].strip()
+            if not line:
+                continue
+            addr, name = line.split(None, 1)
+            names[int(addr, 0)] = name.strip()
+    return names
+
+
+class ChromeTraceExporter(object):
+    """Converts the list of `tntrace.TNTracerEvent` into Chrome JSON events."""
+
+    def __init__(self, ts_freq=0, names=None):
+        #-- if frequency isn't given, one timestamp unit is one microsecond
+        self.ts_scale = (1000000.0 / ts_freq) if ts_freq else 1.0
+        self.names = names or {}
+
+        self.out = []
+        self.tids = {}
+        self.priorities = {}
+
+        #-- task which is currently running, and start of its slice
+        self.cur_task = None
+        self.cur_start = None
+
+        #-- pending flows: task address -> flow id
+        self.flows_pending = {}
+        self.flow_id_next = 1
+
+        #-- async wait slices in progress: task address -> slice name
+        self.waits = {}
+
+    def _us(self, ts):
+        return ts * self.ts_scale
+
+    def _name(self, addr):
+        return self.names.get(addr, "0x{:08x}".format(addr))
+
+    def _tid(self, task):
+        if task not in self.tids:
+            #-- tid 1 is reserved for ISR track
+            self.tids[task] = len(self.tids) + 2
+        return self.tids[task]
+
+    def _emit(self, **kw):
+        kw.setdefault("pid", _PID)
+        self.out.append(kw)
+
+    def _slice_end(self, ts):
+        if self.cur_task is not None:
+            self._emit(
+                name=self._name(self.cur_task), ph="X", cat="run",
+                tid=self._tid(self.cur_task),
+                ts=self._us(self.cur_start),
+                dur=max(self._us(ts - self.cur_start), 0),
+            )
+        self.cur_task = None
+        self.cur_start = None
+
+    def _slice_begin(self, task, ts):
+        self.cur_task = task
+        self.cur_start = ts
+
+        #-- if the task was woken up by someone, finish the flow arrow
+        #   here: it binds to the slice that starts right now
+        flow_id = self.flows_pending.pop(task, None)
+        if flow_id is not None:
+            self._emit(
+                name="wakeup", ph="f", cat="wakeup", id=flow_id,
+                tid=self._tid(task), ts=self._us(ts),
+            )
+
+    def _causer_tid(self, ev):
+        if ev.isr or self.cur_task is None:
+            return _TID_ISR
+        return self._tid(self.cur_task)
+
+    def _on_context_switch(self, ev):
+        self._slice_end(ev.timestamp)
+        self._slice_begin(ev.obj, ev.timestamp)
+
+    def _on_wait(self, ev):
+        name = "wait {}".format(
+            tntrace.enum_name_get(tntrace.WAIT_REASONS, ev.small)
+        )
+        if ev.arg:
+            name += " " + self._name(ev.arg)
+        self.waits[ev.obj] = name
+        self._emit(
+            name=name, ph="b", cat="wait", id=ev.obj,
+            tid=self._tid(ev.obj), ts=self._us(ev.timestamp),
+        )
+
+    def _on_wait_end(self, ev):
+        name = self.waits.pop(ev.obj, None)
+        if name is not None:
+            self._emit(
+                name=name, ph="e", cat="wait", id=ev.obj,
+                tid=self._tid(ev.obj), ts=self._us(ev.timestamp),
+                args={"rc": tntrace.enum_name_get(tntrace.RCODES, ev.small)},
+            )
+
+        if ev.isr or ev.obj != self.cur_task:
+            #-- the task is woken up by someone else: draw an arrow from the
+            #   signaller.
+            tid = self._causer_tid(ev)
+            if tid == _TID_ISR:
+                #-- flow should be bound to a slice, so, make a tiny one
+                self._emit(
+                    name="ISR", ph="X", cat="isr", tid=_TID_ISR,
+                    ts=self._us(ev.timestamp), dur=0,
+                )
+
+            flow_id = self.flow_id_next
+            self.flow_id_next += 1
+
+            self._emit(
+                name="wakeup", ph="s", cat="wakeup", id=flow_id,
+                tid=tid, ts=self._us(ev.timestamp),
+            )
+            self.flows_pending[ev.obj] = flow_id
+
+    def _on_instant(self, ev):
+        tid = self._causer_tid(ev)
+        if tid == _TID_ISR:
+            self._emit(
+                name=ev.name, ph="X", cat="isr", tid=_TID_ISR,
+                ts=self._us(ev.timestamp), dur=0,
+            )
+        self._emit(
+            name="{} {}".format(ev.name, self._name(ev.obj)),
+            ph="i", s="t", cat="kernel", tid=tid,
+            ts=self._us(ev.timestamp),
+            args={"details": ev.details()},
+        )
+
+    def convert(self, events):
+        for ev in events:
+            if isinstance(ev, tntrace.TNTracerEventContextSwitch):
+                self._on_context_switch(ev)
+            elif isinstance(ev, tntrace.TNTracerEventTaskWait):
+                self._on_wait(ev)
+            elif isinstance(ev, tntrace.TNTracerEventTaskWaitEnd):
+                self._on_wait_end(ev)
+            elif type(ev) in _INSTANT_EVENTS:
+                if isinstance(ev, tntrace.TNTracerEventTaskCreated):
+                    self.priorities[ev.obj] = ev.small
+                self._on_instant(ev)
+
+        if events:
+            self._slice_end(events[-1].timestamp)
+
+        return self._metadata() + self.out
+
+    def _metadata(self):
+        meta = [
+            dict(name="process_name", ph="M", pid=_PID,
+                 args={"name": "TNeo"}),
+            dict(name="thread_name", ph="M", pid=_PID, tid=_TID_ISR,
+                 args={"name": "ISR / startup"}),
+            dict(name="thread_sort_index", ph="M", pid=_PID, tid=_TID_ISR,
+                 args={"sort_index": -1}),
+        ]
+        for task, tid in self.tids.items():
+            meta.append(dict(
+                name="thread_name", ph="M", pid=_PID, tid=tid,
+                args={"name": self._name(task)},
+            ))
+            if task in self.priorities:
+                meta.append(dict(
+                    name="thread_sort_index", ph="M", pid=_PID, tid=tid,
+                    args={"sort_index": self.priorities[task]},
+                ))
+        return meta
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(
+        description="Convert TNeo kernel trace to Chrome/Perfetto JSON"
+    )
+    parser.add_argument(
+        "snapshot", help="file with the raw contents of the trace buffer"
+    )
+    parser.add_argument(
+        "-o", "--output", default="-",
+        help="output JSON file (default: stdout)"
+    )
+    parser.add_argument(
+        "--ts-freq", type=float, default=0, metavar="HZ",
+        help="timestamp frequency; if not given, one timestamp unit is "
+             "shown as one microsecond"
+    )
+    parser.add_argument(
+        "--names", metavar="FILE",
+        help="file with \"address name\" lines"
+    )
+    args = parser.parse_args(argv)
+
+    core = tntrace.TNTracerCore(tntrace.DataSrcSnapshot(args.snapshot))
+    try:
+        events = core.load()
+    except tntrace.DataCodecError as e:
+        sys.stderr.write("error: {}\n".format(e))
+        return 1
+
+    names = names_load(args.names) if args.names else {}
+    exporter = ChromeTraceExporter(ts_freq=args.ts_freq, names=names)
+    trace = {
+        "traceEvents": exporter.convert(events),
+        "displayTimeUnit": "ns",
+    }
+
+    if args.output == "-":
+        json.dump(trace, sys.stdout, indent=1)
+    else:
+        with open(args.output, "w") as f:
+            json.dump(trace, f, indent=1)
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())